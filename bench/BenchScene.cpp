@@ -0,0 +1,622 @@
+#include <cmath>
+#include <climits>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+#include <string_view>
+
+#include <spdlog/spdlog.h>
+#include <spdlog/sinks/stdout_color_sinks.h>
+#include <glm/gtc/constants.hpp>
+
+#include <Engine.h>
+#include <Scene.h>
+#include <SceneComponent.h>
+#include <Graphics.h>
+#include <DynamicResolution.h>
+#include <GPUProfiler.h>
+#include <Profiler.h>
+#include <RenderStats.h>
+#include <TimeSystem.h>
+#include <Resources.h>
+#include <Shader.h>
+#include <Mesh.h>
+#include <Material.h>
+#include <MeshRenderer.h>
+#include <Camera.h>
+#include <Light.h>
+#include <ReflectionProbe.h>
+#include <Stars.h>
+#include <FrameCapture.h>
+#include <AllocationTracker.h>
+#include <MemoryTracker.h>
+
+enum class Hierarchy {
+	Wide,
+	Deep
+};
+
+struct BenchParams {
+	std::string name = "custom";
+	int frames = 300;
+	int warmupFrames = 30;
+	unsigned int width = 1280;
+	unsigned int height = 720;
+	float timestep = 1.0f / 60.0f;
+	uint32_t seed = 1;
+
+	int renderers = 1000;
+	bool sharedMaterials = true;
+	int pointShadows = 1;
+	int spotShadows = 1;
+	int directionalShadows = 1;
+	int probes = 0;
+	Hierarchy hierarchy = Hierarchy::Wide;
+	int hierarchyDepth = 32;
+	int stars = 0;
+	bool animate = true;
+	bool temporalUpsampling = false;
+	float renderScale = 1.0f;
+
+	bool allocations = false;
+	bool zeroAllocations = false;
+
+	std::string capture;
+	std::string replay;
+	std::string output;
+};
+
+struct Preset {
+	const char* name;
+	void (*apply)(BenchParams& params);
+};
+
+const Preset PRESETS[] = {
+	{ "renderers",        [](BenchParams& p) { p.renderers = 5000; p.sharedMaterials = true; } },
+	{ "unique-materials", [](BenchParams& p) { p.renderers = 5000; p.sharedMaterials = false; } },
+	{ "shadows",          [](BenchParams& p) { p.renderers = 1000; p.pointShadows = 4; p.spotShadows = 4; p.directionalShadows = 1; } },
+	{ "probes",           [](BenchParams& p) { p.renderers = 500; p.probes = 8; } },
+	{ "deep-hierarchy",   [](BenchParams& p) { p.renderers = 5000; p.hierarchy = Hierarchy::Deep; p.hierarchyDepth = 64; } },
+	{ "stars",            [](BenchParams& p) { p.renderers = 100; p.stars = 100000; } },
+};
+
+class Spinner : public GameObject {
+private:
+	float degreesPerSecond;
+public:
+	Spinner(float degreesPerSecond):
+	degreesPerSecond(degreesPerSecond) { }
+
+	void Update() {
+		this->LocalTransform().Rotation() *= glm::angleAxis(glm::radians(this->degreesPerSecond * Time::Delta()), glm::vec3(0.0f, 1.0f, 0.0f));
+	}
+};
+
+// Samples the previous frame at the start of every update, once its CPU time and render counters are final
+class BenchRecorder : public SceneComponent {
+private:
+	int warmupFrames;
+	int frame;
+	unsigned int lastGPUFrame;
+	std::string capturePath;
+public:
+	std::vector<float> cpuTimes;
+	std::vector<float> gpuTimes;
+	std::vector<RenderStats::Snapshot> renderStats;
+	std::vector<uint64_t> allocationCounts;
+	std::vector<uint64_t> allocationBytes;
+
+	BenchRecorder(Scene* scene):
+	SceneComponent(scene),
+	warmupFrames(0),
+	frame(0),
+	lastGPUFrame(0),
+	capturePath() { }
+
+	void SetWarmupFrames(int warmupFrames) {
+		this->warmupFrames = warmupFrames;
+	}
+
+	void SetCapturePath(const std::string& capturePath) {
+		this->capturePath = capturePath;
+	}
+
+	// Sampling runs inside Scene::Update, so the sample storage must not grow while measuring
+	void Reserve(int frames) {
+		this->cpuTimes.reserve(frames);
+		this->gpuTimes.reserve(frames);
+		this->renderStats.reserve(frames);
+		this->allocationCounts.reserve(frames);
+		this->allocationBytes.reserve(frames);
+	}
+
+	virtual void OnPreUpdate() {
+		GPUProfiler* gpuProfiler = GetScene()->GetGraphics()->GetGPUProfiler();
+
+		// GPU timings arrive a few frames late and skip frames whose queries were not ready in time
+		unsigned int gpuFrame = gpuProfiler->GetTimingsFrame();
+
+		if (gpuFrame != this->lastGPUFrame && gpuFrame >= (unsigned int) this->warmupFrames && !gpuProfiler->GetTimings().empty()) {
+			this->gpuTimes.push_back(gpuProfiler->GetFrameTime());
+		}
+
+		this->lastGPUFrame = gpuFrame;
+
+		// The first measured frame is the one worth replaying
+		if (this->frame == this->warmupFrames && !this->capturePath.empty()) {
+			GetScene()->GetGraphics()->CaptureFrame(this->capturePath);
+		}
+
+		if (this->frame++ <= this->warmupFrames) {
+			return;
+		}
+
+		this->cpuTimes.push_back(Profiler::GetLastFrameTime());
+		this->renderStats.push_back(RenderStats::GetLastFrame());
+
+		if (AllocationTracker::IsEnabled()) {
+			this->allocationCounts.push_back(AllocationTracker::GetLastFrame().count);
+			this->allocationBytes.push_back(AllocationTracker::GetLastFrame().bytes);
+		}
+	}
+
+	virtual int Order() {
+		return INT_MIN + 1;
+	}
+};
+
+void PrintUsage() {
+	std::string presets;
+
+	for (const Preset& preset : PRESETS) {
+		presets += std::format(" {}", preset.name);
+	}
+
+	fprintf(stderr,
+		"Usage: syzyf_bench_scene [options]\n"
+		"  --preset NAME           Start from a named configuration:%s\n"
+		"  --frames N              Measured frames (default 300)\n"
+		"  --warmup N              Frames rendered before measuring (default 30)\n"
+		"  --resolution WxH        Output resolution (default 1280x720)\n"
+		"  --timestep SECONDS      Fixed simulation step (default 1/60)\n"
+		"  --seed N                Seed for object placement (default 1)\n"
+		"  --renderers N           Mesh renderers in the scene\n"
+		"  --unique-materials      Give every renderer its own material\n"
+		"  --shared-materials      Make all renderers share one material\n"
+		"  --point-shadows N       Shadow casting point lights\n"
+		"  --spot-shadows N        Shadow casting spot lights\n"
+		"  --directional-shadows N Shadow casting directional lights\n"
+		"  --probes N              Reflection probes\n"
+		"  --hierarchy wide|deep   Parent renderers to one node or chain them\n"
+		"  --depth N               Chain length of the deep hierarchy (default 32)\n"
+		"  --stars N               Instances drawn by the Stars object\n"
+		"  --static                Disable the spinning scene root\n"
+		"  --temporal-upsampling   Jitter the camera and resolve with temporal upsampling\n"
+		"  --render-scale S        Fixed render scale, dynamic resolution stays off (default 1)\n"
+		"  --allocations           Report heap allocations per frame, needs SYZYF_ALLOCATION_TRACKING\n"
+		"  --zero-alloc            Like --allocations, and flag every allocation in measured frames\n"
+		"  --capture PATH          Save the first measured frame as a frame capture\n"
+		"  --replay PATH           Render a frame capture in a loop instead of building a scene\n"
+		"  --output PATH           Write the JSON report to PATH instead of stdout\n",
+		presets.c_str()
+	);
+}
+
+bool ParseArgs(int argc, char** argv, BenchParams& params) {
+	for (int i = 1; i < argc; i++) {
+		std::string_view arg = argv[i];
+		const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+
+		auto takesValue = [&]() {
+			if (value == nullptr) {
+				spdlog::error("Missing value for {}", arg);
+				return false;
+			}
+
+			i++;
+			return true;
+		};
+
+		if (arg == "--help" || arg == "-h") {
+			PrintUsage();
+			return false;
+		}
+		else if (arg == "--preset") {
+			if (!takesValue()) return false;
+
+			auto preset = std::find_if(std::begin(PRESETS), std::end(PRESETS), [&](const Preset& p) { return value == std::string_view(p.name); });
+
+			if (preset == std::end(PRESETS)) {
+				spdlog::error("Unknown preset {}", value);
+				return false;
+			}
+
+			preset->apply(params);
+			params.name = preset->name;
+		}
+		else if (arg == "--frames") {
+			if (!takesValue()) return false;
+			params.frames = std::atoi(value);
+		}
+		else if (arg == "--warmup") {
+			if (!takesValue()) return false;
+			params.warmupFrames = std::atoi(value);
+		}
+		else if (arg == "--resolution") {
+			if (!takesValue()) return false;
+
+			if (sscanf(value, "%ux%u", &params.width, &params.height) != 2) {
+				spdlog::error("Invalid resolution {}, expected WIDTHxHEIGHT", value);
+				return false;
+			}
+		}
+		else if (arg == "--timestep") {
+			if (!takesValue()) return false;
+			params.timestep = (float) std::atof(value);
+		}
+		else if (arg == "--seed") {
+			if (!takesValue()) return false;
+			params.seed = (uint32_t) std::strtoul(value, nullptr, 10);
+		}
+		else if (arg == "--renderers") {
+			if (!takesValue()) return false;
+			params.renderers = std::atoi(value);
+		}
+		else if (arg == "--unique-materials") {
+			params.sharedMaterials = false;
+		}
+		else if (arg == "--shared-materials") {
+			params.sharedMaterials = true;
+		}
+		else if (arg == "--point-shadows") {
+			if (!takesValue()) return false;
+			params.pointShadows = std::atoi(value);
+		}
+		else if (arg == "--spot-shadows") {
+			if (!takesValue()) return false;
+			params.spotShadows = std::atoi(value);
+		}
+		else if (arg == "--directional-shadows") {
+			if (!takesValue()) return false;
+			params.directionalShadows = std::atoi(value);
+		}
+		else if (arg == "--probes") {
+			if (!takesValue()) return false;
+			params.probes = std::atoi(value);
+		}
+		else if (arg == "--hierarchy") {
+			if (!takesValue()) return false;
+
+			if (value == std::string_view("wide")) {
+				params.hierarchy = Hierarchy::Wide;
+			}
+			else if (value == std::string_view("deep")) {
+				params.hierarchy = Hierarchy::Deep;
+			}
+			else {
+				spdlog::error("Unknown hierarchy {}, expected wide or deep", value);
+				return false;
+			}
+		}
+		else if (arg == "--depth") {
+			if (!takesValue()) return false;
+			params.hierarchyDepth = std::max(std::atoi(value), 1);
+		}
+		else if (arg == "--stars") {
+			if (!takesValue()) return false;
+			params.stars = std::atoi(value);
+		}
+		else if (arg == "--static") {
+			params.animate = false;
+		}
+		else if (arg == "--temporal-upsampling") {
+			params.temporalUpsampling = true;
+		}
+		else if (arg == "--render-scale") {
+			if (!takesValue()) return false;
+			params.renderScale = std::clamp((float) std::atof(value), 0.05f, 1.0f);
+		}
+		else if (arg == "--allocations") {
+			params.allocations = true;
+		}
+		else if (arg == "--zero-alloc") {
+			params.allocations = true;
+			params.zeroAllocations = true;
+		}
+		else if (arg == "--capture") {
+			if (!takesValue()) return false;
+			params.capture = value;
+		}
+		else if (arg == "--replay") {
+			if (!takesValue()) return false;
+			params.replay = value;
+		}
+		else if (arg == "--output") {
+			if (!takesValue()) return false;
+			params.output = value;
+		}
+		else {
+			spdlog::error("Unknown option {}", arg);
+			PrintUsage();
+			return false;
+		}
+	}
+
+	if (params.frames <= 0 || params.warmupFrames < 0) {
+		spdlog::error("Frame counts must be positive");
+		return false;
+	}
+
+	return true;
+}
+
+void BuildScene(Scene* scene, const BenchParams& params) {
+	std::mt19937 random(params.seed);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+	ShaderProgram* coloredProg = ShaderProgram::Build().WithVertexShader(
+		scene->Resources()->Get<VertexShader>("./res/shaders/lit.vert")
+	).WithPixelShader(
+		scene->Resources()->Get<PixelShader>("./res/shaders/lambert color.frag")
+	).Link();
+
+	Mesh* cubeMesh = scene->Resources()->Get<Mesh>("./res/models/not_cube.obj");
+
+	int side = std::max((int) std::ceil(std::sqrt((float) params.renderers)), 1);
+	float spacing = 2.0f;
+	float extent = side * spacing * 0.5f;
+
+	SceneNode* rootNode = scene->CreateNode("Bench Root");
+
+	if (params.animate) {
+		rootNode->AddObject<Spinner>(10.0f);
+	}
+
+	Material* sharedMat = new Material(coloredProg);
+	sharedMat->SetValue("uColor", glm::vec3(0.8f, 0.8f, 0.8f));
+
+	SceneNode* chainParent = rootNode;
+
+	for (int i = 0; i < params.renderers; i++) {
+		if (params.hierarchy == Hierarchy::Deep && i % params.hierarchyDepth == 0) {
+			chainParent = rootNode;
+		}
+
+		SceneNode* node = scene->CreateNode(chainParent, std::format("Renderer {}", i));
+
+		Material* material = sharedMat;
+
+		if (!params.sharedMaterials) {
+			material = new Material(coloredProg);
+			material->SetValue("uColor", glm::vec3(unit(random), unit(random), unit(random)));
+		}
+
+		node->AddObject<MeshRenderer>(cubeMesh, material);
+		node->GlobalTransform().Position() = glm::vec3((i % side) * spacing - extent, 0.5f, (i / side) * spacing - extent);
+		node->GlobalTransform().Rotation() = glm::angleAxis(unit(random) * glm::two_pi<float>(), glm::vec3(0.0f, 1.0f, 0.0f));
+		node->GlobalTransform().Scale() = glm::vec3(0.5f + unit(random) * 0.4f);
+
+		if (params.hierarchy == Hierarchy::Deep) {
+			chainParent = node;
+		}
+	}
+
+	auto randomPosition = [&](float height) {
+		return glm::vec3((unit(random) * 2.0f - 1.0f) * extent, height, (unit(random) * 2.0f - 1.0f) * extent);
+	};
+
+	for (int i = 0; i < params.pointShadows; i++) {
+		SceneNode* node = scene->CreateNode(std::format("Point Light {}", i));
+		node->AddObject<Light>(Light::PointLight({1, 1, 1}, 15, 2))->SetShadowCasting(true);
+		node->GlobalTransform().Position() = randomPosition(3.0f);
+	}
+
+	for (int i = 0; i < params.spotShadows; i++) {
+		SceneNode* node = scene->CreateNode(std::format("Spot Light {}", i));
+		node->AddObject<Light>(Light::SpotLight({1, 1, 1}, 45, 20, 3))->SetShadowCasting(true);
+		node->GlobalTransform().Position() = randomPosition(6.0f);
+		node->GlobalTransform().Rotation() = glm::quat(glm::radians(glm::vec3(90.0f, 0.0f, 0.0f)));
+	}
+
+	for (int i = 0; i < params.directionalShadows; i++) {
+		SceneNode* node = scene->CreateNode(std::format("Directional Light {}", i));
+		node->AddObject<Light>(Light::DirectionalLight({1, 1, 1}, 1))->SetShadowCasting(true);
+		node->GlobalTransform().Rotation() = glm::quat(glm::radians(glm::vec3(50.0f, -20.0f + i * 30.0f, 0.0f)));
+	}
+
+	for (int i = 0; i < params.probes; i++) {
+		SceneNode* node = scene->CreateNode(std::format("Reflection Probe {}", i));
+		node->AddObject<ReflectionProbe>();
+		node->GlobalTransform().Position() = randomPosition(1.5f);
+	}
+
+	if (params.stars > 0) {
+		SceneNode* node = scene->CreateNode("Stars");
+		node->AddObject<Stars>(params.stars);
+		node->GlobalTransform().Position() = glm::vec3(0.0f, 10.0f, extent + 20.0f);
+	}
+
+	SceneNode* cameraNode = scene->CreateNode("Camera");
+	cameraNode->AddObject<Camera>(Camera::Perspective(60.0f, (float) params.width / params.height, 0.5f, 500.0f));
+	cameraNode->GlobalTransform().Position() = glm::vec3(0.0f, extent * 0.5f + 5.0f, -extent - 5.0f);
+	cameraNode->GlobalTransform().Rotation() = glm::quat(glm::radians(glm::vec3(30.0f, 0.0f, 0.0f)));
+
+	scene->GetGraphics()->SetTemporalUpsamplingEnabled(params.temporalUpsampling);
+}
+
+std::string TimingJSON(std::vector<float> times) {
+	if (times.empty()) {
+		return "null";
+	}
+
+	std::sort(times.begin(), times.end());
+
+	double sum = 0.0;
+	for (float time : times) {
+		sum += time;
+	}
+
+	size_t p99 = (size_t) std::ceil(times.size() * 0.99) - 1;
+
+	return std::format(
+		"{{\"samples\":{},\"min\":{:.4f},\"avg\":{:.4f},\"p99\":{:.4f},\"max\":{:.4f}}}",
+		times.size(),
+		times.front(),
+		sum / times.size(),
+		times[p99],
+		times.back()
+	);
+}
+
+std::string ReportJSON(const BenchParams& params, const BenchRecorder* recorder) {
+	std::string json = std::format(
+		"{{\"scene\":\"{}\",\"params\":{{\"frames\":{},\"warmupFrames\":{},\"width\":{},\"height\":{},\"timestep\":{},\"seed\":{},"
+		"\"renderers\":{},\"sharedMaterials\":{},\"pointShadows\":{},\"spotShadows\":{},\"directionalShadows\":{},"
+		"\"probes\":{},\"hierarchy\":\"{}\",\"hierarchyDepth\":{},\"stars\":{},\"animate\":{},\"temporalUpsampling\":{},\"renderScale\":{}}}",
+		params.name, params.frames, params.warmupFrames, params.width, params.height, params.timestep, params.seed,
+		params.renderers, params.sharedMaterials, params.pointShadows, params.spotShadows, params.directionalShadows,
+		params.probes, params.hierarchy == Hierarchy::Deep ? "deep" : "wide", params.hierarchyDepth, params.stars, params.animate, params.temporalUpsampling, params.renderScale
+	);
+
+	json += std::format(",\"cpuFrameMs\":{},\"gpuFrameMs\":{},\"renderStats\":{{", TimingJSON(recorder->cpuTimes), TimingJSON(recorder->gpuTimes));
+
+	for (int i = 0; i < (int) RenderCounter::Count; i++) {
+		uint64_t sum = 0;
+		uint64_t max = 0;
+
+		for (const RenderStats::Snapshot& snapshot : recorder->renderStats) {
+			sum += snapshot.counters[i];
+			max = std::max(max, snapshot.counters[i]);
+		}
+
+		double avg = recorder->renderStats.empty() ? 0.0 : (double) sum / recorder->renderStats.size();
+
+		json += std::format("{}\"{}\":{{\"avg\":{:.2f},\"max\":{}}}", i > 0 ? "," : "", RenderStats::GetKey((RenderCounter) i), avg, max);
+	}
+
+	json += "}";
+
+	if (!recorder->allocationCounts.empty()) {
+		auto statJSON = [](const std::vector<uint64_t>& values) {
+			uint64_t sum = 0;
+			uint64_t max = 0;
+
+			for (uint64_t value : values) {
+				sum += value;
+				max = std::max(max, value);
+			}
+
+			return std::format("{{\"avg\":{:.2f},\"max\":{}}}", (double) sum / values.size(), max);
+		};
+
+		json += std::format(
+			",\"allocations\":{{\"count\":{},\"bytes\":{},\"violations\":{}}}",
+			statJSON(recorder->allocationCounts),
+			statJSON(recorder->allocationBytes),
+			AllocationTracker::GetTotalViolations()
+		);
+	}
+
+	json += std::format(",\"memory\":{}", MemoryTracker::ToJSON());
+
+	json += "}";
+
+	return json;
+}
+
+int main(int argc, char** argv) {
+	// Keep stdout clean for the JSON report
+	spdlog::set_default_logger(spdlog::stderr_color_mt("bench"));
+
+	BenchParams params;
+
+	if (!ParseArgs(argc, argv, params)) {
+		return EXIT_FAILURE;
+	}
+
+	Time::SetFixedDelta(params.timestep);
+
+	FrameCapture* capture = nullptr;
+
+	if (!params.replay.empty()) {
+		capture = FrameCapture::Load(params.replay);
+
+		if (!capture) {
+			return EXIT_FAILURE;
+		}
+
+		params.name = std::format("replay:{}", params.replay);
+		params.width = capture->resolution.x;
+		params.height = capture->resolution.y;
+		params.renderScale = capture->renderScale;
+	}
+
+	// One extra frame, the recorder samples each frame at the start of the next one
+	if (!Engine::SetupHeadless(params.width, params.height, params.warmupFrames + params.frames + 1)) {
+		spdlog::error("Failed to initialize headless engine!");
+		return EXIT_FAILURE;
+	}
+
+	Scene* scene = Engine::GetRoot();
+
+	if (capture) {
+		if (!scene->AddComponent<FrameReplay>()->Load(capture)) {
+			spdlog::error("Failed to replay {}", params.replay);
+			return EXIT_FAILURE;
+		}
+
+		delete capture;
+	}
+	else {
+		BuildScene(scene, params);
+	}
+
+	// Scale changes driven by GPU timings would make the measured frames depend on the machine
+	DynamicResolution* dynamicResolution = scene->GetGraphics()->GetDynamicResolution();
+	dynamicResolution->SetEnabled(false);
+	dynamicResolution->SetScaleRange(params.renderScale, params.renderScale);
+
+	BenchRecorder* recorder = scene->AddComponent<BenchRecorder>();
+	recorder->SetWarmupFrames(params.warmupFrames);
+	recorder->SetCapturePath(params.capture);
+	recorder->Reserve(params.frames + 1);
+
+	if (params.allocations) {
+		if (!AllocationTracker::IsAvailable()) {
+			spdlog::error("Allocation tracking needs an engine built with SYZYF_ALLOCATION_TRACKING");
+			return EXIT_FAILURE;
+		}
+
+		AllocationTracker::SetEnabled(true);
+
+		// Warm-up frames and the frame a capture is requested in may allocate, measured frames may not
+		AllocationTracker::SetStrict(params.zeroAllocations, params.warmupFrames + 1);
+	}
+
+	spdlog::info("Running bench scene {} for {} + {} frames", params.name, params.warmupFrames, params.frames);
+
+	Engine::MainLoop();
+
+	std::string report = ReportJSON(params, recorder);
+
+	if (params.output.empty()) {
+		std::cout << report << std::endl;
+	}
+	else {
+		std::ofstream file(params.output);
+
+		if (!file.is_open()) {
+			spdlog::error("Failed to open {} for the bench report", params.output);
+			return EXIT_FAILURE;
+		}
+
+		file << report << "\n";
+	}
+
+	return 0;
+}
\ No newline at end of file
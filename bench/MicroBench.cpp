@@ -0,0 +1,573 @@
+#include <cmath>
+#include <chrono>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+#include <functional>
+
+#include <spdlog/spdlog.h>
+#include <spdlog/sinks/stdout_color_sinks.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <Profiler.h>
+#include <Scene.h>
+#include <GameObject.h>
+#include <Frustum.h>
+#include <BoundingBox.h>
+#include <Resources.h>
+#include <UniformSpec.h>
+#include <Material.h>
+#include <VertexSpec.h>
+#include <Mesh.h>
+#include <MeshOptimizer.h>
+#include <Shader.h>
+#include <RecordingBackend.h>
+
+struct MicroBenchParams {
+	std::string filter;
+	int samples = 15;
+	float scale = 1.0f;
+	bool list = false;
+
+	std::string output;
+};
+
+struct MicroBench {
+	const char* name;
+	int iterations;
+	std::function<void(int iterations)> run;
+};
+
+struct MicroBenchResult {
+	std::string name;
+	int iterations;
+	double minNs;
+	double medianNs;
+	double maxNs;
+};
+
+struct MessageBench {
+	const char* name;
+	int receivers;
+	int iterations;
+};
+
+struct MeshBench {
+	const char* name;
+	const char* path;
+	int iterations;
+};
+
+const MessageBench MESSAGE_BENCHES[] = {
+	{ "messages.update_1k",   1000,   1000 },
+	{ "messages.update_100k", 100000, 10 },
+};
+
+const MeshBench MESH_BENCHES[] = {
+	{ "mesh.import_cube",     "./res/models/cube.obj",               200 },
+	{ "mesh.import_nanosuit", "./res/models/nanosuit/nanosuit.obj", 2 },
+};
+
+// Keeps the optimizer from dropping work whose result is otherwise unused
+volatile uint64_t benchSink = 0;
+
+template<typename T>
+inline void Consume(const T& value) {
+	benchSink = benchSink + *reinterpret_cast<const unsigned char*>(&value);
+}
+
+class Counter : public GameObject {
+public:
+	uint64_t count = 0;
+
+	void Update() {
+		this->count++;
+	}
+};
+
+class BenchResource : public Resource {
+public:
+	int value = 0;
+};
+
+void PrintUsage() {
+	std::cerr <<
+		"Usage: syzyf_microbench [options]\n"
+		"  --filter TEXT   Only run benchmarks whose name contains TEXT\n"
+		"  --samples N     Timed samples per benchmark (default 15)\n"
+		"  --scale F       Multiplies the iteration count of every sample (default 1.0)\n"
+		"  --output FILE   Write the JSON report to FILE instead of stdout\n"
+		"  --list          Print benchmark names and exit\n"
+		"  --help          Show this message\n";
+}
+
+bool ParseArgs(int argc, char** argv, MicroBenchParams& params) {
+	for (int i = 1; i < argc; i++) {
+		std::string arg = argv[i];
+		bool hasValue = i + 1 < argc;
+
+		if (arg == "--filter" && hasValue) {
+			params.filter = argv[++i];
+		}
+		else if (arg == "--samples" && hasValue) {
+			params.samples = std::max(1, std::atoi(argv[++i]));
+		}
+		else if (arg == "--scale" && hasValue) {
+			params.scale = std::max(0.001f, (float) std::atof(argv[++i]));
+		}
+		else if (arg == "--output" && hasValue) {
+			params.output = argv[++i];
+		}
+		else if (arg == "--list") {
+			params.list = true;
+		}
+		else if (arg == "--help" || arg == "-h") {
+			return false;
+		}
+		else {
+			spdlog::error("Unknown argument {}", arg);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+MicroBenchResult Measure(const MicroBench& bench, const MicroBenchParams& params) {
+	int iterations = std::max(1, (int) (bench.iterations * params.scale));
+
+	// One untimed sample to warm caches and fill lazily created state
+	bench.run(iterations);
+
+	std::vector<double> samples;
+	samples.reserve(params.samples);
+
+	for (int sample = 0; sample < params.samples; sample++) {
+		auto start = std::chrono::steady_clock::now();
+
+		bench.run(iterations);
+
+		auto end = std::chrono::steady_clock::now();
+
+		samples.push_back(std::chrono::duration<double, std::nano>(end - start).count() / iterations);
+	}
+
+	std::sort(samples.begin(), samples.end());
+
+	return MicroBenchResult {
+		.name = bench.name,
+		.iterations = iterations,
+		.minNs = samples.front(),
+		.medianNs = samples[samples.size() / 2],
+		.maxNs = samples.back()
+	};
+}
+
+std::string BuildReport(const std::vector<MicroBenchResult>& results, const MicroBenchParams& params) {
+	std::string json = std::format("{{\n\t\"samples\": {},\n\t\"benchmarks\": [", params.samples);
+
+	for (int i = 0; i < (int) results.size(); i++) {
+		const MicroBenchResult& result = results[i];
+
+		json += std::format(
+			"{}\n\t\t{{\"name\": \"{}\", \"iterations\": {}, \"minNs\": {:.2f}, \"medianNs\": {:.2f}, \"maxNs\": {:.2f}, \"opsPerSecond\": {:.0f}}}",
+			i > 0 ? "," : "",
+			result.name,
+			result.iterations,
+			result.minNs,
+			result.medianNs,
+			result.maxNs,
+			result.medianNs > 0.0 ? 1e9 / result.medianNs : 0.0
+		);
+	}
+
+	json += "\n\t]\n}\n";
+
+	return json;
+}
+
+std::vector<glm::mat4> RandomTransforms(int count) {
+	std::vector<glm::mat4> transforms;
+	transforms.reserve(count);
+
+	for (int i = 0; i < count; i++) {
+		float t = (float) i;
+
+		glm::mat4 transform = glm::translate(glm::mat4(1.0f), glm::vec3(std::sin(t) * 50.0f, std::cos(t * 0.7f) * 10.0f, -std::fmod(t, 100.0f)));
+		transform = glm::rotate(transform, t * 0.1f, glm::normalize(glm::vec3(1.0f, 2.0f, 3.0f)));
+
+		transforms.push_back(glm::scale(transform, glm::vec3(0.5f + std::fmod(t, 3.0f))));
+	}
+
+	return transforms;
+}
+
+Scene* CreateReceiverScene(int receivers) {
+	Scene* scene = new Scene();
+
+	// Spread receivers over a two level hierarchy so propagation walks both breadth and depth
+	int groups = std::max(1, receivers / 100);
+
+	for (int group = 0; group < groups; group++) {
+		SceneNode* groupNode = scene->CreateNode();
+
+		for (int i = group; i < receivers; i += groups) {
+			scene->CreateNode(groupNode)->AddObject<Counter>();
+		}
+	}
+
+	return scene;
+}
+
+std::vector<MicroBench> CreateBenchmarks() {
+	std::vector<MicroBench> benches;
+
+	{
+		Scene* scene = new Scene();
+		SceneNode* node = scene->CreateNode();
+
+		benches.push_back({ "transform.local_write", 100000, [node](int iterations) {
+			for (int i = 0; i < iterations; i++) {
+				node->LocalTransform().Position() = glm::vec3((float) i, 0.0f, 0.0f);
+			}
+
+			Consume(node->GlobalTransform().Value());
+		} });
+	}
+
+	{
+		Scene* scene = new Scene();
+		SceneNode* parent = scene->GetRootNode();
+
+		std::vector<SceneNode*> chain;
+
+		for (int i = 0; i < 64; i++) {
+			parent = scene->CreateNode(parent);
+			parent->LocalTransform().Position() = glm::vec3(0.0f, 1.0f, 0.0f);
+
+			chain.push_back(parent);
+		}
+
+		benches.push_back({ "transform.deep_chain_64", 2000, [chain](int iterations) {
+			for (int i = 0; i < iterations; i++) {
+				chain.front()->LocalTransform().Rotation() *= glm::vec3(0.0f, 0.01f, 0.0f);
+
+				for (SceneNode* node : chain) {
+					Consume(node->GlobalTransform().Value()[3].y);
+				}
+			}
+		} });
+	}
+
+	{
+		Scene* scene = new Scene();
+		SceneNode* parent = scene->CreateNode();
+
+		std::vector<SceneNode*> children;
+
+		for (int i = 0; i < 1000; i++) {
+			SceneNode* child = scene->CreateNode(parent);
+			child->LocalTransform().Position() = glm::vec3((float) i, 0.0f, 0.0f);
+
+			children.push_back(child);
+		}
+
+		benches.push_back({ "transform.wide_1k", 100, [parent, children](int iterations) {
+			for (int i = 0; i < iterations; i++) {
+				parent->LocalTransform().Position() = glm::vec3(0.0f, (float) i, 0.0f);
+
+				for (SceneNode* node : children) {
+					Consume(node->GlobalTransform().Value()[3].y);
+				}
+			}
+		} });
+	}
+
+	for (const MessageBench& messageBench : MESSAGE_BENCHES) {
+		Scene* scene = CreateReceiverScene(messageBench.receivers);
+
+		benches.push_back({ messageBench.name, messageBench.iterations, [scene](int iterations) {
+			for (int i = 0; i < iterations; i++) {
+				scene->Update();
+			}
+		} });
+	}
+
+	{
+		std::vector<glm::mat4> transforms = RandomTransforms(4096);
+		BoundingBox bounds(glm::vec3(-1.0f), glm::vec3(1.0f));
+
+		benches.push_back({ "culling.bbox_transform_4k", 50, [transforms, bounds](int iterations) {
+			for (int i = 0; i < iterations; i++) {
+				for (const glm::mat4& transform : transforms) {
+					Consume(bounds.Transform(transform).center.x);
+				}
+			}
+		} });
+	}
+
+	{
+		std::vector<glm::mat4> transforms = RandomTransforms(4096);
+		std::vector<BoundingBox> boxes;
+
+		for (const glm::mat4& transform : transforms) {
+			boxes.push_back(BoundingBox(glm::vec3(-1.0f), glm::vec3(1.0f)).Transform(transform));
+		}
+
+		glm::mat4 viewProjection =
+			glm::perspective(glm::radians(70.0f), 16.0f / 9.0f, 0.1f, 200.0f)
+			* glm::lookAt(glm::vec3(0.0f, 5.0f, 10.0f), glm::vec3(0.0f, 0.0f, -50.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+
+		Frustum frustum = ComputeFrustum(viewProjection);
+
+		benches.push_back({ "culling.test_frustum_4k", 200, [frustum, boxes](int iterations) {
+			for (int i = 0; i < iterations; i++) {
+				int visible = 0;
+
+				for (const BoundingBox& box : boxes) {
+					visible += TestFrustum(frustum, box);
+				}
+
+				Consume(visible);
+			}
+		} });
+	}
+
+	{
+		ResourceDatabase* database = new ResourceDatabase();
+		std::vector<fs::path> paths;
+
+		for (int i = 0; i < 10000; i++) {
+			paths.push_back(std::format("./res/generated/resource_{}.bin", i));
+			database->Register(new BenchResource(), paths.back());
+		}
+
+		benches.push_back({ "resources.get_10k", 100000, [database, paths](int iterations) {
+			for (int i = 0; i < iterations; i++) {
+				Consume(database->Get<BenchResource>(paths[(i * 7919) % paths.size()]));
+			}
+		} });
+
+		benches.push_back({ "resources.get_miss", 100000, [database](int iterations) {
+			fs::path missing = "./res/generated/missing.bin";
+
+			for (int i = 0; i < iterations; i++) {
+				Consume(database->Get<BenchResource>(missing));
+			}
+		} });
+	}
+
+	{
+		// Mirrors the size of the default block of pbr.frag, the lookup is linear so the last name is the worst case
+		UniformSpec* spec = new UniformSpec();
+
+		for (int i = 0; i < 24; i++) {
+			spec->AddVariable(std::format("material.parameter{}", i), i % 2 ? UniformSpec::UniformType::Float4 : UniformSpec::UniformType::Float1);
+		}
+
+		ShaderVariableStorage* storage = new ShaderVariableStorage(*spec);
+
+		benches.push_back({ "material.set_value_by_name", 100000, [storage](int iterations) {
+			for (int i = 0; i < iterations; i++) {
+				storage->SetValue("material.parameter22", (float) i);
+			}
+
+			Consume(storage->GetValue<float>(22u));
+		} });
+
+		benches.push_back({ "submission.bind_draw", 10000, [storage](int iterations) {
+			GraphicsBackend* gfx = GraphicsBackend::Current();
+
+			for (int i = 0; i < iterations; i++) {
+				gfx->UseProgram(1 + i % 4);
+				storage->Bind();
+				gfx->BindVertexArray(1 + i % 16);
+				gfx->DrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0, 0);
+			}
+		} });
+	}
+
+	benches.push_back({ "vertexspec.build", 100000, [](int iterations) {
+		for (int i = 0; i < iterations; i++) {
+			VertexSpec spec {
+				{ VertexInputType::Position, 4 },
+				{ VertexInputType::Normal, 4 },
+				{ VertexInputType::Tangent, 4 },
+				{ VertexInputType::UV1, (uint8_t) (2 + i % 3) }
+			};
+
+			Consume(spec.GetHash());
+		}
+	} });
+
+	benches.push_back({ "vertexspec.query", 100000, [](int iterations) {
+		const VertexSpec& spec = VertexSpec::MeshFull;
+
+		for (int i = 0; i < iterations; i++) {
+			Consume(spec.VertexSize() + spec.GetLengthOf(VertexInputType(1 + i % 7)) + spec.Compatible(VertexSpec::Mesh));
+		}
+	} });
+
+	benches.push_back({ "vertexspec.get_inputs", 100000, [](int iterations) {
+		for (int i = 0; i < iterations; i++) {
+			Consume(VertexSpec::MeshFull.GetInputs().size());
+		}
+	} });
+
+	{
+		// Grid with its triangles shuffled, the worst case order for the vertex cache
+		const int size = 128;
+
+		std::vector<float> positions;
+		std::vector<unsigned int> indices;
+
+		for (int y = 0; y <= size; y++) {
+			for (int x = 0; x <= size; x++) {
+				positions.insert(positions.end(), { (float) x, std::sin(x * 0.1f) * std::cos(y * 0.1f), (float) y });
+			}
+		}
+
+		std::vector<unsigned int> triangles;
+
+		for (unsigned int i = 0; i < size * size * 2; i++) {
+			triangles.push_back((i * 7919u) % (size * size * 2));
+		}
+
+		for (unsigned int triangle : triangles) {
+			unsigned int cell = triangle / 2;
+			unsigned int corner = (cell / size) * (size + 1) + cell % size;
+
+			if (triangle % 2) {
+				indices.insert(indices.end(), { corner + 1, corner + size + 1, corner + size + 2 });
+			}
+			else {
+				indices.insert(indices.end(), { corner, corner + size + 1, corner + 1 });
+			}
+		}
+
+		benches.push_back({ "mesh.optimize_grid_32k", 20, [positions, indices](int iterations) {
+			for (int i = 0; i < iterations; i++) {
+				std::vector<unsigned int> optimized = indices;
+
+				MeshOptimizer::OptimizeVertexCache(optimized.data(), optimized.size());
+				MeshOptimizer::OptimizeOverdraw(optimized.data(), optimized.size(), positions.data(), 3);
+
+				Consume(optimized[0]);
+			}
+		} });
+
+		benches.push_back({ "mesh.simplify_grid_32k", 10, [positions, indices](int iterations) {
+			for (int i = 0; i < iterations; i++) {
+				std::vector<unsigned int> simplified(indices.size());
+
+				Consume(MeshOptimizer::Simplify(simplified.data(), indices.data(), indices.size(), positions.data(), 3, indices.size() / 2, 1.0f));
+			}
+		} });
+
+		std::vector<unsigned int> cacheOrdered = indices;
+		MeshOptimizer::OptimizeVertexCache(cacheOrdered.data(), cacheOrdered.size());
+
+		benches.push_back({ "mesh.meshlets_grid_32k", 20, [positions, cacheOrdered](int iterations) {
+			for (int i = 0; i < iterations; i++) {
+				Consume(MeshOptimizer::BuildMeshlets(cacheOrdered.data(), cacheOrdered.size(), positions.data(), 3).size());
+			}
+		} });
+	}
+
+	for (const MeshBench& meshBench : MESH_BENCHES) {
+		const char* path = meshBench.path;
+
+		benches.push_back({ meshBench.name, meshBench.iterations, [path](int iterations) {
+			for (int i = 0; i < iterations; i++) {
+				Mesh* mesh = Mesh::Import(path);
+
+				Consume(mesh ? mesh->GetVertexCount() : 0);
+
+				delete mesh;
+			}
+		} });
+	}
+
+	benches.push_back({ "profiler.zone", 1000000, [](int iterations) {
+		Profiler::SetEnabled(true);
+
+		for (int i = 0; i < iterations; i++) {
+			PROFILE_ZONE("Bench Zone");
+		}
+
+		Profiler::SetEnabled(false);
+	} });
+
+	benches.push_back({ "shader.preprocess_pbr", 200, [](int iterations) {
+		for (int i = 0; i < iterations; i++) {
+			Consume(ShaderBase::Preprocess("./res/shaders/pbr.frag").size());
+		}
+	} });
+
+	return benches;
+}
+
+int main(int argc, char** argv) {
+	spdlog::set_default_logger(spdlog::stderr_color_mt("microbench"));
+
+	MicroBenchParams params;
+
+	if (!ParseArgs(argc, argv, params)) {
+		PrintUsage();
+		return 1;
+	}
+
+	// Profiler zones would otherwise be part of every measurement
+	Profiler::SetEnabled(false);
+
+	// Nothing here owns a GL context, submission is measured against the recorder instead of a driver
+	RecordingBackend recorder(false);
+	GraphicsBackend::SetCurrent(&recorder);
+
+	std::vector<MicroBench> benches = CreateBenchmarks();
+
+	if (params.list) {
+		for (const MicroBench& bench : benches) {
+			std::cout << bench.name << "\n";
+		}
+
+		return 0;
+	}
+
+	std::vector<MicroBenchResult> results;
+
+	for (const MicroBench& bench : benches) {
+		if (!params.filter.empty() && std::string(bench.name).find(params.filter) == std::string::npos) {
+			continue;
+		}
+
+		MicroBenchResult result = Measure(bench, params);
+
+		spdlog::info("{:<28} {:>12.1f} ns/op (min {:.1f}, max {:.1f})", result.name, result.medianNs, result.minNs, result.maxNs);
+
+		results.push_back(result);
+	}
+
+	std::string report = BuildReport(results, params);
+
+	if (params.output.empty()) {
+		std::cout << report;
+	}
+	else {
+		std::ofstream file(params.output);
+
+		if (!file.is_open()) {
+			spdlog::error("Failed to open {} for the benchmark report", params.output);
+			return 1;
+		}
+
+		file << report;
+	}
+
+	return 0;
+}
\ No newline at end of file
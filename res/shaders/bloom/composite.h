@@ -0,0 +1,26 @@
+#ifndef BLOOM_COMPOSITE_H
+#define BLOOM_COMPOSITE_H
+
+// 3x3 tent, based on [Jimenez14] http://goo.gl/eomGso
+vec3 BloomTent(sampler2D bloomTex, vec2 uv, vec2 texelSize, float level) {
+	vec3 s = vec3(0.0);
+
+	for (int y = -1; y <= 1; y++) {
+		for (int x = -1; x <= 1; x++) {
+			float weight = float((2 - abs(x)) * (2 - abs(y)));
+			s += textureLod(bloomTex, uv + vec2(x, y) * texelSize, level).rgb * weight;
+		}
+	}
+
+	return s * (1.0 / 16.0);
+}
+
+// The last upsample step (mip 1 into mip 0) is folded into the composite, so the pyramid never has to be
+// written back at its largest level
+vec3 BloomComposite(sampler2D bloomTex, vec2 uv, vec2 frameTexelSize, vec2 bloomTexelSize, float intensity) {
+	vec3 bloom = BloomTent(bloomTex, uv, frameTexelSize, 0.0) + BloomTent(bloomTex, uv, bloomTexelSize, 1.0) * intensity;
+
+	return bloom * intensity;
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,14 @@
+#version 460
+
+in vec4 currentClipPos;
+in vec4 previousClipPos;
+
+// rg -> screen space motion since the last frame, b -> marks pixels covered by an object
+out vec4 velocity;
+
+void main() {
+	vec2 currentUV = currentClipPos.xy / currentClipPos.w * 0.5 + 0.5;
+	vec2 previousUV = previousClipPos.xy / previousClipPos.w * 0.5 + 0.5;
+
+	velocity = vec4(currentUV - previousUV, 1.0, 0.0);
+}
\ No newline at end of file
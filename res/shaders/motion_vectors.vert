@@ -0,0 +1,16 @@
+#version 460
+
+#include "shared/shared.h"
+#include "shared/uniforms.h"
+
+layout (IN_POSITION) in vec3 vPos;
+
+out vec4 currentClipPos;
+out vec4 previousClipPos;
+
+void main() {
+	gl_Position = Object_MVPMatrix * vec4(vPos, 1.0);
+
+	currentClipPos = Global_UnjitteredVPMatrix * (Object_ModelMatrix * vec4(vPos, 1.0));
+	previousClipPos = Global_PrevVPMatrix * (Object_PrevModelMatrix * vec4(vPos, 1.0));
+}
\ No newline at end of file
@@ -22,6 +22,8 @@ UNIFORM_DECL(0) ShaderGlobalUniforms
 	mat4 Global_ViewMatrix;
 	mat4 Global_ProjectionMatrix;
 	mat4 Global_VPMatrix;
+	mat4 Global_UnjitteredVPMatrix;
+	mat4 Global_PrevVPMatrix;
 	vec3 Global_CameraWorldPos;
 	float Global_Time;
 	float Global_CameraNearPlane;
@@ -33,6 +35,7 @@ UNIFORM_DECL(1) ShaderObjectUniforms
 	mat4 Object_ModelMatrix;
 	mat4 Object_MVPMatrix;
 	mat3 Object_NormalModelMatrix;
+	mat4 Object_PrevModelMatrix;
 };
 
 #ifdef mat4
@@ -0,0 +1,82 @@
+#ifndef TONEMAPPING_OPERATORS_H
+
+vec3 ReinhardTonemapper(vec3 color) {
+	return color / (1.0 + color);
+}
+
+const mat3 ACESInputMat = transpose(mat3(
+	vec3(0.59719, 0.35458, 0.04823),
+	vec3(0.07600, 0.90834, 0.01566),
+	vec3(0.02840, 0.13383, 0.83777)
+));
+
+// ODT_SAT => XYZ => D60_2_D65 => sRGB
+const mat3 ACESOutputMat = transpose(mat3(
+	vec3( 1.60475, -0.53108, -0.07367),
+	vec3(-0.10208,  1.10813, -0.00605),
+	vec3(-0.00327, -0.07276,  1.07602)
+));
+
+vec3 RRTAndODTFit(vec3 v) {
+	vec3 a = v * (v + 0.0245786) - 0.000090537;
+	vec3 b = v * (0.983729 * v + 0.4329510) + 0.238081;
+	return a / b;
+}
+
+vec3 ACESFitted(vec3 color) {
+	color = ACESInputMat * color;
+
+	// Apply RRT and ODT
+	color = RRTAndODTFit(color);
+
+	color = ACESOutputMat * color;
+
+	// Clamp to [0, 1]
+	color = clamp(color, 0, 1);
+
+	return color;
+}
+
+vec3 ACESFilm(vec3 x) {
+	const float a = 2.51f;
+	const float b = 0.03f;
+	const float c = 2.43f;
+	const float d = 0.59f;
+	const float e = 0.14f;
+	return clamp((x*(a*x+b))/(x*(c*x+d)+e), 0, 1);
+}
+
+float W_f(float x, float e0, float e1) {
+	float a = clamp((x - e0) / (e1 - e0), 0, 1);
+	return a * a * (3.0 - 2.0 * a);
+}
+
+float H_f(float x, float e0, float e1) {
+	return clamp((x - e0) / (e1 - e0), 0, 1);
+}
+
+float GranTurismoTonemapper(float x) {
+	const float P = 1.0, a = 1.0, m = 0.22, l = 0.4, c = 1.33, b = 0.0;
+	const float l0 = ((P - m) * l) / a;
+	const float S0 = m + l0;
+	const float S1 = m + a * l0;
+	const float C2 = (a * P) / (P - S1);
+	const float w0_x = 1.0 - W_f(x, 0.0, m);
+	const float w2_x = H_f(x, S0, S1);
+	const float w1_x = 1.0 - w0_x - w2_x;
+	const float T_x = m * pow(abs(x / m), c) + b;
+	const float L_x = m + a * (x - m);
+	const float S_x = P - (P - S1) * exp(-(C2 * (x - S0)) / P);
+	return T_x * w0_x + L_x * w1_x + S_x * w2_x;
+}
+
+vec3 GranTurismoTonemapper(vec3 color) {
+	return vec3(
+		GranTurismoTonemapper(color.r),
+		GranTurismoTonemapper(color.g),
+		GranTurismoTonemapper(color.b)
+	);
+}
+
+#define TONEMAPPING_OPERATORS_H
+#endif
\ No newline at end of file
@@ -0,0 +1,345 @@
+#include <AllocationTracker.h>
+
+#include <new>
+#include <cstdlib>
+#include <algorithm>
+
+#include <spdlog/spdlog.h>
+#include <imgui.h>
+
+#include <Profiler.h>
+
+std::atomic<bool> AllocationTracker::enabled = false;
+bool AllocationTracker::strict = false;
+uint64_t AllocationTracker::strictFromFrame = 0;
+uint64_t AllocationTracker::reportedFrames = 0;
+
+uint64_t AllocationTracker::frameCount = 0;
+uint64_t AllocationTracker::totalViolations = 0;
+
+std::mutex AllocationTracker::zonesMutex;
+AllocationTracker::ZoneSlot AllocationTracker::zones[MaxZones + 1] = {};
+
+AllocationTracker::Snapshot AllocationTracker::lastFrame = {};
+
+thread_local int AllocationTracker::suspended = 0;
+thread_local int AllocationTracker::noAllocationDepth = 0;
+
+AllocationTracker::NoAllocationScope::NoAllocationScope() {
+	noAllocationDepth++;
+}
+
+AllocationTracker::NoAllocationScope::~NoAllocationScope() {
+	noAllocationDepth--;
+}
+
+AllocationTracker::ZoneSlot& AllocationTracker::FindSlot(const char* name, const char* detail) {
+	// Zone names are interned, so pointer identity is enough to tell zones apart
+	size_t hash = (std::hash<const void*>()(name) * 31) ^ std::hash<const void*>()(detail);
+
+	for (int i = 0; i < MaxZones; i++) {
+		ZoneSlot& slot = zones[(hash + i) % MaxZones];
+
+		if (!slot.used) {
+			slot.used = true;
+			slot.allocations = ZoneAllocations{name, detail, 0, 0, 0};
+
+			return slot;
+		}
+
+		if (slot.allocations.name == name && slot.allocations.detail == detail) {
+			return slot;
+		}
+	}
+
+	// Out of slots, the extra one at the end collects every zone that did not fit
+	ZoneSlot& overflow = zones[MaxZones];
+	overflow.used = true;
+
+	return overflow;
+}
+
+void AllocationTracker::Record(size_t size) {
+	if (!enabled.load(std::memory_order_relaxed) || suspended) {
+		return;
+	}
+
+	suspended++;
+
+	const Profiler::Scope* scope = Profiler::GetCurrentScope();
+
+	{
+		std::lock_guard lock(zonesMutex);
+
+		ZoneAllocations& allocations = FindSlot(scope ? scope->GetName() : nullptr, scope ? scope->GetDetail() : nullptr).allocations;
+		allocations.count++;
+		allocations.bytes += size;
+
+		if (strict && noAllocationDepth > 0 && frameCount > strictFromFrame) {
+			allocations.violations++;
+		}
+	}
+
+	suspended--;
+}
+
+void AllocationTracker::BeginFrame() {
+	suspended++;
+
+	{
+		std::lock_guard lock(zonesMutex);
+
+		// Before the first frame this collects everything allocated during setup
+		lastFrame.frame = frameCount > 0 ? frameCount - 1 : 0;
+		lastFrame.count = 0;
+		lastFrame.bytes = 0;
+		lastFrame.violations = 0;
+		lastFrame.zones.clear();
+
+		// Slots stay claimed between frames so steady state frames never probe for a new one
+		for (ZoneSlot& slot : zones) {
+			if (!slot.used || slot.allocations.count == 0) {
+				continue;
+			}
+
+			lastFrame.count += slot.allocations.count;
+			lastFrame.bytes += slot.allocations.bytes;
+			lastFrame.violations += slot.allocations.violations;
+			lastFrame.zones.push_back(slot.allocations);
+
+			slot.allocations.count = 0;
+			slot.allocations.bytes = 0;
+			slot.allocations.violations = 0;
+		}
+
+		frameCount++;
+	}
+
+	std::sort(lastFrame.zones.begin(), lastFrame.zones.end(), [](const ZoneAllocations& a, const ZoneAllocations& b) {
+		return a.bytes > b.bytes;
+	});
+
+	if (lastFrame.violations > 0) {
+		totalViolations += lastFrame.violations;
+
+		ReportViolations();
+	}
+
+	suspended--;
+}
+
+void AllocationTracker::ReportViolations() {
+	if (reportedFrames++ >= MaxReportedFrames) {
+		return;
+	}
+
+	spdlog::error("Frame {} made {} heap allocations inside Scene::Update or Scene::Render", lastFrame.frame, lastFrame.violations);
+
+	for (const ZoneAllocations& zone : lastFrame.zones) {
+		if (zone.violations > 0) {
+			spdlog::error("  {} allocations in {}", zone.violations, zone.name ? Profiler::DisplayName(zone.name, zone.detail) : "(no zone)");
+		}
+	}
+
+	if (reportedFrames == MaxReportedFrames) {
+		spdlog::error("Further frames with heap allocations are only counted");
+	}
+}
+
+bool AllocationTracker::IsAvailable() {
+	return SYZYF_ALLOCATION_TRACKING;
+}
+
+bool AllocationTracker::IsEnabled() {
+	return enabled;
+}
+
+void AllocationTracker::SetEnabled(bool enabled) {
+	AllocationTracker::enabled = enabled && SYZYF_ALLOCATION_TRACKING;
+}
+
+void AllocationTracker::SetStrict(bool strict, uint64_t fromFrame) {
+	std::lock_guard lock(zonesMutex);
+
+	AllocationTracker::strict = strict;
+	AllocationTracker::strictFromFrame = fromFrame;
+	AllocationTracker::reportedFrames = 0;
+}
+
+bool AllocationTracker::IsStrict() {
+	return strict;
+}
+
+const AllocationTracker::Snapshot& AllocationTracker::GetLastFrame() {
+	return lastFrame;
+}
+
+uint64_t AllocationTracker::GetTotalViolations() {
+	return totalViolations;
+}
+
+void AllocationTracker::DrawImGui() {
+	if (ImGui::TreeNode("Allocations")) {
+		if (!IsAvailable()) {
+			ImGui::TextUnformatted("Build with SYZYF_ALLOCATION_TRACKING to track allocations");
+			ImGui::TreePop();
+			return;
+		}
+
+		bool enabledValue = enabled;
+
+		if (ImGui::Checkbox("Enabled", &enabledValue)) {
+			SetEnabled(enabledValue);
+		}
+
+		ImGui::SameLine();
+
+		bool strictValue = strict;
+
+		if (ImGui::Checkbox("Strict", &strictValue)) {
+			SetStrict(strictValue, frameCount);
+		}
+
+		ImGui::Text("Last frame: %llu allocations, %llu bytes", (unsigned long long) lastFrame.count, (unsigned long long) lastFrame.bytes);
+		ImGui::Text("Steady state violations: %llu", (unsigned long long) totalViolations);
+
+		if (ImGui::BeginTable("Zone Allocations", 3, ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV)) {
+			for (const ZoneAllocations& zone : lastFrame.zones) {
+				ImGui::TableNextRow();
+
+				ImGui::TableSetColumnIndex(0);
+				ImGui::TextUnformatted(zone.name ? Profiler::DisplayName(zone.name, zone.detail).c_str() : "(no zone)");
+
+				ImGui::TableSetColumnIndex(1);
+				ImGui::Text("%llu", (unsigned long long) zone.count);
+
+				ImGui::TableSetColumnIndex(2);
+				ImGui::Text("%llu B", (unsigned long long) zone.bytes);
+			}
+
+			ImGui::EndTable();
+		}
+
+		ImGui::TreePop();
+	}
+}
+
+#if SYZYF_ALLOCATION_TRACKING
+void* TrackedAllocate(size_t size) {
+	AllocationTracker::Record(size);
+
+	return std::malloc(size ? size : 1);
+}
+
+void* TrackedAllocateAligned(size_t size, size_t alignment) {
+	AllocationTracker::Record(size);
+
+	size = std::max((size + alignment - 1) / alignment * alignment, alignment);
+
+#ifdef _MSC_VER
+	return _aligned_malloc(size, alignment);
+#else
+	return std::aligned_alloc(alignment, size);
+#endif
+}
+
+void TrackedFreeAligned(void* ptr) {
+#ifdef _MSC_VER
+	_aligned_free(ptr);
+#else
+	std::free(ptr);
+#endif
+}
+
+void* operator new(size_t size) {
+	void* ptr = TrackedAllocate(size);
+
+	if (!ptr) {
+		throw std::bad_alloc();
+	}
+
+	return ptr;
+}
+
+void* operator new[](size_t size) {
+	return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+	return TrackedAllocate(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+	return TrackedAllocate(size);
+}
+
+void* operator new(size_t size, std::align_val_t alignment) {
+	void* ptr = TrackedAllocateAligned(size, (size_t) alignment);
+
+	if (!ptr) {
+		throw std::bad_alloc();
+	}
+
+	return ptr;
+}
+
+void* operator new[](size_t size, std::align_val_t alignment) {
+	return operator new(size, alignment);
+}
+
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+	return TrackedAllocateAligned(size, (size_t) alignment);
+}
+
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+	return TrackedAllocateAligned(size, (size_t) alignment);
+}
+
+void operator delete(void* ptr) noexcept {
+	std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+	std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+	std::free(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept {
+	std::free(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept {
+	std::free(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept {
+	std::free(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept {
+	TrackedFreeAligned(ptr);
+}
+
+void operator delete[](void* ptr, std::align_val_t) noexcept {
+	TrackedFreeAligned(ptr);
+}
+
+void operator delete(void* ptr, size_t, std::align_val_t) noexcept {
+	TrackedFreeAligned(ptr);
+}
+
+void operator delete[](void* ptr, size_t, std::align_val_t) noexcept {
+	TrackedFreeAligned(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t, const std::nothrow_t&) noexcept {
+	TrackedFreeAligned(ptr);
+}
+
+void operator delete[](void* ptr, std::align_val_t, const std::nothrow_t&) noexcept {
+	TrackedFreeAligned(ptr);
+}
+#endif
\ No newline at end of file
@@ -1,104 +1,212 @@
 #include <Bloom.h>
 
+#include <cmath>
+
 #include <imgui.h>
 
 #include <Resources.h>
 #include <Graphics.h>
+#include <RenderStats.h>
+#include <RenderGraph.h>
 
 constexpr int BLOOM_LEVEL = 6;
+constexpr int BLOOM_DOWNSAMPLE_TILE_SIZE = 32;
+
+constexpr TextureParams BloomTextureParams {
+	.channels = TextureChannels::RGBA,
+	.colorSpace = TextureColor::Linear,
+	.format = TextureFormat::Float,
+	.wrapU = TextureWrap::Clamp,
+	.wrapV = TextureWrap::Clamp,
+	.wrapW = TextureWrap::Clamp,
+	.minFilter = TextureFilter::LinearMipmapNearest,
+	.magFilter = TextureFilter::Linear
+};
+
+Bloom::Bloom():
+frameResolution(0.0f),
+bloomTexture(nullptr),
+mipCount(0) {
+	GLuint zero = 0;
+	glCreateBuffers(1, &this->downsampleCounterBuffer);
+	glNamedBufferStorage(this->downsampleCounterBuffer, sizeof(GLuint), &zero, 0);
 
-void Bloom::UpdateTexture() {
-	glm::uvec2 resolution = glm::ceil(this->savedResolution / 2.0f);
-
-	if (resolution.x <= 0 || resolution.y <= 0) {
-		return;
-	}
+	this->downsampleShader = new ComputeShaderProgram(GetScene()->Resources()->Get<ComputeShader>("./res/shaders/bloom/bloom_downsample.comp"));
+	this->upsampleShader = new ComputeShaderProgram(GetScene()->Resources()->Get<ComputeShader>("./res/shaders/bloom/bloom_upsample.comp"));
+	this->finalShader = new ComputeShaderProgram(GetScene()->Resources()->Get<ComputeShader>("./res/shaders/bloom/bloom_final.comp"));
 
-	glBindTexture(GL_TEXTURE_2D, this->bloomTexture);
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, resolution.x, resolution.y, 0, GL_RGBA, GL_FLOAT, nullptr);
-	glGenerateMipmap(GL_TEXTURE_2D);
-	glBindTexture(GL_TEXTURE_2D, 0);
+	GLuint downsampleHandle = this->downsampleShader->GetHandle();
+	this->downsampleUniforms.treshold = glGetUniformLocation(downsampleHandle, "treshold");
+	this->downsampleUniforms.mip0Size = glGetUniformLocation(downsampleHandle, "mip0Size");
+	this->downsampleUniforms.mipCount = glGetUniformLocation(downsampleHandle, "mipCount");
+	this->downsampleUniforms.groupCount = glGetUniformLocation(downsampleHandle, "groupCount");
+
+	GLuint upsampleHandle = this->upsampleShader->GetHandle();
+	this->upsampleUniforms.texelSize = glGetUniformLocation(upsampleHandle, "texelSize");
+	this->upsampleUniforms.mipLevel = glGetUniformLocation(upsampleHandle, "mipLevel");
+	this->upsampleUniforms.bloomIntensity = glGetUniformLocation(upsampleHandle, "bloomIntensity");
+
+	GLuint finalHandle = this->finalShader->GetHandle();
+	this->finalUniforms.frameTexelSize = glGetUniformLocation(finalHandle, "frameTexelSize");
+	this->finalUniforms.bloomTexelSize = glGetUniformLocation(finalHandle, "bloomTexelSize");
+	this->finalUniforms.bloomIntensity = glGetUniformLocation(finalHandle, "bloomIntensity");
 }
 
-Bloom::Bloom() {
-	this->savedResolution = GetScene()->GetGraphics()->GetScreenResolution();
+Bloom::~Bloom() {
+	glDeleteBuffers(1, &this->downsampleCounterBuffer);
 
-	glCreateTextures(GL_TEXTURE_2D, 1, &this->bloomTexture);
-	
-	UpdateTexture();
-	glTextureParameteri(this->bloomTexture, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_NEAREST);
-	glTextureParameteri(this->bloomTexture, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-	glTextureParameteri(this->bloomTexture, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-	glTextureParameteri(this->bloomTexture, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-
-	this->downsampleShader = new ComputeShaderProgram(GetScene()->Resources()->Get<ComputeShader>("./res/shaders/bloom/bloom_downsample.comp"));
-	this->upsampleShader = new ComputeShaderProgram(GetScene()->Resources()->Get<ComputeShader>("./res/shaders/bloom/bloom_upsample.comp"));
-	this->finalShader = new ComputeShaderProgram(GetScene()->Resources()->Get<ComputeShader>("./res/shaders/bloom/bloom_final.comp"));
+	delete this->downsampleShader;
+	delete this->upsampleShader;
+	delete this->finalShader;
 }
 
-void Bloom::OnPostProcess(const PostProcessParams* params) {
-	if (this->savedResolution != GetScene()->GetGraphics()->GetScreenResolution()) {
-		this->savedResolution = GetScene()->GetGraphics()->GetScreenResolution();
+void Bloom::BuildPyramid(const PostProcessParams* params) {
+	this->frameResolution = glm::vec2(params->inputTexture->GetSize());
+	this->bloomTexture = nullptr;
+
+	glm::ivec2 mip0Size = glm::ceil(this->frameResolution / 2.0f);
 
-		UpdateTexture();
+	if (mip0Size.x <= 0 || mip0Size.y <= 0) {
+		return;
 	}
 
-	glm::uvec2 resolution = glm::ceil(this->savedResolution / 2.0f);
+	// The pyramid only lives for the current pass, so it can share memory with the other transient targets
+	this->bloomTexture = GetScene()->GetGraphics()->GetRenderGraph()->AcquireScratchTexture(glm::uvec2(mip0Size), BloomTextureParams);
+
+	int maxMipCount = (int) std::floor(std::log2((float) glm::max(mip0Size.x, mip0Size.y))) + 1;
+	this->mipCount = glm::min(BLOOM_LEVEL - 1, maxMipCount);
+
+	GLuint bloomHandle = this->bloomTexture->GetHandle();
+
+	glm::uvec2 groups = (glm::uvec2(mip0Size) + glm::uvec2(BLOOM_DOWNSAMPLE_TILE_SIZE - 1)) / glm::uvec2(BLOOM_DOWNSAMPLE_TILE_SIZE);
 
 	glUseProgram(this->downsampleShader->GetHandle());
+	RenderStats::Add(RenderCounter::ProgramBinds);
 
 	glm::vec4 tresholdVec = glm::vec4(this->threshold, this->threshold - this->knee, 2.0f * this->knee, 0.25f * this->knee);
 
-	glUniform4fv(glGetUniformLocation(this->downsampleShader->GetHandle(), "treshold"), 1, &tresholdVec[0]);
+	glUniform4fv(this->downsampleUniforms.treshold, 1, &tresholdVec[0]);
+	glUniform2i(this->downsampleUniforms.mip0Size, mip0Size.x, mip0Size.y);
+	glUniform1i(this->downsampleUniforms.mipCount, this->mipCount);
+	glUniform1ui(this->downsampleUniforms.groupCount, groups.x * groups.y);
 
 	glBindTextureUnit(0, params->inputTexture->GetHandle());
 
-	for (int i = 0; i < BLOOM_LEVEL - 1; i++) {
-		if (i == 1) {
-			glBindTextureUnit(0, this->bloomTexture);
-		}
+	for (int i = 0; i < this->mipCount; i++) {
+		glBindImageTexture(i, bloomHandle, i, false, 0, i >= 3 ? GL_READ_WRITE : GL_WRITE_ONLY, GL_RGBA16F);
+	}
 
-		glBindImageTexture(0, this->bloomTexture, i, false, 0, GL_WRITE_ONLY, GL_RGBA16F);
-		
-		glm::vec2 texelSize = 1.0f / glm::vec2(resolution);
-		glUniform2fv(glGetUniformLocation(this->downsampleShader->GetHandle(), "texelSize"), 1, &texelSize[0]);
-		glUniform1i(glGetUniformLocation(this->downsampleShader->GetHandle(), "mipLevel"), std::max(i - 1, 0));
-		glUniform1i(glGetUniformLocation(this->downsampleShader->GetHandle(), "useTreshold"), i == 0);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, this->downsampleCounterBuffer);
 
-		glDispatchCompute(std::ceil(float(resolution.x) / 8), std::ceil(float(resolution.y) / 8), 1);
+	glDispatchCompute(groups.x, groups.y, 1);
 
-		resolution = resolution / 2u;
+	RenderStats::Add(RenderCounter::ComputeDispatches);
 
-		glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT);
-	}
+	// The last group resets the counter, the next dispatch has to see the reset
+	glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT);
 
 	glUseProgram(this->upsampleShader->GetHandle());
+	RenderStats::Add(RenderCounter::ProgramBinds);
+
+	glUniform1f(this->upsampleUniforms.bloomIntensity, this->intensity);
 
-	glUniform1f(glGetUniformLocation(this->upsampleShader->GetHandle(), "bloomIntensity"), this->intensity);
+	glBindTextureUnit(0, bloomHandle);
 
-	for (int i = BLOOM_LEVEL - 1; i >= 1; i--) {
-		if (i == 1) {
-			glBindImageTexture(0, params->outputTexture->GetHandle(), 0, false, 0, GL_READ_WRITE, GL_RGBA16F);
-		}
-		else {
-			glBindImageTexture(0, this->bloomTexture, i - 2, false, 0, GL_READ_WRITE, GL_RGBA16F);
-		}
+	// Mip 0 is never written back, the composite pass upsamples mip 1 on the fly
+	for (int i = this->mipCount - 2; i >= 1; i--) {
+		glBindImageTexture(0, bloomHandle, i, false, 0, GL_READ_WRITE, GL_RGBA16F);
 
-		resolution.x = glm::max(1.0, glm::floor(float(savedResolution.x)  / glm::pow(2.0, i - 1)));
-        resolution.y = glm::max(1.0, glm::floor(float(savedResolution.y) / glm::pow(2.0, i - 1)));
+		glm::ivec2 resolution = glm::max(mip0Size >> i, glm::ivec2(1));
 
 		glm::vec2 texelSize = 1.0f / glm::vec2(resolution);
-		glUniform2fv(glGetUniformLocation(this->upsampleShader->GetHandle(), "texelSize"), 1, &texelSize[0]);
-		glUniform1i(glGetUniformLocation(this->upsampleShader->GetHandle(), "mipLevel"), i - 1);
+		glUniform2fv(this->upsampleUniforms.texelSize, 1, &texelSize[0]);
+		glUniform1i(this->upsampleUniforms.mipLevel, i + 1);
 
 		glDispatchCompute(std::ceil(float(resolution.x) / 8), std::ceil(float(resolution.y) / 8), 1);
 
-		resolution = resolution * 2u;
+		RenderStats::Add(RenderCounter::ComputeDispatches);
 
 		glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT);
 	}
 }
 
+void Bloom::OnPostProcess(const PostProcessParams* params) {
+	BuildPyramid(params);
+
+	if (this->bloomTexture == nullptr) {
+		return;
+	}
+
+	glUseProgram(this->finalShader->GetHandle());
+	RenderStats::Add(RenderCounter::ProgramBinds);
+
+	glBindTextureUnit(0, this->bloomTexture->GetHandle());
+	glBindImageTexture(0, params->outputTexture->GetHandle(), 0, false, 0, GL_READ_WRITE, GL_RGBA16F);
+
+	glm::vec2 frameTexelSize = 1.0f / this->frameResolution;
+	glm::vec2 bloomTexelSize = 1.0f / glm::ceil(this->frameResolution / 2.0f);
+	glUniform2fv(this->finalUniforms.frameTexelSize, 1, &frameTexelSize[0]);
+	glUniform2fv(this->finalUniforms.bloomTexelSize, 1, &bloomTexelSize[0]);
+	glUniform1f(this->finalUniforms.bloomIntensity, this->intensity);
+
+	glDispatchCompute(std::ceil(this->frameResolution.x / 8), std::ceil(this->frameResolution.y / 8), 1);
+
+	RenderStats::Add(RenderCounter::ComputeDispatches);
+
+	glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT);
+}
+
+int Bloom::GetFusedVariant() const {
+	return 0;
+}
+
+bool Bloom::GetFusedSnippet(PostProcessSnippet* snippet) const {
+	snippet->declarations =
+		"#include \"bloom/composite.h\"\n"
+		"uniform sampler2D $bloomTex;\n"
+		"uniform vec2 $frameTexelSize;\n"
+		"uniform vec2 $bloomTexelSize;\n"
+		"uniform float $intensity;\n";
+
+	snippet->body = "color.rgb += BloomComposite($bloomTex, uv, $frameTexelSize, $bloomTexelSize, $intensity);\n";
+	snippet->uniforms = { "bloomTex", "frameTexelSize", "bloomTexelSize", "intensity" };
+
+	return true;
+}
+
+void Bloom::OnPreFusedPass(const PostProcessParams* params) {
+	BuildPyramid(params);
+}
+
+bool Bloom::PreFusedPassReadsInput() const {
+	return true;
+}
+
+void Bloom::SetFusedValues(ComputeDispatchData* data, const std::vector<std::string>& uniforms) {
+	data->SetValue(uniforms[0], this->bloomTexture);
+	data->SetValue(uniforms[1], 1.0f / this->frameResolution);
+	data->SetValue(uniforms[2], 1.0f / glm::ceil(this->frameResolution / 2.0f));
+	data->SetValue(uniforms[3], this->intensity);
+}
+
+bool Bloom::RunsInPlace() const {
+	return true;
+}
+
+std::vector<float> Bloom::GetSettings() const {
+	return { this->threshold, this->knee, this->intensity };
+}
+
+void Bloom::SetSettings(const std::vector<float>& settings) {
+	if (settings.size() != 3) {
+		return;
+	}
+
+	this->threshold = settings[0];
+	this->knee = settings[1];
+	this->intensity = settings[2];
+}
+
 void Bloom::DrawImGui() {
 	ImGui::InputFloat("Threshold", &this->threshold);
 	ImGui::InputFloat("Knee", &this->knee);
@@ -29,7 +29,8 @@ Camera::Camera(Perspective perspectiveData):
 type(CameraType::Perspective),
 perspectiveData(perspectiveData),
 orthoData(),
-layerMask(LayerMask::All) {
+layerMask(LayerMask::All),
+projectionJitter(0.0f) {
 	if (GetScene()->GetGraphics() && GetScene()->GetGraphics()->GetMainCamera() == nullptr) {
 		SetAsMainCamera();
 	}
@@ -39,7 +40,8 @@ Camera::Camera(Orthographic orthoData):
 type(CameraType::Orthographic),
 perspectiveData(),
 orthoData(orthoData),
-layerMask(LayerMask::All) {
+layerMask(LayerMask::All),
+projectionJitter(0.0f) {
 	if (GetScene()->GetGraphics() && GetScene()->GetGraphics()->GetMainCamera() == nullptr) {
 		SetAsMainCamera();
 	}
@@ -191,6 +193,13 @@ glm::mat4 Camera::ViewMatrix() const {
 	);
 }
 glm::mat4 Camera::ProjectionMatrix() const {
+	if (this->projectionJitter == glm::vec2(0.0f)) {
+		return UnjitteredProjectionMatrix();
+	}
+
+	return glm::translate(glm::mat4(1.0f), glm::vec3(this->projectionJitter, 0.0f)) * UnjitteredProjectionMatrix();
+}
+glm::mat4 Camera::UnjitteredProjectionMatrix() const {
 	if (this->type == CameraType::Perspective) {
 		return glm::perspective(
 			glm::radians(this->perspectiveData.fovyDegrees),
@@ -212,6 +221,14 @@ glm::mat4 Camera::ViewProjectionMatrix() const {
 	return ProjectionMatrix() * ViewMatrix();
 }
 
+glm::vec2 Camera::GetProjectionJitter() const {
+	return this->projectionJitter;
+}
+
+void Camera::SetProjectionJitter(glm::vec2 ndcOffset) {
+	this->projectionJitter = ndcOffset;
+}
+
 Viewport* Camera::GetRenderTarget() const {
 	return this->renderTarget;
 }
@@ -0,0 +1,162 @@
+#include <DynamicResolution.h>
+
+#include <imgui.h>
+
+constexpr float DYNAMIC_RESOLUTION_SCALE_STEP = 0.05f;
+constexpr float DYNAMIC_RESOLUTION_HEADROOM = 0.85f;
+constexpr float DYNAMIC_RESOLUTION_SMOOTHING = 0.1f;
+constexpr int DYNAMIC_RESOLUTION_COOLDOWN_FRAMES = 30;
+
+DynamicResolution::DynamicResolution():
+queryIndex(0),
+enabled(true),
+targetFrameTime(1000.0f / 60.0f),
+minScale(0.5f),
+maxScale(1.0f),
+scale(1.0f),
+gpuFrameTime(0.0f),
+framesSinceChange(0) {
+	glGenQueries(QueryLatency, this->startQueries);
+	glGenQueries(QueryLatency, this->endQueries);
+
+	for (int i = 0; i < QueryLatency; i++) {
+		this->queryIssued[i] = false;
+	}
+}
+
+DynamicResolution::~DynamicResolution() {
+	glDeleteQueries(QueryLatency, this->startQueries);
+	glDeleteQueries(QueryLatency, this->endQueries);
+}
+
+void DynamicResolution::BeginFrame() {
+	glQueryCounter(this->startQueries[this->queryIndex], GL_TIMESTAMP);
+}
+
+void DynamicResolution::EndFrame() {
+	glQueryCounter(this->endQueries[this->queryIndex], GL_TIMESTAMP);
+
+	this->queryIssued[this->queryIndex] = true;
+	this->queryIndex = (this->queryIndex + 1) % QueryLatency;
+
+	// The slot we are about to reuse holds the oldest frame, read it back without stalling
+	if (!this->queryIssued[this->queryIndex]) {
+		return;
+	}
+
+	GLint available = 0;
+	glGetQueryObjectiv(this->endQueries[this->queryIndex], GL_QUERY_RESULT_AVAILABLE, &available);
+
+	if (!available) {
+		return;
+	}
+
+	GLuint64 start = 0;
+	GLuint64 end = 0;
+	glGetQueryObjectui64v(this->startQueries[this->queryIndex], GL_QUERY_RESULT, &start);
+	glGetQueryObjectui64v(this->endQueries[this->queryIndex], GL_QUERY_RESULT, &end);
+
+	this->queryIssued[this->queryIndex] = false;
+
+	OnFrameTimeMeasured((float) (end - start) / 1000000.0f);
+}
+
+void DynamicResolution::OnFrameTimeMeasured(float frameTimeMs) {
+	if (this->gpuFrameTime <= 0.0f) {
+		this->gpuFrameTime = frameTimeMs;
+	}
+	else {
+		this->gpuFrameTime = glm::mix(this->gpuFrameTime, frameTimeMs, DYNAMIC_RESOLUTION_SMOOTHING);
+	}
+
+	this->framesSinceChange++;
+
+	if (!this->enabled || this->framesSinceChange < DYNAMIC_RESOLUTION_COOLDOWN_FRAMES) {
+		return;
+	}
+
+	bool overBudget = this->gpuFrameTime > this->targetFrameTime;
+	bool underBudget = this->gpuFrameTime < this->targetFrameTime * DYNAMIC_RESOLUTION_HEADROOM;
+
+	if (!overBudget && !underBudget) {
+		return;
+	}
+
+	// Cost scales with the pixel count, so the axis scale follows the square root of the time ratio
+	float desired = this->scale * glm::sqrt(this->targetFrameTime / glm::max(this->gpuFrameTime, 0.01f));
+
+	desired = glm::round(desired / DYNAMIC_RESOLUTION_SCALE_STEP) * DYNAMIC_RESOLUTION_SCALE_STEP;
+
+	// Drop quickly when over budget, but only creep back up to avoid oscillating around the target
+	if (underBudget) {
+		desired = glm::min(desired, this->scale + DYNAMIC_RESOLUTION_SCALE_STEP);
+	}
+
+	desired = glm::clamp(desired, this->minScale, this->maxScale);
+
+	if (glm::abs(desired - this->scale) < DYNAMIC_RESOLUTION_SCALE_STEP * 0.5f) {
+		return;
+	}
+
+	this->scale = desired;
+	this->framesSinceChange = 0;
+}
+
+bool DynamicResolution::IsEnabled() const {
+	return this->enabled;
+}
+
+void DynamicResolution::SetEnabled(bool enabled) {
+	this->enabled = enabled;
+}
+
+float DynamicResolution::GetTargetFrameTime() const {
+	return this->targetFrameTime;
+}
+
+void DynamicResolution::SetTargetFrameTime(float frameTimeMs) {
+	this->targetFrameTime = frameTimeMs;
+}
+
+void DynamicResolution::SetScaleRange(float minScale, float maxScale) {
+	this->minScale = glm::clamp(minScale, DYNAMIC_RESOLUTION_SCALE_STEP, 1.0f);
+	this->maxScale = glm::clamp(maxScale, this->minScale, 1.0f);
+
+	this->scale = glm::clamp(this->scale, this->minScale, this->maxScale);
+}
+
+float DynamicResolution::GetScale() const {
+	return this->scale;
+}
+
+float DynamicResolution::GetGPUFrameTime() const {
+	return this->gpuFrameTime;
+}
+
+glm::uvec2 DynamicResolution::GetRenderResolution(const glm::uvec2& outputResolution) const {
+	return glm::max(glm::uvec2(glm::round(glm::vec2(outputResolution) * this->scale)), glm::uvec2(1));
+}
+
+void DynamicResolution::DrawImGui() {
+	if (ImGui::TreeNode("Dynamic Resolution")) {
+		ImGui::Checkbox("Enabled", &this->enabled);
+		ImGui::InputFloat("Target frame time (ms)", &this->targetFrameTime);
+
+		float range[2] = {this->minScale, this->maxScale};
+
+		if (ImGui::SliderFloat2("Scale range", range, DYNAMIC_RESOLUTION_SCALE_STEP, 1.0f)) {
+			SetScaleRange(range[0], range[1]);
+		}
+
+		if (this->enabled) {
+			ImGui::Text("Render scale: %.2f", this->scale);
+		}
+		else {
+			ImGui::SliderFloat("Render scale", &this->scale, this->minScale, this->maxScale);
+		}
+
+		ImGui::Text("GPU frame time: %.3f ms", this->gpuFrameTime);
+
+		ImGui::TreePop();
+	}
+}
\ No newline at end of file
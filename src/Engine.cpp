@@ -20,9 +20,27 @@ extern "C" {
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 
+#ifdef SYZYF_HAS_EGL
+#define EGL_NO_X11
+#define MESA_EGL_NO_X11_HEADERS
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
 #include <Scene.h>
 #include <TimeSystem.h>
 #include <Graphics.h>
+#include <Viewport.h>
+#include <Framebuffer.h>
+#include <Profiler.h>
+#include <RenderStats.h>
+#include <AllocationTracker.h>
+#include <MemoryTracker.h>
+#include <ResourceLoader.h>
+#include <Resources.h>
+#include <Texture.h>
+#include <Mesh.h>
+#include <FrameAllocator.h>
 
 const char*   glsl_version     = "#version 460";
 constexpr int32_t GL_VERSION_MAJOR = 4;
@@ -31,6 +49,29 @@ constexpr int32_t GL_VERSION_MINOR = 6;
 GLFWwindow* Engine::window = nullptr;
 Scene* Engine::rootScene = nullptr;
 
+bool Engine::headless = false;
+int Engine::frameLimit = 0;
+Viewport* Engine::headlessTarget = nullptr;
+
+#ifdef SYZYF_HAS_EGL
+static EGLDisplay eglDisplay = EGL_NO_DISPLAY;
+static EGLContext eglContext = EGL_NO_CONTEXT;
+
+static EGLDisplay GetSurfacelessDisplay() {
+	auto getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC) eglGetProcAddress("eglGetPlatformDisplayEXT");
+
+	if (getPlatformDisplay) {
+		EGLDisplay display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+
+		if (display != EGL_NO_DISPLAY) {
+			return display;
+		}
+	}
+
+	return eglGetDisplay(EGL_DEFAULT_DISPLAY);
+}
+#endif
+
 
 static void GLFWErrorCallback(int error, const char* description) {
 	fprintf(stderr, "Glfw Error %d: %s\n", error, description);
@@ -117,6 +158,104 @@ bool Engine::InitProgram() {
 		return false;
 	}
 
+	InitGLState();
+
+	return true;
+}
+
+bool Engine::InitHeadless(unsigned int width, unsigned int height) {
+	glfwSetErrorCallback(GLFWErrorCallback);
+
+	// Only the timer is used without a window, so no display connection is needed
+	glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+
+	if (!glfwInit())  {
+		spdlog::error("Failed to initalize GLFW!");
+
+		return false;
+	}
+
+#ifdef SYZYF_HAS_EGL
+#ifndef _WIN32
+	// llvmpipe advertises 4.5 but implements everything the engine uses from 4.6
+	setenv("MESA_GL_VERSION_OVERRIDE", "4.6", 0);
+	setenv("MESA_GLSL_VERSION_OVERRIDE", "460", 0);
+#endif
+
+	eglDisplay = GetSurfacelessDisplay();
+
+	if (eglDisplay == EGL_NO_DISPLAY || !eglInitialize(eglDisplay, nullptr, nullptr)) {
+		spdlog::error("Failed to initialize EGL display!");
+
+		return false;
+	}
+
+	if (!eglBindAPI(EGL_OPENGL_API)) {
+		spdlog::error("EGL display does not support desktop OpenGL!");
+
+		return false;
+	}
+
+	const EGLint configAttributes[] = {
+		EGL_SURFACE_TYPE,    EGL_PBUFFER_BIT,
+		EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+		EGL_NONE
+	};
+
+	EGLConfig config = nullptr;
+	EGLint configCount = 0;
+
+	if (!eglChooseConfig(eglDisplay, configAttributes, &config, 1, &configCount) || configCount == 0) {
+		config = nullptr;
+	}
+
+	const EGLint contextAttributes[] = {
+		EGL_CONTEXT_MAJOR_VERSION,       GL_VERSION_MAJOR,
+		EGL_CONTEXT_MINOR_VERSION,       GL_VERSION_MINOR,
+		EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+		EGL_CONTEXT_OPENGL_DEBUG,        EGL_TRUE,
+		EGL_NONE
+	};
+
+	eglContext = eglCreateContext(eglDisplay, config, EGL_NO_CONTEXT, contextAttributes);
+
+	if (eglContext == EGL_NO_CONTEXT) {
+		spdlog::error("Failed to create OpenGL {}.{} EGL context! (0x{:x})", GL_VERSION_MAJOR, GL_VERSION_MINOR, eglGetError());
+
+		return false;
+	}
+
+	if (!eglMakeCurrent(eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, eglContext)) {
+		spdlog::error("Failed to make surfaceless EGL context current!");
+
+		return false;
+	}
+
+	bool err = !gladLoadGLLoader((GLADloadproc) eglGetProcAddress);
+
+	if (err) {
+		spdlog::error("Failed to initialize OpenGL loader!");
+
+		return false;
+	}
+
+	spdlog::info("Headless context: {} ({})", (const char*) glGetString(GL_RENDERER), (const char*) glGetString(GL_VERSION));
+
+	InitGLState();
+
+	headlessTarget = new Viewport();
+	headlessTarget->GetFramebuffer()->CreateColorAttachment(false, false);
+	headlessTarget->SetSize(glm::uvec2(width, height));
+
+	return true;
+#else
+	spdlog::error("Headless rendering requires the engine to be built with EGL support!");
+
+	return false;
+#endif
+}
+
+void Engine::InitGLState() {
 	int contextFlags = 0;
 	glGetIntegerv(GL_CONTEXT_FLAGS, &contextFlags);
 
@@ -125,6 +264,9 @@ bool Engine::InitProgram() {
 		glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
 		glDebugMessageCallback(glDebugOutput, nullptr);
 		glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DONT_CARE, 0, nullptr, true);
+		// Profiler debug groups are pushed every pass, every frame
+		glDebugMessageControl(GL_DEBUG_SOURCE_APPLICATION, GL_DEBUG_TYPE_PUSH_GROUP, GL_DONT_CARE, 0, nullptr, false);
+		glDebugMessageControl(GL_DEBUG_SOURCE_APPLICATION, GL_DEBUG_TYPE_POP_GROUP, GL_DONT_CARE, 0, nullptr, false);
 	}
 	else {
 		spdlog::warn("Current machine does not support OpenGL debugging");
@@ -133,8 +275,6 @@ bool Engine::InitProgram() {
 	glEnable(GL_DEPTH_TEST);
 	glEnable(GL_CULL_FACE);
 	glEnable(GL_TEXTURE_CUBE_MAP_SEAMLESS);
-
-	return true;
 }
 
 bool Engine::InitImGui() {
@@ -157,31 +297,69 @@ void Engine::Terminate() {
 		delete rootScene;
 	}
 
-	ImGui_ImplOpenGL3_Shutdown();
-	ImGui_ImplGlfw_Shutdown();
-	ImGui::DestroyContext();
+	ResourceLoader::Stop();
+
+	if (headless) {
+		delete headlessTarget;
+
+#ifdef SYZYF_HAS_EGL
+		if (eglDisplay != EGL_NO_DISPLAY) {
+			eglMakeCurrent(eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+
+			if (eglContext != EGL_NO_CONTEXT) {
+				eglDestroyContext(eglDisplay, eglContext);
+			}
+
+			eglTerminate(eglDisplay);
+		}
+#endif
+	}
+	else {
+		ImGui_ImplOpenGL3_Shutdown();
+		ImGui_ImplGlfw_Shutdown();
+		ImGui::DestroyContext();
+
+		glfwDestroyWindow(window);
+	}
 
-	glfwDestroyWindow(window);
 	glfwTerminate();
 }
 
 void Engine::Update() {
+	PROFILE_ZONE("Engine::Update");
+
 	Time::Update();
 
 	rootScene->Update();
 }
 
 void Engine::Render() {
-	int display_w, display_h;
-	glfwMakeContextCurrent(window);
-	glfwGetFramebufferSize(window, &display_w, &display_h);
+	PROFILE_ZONE("Engine::Render");
+
+	if (headless) {
+		rootScene->GetGraphics()->UpdateScreenResolution(glm::vec2(headlessTarget->GetSize()));
+	}
+	else {
+		int display_w, display_h;
+		glfwMakeContextCurrent(window);
+		glfwGetFramebufferSize(window, &display_w, &display_h);
 
-	rootScene->GetGraphics()->UpdateScreenResolution(glm::vec2(display_w, display_h));
+		rootScene->GetGraphics()->UpdateScreenResolution(glm::vec2(display_w, display_h));
+	}
 
 	rootScene->Render();
 }
 
+void Engine::InitResources() {
+	ResourceLoader::Start();
+
+	ResourceDatabase::SetPlaceholder(ResourceDatabase::Global->Get<Texture2D>("./res/textures/default_color.png", Texture::ColorTextureRGB));
+	ResourceDatabase::SetPlaceholder(ResourceDatabase::Global->Get<Mesh>("./res/models/cube.obj"));
+}
+
 void Engine::DrawImGui() {
+	PROFILE_ZONE("Engine::DrawImGui");
+
 	ImGui_ImplOpenGL3_NewFrame();
 	ImGui_ImplGlfw_NewFrame();
 	ImGui::NewFrame();
@@ -194,6 +372,10 @@ void Engine::DrawImGui() {
 
 	rootScene->DrawImGui();
 
+	Profiler::DrawImGui();
+	AllocationTracker::DrawImGui();
+	MemoryTracker::DrawImGui();
+
 	ImGui::End();
 
 	ImGui::Render();
@@ -211,26 +393,84 @@ bool Engine::Setup() {
 		return false;
 	}
 
+	InitResources();
+
 	rootScene = Scene::CreateStandaloneScene();
 
 	return true;
 }
 
+bool Engine::SetupHeadless(unsigned int width, unsigned int height, int frameCount) {
+	headless = true;
+	frameLimit = frameCount;
+
+	if (!InitHeadless(width, height)) {
+		return false;
+	}
+
+	InitResources();
+
+	rootScene = Scene::CreateStandaloneScene();
+	rootScene->GetGraphics()->SetOutputTarget(headlessTarget);
+
+	return true;
+}
+
 void Engine::MainLoop() {
-	while (!glfwWindowShouldClose(window)) {
+	int frame = 0;
+
+	while (headless ? frame < frameLimit : !glfwWindowShouldClose(window)) {
+		Profiler::BeginFrame();
+		AllocationTracker::BeginFrame();
+		FrameArena::BeginFrame();
+		RenderStats::BeginFrame();
+
+		PROFILE_ZONE("Engine::Frame");
+
+		// Bounded so streaming assets in does not hitch the frame
+		ResourceLoader::ProcessUploads(UploadBudgetSeconds);
+
 		Update();
 
 		Render();
 
+		RenderStats::EndFrame();
+
+		frame++;
+
+		if (headless) {
+			continue;
+		}
+
 		DrawImGui();
 
+		PROFILE_ZONE("Engine::Present");
+
 		glfwPollEvents();
 		glfwMakeContextCurrent(window);
 		glfwSwapBuffers(window);
 	}
+
+	if (headless) {
+		glFinish();
+
+		spdlog::info("Rendered {} headless frames", frame);
+	}
+
+	WriteProfilerTrace();
+}
+
+void Engine::WriteProfilerTrace() {
+	const char* tracePath = std::getenv("SYZYF_PROFILE_TRACE");
+
+	if (tracePath != nullptr && tracePath[0] != '\0') {
+		Profiler::ExportChromeTrace(tracePath);
+	}
 }
 
 void Engine::Exit(int code) {
+	WriteProfilerTrace();
+
 	Terminate();
 
 	exit(code);
@@ -242,4 +482,12 @@ Scene* Engine::GetRoot() {
 
 GLFWwindow* Engine::GetWindow() {
 	return window;
+}
+
+bool Engine::IsHeadless() {
+	return headless;
+}
+
+Viewport* Engine::GetHeadlessTarget() {
+	return headlessTarget;
 }
\ No newline at end of file
@@ -0,0 +1,99 @@
+#include <FrameAllocator.h>
+
+#include <cstdlib>
+#include <algorithm>
+
+std::atomic<uint64_t> FrameArena::currentFrame = 0;
+
+FrameArena::FrameArena():
+current(nullptr),
+offset(0),
+used(0),
+peak(0),
+frame(0) { }
+
+FrameArena::~FrameArena() {
+	while (this->current) {
+		Block* previous = this->current->previous;
+		std::free(this->current);
+		this->current = previous;
+	}
+}
+
+void FrameArena::AddBlock(size_t minSize) {
+	size_t size = std::max(minSize + sizeof(Block), this->current ? this->current->size * 2 : MinBlockSize);
+
+	Block* block = static_cast<Block*>(std::malloc(size));
+	block->previous = this->current;
+	block->size = size;
+
+	this->current = block;
+	this->offset = sizeof(Block);
+}
+
+void FrameArena::Rewind() {
+	this->frame = currentFrame.load(std::memory_order_relaxed);
+	this->peak = std::max(this->peak, this->used);
+	this->used = 0;
+
+	if (!this->current) {
+		return;
+	}
+
+	// A frame that spilled into several blocks gets one block big enough for all of them,
+	// so steady state frames are a single block and never hit malloc
+	if (this->current->previous) {
+		size_t total = 0;
+
+		while (this->current) {
+			Block* previous = this->current->previous;
+			total += this->current->size;
+			std::free(this->current);
+			this->current = previous;
+		}
+
+		AddBlock(total);
+	}
+
+	this->offset = sizeof(Block);
+}
+
+void* FrameArena::Allocate(size_t size, size_t alignment) {
+	if (this->frame != currentFrame.load(std::memory_order_relaxed)) {
+		Rewind();
+	}
+
+	if (this->current) {
+		uintptr_t base = reinterpret_cast<uintptr_t>(this->current);
+		uintptr_t start = (base + this->offset + alignment - 1) & ~(uintptr_t) (alignment - 1);
+
+		if (start + size <= base + this->current->size) {
+			this->offset = start + size - base;
+			this->used += size;
+
+			return reinterpret_cast<void*>(start);
+		}
+	}
+
+	AddBlock(size + alignment);
+
+	return Allocate(size, alignment);
+}
+
+size_t FrameArena::GetUsedBytes() const {
+	return this->used;
+}
+
+size_t FrameArena::GetPeakBytes() const {
+	return std::max(this->peak, this->used);
+}
+
+FrameArena& FrameArena::Local() {
+	static thread_local FrameArena arena;
+
+	return arena;
+}
+
+void FrameArena::BeginFrame() {
+	currentFrame.fetch_add(1, std::memory_order_relaxed);
+}
\ No newline at end of file
@@ -0,0 +1,727 @@
+#include <FrameCapture.h>
+
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <algorithm>
+#include <type_traits>
+#include <unordered_map>
+
+#include <spdlog/spdlog.h>
+
+#include <Scene.h>
+#include <Graphics.h>
+#include <DynamicResolution.h>
+#include <Mesh.h>
+#include <Material.h>
+#include <Shader.h>
+#include <Skybox.h>
+#include <LightSystem.h>
+#include <PostProcessingSystem.h>
+#include <Bloom.h>
+#include <Tonemapper.h>
+
+constexpr uint32_t CAPTURE_MAGIC = 0x43465A53; // "SZFC"
+constexpr uint32_t CAPTURE_VERSION = 2;
+// Upper bound for any element count read from a file, anything larger means the file is corrupt
+constexpr uint32_t CAPTURE_MAX_ELEMENTS = 1 << 24;
+
+struct EffectType {
+	const char* name;
+	bool (*matches)(const PostProcessEffect* effect);
+	PostProcessEffect* (*create)(SceneNode* node);
+};
+
+const EffectType EFFECT_TYPES[] = {
+	{ "bloom",      [](const PostProcessEffect* e) { return dynamic_cast<const Bloom*>(e) != nullptr; },      [](SceneNode* n) -> PostProcessEffect* { return n->AddObject<Bloom>(); } },
+	{ "tonemapper", [](const PostProcessEffect* e) { return dynamic_cast<const Tonemapper*>(e) != nullptr; }, [](SceneNode* n) -> PostProcessEffect* { return n->AddObject<Tonemapper>(); } },
+};
+
+bool IsTextureUniform(UniformSpec::UniformType type) {
+	return type == UniformSpec::UniformType::Sampler2D
+		|| type == UniformSpec::UniformType::Cubemap
+		|| type == UniformSpec::UniformType::Image2D
+		|| type == UniformSpec::UniformType::UImage2D
+		|| type == UniformSpec::UniformType::ImageCube;
+}
+
+bool IsCubemapUniform(UniformSpec::UniformType type) {
+	return type == UniformSpec::UniformType::Cubemap || type == UniformSpec::UniformType::ImageCube;
+}
+
+template<typename T>
+	requires(std::is_trivially_copyable_v<T>)
+void Write(std::ofstream& file, const T& value) {
+	file.write((const char*) &value, sizeof(T));
+}
+
+void WriteString(std::ofstream& file, const std::string& value) {
+	Write(file, (uint32_t) value.size());
+	file.write(value.data(), value.size());
+}
+
+template<typename T>
+	requires(std::is_trivially_copyable_v<T>)
+void WriteArray(std::ofstream& file, const std::vector<T>& values) {
+	Write(file, (uint32_t) values.size());
+	file.write((const char*) values.data(), values.size() * sizeof(T));
+}
+
+template<typename T>
+	requires(std::is_trivially_copyable_v<T>)
+bool Read(std::ifstream& file, T& value) {
+	file.read((char*) &value, sizeof(T));
+
+	return file.good();
+}
+
+bool ReadCount(std::ifstream& file, uint32_t& count) {
+	return Read(file, count) && count <= CAPTURE_MAX_ELEMENTS;
+}
+
+bool ReadString(std::ifstream& file, std::string& value) {
+	uint32_t length;
+
+	if (!ReadCount(file, length)) {
+		return false;
+	}
+
+	value.resize(length);
+	file.read(value.data(), length);
+
+	return file.good();
+}
+
+template<typename T>
+	requires(std::is_trivially_copyable_v<T>)
+bool ReadArray(std::ifstream& file, std::vector<T>& values) {
+	uint32_t count;
+
+	if (!ReadCount(file, count)) {
+		return false;
+	}
+
+	values.resize(count);
+	file.read((char*) values.data(), count * sizeof(T));
+
+	return file.good();
+}
+
+FrameCapture::FrameCapture():
+resolution(0),
+renderScale(1.0f),
+temporalUpsampling(false),
+camera(),
+meshes(),
+materials(),
+nodes(),
+lights(),
+effects(),
+skyMaterial(-1) { }
+
+void FrameCapture::CaptureMaterial(const Material* material, const std::unordered_map<const void*, std::string>& texturePaths, MaterialRecord& record) {
+	const ShaderProgram* shader = material->GetShader();
+
+	auto stagePath = [](const ShaderBase* stage) {
+		return stage ? stage->GetFilePath().string() : std::string();
+	};
+
+	record.vertexShader = stagePath(shader->GetVertexShader());
+	record.geometryShader = stagePath(shader->GetGeometryShader());
+	record.tessControlShader = stagePath(shader->GetTessControlShader());
+	record.tessEvaluationShader = stagePath(shader->GetTessEvaluationShader());
+	record.pixelShader = stagePath(shader->GetPixelShader());
+	record.ignoresDepthPrepass = shader->IgnoresDepthPrepass();
+	record.castsShadows = shader->CastsShadows();
+
+	const ShaderVariableStorage& storage = material->shaderVariables;
+
+	for (unsigned int i = 0; i < storage.uniformSpec->VariableCount(); i++) {
+		const UniformSpec::UniformVariableSpec& variable = storage.uniformSpec->VariableAt(i);
+		const char* data = (const char*) storage.dataBuffer + variable.offset;
+
+		VariableRecord variableRecord{
+			.name = variable.name,
+			.type = variable.type,
+			.value = {},
+			.texturePath = {},
+			.textureParams = {},
+			.level = 0
+		};
+
+		if (IsTextureUniform(variable.type)) {
+			const UniformSpec::TextureUniform<Texture>* texture = (const UniformSpec::TextureUniform<Texture>*) data;
+
+			variableRecord.level = texture->level;
+
+			if (texture->tex) {
+				auto path = texturePaths.find(texture->tex);
+
+				if (path != texturePaths.end()) {
+					variableRecord.texturePath = path->second;
+					variableRecord.textureParams.channels = texture->tex->GetChannels();
+					variableRecord.textureParams.colorSpace = texture->tex->GetColorSpace();
+					variableRecord.textureParams.format = texture->tex->GetFormat();
+				}
+				else {
+					spdlog::warn("Texture bound to {} is not a loaded resource, the replay will leave it unbound", variable.name);
+				}
+			}
+		}
+		else if (variable.type != UniformSpec::UniformType::Unsupported) {
+			variableRecord.value.assign(data, data + UniformSpec::SizeOf(variable.type));
+		}
+
+		record.variables.push_back(variableRecord);
+	}
+
+	for (unsigned int i = 0; i < storage.uniformSpec->UniformBuffersCount(); i++) {
+		const UniformSpec::UniformBufferSpec& buffer = storage.uniformSpec->UniformBufferAt(i);
+		const char* data = (const char*) storage.uniformBuffers[i].bufferData;
+
+		record.uniformBuffers.push_back(UniformBufferRecord{ buffer.name, std::vector<char>(data, data + buffer.size) });
+	}
+}
+
+void FrameCapture::RestoreMaterial(const MaterialRecord& record, Material* material, ResourceDatabase* resources) {
+	ShaderVariableStorage& storage = material->shaderVariables;
+	const UniformSpec* spec = storage.uniformSpec;
+
+	for (const VariableRecord& variableRecord : record.variables) {
+		int index = -1;
+
+		for (unsigned int i = 0; i < spec->VariableCount(); i++) {
+			if (spec->VariableAt(i).name == variableRecord.name) {
+				index = i;
+				break;
+			}
+		}
+
+		// Shaders may have changed since the capture, mismatched variables keep their defaults
+		if (index < 0 || spec->VariableAt(index).type != variableRecord.type) {
+			spdlog::warn("Captured variable {} no longer matches the shader", variableRecord.name);
+			continue;
+		}
+
+		char* data = (char*) storage.dataBuffer + spec->VariableAt(index).offset;
+
+		if (IsTextureUniform(variableRecord.type)) {
+			Texture* texture = nullptr;
+
+			if (!variableRecord.texturePath.empty()) {
+				if (IsCubemapUniform(variableRecord.type)) {
+					texture = resources->Get<Cubemap>(variableRecord.texturePath, variableRecord.textureParams);
+				}
+				else {
+					texture = resources->Get<Texture2D>(variableRecord.texturePath, variableRecord.textureParams);
+				}
+			}
+
+			*(UniformSpec::TextureUniform<Texture>*) data = { texture, variableRecord.level };
+		}
+		else if (variableRecord.value.size() == (size_t) UniformSpec::SizeOf(variableRecord.type)) {
+			memcpy(data, variableRecord.value.data(), variableRecord.value.size());
+		}
+	}
+
+	for (const UniformBufferRecord& bufferRecord : record.uniformBuffers) {
+		for (unsigned int i = 0; i < spec->UniformBuffersCount(); i++) {
+			if (spec->UniformBufferAt(i).name == bufferRecord.name && spec->UniformBufferAt(i).size == (int) bufferRecord.data.size()) {
+				memcpy(storage.uniformBuffers[i].bufferData, bufferRecord.data.data(), bufferRecord.data.size());
+			}
+		}
+	}
+}
+
+FrameCapture* FrameCapture::Capture(SceneGraphics* graphics) {
+	Camera* mainCamera = graphics->GetMainCamera();
+
+	if (!mainCamera) {
+		spdlog::error("Can't capture a frame without a main camera");
+		return nullptr;
+	}
+
+	FrameCapture* capture = new FrameCapture();
+
+	capture->resolution = graphics->outputResolution;
+	capture->renderScale = graphics->dynamicResolution->GetScale();
+	capture->temporalUpsampling = graphics->temporalUpsampling;
+
+	capture->camera = CameraRecord{
+		.type = mainCamera->GetType(),
+		.perspective = Camera::Perspective(mainCamera->GetFov(), mainCamera->GetAspectRatio(), mainCamera->GetNearPlane(), mainCamera->GetFarPlane()),
+		.ortho = Camera::Orthographic(mainCamera->GetLeftOrthoPlane(), mainCamera->GetRightOrthoPlane(), mainCamera->GetTopOrthoPlane(), mainCamera->GetBottomOrthoPlane()),
+		.layerMask = mainCamera->GetLayerMask(),
+		.position = mainCamera->GlobalTransform().Position().Value(),
+		.rotation = mainCamera->GlobalTransform().Rotation().Value()
+	};
+
+	struct SubMeshSource {
+		const Mesh* mesh;
+		std::string path;
+		uint32_t index;
+	};
+
+	std::unordered_map<const Mesh::SubMesh*, SubMeshSource> subMeshSources;
+	std::unordered_map<const void*, std::string> texturePaths;
+
+	for (ResourceDatabase* database : { graphics->GetScene()->Resources(), ResourceDatabase::Global }) {
+		for (const auto& [path, mesh] : database->GetLoaded<Mesh>()) {
+			for (unsigned int i = 0; i < mesh->GetSubMeshCount(); i++) {
+				subMeshSources[&mesh->SubMeshAt(i)] = SubMeshSource{ mesh, path.string(), i };
+			}
+		}
+
+		for (const auto& [path, texture] : database->GetLoaded<Texture2D>()) {
+			texturePaths[texture] = path.string();
+		}
+
+		for (const auto& [path, texture] : database->GetLoaded<Cubemap>()) {
+			texturePaths[texture] = path.string();
+		}
+	}
+
+	std::unordered_map<const Mesh*, uint32_t> meshIndices;
+	std::unordered_map<const Material*, uint32_t> materialIndices;
+
+	auto materialIndex = [&](const Material* material) {
+		auto found = materialIndices.find(material);
+
+		if (found != materialIndices.end()) {
+			return found->second;
+		}
+
+		uint32_t index = capture->materials.size();
+
+		capture->materials.emplace_back();
+		CaptureMaterial(material, texturePaths, capture->materials.back());
+
+		materialIndices[material] = index;
+
+		return index;
+	};
+
+	int skippedNodes = 0;
+
+	for (const SceneGraphics::RenderNode& node : graphics->currentRenders) {
+		auto source = subMeshSources.find(node.mesh);
+
+		if (source == subMeshSources.end() || !node.material) {
+			skippedNodes++;
+			continue;
+		}
+
+		auto meshIndex = meshIndices.find(source->second.mesh);
+
+		if (meshIndex == meshIndices.end()) {
+			meshIndex = meshIndices.insert({ source->second.mesh, (uint32_t) capture->meshes.size() }).first;
+
+			capture->meshes.push_back(source->second.path);
+		}
+
+		capture->nodes.push_back(NodeRecord{
+			.mesh = meshIndex->second,
+			.subMesh = source->second.index,
+			.material = materialIndex(node.material),
+			.instanceCount = node.instanceCount,
+			.transformation = node.transformation,
+			.bounds = node.bounds,
+			.layer = node.layer
+		});
+	}
+
+	if (skippedNodes > 0) {
+		spdlog::warn("{} render nodes use meshes that aren't loaded resources and were left out of the capture", skippedNodes);
+	}
+
+	for (Light* light : *graphics->GetLightSystem()->GetAllObjects()) {
+		if (!light->IsEnabled()) {
+			continue;
+		}
+
+		capture->lights.push_back(LightRecord{
+			.type = light->GetType(),
+			.color = light->GetColor(),
+			.range = light->GetRange(),
+			.spotlightAngle = light->GetSpotlightAngle(),
+			.intensity = light->GetIntensity(),
+			.linearAttenuation = light->GetLinearAttenuation(),
+			.quadraticAttenuation = light->GetQuadraticAttenuation(),
+			.shadowCasting = light->IsShadowCasting(),
+			.position = light->GlobalTransform().Position().Value(),
+			.rotation = light->GlobalTransform().Rotation().Value()
+		});
+	}
+
+	if (graphics->GetPostProcessing()) {
+		for (PostProcessEffect* effect : *graphics->GetPostProcessing()->GetAllObjects()) {
+			if (!effect->IsEnabled()) {
+				continue;
+			}
+
+			auto type = std::find_if(std::begin(EFFECT_TYPES), std::end(EFFECT_TYPES), [&](const EffectType& t) { return t.matches(effect); });
+
+			if (type == std::end(EFFECT_TYPES)) {
+				spdlog::warn("Post process effect {} can't be captured", typeid(*effect).name());
+				continue;
+			}
+
+			capture->effects.push_back(EffectRecord{ type->name, effect->GetSettings() });
+		}
+	}
+
+	if (Skybox* sky = Skybox::GetCurrentSkybox()) {
+		capture->skyMaterial = materialIndex(sky->GetSkyMaterial());
+	}
+
+	return capture;
+}
+
+bool FrameCapture::Save(const fs::path& path) const {
+	std::ofstream file(path, std::ios::binary);
+
+	if (!file.is_open()) {
+		spdlog::error("Failed to open {} for the frame capture", path.string());
+		return false;
+	}
+
+	Write(file, CAPTURE_MAGIC);
+	Write(file, CAPTURE_VERSION);
+
+	Write(file, this->resolution);
+	Write(file, this->renderScale);
+	Write(file, this->temporalUpsampling);
+	Write(file, this->camera);
+
+	Write(file, (uint32_t) this->meshes.size());
+
+	for (const std::string& mesh : this->meshes) {
+		WriteString(file, mesh);
+	}
+
+	Write(file, (uint32_t) this->materials.size());
+
+	for (const MaterialRecord& material : this->materials) {
+		WriteString(file, material.vertexShader);
+		WriteString(file, material.geometryShader);
+		WriteString(file, material.tessControlShader);
+		WriteString(file, material.tessEvaluationShader);
+		WriteString(file, material.pixelShader);
+		Write(file, material.ignoresDepthPrepass);
+		Write(file, material.castsShadows);
+
+		Write(file, (uint32_t) material.variables.size());
+
+		for (const VariableRecord& variable : material.variables) {
+			WriteString(file, variable.name);
+			Write(file, variable.type);
+			WriteArray(file, variable.value);
+			WriteString(file, variable.texturePath);
+			Write(file, variable.textureParams);
+			Write(file, variable.level);
+		}
+
+		Write(file, (uint32_t) material.uniformBuffers.size());
+
+		for (const UniformBufferRecord& buffer : material.uniformBuffers) {
+			WriteString(file, buffer.name);
+			WriteArray(file, buffer.data);
+		}
+	}
+
+	WriteArray(file, this->nodes);
+	WriteArray(file, this->lights);
+
+	Write(file, (uint32_t) this->effects.size());
+
+	for (const EffectRecord& effect : this->effects) {
+		WriteString(file, effect.type);
+		WriteArray(file, effect.settings);
+	}
+
+	Write(file, this->skyMaterial);
+
+	if (!file.good()) {
+		spdlog::error("Failed to write the frame capture to {}", path.string());
+		return false;
+	}
+
+	return true;
+}
+
+FrameCapture* FrameCapture::Load(const fs::path& path) {
+	std::ifstream file(path, std::ios::binary);
+
+	if (!file.is_open()) {
+		spdlog::error("Failed to open frame capture {}", path.string());
+		return nullptr;
+	}
+
+	uint32_t magic = 0;
+	uint32_t version = 0;
+
+	if (!Read(file, magic) || !Read(file, version) || magic != CAPTURE_MAGIC) {
+		spdlog::error("{} is not a frame capture", path.string());
+		return nullptr;
+	}
+
+	if (version != CAPTURE_VERSION) {
+		spdlog::error("Frame capture {} has version {}, expected {}", path.string(), version, CAPTURE_VERSION);
+		return nullptr;
+	}
+
+	FrameCapture* capture = new FrameCapture();
+
+	auto readMaterial = [&](MaterialRecord& material) {
+		uint32_t count;
+
+		bool valid = ReadString(file, material.vertexShader)
+			&& ReadString(file, material.geometryShader)
+			&& ReadString(file, material.tessControlShader)
+			&& ReadString(file, material.tessEvaluationShader)
+			&& ReadString(file, material.pixelShader)
+			&& Read(file, material.ignoresDepthPrepass)
+			&& Read(file, material.castsShadows)
+			&& ReadCount(file, count);
+
+		for (uint32_t i = 0; valid && i < count; i++) {
+			VariableRecord& variable = material.variables.emplace_back();
+
+			valid = ReadString(file, variable.name)
+				&& Read(file, variable.type)
+				&& ReadArray(file, variable.value)
+				&& ReadString(file, variable.texturePath)
+				&& Read(file, variable.textureParams)
+				&& Read(file, variable.level);
+		}
+
+		valid = valid && ReadCount(file, count);
+
+		for (uint32_t i = 0; valid && i < count; i++) {
+			UniformBufferRecord& buffer = material.uniformBuffers.emplace_back();
+
+			valid = ReadString(file, buffer.name) && ReadArray(file, buffer.data);
+		}
+
+		return valid;
+	};
+
+	uint32_t count;
+
+	bool valid = Read(file, capture->resolution)
+		&& Read(file, capture->renderScale)
+		&& Read(file, capture->temporalUpsampling)
+		&& Read(file, capture->camera)
+		&& ReadCount(file, count);
+
+	for (uint32_t i = 0; valid && i < count; i++) {
+		valid = ReadString(file, capture->meshes.emplace_back());
+	}
+
+	valid = valid && ReadCount(file, count);
+
+	for (uint32_t i = 0; valid && i < count; i++) {
+		valid = readMaterial(capture->materials.emplace_back());
+	}
+
+	valid = valid
+		&& ReadArray(file, capture->nodes)
+		&& ReadArray(file, capture->lights)
+		&& ReadCount(file, count);
+
+	for (uint32_t i = 0; valid && i < count; i++) {
+		EffectRecord& effect = capture->effects.emplace_back();
+
+		valid = ReadString(file, effect.type) && ReadArray(file, effect.settings);
+	}
+
+	valid = valid && Read(file, capture->skyMaterial);
+
+	for (const NodeRecord& node : capture->nodes) {
+		valid = valid && node.mesh < capture->meshes.size() && node.material < capture->materials.size();
+	}
+
+	valid = valid && capture->skyMaterial < (int) capture->materials.size();
+
+	if (!valid) {
+		spdlog::error("Frame capture {} is truncated or corrupt", path.string());
+
+		delete capture;
+		return nullptr;
+	}
+
+	return capture;
+}
+
+FrameReplay::FrameReplay(Scene* scene):
+SceneComponent(scene),
+draws(),
+materials(),
+programs() { }
+
+FrameReplay::~FrameReplay() {
+	for (Material* material : this->materials) {
+		delete material;
+	}
+
+	for (ShaderProgram* program : this->programs) {
+		delete program;
+	}
+}
+
+Material* FrameReplay::CreateMaterial(const FrameCapture::MaterialRecord& record, std::unordered_map<std::string, ShaderProgram*>& programCache) {
+	ResourceDatabase* resources = GetScene()->Resources();
+
+	std::string programKey = std::format(
+		"{}|{}|{}|{}|{}|{}|{}",
+		record.vertexShader, record.geometryShader, record.tessControlShader, record.tessEvaluationShader, record.pixelShader,
+		record.ignoresDepthPrepass, record.castsShadows
+	);
+
+	ShaderProgram* program = nullptr;
+	auto cached = programCache.find(programKey);
+
+	if (cached != programCache.end()) {
+		program = cached->second;
+	}
+	else {
+		ShaderBuilder builder = ShaderProgram::Build();
+
+		builder.WithVertexShader(resources->Get<VertexShader>(record.vertexShader));
+		builder.WithPixelShader(resources->Get<PixelShader>(record.pixelShader));
+
+		if (!record.geometryShader.empty()) {
+			builder.WithGeometryShader(resources->Get<GeometryShader>(record.geometryShader));
+		}
+
+		if (!record.tessControlShader.empty() && !record.tessEvaluationShader.empty()) {
+			builder.WithTessControlShader(resources->Get<TesselationControlShader>(record.tessControlShader));
+			builder.WithTessEvaluationShader(resources->Get<TesselationEvaluationShader>(record.tessEvaluationShader));
+		}
+
+		if (!builder.vertexShader || !builder.pixelShader) {
+			spdlog::error("Failed to load the shaders of captured program {}", programKey);
+			return nullptr;
+		}
+
+		program = builder.Link();
+		program->SetIgnoresDepthPrepass(record.ignoresDepthPrepass);
+		program->SetCastsShadows(record.castsShadows);
+
+		this->programs.push_back(program);
+		programCache[programKey] = program;
+	}
+
+	Material* material = new Material(program);
+
+	FrameCapture::RestoreMaterial(record, material, resources);
+
+	this->materials.push_back(material);
+
+	return material;
+}
+
+bool FrameReplay::Load(const FrameCapture* capture) {
+	Scene* scene = GetScene();
+
+	std::vector<Mesh*> meshes;
+
+	for (const std::string& path : capture->meshes) {
+		Mesh* mesh = scene->Resources()->Get<Mesh>(path);
+
+		if (!mesh) {
+			spdlog::error("Failed to load captured mesh {}", path);
+			return false;
+		}
+
+		meshes.push_back(mesh);
+	}
+
+	std::unordered_map<std::string, ShaderProgram*> programCache;
+	std::vector<Material*> captureMaterials;
+
+	for (const FrameCapture::MaterialRecord& record : capture->materials) {
+		captureMaterials.push_back(CreateMaterial(record, programCache));
+	}
+
+	for (const FrameCapture::NodeRecord& node : capture->nodes) {
+		if (node.subMesh >= meshes[node.mesh]->GetSubMeshCount() || !captureMaterials[node.material]) {
+			continue;
+		}
+
+		this->draws.push_back(Draw{
+			.mesh = meshes[node.mesh],
+			.subMesh = (int) node.subMesh,
+			.material = captureMaterials[node.material],
+			.instanceCount = node.instanceCount,
+			.transformation = node.transformation,
+			.bounds = node.bounds,
+			.layer = node.layer
+		});
+	}
+
+	SceneNode* cameraNode = scene->CreateNode("Replay Camera");
+	Camera* camera = nullptr;
+
+	if (capture->camera.type == Camera::CameraType::Perspective) {
+		camera = cameraNode->AddObject<Camera>(capture->camera.perspective);
+	}
+	else {
+		camera = cameraNode->AddObject<Camera>(capture->camera.ortho);
+	}
+
+	camera->SetLayerMask(LayerMask(capture->camera.layerMask));
+	camera->SetAsMainCamera();
+
+	cameraNode->GlobalTransform().Position() = capture->camera.position;
+	cameraNode->GlobalTransform().Rotation() = capture->camera.rotation;
+
+	for (const FrameCapture::EffectRecord& effectRecord : capture->effects) {
+		auto type = std::find_if(std::begin(EFFECT_TYPES), std::end(EFFECT_TYPES), [&](const EffectType& t) { return effectRecord.type == t.name; });
+
+		if (type == std::end(EFFECT_TYPES)) {
+			spdlog::warn("Unknown captured post process effect {}", effectRecord.type);
+			continue;
+		}
+
+		type->create(cameraNode)->SetSettings(effectRecord.settings);
+	}
+
+	for (const FrameCapture::LightRecord& lightRecord : capture->lights) {
+		SceneNode* lightNode = scene->CreateNode("Replay Light");
+		Light* light = lightNode->AddObject<Light>(Light::PointLight(lightRecord.color, lightRecord.range, lightRecord.intensity, lightRecord.linearAttenuation, lightRecord.quadraticAttenuation));
+
+		light->SetType(lightRecord.type);
+		light->SetSpotlightAngle(lightRecord.spotlightAngle);
+		light->SetShadowCasting(lightRecord.shadowCasting);
+
+		lightNode->GlobalTransform().Position() = lightRecord.position;
+		lightNode->GlobalTransform().Rotation() = lightRecord.rotation;
+	}
+
+	if (capture->skyMaterial >= 0 && captureMaterials[capture->skyMaterial]) {
+		scene->CreateNode("Replay Sky")->AddObject<Skybox>(captureMaterials[capture->skyMaterial]);
+	}
+
+	scene->GetGraphics()->SetTemporalUpsamplingEnabled(capture->temporalUpsampling);
+
+	DynamicResolution* dynamicResolution = scene->GetGraphics()->GetDynamicResolution();
+	dynamicResolution->SetEnabled(false);
+	dynamicResolution->SetScaleRange(capture->renderScale, capture->renderScale);
+
+	spdlog::info("Replaying {} draws, {} materials and {} lights", this->draws.size(), this->materials.size(), capture->lights.size());
+
+	return true;
+}
+
+unsigned int FrameReplay::GetDrawCount() const {
+	return this->draws.size();
+}
+
+void FrameReplay::OnPreRender() {
+	SceneGraphics* graphics = GetScene()->GetGraphics();
+
+	for (const Draw& draw : this->draws) {
+		graphics->DrawMeshInstanced(draw.mesh, draw.subMesh, draw.material, draw.transformation, draw.instanceCount, draw.bounds, draw.layer);
+	}
+}
\ No newline at end of file
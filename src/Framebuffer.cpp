@@ -1,5 +1,7 @@
 #include <Framebuffer.h>
 
+#include <MemoryTracker.h>
+
 void Framebuffer::SetTextureInternal(Framebuffer::FramebufferBinding& binding, Texture* texture, int level) {
 	if (texture != binding.texture) {
 		if (binding.texture && binding.owning) {
@@ -95,6 +97,8 @@ Texture* Framebuffer::CreateColorAttachment(bool hdr, bool cubemapped) {
 	this->colorAttachment.enabled = true;
 	this->dirty = true;
 
+	MemoryTracker::SetCategory(this->colorAttachment.texture, MemoryCategory::RenderTargets);
+
 	return this->colorAttachment.texture;
 }
 
@@ -116,6 +120,8 @@ Texture* Framebuffer::CreateDepthAttachment(bool withStencil, bool cubemapped) {
 	this->depthAttachment.enabled = true;
 	this->dirty = true;
 
+	MemoryTracker::SetCategory(this->depthAttachment.texture, MemoryCategory::RenderTargets);
+
 	return this->depthAttachment.texture;
 }
 
@@ -139,6 +145,8 @@ Texture* Framebuffer::CreateCustomAttachment(int index, const TextureParams& cre
 	this->customAttachments[index].enabled = true;
 	this->dirty = true;
 
+	MemoryTracker::SetCategory(this->customAttachments[index].texture, MemoryCategory::RenderTargets);
+
 	return this->customAttachments[index].texture;
 }
 
@@ -0,0 +1,327 @@
+#include <GPUProfiler.h>
+
+#include <fstream>
+#include <cstring>
+#include <algorithm>
+
+#include <spdlog/spdlog.h>
+#include <imgui.h>
+
+constexpr int GPU_PROFILER_QUERY_POOL_GROWTH = 32;
+constexpr int GPU_PROFILER_MAX_RECORDED_ZONES = 1 << 20;
+constexpr float GPU_PROFILER_AVERAGE_SMOOTHING = 0.05f;
+
+GPUProfiler::Scope::Scope(GPUProfiler* profiler, const char* name):
+profiler(profiler) {
+	if (this->profiler) {
+		this->profiler->BeginZone(name);
+	}
+}
+
+GPUProfiler::Scope::~Scope() {
+	if (this->profiler) {
+		this->profiler->EndZone();
+	}
+}
+
+GPUProfiler::GPUProfiler():
+queryIndex(0),
+frameIndex(0),
+inFrame(false),
+openZones(),
+enabled(true),
+timings(),
+previousTimings(),
+timingsFrameIndex(0),
+droppedFrames(0),
+historyOffset(0),
+recording(false),
+recordedZones() {
+	for (int i = 0; i < QueryLatency; i++) {
+		this->frames[i].usedQueries = 0;
+		this->frames[i].lastQuery = 0;
+		this->frames[i].frameIndex = 0;
+		this->frames[i].issued = false;
+	}
+
+	for (int i = 0; i < HistoryLength; i++) {
+		this->frameTimeHistory[i] = 0.0f;
+	}
+}
+
+GPUProfiler::~GPUProfiler() {
+	for (int i = 0; i < QueryLatency; i++) {
+		if (!this->frames[i].queries.empty()) {
+			glDeleteQueries((GLsizei) this->frames[i].queries.size(), this->frames[i].queries.data());
+		}
+	}
+}
+
+GLuint GPUProfiler::AcquireQuery(FrameQueries& frame) {
+	if (frame.usedQueries == (int) frame.queries.size()) {
+		frame.queries.resize(frame.queries.size() + GPU_PROFILER_QUERY_POOL_GROWTH);
+
+		glGenQueries(GPU_PROFILER_QUERY_POOL_GROWTH, frame.queries.data() + frame.usedQueries);
+	}
+
+	return frame.queries[frame.usedQueries++];
+}
+
+void GPUProfiler::Collect(FrameQueries& frame) {
+	if (!frame.issued) {
+		return;
+	}
+
+	frame.issued = false;
+
+	// Timestamps resolve in submission order, so the last one landing means the whole frame did
+	GLint available = 0;
+	glGetQueryObjectiv(frame.lastQuery, GL_QUERY_RESULT_AVAILABLE, &available);
+
+	if (!available) {
+		this->droppedFrames++;
+		return;
+	}
+
+	std::swap(this->timings, this->previousTimings);
+
+	const std::vector<ZoneTiming>& previous = this->previousTimings;
+
+	this->timings.clear();
+
+	for (int i = 0; i < (int) frame.zones.size(); i++) {
+		const PendingZone& zone = frame.zones[i];
+
+		GLuint64 start = 0;
+		GLuint64 end = 0;
+		glGetQueryObjectui64v(zone.startQuery, GL_QUERY_RESULT, &start);
+		glGetQueryObjectui64v(zone.endQuery, GL_QUERY_RESULT, &end);
+
+		float time = end > start ? (float) (end - start) / 1000000.0f : 0.0f;
+		float averageTime = time;
+
+		if (i < (int) previous.size() && previous[i].depth == zone.depth && std::strcmp(previous[i].name, zone.name) == 0) {
+			averageTime = previous[i].averageTime + (time - previous[i].averageTime) * GPU_PROFILER_AVERAGE_SMOOTHING;
+		}
+
+		this->timings.push_back(ZoneTiming{zone.name, zone.depth, time, averageTime});
+
+		if (this->recording) {
+			this->recordedZones.push_back(RecordedZone{frame.frameIndex, zone.name, zone.depth, time});
+		}
+	}
+
+	this->timingsFrameIndex = frame.frameIndex;
+
+	this->frameTimeHistory[this->historyOffset] = GetFrameTime();
+	this->historyOffset = (this->historyOffset + 1) % HistoryLength;
+
+	if (this->recording && (int) this->recordedZones.size() >= GPU_PROFILER_MAX_RECORDED_ZONES) {
+		spdlog::warn("GPU profiler recording reached {} zones, stopping", GPU_PROFILER_MAX_RECORDED_ZONES);
+
+		this->recording = false;
+	}
+}
+
+void GPUProfiler::BeginFrame() {
+	FrameQueries& frame = this->frames[this->queryIndex];
+
+	// The slot we are about to reuse holds the oldest frame, read it back without stalling
+	Collect(frame);
+
+	frame.usedQueries = 0;
+	frame.zones.clear();
+	frame.frameIndex = this->frameIndex;
+
+	this->inFrame = this->enabled;
+	this->openZones.clear();
+
+	BeginZone("Frame");
+}
+
+void GPUProfiler::EndFrame() {
+	while (!this->openZones.empty()) {
+		EndZone();
+	}
+
+	if (this->inFrame) {
+		FrameQueries& frame = this->frames[this->queryIndex];
+
+		frame.lastQuery = frame.zones.front().endQuery;
+		frame.issued = true;
+
+		this->queryIndex = (this->queryIndex + 1) % QueryLatency;
+	}
+
+	this->inFrame = false;
+	this->frameIndex++;
+}
+
+void GPUProfiler::BeginZone(const char* name) {
+	glPushDebugGroup(GL_DEBUG_SOURCE_APPLICATION, 0, -1, name);
+
+	if (!this->inFrame) {
+		this->openZones.push_back(-1);
+		return;
+	}
+
+	FrameQueries& frame = this->frames[this->queryIndex];
+
+	PendingZone zone;
+	zone.name = name;
+	zone.depth = (int) this->openZones.size();
+	zone.startQuery = AcquireQuery(frame);
+	zone.endQuery = AcquireQuery(frame);
+
+	glQueryCounter(zone.startQuery, GL_TIMESTAMP);
+
+	frame.zones.push_back(zone);
+
+	this->openZones.push_back((int) frame.zones.size() - 1);
+}
+
+void GPUProfiler::EndZone() {
+	if (this->openZones.empty()) {
+		spdlog::error("GPU profiler zone ended without a matching begin");
+		return;
+	}
+
+	int zoneIndex = this->openZones.back();
+	this->openZones.pop_back();
+
+	if (zoneIndex >= 0 && this->inFrame) {
+		glQueryCounter(this->frames[this->queryIndex].zones[zoneIndex].endQuery, GL_TIMESTAMP);
+	}
+
+	glPopDebugGroup();
+}
+
+bool GPUProfiler::IsEnabled() const {
+	return this->enabled;
+}
+
+void GPUProfiler::SetEnabled(bool enabled) {
+	this->enabled = enabled;
+}
+
+const std::vector<GPUProfiler::ZoneTiming>& GPUProfiler::GetTimings() const {
+	return this->timings;
+}
+
+float GPUProfiler::GetFrameTime() const {
+	if (this->timings.empty()) {
+		return 0.0f;
+	}
+
+	return this->timings.front().time;
+}
+
+unsigned int GPUProfiler::GetTimingsFrame() const {
+	return this->timingsFrameIndex;
+}
+
+bool GPUProfiler::IsRecording() const {
+	return this->recording;
+}
+
+void GPUProfiler::StartRecording() {
+	this->recordedZones.clear();
+	this->recording = true;
+}
+
+void GPUProfiler::StopRecording() {
+	this->recording = false;
+}
+
+bool GPUProfiler::ExportCSV(const fs::path& path) const {
+	std::ofstream file(path);
+
+	if (!file.is_open()) {
+		spdlog::error("Failed to open {} for GPU profiler export", path.string());
+		return false;
+	}
+
+	file << "frame,zone,depth,ms\n";
+
+	const std::vector<RecordedZone>* rows = &this->recordedZones;
+	std::vector<RecordedZone> lastFrame;
+
+	// Without a recording the most recent resolved frame is exported on its own
+	if (rows->empty()) {
+		for (const ZoneTiming& timing : this->timings) {
+			lastFrame.push_back(RecordedZone{this->timingsFrameIndex, timing.name, timing.depth, timing.time});
+		}
+
+		rows = &lastFrame;
+	}
+
+	for (const RecordedZone& zone : *rows) {
+		file << zone.frameIndex << ",\"" << zone.name << "\"," << zone.depth << "," << zone.time << "\n";
+	}
+
+	spdlog::info("Exported {} GPU profiler zones to {}", rows->size(), path.string());
+
+	return true;
+}
+
+void GPUProfiler::DrawImGui() {
+	if (ImGui::TreeNode("GPU Profiler")) {
+		ImGui::Checkbox("Enabled", &this->enabled);
+
+		ImGui::Text("GPU frame: %.3f ms (frame %u, %i dropped)", GetFrameTime(), this->timingsFrameIndex, this->droppedFrames);
+
+		float maxTime = *std::max_element(this->frameTimeHistory, this->frameTimeHistory + HistoryLength);
+
+		ImGui::PlotLines("##GPUFrameTime", this->frameTimeHistory, HistoryLength, this->historyOffset, "GPU frame (ms)", 0.0f, std::max(maxTime, 1.0f) * 1.1f, ImVec2(0, 60));
+
+		if (this->recording) {
+			if (ImGui::Button("Stop recording")) {
+				StopRecording();
+			}
+		}
+		else if (ImGui::Button("Start recording")) {
+			StartRecording();
+		}
+
+		ImGui::SameLine();
+
+		if (ImGui::Button("Export CSV")) {
+			ExportCSV("gpu_profile.csv");
+		}
+
+		ImGui::SameLine();
+		ImGui::Text("%i zones recorded", (int) this->recordedZones.size());
+
+		if (ImGui::BeginTable("GPU Zones", 3, ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV | ImGuiTableFlags_SizingStretchProp)) {
+			ImGui::TableSetupColumn("Zone");
+			ImGui::TableSetupColumn("ms");
+			ImGui::TableSetupColumn("avg ms");
+			ImGui::TableHeadersRow();
+
+			for (const ZoneTiming& timing : this->timings) {
+				ImGui::TableNextRow();
+
+				ImGui::TableSetColumnIndex(0);
+
+				if (timing.depth > 0) {
+					ImGui::Indent(timing.depth * ImGui::GetStyle().IndentSpacing * 0.5f);
+					ImGui::TextUnformatted(timing.name);
+					ImGui::Unindent(timing.depth * ImGui::GetStyle().IndentSpacing * 0.5f);
+				}
+				else {
+					ImGui::TextUnformatted(timing.name);
+				}
+
+				ImGui::TableSetColumnIndex(1);
+				ImGui::Text("%.3f", timing.time);
+
+				ImGui::TableSetColumnIndex(2);
+				ImGui::Text("%.3f", timing.averageTime);
+			}
+
+			ImGui::EndTable();
+		}
+
+		ImGui::TreePop();
+	}
+}
\ No newline at end of file
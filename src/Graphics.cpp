@@ -2,7 +2,6 @@
 
 #include <glad/glad.h>
 #include <spdlog/spdlog.h>
-#include <glm/gtc/matrix_access.hpp>
 #include <imgui.h>
 
 #include <MeshRenderer.h>
@@ -15,90 +14,55 @@
 #include <PostProcessingSystem.h>
 #include <ReflectionProbeSystem.h>
 #include <Frustum.h>
+#include <GraphicsBackend.h>
 #include <Viewport.h>
+#include <RenderGraph.h>
+#include <GPUProfiler.h>
+#include <Profiler.h>
+#include <RenderStats.h>
+#include <DynamicResolution.h>
+#include <TemporalUpsampler.h>
+#include <MeshletCuller.h>
+#include <FrameCapture.h>
 
 #include "../res/shaders/shared/shared.h"
 #include "../res/shaders/shared/uniforms.h"
 
-#include <GLFW/glfw3.h>
+#include <TimeSystem.h>
 
 #define LIGHT_GRID_SIZE 16
-
-Frustum ComputeFrustum(const glm::mat4& projectionMatrix) {
-	Frustum result;
-
-	const glm::vec4 planeLeftParams = glm::normalize(-(glm::row(projectionMatrix, 3) + glm::row(projectionMatrix, 0)));
-	const glm::vec4 planeRightParams = glm::normalize(-(glm::row(projectionMatrix, 3) - glm::row(projectionMatrix, 0)));
-	const glm::vec4 planeBottomParams = glm::normalize(-(glm::row(projectionMatrix, 3) + glm::row(projectionMatrix, 1)));
-	const glm::vec4 planeTopParams = glm::normalize(-(glm::row(projectionMatrix, 3) - glm::row(projectionMatrix, 1)));
-	const glm::vec4 planeNearParams = glm::normalize(-(glm::row(projectionMatrix, 3) + glm::row(projectionMatrix, 2)));
-	const glm::vec4 planeFarParams = glm::normalize(-(glm::row(projectionMatrix, 3) - glm::row(projectionMatrix, 2)));
-
-	result.left = Plane(glm::vec3(planeLeftParams), planeLeftParams.w);
-	result.right = Plane(glm::vec3(planeRightParams), planeRightParams.w);
-	result.bottom = Plane(glm::vec3(planeBottomParams), planeBottomParams.w);
-	result.top = Plane(glm::vec3(planeTopParams), planeTopParams.w);
-	result.nearPlane = Plane(glm::vec3(planeNearParams), planeNearParams.w);
-	result.farPlane = Plane(glm::vec3(planeFarParams), planeFarParams.w);
-	
-	return result;
-}
-
-bool TestPlane(const Plane& plane, const BoundingBox& bounds) {
-	const glm::vec3 n = plane.normal;
-	const float d = plane.distance;
-
-	const glm::vec3 c = bounds.center;
-	const glm::vec3 h = bounds.GetExtents();
-
-	const float e = h.x * glm::abs(
-		glm::dot(n, glm::vec3(bounds.axisU))
-	) + h.y * glm::abs(
-		glm::dot(n, glm::vec3(bounds.axisV))
-	) + h.z * glm::abs(
-		glm::dot(n, glm::vec3(bounds.axisW))
-	);
-
-	const float s = glm::dot(c, n) + d;
-
-	return s - e <= 0;
-}
-
-bool TestFrustum(const Frustum& frustum, const BoundingBox& bounds) {
-	return (
-		TestPlane(frustum.left, bounds)
-		&&
-		TestPlane(frustum.right, bounds)
-		&&
-		TestPlane(frustum.bottom, bounds)
-		&&
-		TestPlane(frustum.top, bounds)
-		&&
-		TestPlane(frustum.farPlane, bounds)
-	);
-}
+// A coarser level of detail than last frame's is only picked once its error is this much below the limit
+#define LOD_HYSTERESIS 0.25f
+// Frames an owner can go unrendered before its previous transform and level of detail are forgotten
+#define RENDER_HISTORY_FRAMES 120
+// Below this many meshlets the cull dispatch costs more than the triangles it saves
+#define MESHLET_CULLING_MIN_COUNT 16
 
 RenderParams::RenderParams(RenderPassType pass, glm::vec4 viewport, bool clearDepth, LayerMask layers):
 pass(pass),
 viewport(viewport),
 clearDepth(clearDepth),
-layers(layers) { }
+layers(layers),
+lodBias(1.0f),
+recordLODs(false) { }
 
-SceneGraphics::RenderNode::RenderNode(const Mesh::SubMesh* mesh, const Material* material, unsigned int instanceCount, const glm::mat4& transformation, uint8_t layer):
+SceneGraphics::RenderNode::RenderNode(const Mesh::SubMesh* mesh, const Material* material, unsigned int instanceCount, const glm::mat4& transformation, uint8_t layer, const void* owner):
 mesh(mesh),
 material(material),
 instanceCount(instanceCount),
 transformation(transformation),
 bounds(mesh->GetBounds()),
-layer(layer) { }
+layer(layer),
+owner(owner) { }
 
-SceneGraphics::RenderNode::RenderNode(const Mesh::SubMesh* mesh, const Material* material, unsigned int instanceCount, const glm::mat4& transformation, const BoundingBox& bounds, uint8_t layer):
+SceneGraphics::RenderNode::RenderNode(const Mesh::SubMesh* mesh, const Material* material, unsigned int instanceCount, const glm::mat4& transformation, const BoundingBox& bounds, uint8_t layer, const void* owner):
 mesh(mesh),
 material(material),
 instanceCount(instanceCount),
 transformation(transformation),
 bounds(bounds),
-layer(layer) { }
+layer(layer),
+owner(owner) { }
 
 SceneGraphics::RenderNode::RenderNode(const Mesh::SubMesh* mesh, const Material* material, bool ignoreDepth, const glm::mat4& transformation, uint8_t layer):
 mesh(mesh),
@@ -106,7 +70,8 @@ material(material),
 ignoreDepth(ignoreDepth),
 transformation(transformation),
 bounds(mesh->GetBounds()),
-layer(layer) { }
+layer(layer),
+owner(nullptr) { }
 
 SceneGraphics::RenderNode::RenderNode(const Mesh::SubMesh* mesh, const Material* material, bool ignoreDepth, const glm::mat4& transformation, const BoundingBox& bounds, uint8_t layer):
 mesh(mesh),
@@ -114,7 +79,8 @@ material(material),
 ignoreDepth(ignoreDepth),
 transformation(transformation),
 bounds(bounds),
-layer(layer) { }
+layer(layer),
+owner(nullptr) { }
 
 SceneGraphics::SceneGraphics(Scene* scene):
 GameObjectSystem(scene),
@@ -123,37 +89,63 @@ gizmoRenders(),
 globalUniformsBuffer(0),
 objectUniformsBuffer(0),
 mainCamera(nullptr),
-mainViewport(new Viewport()) {
-	glGenBuffers(1, &this->globalUniformsBuffer);
-	glBindBuffer(GL_UNIFORM_BUFFER, this->globalUniformsBuffer);
-	glBufferData(GL_UNIFORM_BUFFER, sizeof(ShaderGlobalUniforms), nullptr, GL_DYNAMIC_DRAW);
-	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+capturePath(),
+mainViewport(new Viewport()),
+outputTarget(nullptr),
+outputResolution(0),
+gpuProfiler(new GPUProfiler()),
+renderGraph(new RenderGraph(gpuProfiler)),
+dynamicResolution(new DynamicResolution()),
+temporalUpsampler(nullptr),
+temporalUpsampling(false),
+meshletCuller(nullptr),
+meshletCulling(false),
+previousTransforms(),
+previousLODs(),
+historyFrame(0),
+lodErrorPixels(1.0f),
+shadowLODBias(4.0f),
+probeLODBias(4.0f) {
+	GraphicsBackend* gfx = GraphicsBackend::Current();
+
+	this->globalUniformsBuffer = gfx->CreateBuffer();
+	gfx->BufferData(GL_UNIFORM_BUFFER, this->globalUniformsBuffer, sizeof(ShaderGlobalUniforms), nullptr, GL_DYNAMIC_DRAW);
 	
-	glGenBuffers(1, &this->objectUniformsBuffer);
-	glBindBuffer(GL_UNIFORM_BUFFER, this->objectUniformsBuffer);
-	glBufferData(GL_UNIFORM_BUFFER, sizeof(ShaderObjectUniforms), nullptr, GL_DYNAMIC_DRAW);
-	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	this->objectUniformsBuffer = gfx->CreateBuffer();
+	gfx->BufferData(GL_UNIFORM_BUFFER, this->objectUniformsBuffer, sizeof(ShaderObjectUniforms), nullptr, GL_DYNAMIC_DRAW);
 
 	this->lightSystem = GetScene()->AddComponent<LightSystem>();
 	this->postProcessing = GetScene()->AddComponent<PostProcessingSystem>();
 	this->envMapping = GetScene()->AddComponent<ReflectionProbeSystem>();
 
+	this->temporalUpsampler = new TemporalUpsampler(GetScene()->Resources());
+	this->meshletCuller = new MeshletCuller(GetScene()->Resources());
+
 	this->mainViewport->GetFramebuffer()->CreateColorAttachment(true, false);
 	this->mainViewport->GetFramebuffer()->CreateDepthAttachment(false, false);
 }
 
 glm::vec2 SceneGraphics::GetScreenResolution() const {
+	return this->outputResolution;
+}
+
+glm::vec2 SceneGraphics::GetRenderResolution() const {
 	return this->mainViewport->GetSize();
 }
 
 void SceneGraphics::UpdateScreenResolution(glm::vec2 newResolution) {
-	if (this->mainViewport->GetSize() != glm::uvec2(newResolution)) {
+	bool outputChanged = this->outputResolution != glm::uvec2(newResolution);
+
+	if (outputChanged) {
+		this->outputResolution = glm::uvec2(newResolution);
+	}
 
-		this->mainViewport->SetSize(newResolution);
+	glm::uvec2 renderResolution = this->dynamicResolution->GetRenderResolution(this->outputResolution);
 
-		if (GetPostProcessing()) {
-			GetPostProcessing()->UpdateBufferResolution(newResolution);
-		}
+	if (outputChanged || this->mainViewport->GetSize() != renderResolution) {
+		this->mainViewport->SetSize(renderResolution);
+
+		this->temporalUpsampler->Resize(renderResolution, this->outputResolution, GetMainFramebuffer()->GetDepthTexture());
 	}
 }
 
@@ -169,6 +161,38 @@ ReflectionProbeSystem* SceneGraphics::GetEnvMapping() {
 	return this->envMapping;
 }
 
+RenderGraph* SceneGraphics::GetRenderGraph() const {
+	return this->renderGraph;
+}
+
+GPUProfiler* SceneGraphics::GetGPUProfiler() const {
+	return this->gpuProfiler;
+}
+
+DynamicResolution* SceneGraphics::GetDynamicResolution() const {
+	return this->dynamicResolution;
+}
+
+TemporalUpsampler* SceneGraphics::GetTemporalUpsampler() const {
+	return this->temporalUpsampler;
+}
+
+bool SceneGraphics::IsTemporalUpsamplingEnabled() const {
+	return this->temporalUpsampling;
+}
+
+void SceneGraphics::SetTemporalUpsamplingEnabled(bool enabled) {
+	if (enabled != this->temporalUpsampling) {
+		this->temporalUpsampler->InvalidateHistory();
+	}
+
+	this->temporalUpsampling = enabled;
+}
+
+bool SceneGraphics::UsesUpsampling() const {
+	return this->temporalUpsampling || this->mainViewport->GetSize() != this->outputResolution;
+}
+
 Viewport* SceneGraphics::GetMainViewport() const {
 	return this->mainViewport;
 }
@@ -177,6 +201,14 @@ Framebuffer* SceneGraphics::GetMainFramebuffer() const {
 	return this->mainViewport->GetFramebuffer();
 }
 
+Viewport* SceneGraphics::GetOutputTarget() const {
+	return this->outputTarget;
+}
+
+void SceneGraphics::SetOutputTarget(Viewport* target) {
+	this->outputTarget = target;
+}
+
 Camera* SceneGraphics::GetMainCamera() const {
 	return this->mainCamera;
 }
@@ -185,10 +217,112 @@ void SceneGraphics::SetMainCamera(Camera* camera) {
 	this->mainCamera = camera;
 }
 
+void SceneGraphics::CaptureFrame(const fs::path& path) {
+	this->capturePath = path;
+}
+
+void SceneGraphics::SetLODErrorPixels(float pixels) {
+	this->lodErrorPixels = pixels;
+}
+
+float SceneGraphics::GetLODErrorPixels() const {
+	return this->lodErrorPixels;
+}
+
+void SceneGraphics::SetShadowLODBias(float bias) {
+	this->shadowLODBias = bias;
+}
+
+float SceneGraphics::GetShadowLODBias() const {
+	return this->shadowLODBias;
+}
+
+void SceneGraphics::SetProbeLODBias(float bias) {
+	this->probeLODBias = bias;
+}
+
+float SceneGraphics::GetProbeLODBias() const {
+	return this->probeLODBias;
+}
+
+void SceneGraphics::SetMeshletCulling(bool enabled) {
+	this->meshletCulling = enabled;
+}
+
+bool SceneGraphics::GetMeshletCulling() const {
+	return this->meshletCulling;
+}
+
+SceneGraphics::LODView SceneGraphics::GetLODView(const glm::mat4& projection, const glm::mat4& view, float viewportHeight, float bias) const {
+	return {
+		projection * view,
+		std::abs(projection[1][1]) * 0.5f * viewportHeight,
+		projection[3][3] == 0.0f,
+		this->lodErrorPixels * bias
+	};
+}
+
+unsigned int SceneGraphics::SelectLOD(const RenderNode& node, const BoundingBox& worldBounds, const LODView& view) const {
+	unsigned int levels = node.mesh->GetLODCount();
+
+	if (levels == 1 || view.errorPixels <= 0.0f) {
+		return 0;
+	}
+
+	// Errors are in model units, the largest scale of the transformation brings them to world units
+	glm::mat3 model(node.transformation);
+	float pixelsPerError = std::max({ glm::length(model[0]), glm::length(model[1]), glm::length(model[2]) }) * view.pixelsPerUnit;
+
+	if (view.perspective) {
+		// From the nearest the bounds get to the camera, so large meshes keep their detail where they are close
+		float radius = glm::length(glm::vec3(
+			glm::length(glm::vec3(worldBounds.axisU)) * worldBounds.axisU.w,
+			glm::length(glm::vec3(worldBounds.axisV)) * worldBounds.axisV.w,
+			glm::length(glm::vec3(worldBounds.axisW)) * worldBounds.axisW.w
+		));
+		float depth = (view.viewProjection * glm::vec4(worldBounds.center, 1.0f)).w - radius;
+
+		if (depth <= 0.0f) {
+			return 0;
+		}
+
+		pixelsPerError /= depth;
+	}
+
+	auto fits = [&](unsigned int level, float margin) -> bool {
+		return node.mesh->GetLOD(level).error * pixelsPerError <= view.errorPixels * margin;
+	};
+
+	unsigned int level = 0;
+	float margin = 1.0f;
+
+	if (node.owner) {
+		auto previous = this->previousLODs.find({ node.owner, node.mesh });
+
+		if (previous != this->previousLODs.end()) {
+			level = std::min(previous->second.level, levels - 1);
+			margin = 1.0f - LOD_HYSTERESIS;
+		}
+	}
+
+	while (level > 0 && !fits(level, 1.0f)) {
+		level--;
+	}
+
+	while (level + 1 < levels && fits(level + 1, margin)) {
+		level++;
+	}
+
+	return level;
+}
+
 void SceneGraphics::RenderObjects(const ShaderGlobalUniforms& globalUniforms, RenderParams params) {
+	GraphicsBackend* gfx = GraphicsBackend::Current();
+
 	ShaderObjectUniforms objectUniforms;
 
 	Frustum viewFrustum = ComputeFrustum(globalUniforms.Global_VPMatrix);
+	LODView lodView = GetLODView(globalUniforms.Global_ProjectionMatrix, globalUniforms.Global_ViewMatrix, params.viewport.w, params.lodBias);
 
 	bool drawsGizmos = ((int) params.pass & (int) RenderPassType::Gizmos) != 0;
 
@@ -196,13 +330,16 @@ void SceneGraphics::RenderObjects(const ShaderGlobalUniforms& globalUniforms, Re
 
 	for (const RenderNode& node : renders) {
 		if (!params.layers.Test(node.layer)) {
+			RenderStats::Add(RenderCounter::LayerCulled);
 			continue;
 		}
 
 		const Mesh::SubMesh* mesh = node.mesh;
 		const Material* mat = node.material;
+		BoundingBox worldBounds = node.bounds.Transform(node.transformation);
 
-		if (!TestFrustum(viewFrustum, node.bounds.Transform(node.transformation))) {
+		if (!TestFrustum(viewFrustum, worldBounds)) {
+			RenderStats::Add(RenderCounter::FrustumCulled);
 			continue;
 		}
 
@@ -222,25 +359,45 @@ void SceneGraphics::RenderObjects(const ShaderGlobalUniforms& globalUniforms, Re
 		objectUniforms.Object_ModelMatrix = node.transformation;
 		objectUniforms.Object_MVPMatrix = globalUniforms.Global_VPMatrix * objectUniforms.Object_ModelMatrix;
 		objectUniforms.Object_NormalModelMatrix = glm::transpose(glm::inverse(glm::mat3(objectUniforms.Object_ModelMatrix)));
+		objectUniforms.Object_PrevModelMatrix = objectUniforms.Object_ModelMatrix;
 
-		glBindBuffer(GL_UNIFORM_BUFFER, objectUniformsBuffer);
-		glBufferData(GL_UNIFORM_BUFFER, sizeof(objectUniforms), &objectUniforms, GL_STREAM_DRAW);
-		glBindBuffer(GL_UNIFORM_BUFFER, 0);
+		gfx->BufferData(GL_UNIFORM_BUFFER, this->objectUniformsBuffer, sizeof(objectUniforms), &objectUniforms, GL_STREAM_DRAW);
+
+		RenderStats::Add(RenderCounter::UniformBytesUploaded, sizeof(objectUniforms));
+
+		bool instanced = !drawsGizmos && node.instanceCount > 0;
+		unsigned int lodLevel = drawsGizmos ? 0 : SelectLOD(node, worldBounds, lodView);
+
+		if (params.recordLODs && node.owner && mesh->GetLODCount() > 1) {
+			this->previousLODs[{ node.owner, mesh }] = { lodLevel, this->historyFrame };
+		}
+
+		bool culledMeshlets = this->meshletCulling && !drawsGizmos && !instanced && lodLevel == 0 && !mat->GetShader()->UsesPatches()
+			&& mesh->GetMeshletCount() >= MESHLET_CULLING_MIN_COUNT;
+		uint64_t meshletDraws = 0;
+
+		// The cull dispatch swaps the program, so it has to come before the material
+		if (culledMeshlets) {
+			meshletDraws = this->meshletCuller->Cull(mesh, node.transformation, globalUniforms.Global_ViewMatrix, globalUniforms.Global_ProjectionMatrix);
+		}
 		
 		mat->Bind();
 
 		if (params.pass == RenderPassType::Color) {
-			int shadowmaskUniformLocation = glGetUniformLocation(mat->GetShader()->handle, "Builtin_ShadowMask");
+			int shadowmaskUniformLocation = gfx->GetUniformLocation(mat->GetShader()->handle, "Builtin_ShadowMask");
 
 			if (shadowmaskUniformLocation >= 0) {
-				glActiveTexture(GL_TEXTURE31);
-				glBindTexture(GL_TEXTURE_2D, GetLightSystem()->shadowAtlasFramebuffer->GetDepthTexture()->GetHandle());
-				glUniform1i(shadowmaskUniformLocation, 31);
+				int unit = 31;
+
+				gfx->BindTexture(unit, GL_TEXTURE_2D, GetLightSystem()->shadowAtlasFramebuffer->GetDepthTexture()->GetHandle());
+				gfx->SetUniform(shadowmaskUniformLocation, UniformSpec::UniformType::Sampler2D, &unit);
+
+				RenderStats::Add(RenderCounter::TextureBinds);
 			}
 
-			int irradianceMapUniformLocation = glGetUniformLocation(mat->GetShader()->handle, "Builtin_EnvIrradianceMap");
-			int prefilterMapUniformLocation = glGetUniformLocation(mat->GetShader()->handle, "Builtin_EnvPrefilterMap");
-			int brdfConvolutionMapUniformLocation = glGetUniformLocation(mat->GetShader()->handle, "Builtin_BRDFConvolutionMap");
+			int irradianceMapUniformLocation = gfx->GetUniformLocation(mat->GetShader()->handle, "Builtin_EnvIrradianceMap");
+			int prefilterMapUniformLocation = gfx->GetUniformLocation(mat->GetShader()->handle, "Builtin_EnvPrefilterMap");
+			int brdfConvolutionMapUniformLocation = gfx->GetUniformLocation(mat->GetShader()->handle, "Builtin_BRDFConvolutionMap");
 
 			ReflectionProbe* closestProbe = nullptr;
 
@@ -250,67 +407,163 @@ void SceneGraphics::RenderObjects(const ShaderGlobalUniforms& globalUniforms, Re
 
 			if (closestProbe) {
 				if (irradianceMapUniformLocation >= 0) {
-					glActiveTexture(GL_TEXTURE30);
-					glBindTexture(GL_TEXTURE_CUBE_MAP, closestProbe->GetIrradianceMap()->GetHandle());
-					glUniform1i(irradianceMapUniformLocation, 30);
+					int unit = 30;
+
+					gfx->BindTexture(unit, GL_TEXTURE_CUBE_MAP, closestProbe->GetIrradianceMap()->GetHandle());
+					gfx->SetUniform(irradianceMapUniformLocation, UniformSpec::UniformType::Cubemap, &unit);
+					RenderStats::Add(RenderCounter::TextureBinds);
 				}
 				if (prefilterMapUniformLocation >= 0) {
-					glActiveTexture(GL_TEXTURE29);
-					glBindTexture(GL_TEXTURE_CUBE_MAP, closestProbe->GetPrefilterMap()->GetHandle());
-					glUniform1i(prefilterMapUniformLocation, 29);
+					int unit = 29;
+
+					gfx->BindTexture(unit, GL_TEXTURE_CUBE_MAP, closestProbe->GetPrefilterMap()->GetHandle());
+					gfx->SetUniform(prefilterMapUniformLocation, UniformSpec::UniformType::Cubemap, &unit);
+					RenderStats::Add(RenderCounter::TextureBinds);
 				}
 				if (brdfConvolutionMapUniformLocation >= 0) {
-					glActiveTexture(GL_TEXTURE28);
-					glBindTexture(GL_TEXTURE_2D, envMapping->BRDFConvolutionMap()->GetHandle());
-					glUniform1i(brdfConvolutionMapUniformLocation, 28);
+					int unit = 28;
+
+					gfx->BindTexture(unit, GL_TEXTURE_2D, envMapping->BRDFConvolutionMap()->GetHandle());
+					gfx->SetUniform(brdfConvolutionMapUniformLocation, UniformSpec::UniformType::Sampler2D, &unit);
+					RenderStats::Add(RenderCounter::TextureBinds);
 				}
 			}
 		}
 		
-		glBindVertexArray(mesh->GetVertexArrayHandle());
+		gfx->BindVertexArray(mesh->GetVertexArrayHandle());
+
+		RenderStats::Add(RenderCounter::VertexArrayBinds);
 
 		if (drawsGizmos && node.ignoreDepth) {
-			glDisable(GL_DEPTH_TEST);
+			gfx->SetEnabled(GL_DEPTH_TEST, false);
+		}
+
+		RenderStats::Add(RenderCounter::DrawCalls);
+
+		if (instanced) {
+			RenderStats::Add(RenderCounter::InstancedDrawCalls);
+		}
+
+		Mesh::SubMesh::LOD lod = mesh->GetLOD(lodLevel);
+
+		if (mesh->GetType() == Mesh::MeshType::Triangles) {
+			RenderStats::Add(RenderCounter::Triangles, (uint64_t) lod.indexCount / 3 * (instanced ? node.instanceCount : 1));
 		}
 
 		if (mat->GetShader()->UsesPatches()) {
-			glPatchParameteri(GL_PATCH_VERTICES, (int) mesh->GetType());
+			gfx->SetPatchVertices((int) mesh->GetType());
+		}
 
-			if (drawsGizmos || node.instanceCount <= 0) {
-				glDrawElements(GL_PATCHES, mesh->GetVertexCount(), GL_UNSIGNED_INT, nullptr);
-			}
-			else {
-				glDrawElementsInstanced(GL_PATCHES, mesh->GetVertexCount(), GL_UNSIGNED_INT, nullptr, node.instanceCount);
-			}
+		if (culledMeshlets) {
+			this->meshletCuller->Draw(mesh, meshletDraws);
+
+			RenderStats::Add(RenderCounter::MeshletDraws);
 		}
 		else {
-			if (drawsGizmos || node.instanceCount <= 0) {
-				glDrawElements(mesh->GetDrawMode(), mesh->GetVertexCount(), GL_UNSIGNED_INT, nullptr);
-			}
-			else {
-				glDrawElementsInstanced(mesh->GetDrawMode(), mesh->GetVertexCount(), GL_UNSIGNED_INT, nullptr, node.instanceCount);
-			}
+			gfx->DrawElements(mat->GetShader()->UsesPatches() ? GL_PATCHES : mesh->GetDrawMode(), lod.indexCount, mesh->GetIndexType(), (uint64_t) lod.firstIndex * mesh->GetIndexSize(), mesh->GetBaseVertex(), instanced ? node.instanceCount : 0);
 		}
 
 		if (drawsGizmos && node.ignoreDepth) {
-			glEnable(GL_DEPTH_TEST);
+			gfx->SetEnabled(GL_DEPTH_TEST, true);
+		}
+
+		gfx->BindVertexArray(0);
+	}
+}
+
+void SceneGraphics::RenderMotionVectors(const ShaderGlobalUniforms& globalUniforms, const RenderParams& params) {
+	GraphicsBackend* gfx = GraphicsBackend::Current();
+
+	ShaderObjectUniforms objectUniforms;
+
+	Frustum viewFrustum = ComputeFrustum(globalUniforms.Global_VPMatrix);
+	LODView lodView = GetLODView(globalUniforms.Global_ProjectionMatrix, globalUniforms.Global_ViewMatrix, params.viewport.w, params.lodBias);
+
+	gfx->BindFramebuffer(this->temporalUpsampler->GetMotionFramebuffer()->GetHandle());
+
+	gfx->ClearColor(0, 0, 0, 0);
+	gfx->Clear(GL_COLOR_BUFFER_BIT);
+
+	gfx->SetDepthMask(false);
+	gfx->SetDepthFunc(GL_LEQUAL);
+	gfx->SetCullFace(GL_BACK);
+
+	gfx->UseProgram(this->temporalUpsampler->GetMotionVectorShader()->GetHandle());
+
+	RenderStats::Add(RenderCounter::ProgramBinds);
+
+	for (const RenderNode& node : this->currentRenders) {
+		if (!params.layers.Test(node.layer) || !node.material) {
+			RenderStats::Add(RenderCounter::LayerCulled);
+			continue;
+		}
+
+		const ShaderProgram* shader = node.material->GetShader();
+
+		// Tessellated, instanced and depth-less geometry is left to the camera-only reprojection
+		if (shader->UsesPatches() || shader->IgnoresDepthPrepass() || node.instanceCount > 0) {
+			continue;
+		}
+
+		BoundingBox worldBounds = node.bounds.Transform(node.transformation);
+
+		if (!TestFrustum(viewFrustum, worldBounds)) {
+			RenderStats::Add(RenderCounter::FrustumCulled);
+			continue;
 		}
 
-		glBindVertexArray(0);
+		objectUniforms.Object_ModelMatrix = node.transformation;
+		objectUniforms.Object_MVPMatrix = globalUniforms.Global_VPMatrix * objectUniforms.Object_ModelMatrix;
+		objectUniforms.Object_NormalModelMatrix = glm::transpose(glm::inverse(glm::mat3(objectUniforms.Object_ModelMatrix)));
+		objectUniforms.Object_PrevModelMatrix = node.transformation;
+
+		if (this->temporalUpsampling && node.owner) {
+			auto previousTransform = this->previousTransforms.find(node.owner);
+
+			// Owners that were not rendered last frame have no motion to report
+			if (previousTransform != this->previousTransforms.end() && previousTransform->second.frame + 1 == this->historyFrame) {
+				objectUniforms.Object_PrevModelMatrix = previousTransform->second.transformation;
+			}
+		}
+
+		gfx->BufferData(GL_UNIFORM_BUFFER, this->objectUniformsBuffer, sizeof(objectUniforms), &objectUniforms, GL_STREAM_DRAW);
+
+		RenderStats::Add(RenderCounter::UniformBytesUploaded, sizeof(objectUniforms));
+
+		// Same level as the depth it is tested against
+		Mesh::SubMesh::LOD lod = node.mesh->GetLOD(SelectLOD(node, worldBounds, lodView));
+
+		gfx->BindVertexArray(node.mesh->GetVertexArrayHandle());
+
+		gfx->DrawElements(node.mesh->GetDrawMode(), lod.indexCount, node.mesh->GetIndexType(), (uint64_t) lod.firstIndex * node.mesh->GetIndexSize(), node.mesh->GetBaseVertex());
+
+		RenderStats::Add(RenderCounter::VertexArrayBinds);
+		RenderStats::Add(RenderCounter::DrawCalls);
+
+		if (node.mesh->GetType() == Mesh::MeshType::Triangles) {
+			RenderStats::Add(RenderCounter::Triangles, lod.indexCount / 3);
+		}
 	}
+
+	gfx->BindVertexArray(0);
+	gfx->UseProgram(0);
+
+	gfx->SetDepthMask(true);
 }
 
 void SceneGraphics::BindGlobalUniformBuffer(const ShaderGlobalUniforms& globalUniforms) {
-	glBindBufferBase(GL_UNIFORM_BUFFER, 0, this->globalUniformsBuffer);
+	GraphicsBackend* gfx = GraphicsBackend::Current();
+
+	gfx->BindBufferBase(GL_UNIFORM_BUFFER, 0, this->globalUniformsBuffer);
+
+	gfx->BufferData(GL_UNIFORM_BUFFER, this->globalUniformsBuffer, sizeof(globalUniforms), &globalUniforms, GL_DYNAMIC_DRAW);
 
-	glBindBuffer(GL_UNIFORM_BUFFER, this->globalUniformsBuffer);
-	glBufferData(GL_UNIFORM_BUFFER, sizeof(globalUniforms), &globalUniforms, GL_DYNAMIC_DRAW);
-	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	RenderStats::Add(RenderCounter::UniformBytesUploaded, sizeof(globalUniforms));
 	
-	glBindBufferBase(GL_UNIFORM_BUFFER, 0, this->globalUniformsBuffer);
+	gfx->BindBufferBase(GL_UNIFORM_BUFFER, 0, this->globalUniformsBuffer);
 }
 
-void SceneGraphics::RenderFullscreenFrameQuad() {
+void SceneGraphics::RenderFullscreenFrameQuad(Texture* source) {
 	static ShaderProgram* quadProg = ShaderProgram::Build()
 	.WithVertexShader(
 		GetScene()->Resources()->Get<VertexShader>("./res/shaders/fullscreen.vert")
@@ -321,25 +574,36 @@ void SceneGraphics::RenderFullscreenFrameQuad() {
 
 	static Mesh* quadMesh = GetScene()->Resources()->Get<Mesh>("./res/models/fullscreenquad.obj");
 
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	GPUProfiler::Scope zone(this->gpuProfiler, "Blit");
 
-	glDisable(GL_DEPTH_TEST);
+	GraphicsBackend* gfx = GraphicsBackend::Current();
 
-	glBindVertexArray(quadMesh->SubMeshAt(0).GetVertexArrayHandle());
+	gfx->BindFramebuffer(this->outputTarget ? this->outputTarget->GetFramebuffer()->GetHandle() : 0);
 
-	glUseProgram(quadProg->GetHandle());
+	gfx->SetEnabled(GL_DEPTH_TEST, false);
 
-	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_2D, this->GetMainFramebuffer()->GetColorTexture()->GetHandle());
+	const Mesh::SubMesh& quad = quadMesh->SubMeshAt(0);
+
+	gfx->BindVertexArray(quad.GetVertexArrayHandle());
+
+	gfx->UseProgram(quadProg->GetHandle());
+
+	gfx->BindTexture(0, GL_TEXTURE_2D, source->GetHandle());
 	
-	glDrawElements(GL_TRIANGLES, quadMesh->SubMeshAt(0).GetVertexCount(), GL_UNSIGNED_INT, nullptr);
+	gfx->DrawElements(GL_TRIANGLES, quad.GetVertexCount(), quad.GetIndexType(), 0, quad.GetBaseVertex());
+
+	RenderStats::Add(RenderCounter::ProgramBinds);
+	RenderStats::Add(RenderCounter::TextureBinds);
+	RenderStats::Add(RenderCounter::VertexArrayBinds);
+	RenderStats::Add(RenderCounter::DrawCalls);
+	RenderStats::Add(RenderCounter::Triangles, quadMesh->SubMeshAt(0).GetFaceCount());
 	
-	glBindTexture(GL_TEXTURE_2D, 0);
+	gfx->BindTexture(0, GL_TEXTURE_2D, 0);
 
-	glEnable(GL_DEPTH_TEST);
+	gfx->SetEnabled(GL_DEPTH_TEST, true);
 
-	glBindVertexArray(0);
-	glUseProgram(0);
+	gfx->BindVertexArray(0);
+	gfx->UseProgram(0);
 }
 
 void SceneGraphics::DrawMesh(MeshRenderer* renderer) {
@@ -373,7 +637,8 @@ void SceneGraphics::DrawMeshInstanced(MeshRenderer* renderer, unsigned int insta
 			renderer->GetMaterial(mesh->GetMaterialIndex()),
 			instanceCount,
 			renderer->GlobalTransform(),
-			renderer->GetNode()->GetLayer()
+			renderer->GetNode()->GetLayer(),
+			renderer
 		));
 	}
 }
@@ -400,20 +665,191 @@ void SceneGraphics::DrawMeshInstanced(const Mesh* mesh, int subMeshIndex, const
 }
 
 void SceneGraphics::Render() {
+	PROFILE_ZONE("SceneGraphics::Render");
+
+	this->gpuProfiler->BeginFrame();
+	this->dynamicResolution->BeginFrame();
+	this->meshletCuller->BeginFrame();
+
+	RenderGraph::ResourceHandle shadowAtlas = this->renderGraph->ImportTexture("Shadow Atlas", GetLightSystem()->GetShadowAtlasTexture());
+	RenderGraph::ResourceHandle mainColor = this->renderGraph->ImportTexture("Main Color", GetMainFramebuffer()->GetColorTexture());
+	RenderGraph::ResourceHandle mainDepth = this->renderGraph->ImportTexture("Main Depth", GetMainFramebuffer()->GetDepthTexture());
+	RenderGraph::ResourceHandle historyA = this->renderGraph->ImportTexture("Temporal History A", this->temporalUpsampler->GetHistoryBuffer(0));
+	RenderGraph::ResourceHandle historyB = this->renderGraph->ImportTexture("Temporal History B", this->temporalUpsampler->GetHistoryBuffer(1));
+	RenderGraph::ResourceHandle backbuffer = this->renderGraph->ImportTexture("Backbuffer", nullptr);
+
+	this->renderGraph->MarkOutput(backbuffer);
+
+	RenderGraph::ResourceHandle postBufferA = RenderGraph::InvalidResource;
+	RenderGraph::ResourceHandle postBufferB = RenderGraph::InvalidResource;
+
+	Texture* presentSource = GetMainFramebuffer()->GetColorTexture();
+
+	bool upsampling = UsesUpsampling();
+
 	for (Camera* camera : *this->GetAllObjects()) {
 		if (camera == this->mainCamera) {
-			camera->SetAspectRatio((float) this->mainViewport->GetSize().x / this->mainViewport->GetSize().y);
-			RenderCamera(camera, this->mainViewport);
+			camera->SetAspectRatio((float) this->outputResolution.x / this->outputResolution.y);
+
+			if (this->temporalUpsampling) {
+				this->temporalUpsampler->BeginFrame(camera->UnjitteredProjectionMatrix() * camera->ViewMatrix());
+
+				camera->SetProjectionJitter(this->temporalUpsampler->GetProjectionJitter());
+			}
+			else {
+				camera->SetProjectionJitter(glm::vec2(0.0f));
+			}
+
+			this->renderGraph->AddPass("Main Camera", [this, camera](RenderGraph*) {
+				RenderCamera(camera, this->mainViewport);
+			})
+			.Read(shadowAtlas, RenderResourceUsage::Sampled)
+			.Write(mainColor, RenderResourceUsage::RenderTarget)
+			.Write(mainDepth, RenderResourceUsage::RenderTarget);
+
+			bool postProcessing = GetPostProcessing() && GetPostProcessing()->HasActiveEffects();
+
+			if (postProcessing) {
+				postBufferA = this->renderGraph->CreateTexture("Post Process A", this->outputResolution, PostProcessingSystem::BufferParams);
+				postBufferB = this->renderGraph->CreateTexture("Post Process B", this->outputResolution, PostProcessingSystem::BufferParams);
+			}
+
+			if (upsampling) {
+				RenderGraph::ResourceHandle motionVectors = this->renderGraph->CreateTexture("Motion Vectors", this->mainViewport->GetSize(), Texture::HDRColorBuffer);
+
+				if (this->temporalUpsampling) {
+					this->renderGraph->AddPass("Motion Vectors", [this, camera, motionVectors](RenderGraph* graph) {
+						Framebuffer* motionFramebuffer = this->temporalUpsampler->GetMotionFramebuffer();
+
+						motionFramebuffer->SetColorTexture(graph->GetTexture(motionVectors));
+
+						RenderCamera(camera, this->mainViewport, RenderParams(
+							RenderPassType::MotionVectors,
+							glm::vec4(0, 0, this->mainViewport->GetSize())
+						));
+
+						// The pool may hand the texture to someone else after this pass
+						motionFramebuffer->SetColorTexture(nullptr);
+					})
+					.Read(mainDepth, RenderResourceUsage::Sampled)
+					.Write(motionVectors, RenderResourceUsage::RenderTarget);
+				}
+
+				RenderGraph::PassBuilder upsamplePass = this->renderGraph->AddPass("Temporal Upsample", [this, &presentSource, motionVectors, postBufferA](RenderGraph* graph) {
+					presentSource = this->temporalUpsampler->Resolve(
+						static_cast<Texture2D*>(GetMainFramebuffer()->GetColorTexture()),
+						static_cast<Texture2D*>(GetMainFramebuffer()->GetDepthTexture()),
+						static_cast<Texture2D*>(graph->GetTexture(motionVectors)),
+						static_cast<Texture2D*>(graph->GetTexture(postBufferA)),
+						this->temporalUpsampling
+					);
+				});
+
+				upsamplePass
+				.Read(mainColor, RenderResourceUsage::Sampled)
+				.Read(mainDepth, RenderResourceUsage::Sampled)
+				.Read(motionVectors, RenderResourceUsage::Sampled)
+				.Read(historyA, RenderResourceUsage::Sampled)
+				.Read(historyB, RenderResourceUsage::Sampled)
+				.Write(historyA, RenderResourceUsage::Image)
+				.Write(historyB, RenderResourceUsage::Image);
+
+				if (postProcessing) {
+					upsamplePass.Write(postBufferA, RenderResourceUsage::Image);
+				}
+			}
+
+			if (postProcessing) {
+				this->renderGraph->AddPass("Post Processing", [this, &presentSource, postBufferA, postBufferB](RenderGraph* graph) {
+					presentSource = GetPostProcessing()->Process(
+						static_cast<Texture2D*>(presentSource),
+						static_cast<Texture2D*>(GetMainFramebuffer()->GetDepthTexture()),
+						static_cast<Texture2D*>(graph->GetTexture(postBufferA)),
+						static_cast<Texture2D*>(graph->GetTexture(postBufferB))
+					);
+				})
+				.Read(mainColor, RenderResourceUsage::Sampled)
+				.Read(mainDepth, RenderResourceUsage::Sampled)
+				.Read(postBufferA, RenderResourceUsage::Sampled)
+				.Write(mainColor, RenderResourceUsage::Image)
+				.Write(postBufferA, RenderResourceUsage::Image)
+				.Write(postBufferB, RenderResourceUsage::Image);
+			}
+		}
+
+		if (camera->GetRenderTarget()) {
+			this->renderGraph->AddPass("Camera Target", [this, camera](RenderGraph*) {
+				RenderCamera(camera);
+			})
+			.Read(shadowAtlas, RenderResourceUsage::Sampled)
+			.Write(this->renderGraph->ImportTexture("Camera Target", camera->GetRenderTarget()->GetFramebuffer()->GetColorTexture()), RenderResourceUsage::RenderTarget)
+			.SideEffect();
+		}
+	}
+
+	RenderGraph::PassBuilder presentPass = this->renderGraph->AddPass("Present", [this, &presentSource](RenderGraph*) {
+		this->mainViewport->GetFramebuffer()->Apply();
+
+		GraphicsBackend::Current()->SetViewport(0, 0, this->outputResolution.x, this->outputResolution.y);
+
+		RenderFullscreenFrameQuad(presentSource);
+	});
+
+	presentPass
+	.Read(mainColor, RenderResourceUsage::Sampled)
+	.Write(backbuffer, RenderResourceUsage::RenderTarget);
+
+	if (upsampling) {
+		presentPass
+		.Read(historyA, RenderResourceUsage::Sampled)
+		.Read(historyB, RenderResourceUsage::Sampled);
+	}
+
+	if (postBufferA != RenderGraph::InvalidResource) {
+		presentPass
+		.Read(postBufferA, RenderResourceUsage::Sampled)
+		.Read(postBufferB, RenderResourceUsage::Sampled);
+	}
+
+	this->renderGraph->Execute();
+
+	if (this->mainCamera) {
+		this->mainCamera->SetProjectionJitter(glm::vec2(0.0f));
+	}
+
+	this->dynamicResolution->EndFrame();
+	this->gpuProfiler->EndFrame();
+
+	if (!this->capturePath.empty()) {
+		FrameCapture* capture = FrameCapture::Capture(this);
+
+		if (capture && capture->Save(this->capturePath)) {
+			spdlog::info("Captured frame to {}", this->capturePath.string());
 		}
 
-		RenderCamera(camera);
+		delete capture;
+
+		this->capturePath.clear();
 	}
 
-	this->mainViewport->GetFramebuffer()->Apply();
+	// Only motion vectors read the previous transforms
+	if (this->temporalUpsampling) {
+		for (const RenderNode& node : this->currentRenders) {
+			if (node.owner) {
+				this->previousTransforms[node.owner] = { node.transformation, this->historyFrame };
+			}
+		}
+	}
 
-	glViewport(0, 0, this->mainViewport->GetSize().x, this->mainViewport->GetSize().y);
+	std::erase_if(this->previousTransforms, [this](const auto& entry) {
+		return this->historyFrame - entry.second.frame > RENDER_HISTORY_FRAMES;
+	});
 
-	RenderFullscreenFrameQuad();
+	std::erase_if(this->previousLODs, [this](const auto& entry) {
+		return this->historyFrame - entry.second.frame > RENDER_HISTORY_FRAMES;
+	});
+
+	this->historyFrame++;
 
 	this->currentRenders.clear();
 
@@ -463,15 +899,24 @@ void SceneGraphics::RenderCamera(Camera* camera, Viewport* renderTarget, const R
 	globalUniforms.Global_ViewMatrix = camera->ViewMatrix();
 	globalUniforms.Global_ProjectionMatrix = camera->ProjectionMatrix();
 	globalUniforms.Global_VPMatrix = globalUniforms.Global_ProjectionMatrix * globalUniforms.Global_ViewMatrix;
+	globalUniforms.Global_UnjitteredVPMatrix = camera->UnjitteredProjectionMatrix() * globalUniforms.Global_ViewMatrix;
+	globalUniforms.Global_PrevVPMatrix = globalUniforms.Global_UnjitteredVPMatrix;
 	globalUniforms.Global_CameraWorldPos = glm::vec4(camera->GlobalTransform().Position().Value(), 0.0);
-	globalUniforms.Global_Time = (float) glfwGetTime();
+	globalUniforms.Global_Time = Time::Current();
 	globalUniforms.Global_CameraFarPlane = camera->GetFarPlane();
 	globalUniforms.Global_CameraNearPlane = camera->GetNearPlane();
 	globalUniforms.Global_CameraFov = camera->GetFovRad();
 
+	if (this->temporalUpsampling && camera == this->mainCamera && renderTarget == this->mainViewport) {
+		globalUniforms.Global_PrevVPMatrix = this->temporalUpsampler->GetPreviousViewProjection();
+	}
+
 	RenderParams activeParams((RenderPassType) 0, params.viewport, false, camera->GetLayerMask());
+	activeParams.lodBias = params.lodBias;
 
 	if ((params.pass & RenderPassType::DepthPrepass) == RenderPassType::DepthPrepass) {
+		GPUProfiler::Scope zone(this->gpuProfiler, "Depth Prepass");
+
 		activeParams.pass = RenderPassType::DepthPrepass;
 
 		activeParams.clearDepth = true;
@@ -481,37 +926,56 @@ void SceneGraphics::RenderCamera(Camera* camera, Viewport* renderTarget, const R
 	}
 
 	if ((params.pass & RenderPassType::Color) == RenderPassType::Color) {
+		GPUProfiler::Scope zone(this->gpuProfiler, "Color");
+
 		activeParams.clearDepth = false;
 		activeParams.pass = RenderPassType(RenderPassType::Color);
+		activeParams.recordLODs = camera == this->mainCamera && renderTarget == this->mainViewport;
 	
 		this->GetMainFramebuffer()->SetColorAttachmentEnabled(true);
 		RenderScene(globalUniforms, renderTarget, activeParams);
+
+		activeParams.recordLODs = false;
 	}
 
 	if ((params.pass & RenderPassType::Gizmos) == RenderPassType::Gizmos) {
+		GPUProfiler::Scope zone(this->gpuProfiler, "Gizmos");
+
 		activeParams.pass = RenderPassType(RenderPassType::Gizmos);
 	
 		RenderScene(globalUniforms, renderTarget, activeParams);
 	}
 
 	if ((params.pass & RenderPassType::PostProcessing) == RenderPassType::PostProcessing) {
+		GPUProfiler::Scope zone(this->gpuProfiler, "Post Processing");
+
 		activeParams.pass = RenderPassType(RenderPassType::PostProcessing);
 	
 		RenderScene(globalUniforms, renderTarget, activeParams);
 	}
+
+	if ((params.pass & RenderPassType::MotionVectors) == RenderPassType::MotionVectors) {
+		GPUProfiler::Scope zone(this->gpuProfiler, "Motion Vectors");
+
+		activeParams.pass = RenderPassType(RenderPassType::MotionVectors);
+	
+		RenderScene(globalUniforms, renderTarget, activeParams);
+	}
 }
 
 void SceneGraphics::RenderScene(const ShaderGlobalUniforms& uniforms, Framebuffer* framebuffer, const RenderParams& params) {
-	glBindFramebuffer(GL_FRAMEBUFFER, framebuffer->GetHandle());
+	GraphicsBackend* gfx = GraphicsBackend::Current();
 
-	glViewport(params.viewport.x, params.viewport.y, params.viewport.z, params.viewport.w);
+	gfx->BindFramebuffer(framebuffer->GetHandle());
+
+	gfx->SetViewport(params.viewport.x, params.viewport.y, params.viewport.z, params.viewport.w);
 
 	BindGlobalUniformBuffer(uniforms);
 
-	glBindBufferBase(GL_UNIFORM_BUFFER, 1, objectUniformsBuffer);
+	gfx->BindBufferBase(GL_UNIFORM_BUFFER, 1, this->objectUniformsBuffer);
 
 	if (params.clearDepth) {
-		glClear(GL_DEPTH_BUFFER_BIT);
+		gfx->Clear(GL_DEPTH_BUFFER_BIT);
 	}
 
 	if (((int) params.pass & (int) RenderPassType::DepthPrepass) != 0) {
@@ -520,9 +984,9 @@ void SceneGraphics::RenderScene(const ShaderGlobalUniforms& uniforms, Framebuffe
 		}
 		else {
 		}
-		glCullFace(GL_BACK);
+		gfx->SetCullFace(GL_BACK);
 	
-		glDepthFunc(GL_LESS);
+		gfx->SetDepthFunc(GL_LESS);
 	
 		RenderParams depthPrepassParams = params;
 
@@ -533,12 +997,12 @@ void SceneGraphics::RenderScene(const ShaderGlobalUniforms& uniforms, Framebuffe
 		Skybox* sky = Skybox::GetCurrentSkybox();
 
 		if (!sky) {
-			glClearColor(0, 0, 0, 0);
-			glClear(GL_COLOR_BUFFER_BIT);
+			gfx->ClearColor(0, 0, 0, 0);
+			gfx->Clear(GL_COLOR_BUFFER_BIT);
 		}
 
-		glCullFace(GL_BACK);
-		glDepthFunc(GL_LEQUAL);
+		gfx->SetCullFace(GL_BACK);
+		gfx->SetDepthFunc(GL_LEQUAL);
 
 		RenderParams colorPassParams = params;
 		colorPassParams.pass = RenderPassType::Color;
@@ -546,9 +1010,15 @@ void SceneGraphics::RenderScene(const ShaderGlobalUniforms& uniforms, Framebuffe
 		RenderObjects(uniforms, colorPassParams);
 
 		if (sky) {
+			const Mesh::SubMesh& skyMesh = sky->GetSkyMesh()->SubMeshAt(0);
+
 			sky->GetSkyMaterial()->Bind();
-			glBindVertexArray(sky->GetSkyMesh()->SubMeshAt(0).GetVertexArrayHandle());
-			glDrawElements(GL_TRIANGLES, sky->GetSkyMesh()->SubMeshAt(0).GetVertexCount(), GL_UNSIGNED_INT, nullptr);
+			gfx->BindVertexArray(skyMesh.GetVertexArrayHandle());
+			gfx->DrawElements(GL_TRIANGLES, skyMesh.GetVertexCount(), skyMesh.GetIndexType(), 0, skyMesh.GetBaseVertex());
+
+			RenderStats::Add(RenderCounter::VertexArrayBinds);
+			RenderStats::Add(RenderCounter::DrawCalls);
+			RenderStats::Add(RenderCounter::Triangles, skyMesh.GetFaceCount());
 		}
 	}
 
@@ -565,42 +1035,19 @@ void SceneGraphics::RenderScene(const ShaderGlobalUniforms& uniforms, Framebuffe
 		if (postProcess) {
 			Texture2D* frameTex = dynamic_cast<Texture2D*>(framebuffer->GetColorTexture());
 			Texture2D* frameDepth = dynamic_cast<Texture2D*>(framebuffer->GetDepthTexture());
-			Texture2D postProcessBuffer = Texture::Wrap<Texture2D>(postProcess->GetPostProcessBuffer());
-			
-			PostProcessParams postProcessParams;
-			postProcessParams.inputTexture = &postProcessBuffer;
-			postProcessParams.outputTexture = frameTex;
-			postProcessParams.depthTexture = frameDepth;
-			
-			for (auto* effect : *postProcess->GetAllObjects()) {
-				if (!effect->IsEnabled()) {
-					continue;
-				}
-				
-				glCopyImageSubData(
-					this->GetMainFramebuffer()->GetColorTexture()->GetHandle(),
-					GL_TEXTURE_2D,
-					0,
-					0,
-					0,
-					0,
-					postProcess->GetPostProcessBuffer(),
-					GL_TEXTURE_2D,
-					0,
-					0,
-					0,
-					0,
-					this->mainViewport->GetSize().x,
-					this->mainViewport->GetSize().y,
-					1
-				);
-	
-				effect->OnPostProcess(&postProcessParams);
-			}
+
+			Texture2D* bufferA = this->renderGraph->AcquireScratchTexture(frameTex->GetSize(), PostProcessingSystem::BufferParams);
+			Texture2D* bufferB = this->renderGraph->AcquireScratchTexture(frameTex->GetSize(), PostProcessingSystem::BufferParams);
+
+			postProcess->Process(frameTex, frameDepth, bufferA, bufferB, frameTex);
 		}
 	}
 
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	if (((int) params.pass & (int) RenderPassType::MotionVectors) != 0) {
+		RenderMotionVectors(uniforms, params);
+	}
+
+	gfx->BindFramebuffer(0);
 }
 
 void SceneGraphics::RenderScene(const CameraData& camera, Framebuffer* framebuffer, const RenderParams& params) {
@@ -608,8 +1055,10 @@ void SceneGraphics::RenderScene(const CameraData& camera, Framebuffer* framebuff
 	globalUniforms.Global_ViewMatrix = camera.ViewMatrix();
 	globalUniforms.Global_ProjectionMatrix = camera.ProjectionMatrix();
 	globalUniforms.Global_VPMatrix = globalUniforms.Global_ProjectionMatrix * globalUniforms.Global_ViewMatrix;
+	globalUniforms.Global_UnjitteredVPMatrix = globalUniforms.Global_VPMatrix;
+	globalUniforms.Global_PrevVPMatrix = globalUniforms.Global_VPMatrix;
 	globalUniforms.Global_CameraWorldPos = glm::vec4((glm::vec3) camera.cameraTransform[3], 0.0);
-	globalUniforms.Global_Time = (float) glfwGetTime();
+	globalUniforms.Global_Time = Time::Current();
 	globalUniforms.Global_CameraFarPlane = camera.GetFarPlane();
 	globalUniforms.Global_CameraNearPlane = camera.GetNearPlane();
 	globalUniforms.Global_CameraFov = camera.GetFovRad();
@@ -641,9 +1090,31 @@ void SceneGraphics::OnPostRender() {
 void SceneGraphics::DrawImGui() {
 	ImGui::SetNextItemOpen(true, ImGuiCond_FirstUseEver);
 	if (ImGui::TreeNode("Graphics Debug")) {
-		ImGui::Text("Resolution: %i:%i", (int) this->mainViewport->GetSize().x, (int) this->mainViewport->GetSize().y);
+		ImGui::Text("Resolution: %i:%i", (int) this->outputResolution.x, (int) this->outputResolution.y);
+		ImGui::Text("Render resolution: %i:%i", (int) this->mainViewport->GetSize().x, (int) this->mainViewport->GetSize().y);
 		ImGui::Text("Application average %.3f ms/frame (%.1f FPS)", 1000.0f / ImGui::GetIO().Framerate, ImGui::GetIO().Framerate);
 
+		this->dynamicResolution->DrawImGui();
+
+		bool temporalUpsampling = this->temporalUpsampling;
+
+		if (ImGui::Checkbox("Temporal upsampling", &temporalUpsampling)) {
+			SetTemporalUpsamplingEnabled(temporalUpsampling);
+		}
+
+		this->temporalUpsampler->DrawImGui();
+
+		ImGui::SliderFloat("LOD error (pixels)", &this->lodErrorPixels, 0.0f, 8.0f);
+		ImGui::SliderFloat("Shadow LOD bias", &this->shadowLODBias, 1.0f, 16.0f);
+		ImGui::SliderFloat("Probe LOD bias", &this->probeLODBias, 1.0f, 16.0f);
+		ImGui::Checkbox("Meshlet culling", &this->meshletCulling);
+
+		this->renderGraph->DrawImGui();
+
+		this->gpuProfiler->DrawImGui();
+
+		RenderStats::DrawImGui();
+
 		ImGui::TreePop();
 	}
 }
@@ -0,0 +1,171 @@
+#include <GraphicsBackend.h>
+
+GraphicsBackend* GraphicsBackend::current = nullptr;
+
+GraphicsBackend* GraphicsBackend::Current() {
+	static GLBackend glBackend;
+
+	return current ? current : &glBackend;
+}
+
+void GraphicsBackend::SetCurrent(GraphicsBackend* backend) {
+	current = backend;
+}
+
+GLuint GLBackend::CreateBuffer() {
+	GLuint buffer = 0;
+	glGenBuffers(1, &buffer);
+
+	return buffer;
+}
+
+void GLBackend::DeleteBuffer(GLuint buffer) {
+	glDeleteBuffers(1, &buffer);
+}
+
+void GLBackend::BufferData(GLenum target, GLuint buffer, size_t size, const void* data, GLenum usage) {
+	glBindBuffer(target, buffer);
+	glBufferData(target, size, data, usage);
+	glBindBuffer(target, 0);
+}
+
+void GLBackend::BufferSubData(GLenum target, GLuint buffer, size_t offset, size_t size, const void* data) {
+	glBindBuffer(target, buffer);
+	glBufferSubData(target, offset, size, data);
+	glBindBuffer(target, 0);
+}
+
+void GLBackend::BindBufferBase(GLenum target, unsigned int index, GLuint buffer) {
+	glBindBufferBase(target, index, buffer);
+}
+
+void GLBackend::UseProgram(GLuint program) {
+	glUseProgram(program);
+}
+
+void GLBackend::BindVertexArray(GLuint vertexArray) {
+	glBindVertexArray(vertexArray);
+}
+
+void GLBackend::BindTexture(unsigned int unit, GLenum target, GLuint texture) {
+	glActiveTexture(GL_TEXTURE0 + unit);
+	glBindTexture(target, texture);
+}
+
+void GLBackend::BindImageTexture(unsigned int unit, GLuint texture, int level, bool layered, GLenum access, GLenum format) {
+	glBindImageTexture(unit, texture, level, layered, 0, access, format);
+}
+
+int GLBackend::GetUniformLocation(GLuint program, const char* name) {
+	return glGetUniformLocation(program, name);
+}
+
+void GLBackend::SetUniform(int location, UniformSpec::UniformType type, const void* value) {
+	switch (type) {
+	case UniformSpec::UniformType::Float1:
+		glUniform1f(location, *(const float*) value);
+		break;
+	case UniformSpec::UniformType::Float2:
+		glUniform2fv(location, 1, (const float*) value);
+		break;
+	case UniformSpec::UniformType::Float3:
+		glUniform3fv(location, 1, (const float*) value);
+		break;
+	case UniformSpec::UniformType::Float4:
+		glUniform4fv(location, 1, (const float*) value);
+		break;
+	case UniformSpec::UniformType::Uint1:
+		glUniform1ui(location, *(const unsigned int*) value);
+		break;
+	case UniformSpec::UniformType::Uint2:
+		glUniform2uiv(location, 1, (const unsigned int*) value);
+		break;
+	case UniformSpec::UniformType::Uint3:
+		glUniform3uiv(location, 1, (const unsigned int*) value);
+		break;
+	case UniformSpec::UniformType::Uint4:
+		glUniform4uiv(location, 1, (const unsigned int*) value);
+		break;
+	case UniformSpec::UniformType::Matrix3x3:
+		glUniformMatrix3fv(location, 1, false, (const float*) value);
+		break;
+	case UniformSpec::UniformType::Matrix4x4:
+		glUniformMatrix4fv(location, 1, false, (const float*) value);
+		break;
+	case UniformSpec::UniformType::Sampler2D:
+	case UniformSpec::UniformType::Cubemap:
+	case UniformSpec::UniformType::Image2D:
+	case UniformSpec::UniformType::UImage2D:
+	case UniformSpec::UniformType::ImageCube:
+		glUniform1i(location, *(const int*) value);
+		break;
+	default:
+		break;
+	}
+}
+
+void GLBackend::BindFramebuffer(GLuint framebuffer) {
+	glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+}
+
+void GLBackend::SetViewport(int x, int y, int width, int height) {
+	glViewport(x, y, width, height);
+}
+
+void GLBackend::ClearColor(float r, float g, float b, float a) {
+	glClearColor(r, g, b, a);
+}
+
+void GLBackend::Clear(GLbitfield mask) {
+	glClear(mask);
+}
+
+void GLBackend::SetEnabled(GLenum capability, bool enabled) {
+	if (enabled) {
+		glEnable(capability);
+	}
+	else {
+		glDisable(capability);
+	}
+}
+
+void GLBackend::SetDepthMask(bool enabled) {
+	glDepthMask(enabled ? GL_TRUE : GL_FALSE);
+}
+
+void GLBackend::SetDepthFunc(GLenum func) {
+	glDepthFunc(func);
+}
+
+void GLBackend::SetCullFace(GLenum face) {
+	glCullFace(face);
+}
+
+void GLBackend::SetPatchVertices(int vertices) {
+	glPatchParameteri(GL_PATCH_VERTICES, vertices);
+}
+
+void GLBackend::DrawElements(GLenum mode, unsigned int count, GLenum indexType, uint64_t indexOffset, int baseVertex, unsigned int instanceCount) {
+	if (instanceCount > 0) {
+		glDrawElementsInstancedBaseVertex(mode, count, indexType, (const void*) (uintptr_t) indexOffset, instanceCount, baseVertex);
+	}
+	else {
+		glDrawElementsBaseVertex(mode, count, indexType, (const void*) (uintptr_t) indexOffset, baseVertex);
+	}
+}
+
+void GLBackend::DrawElementsIndirect(GLenum mode, GLenum indexType, GLuint commandBuffer, uint64_t commandOffset, uint64_t countOffset, unsigned int maxDrawCount) {
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+	glBindBuffer(GL_PARAMETER_BUFFER, commandBuffer);
+	glMultiDrawElementsIndirectCount(mode, indexType, (const void*) (uintptr_t) commandOffset, (GLintptr) countOffset, maxDrawCount, 0);
+	glBindBuffer(GL_PARAMETER_BUFFER, 0);
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+}
+
+void GLBackend::DispatchCompute(unsigned int groupsX, unsigned int groupsY, unsigned int groupsZ) {
+	glDispatchCompute(groupsX, groupsY, groupsZ);
+}
+
+void GLBackend::Barrier(GLbitfield barriers) {
+	glMemoryBarrier(barriers);
+}
\ No newline at end of file
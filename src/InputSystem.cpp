@@ -466,6 +466,12 @@ bool InputSystem::MouseLocked() {
 void InputSystem::SetMouseLocked(bool locked) {
 	static glm::vec2 prevMousePos;
 
+	if (Engine::GetWindow() == nullptr) {
+		this->mouseLocked = locked;
+
+		return;
+	}
+
 	if (locked) {
 		glfwSetInputMode(Engine::GetWindow(), GLFW_CURSOR, GLFW_CURSOR_DISABLED);
 		
@@ -504,6 +510,11 @@ glm::vec2 InputSystem::GetMousePosition() {
 }
 
 void InputSystem::OnPreUpdate() {
+	// Headless runs have no window to poll, every key stays released
+	if (Engine::GetWindow() == nullptr) {
+		return;
+	}
+
 	for (auto& key : this->keys) {
 		int keyCode = key.first % MouseButtonOffset;
 
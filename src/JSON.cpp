@@ -0,0 +1,23 @@
+#include <JSON.h>
+
+#include <format>
+
+std::string EscapeJSON(const std::string& text) {
+	std::string result;
+	result.reserve(text.size());
+
+	for (char c : text) {
+		if (c == '"' || c == '\\') {
+			result += '\\';
+			result += c;
+		}
+		else if ((unsigned char) c < 0x20) {
+			result += std::format("\\u{:04x}", (int) c);
+		}
+		else {
+			result += c;
+		}
+	}
+
+	return result;
+}
\ No newline at end of file
@@ -1,20 +1,53 @@
 #include <LightSystem.h>
 
 #include <malloc.h>
+#include <format>
+#include <vector>
 
 #include <glm/glm.hpp>
-#include <GLFW/glfw3.h>
+#include <TimeSystem.h>
 #include <imgui.h>
 
 #include <Light.h>
 #include <Camera.h>
 #include <Graphics.h>
+#include <RenderGraph.h>
+#include <GPUProfiler.h>
+#include <Profiler.h>
+#include <RenderStats.h>
+#include <MemoryTracker.h>
 
 #include "../res/shaders/shared/shared.h"
 #include "../res/shaders/shared/uniforms.h"
 
 constexpr int MAX_NUM_LIGHTS = 128;
 
+static const char* LightTypeName(Light::LightType type) {
+	switch (type) {
+		case Light::LightType::Point:
+			return "Point";
+		case Light::LightType::Spot:
+			return "Spot";
+		case Light::LightType::Directional:
+			return "Directional";
+	}
+
+	return "Unknown";
+}
+
+// Interned once per type and number, so naming the zone does not allocate every frame
+static const char* LightZoneName(Light::LightType type, int number) {
+	static std::vector<const char*> zoneNames[3];
+
+	std::vector<const char*>& names = zoneNames[(int) type];
+
+	while ((int) names.size() <= number) {
+		names.push_back(Profiler::Intern(std::format("{} Light {}", LightTypeName(type), names.size())));
+	}
+
+	return names[number];
+}
+
 LightSystem::LightSystem(Scene* scene):
 GameObjectSystem<Light>(scene),
 lightsBuffer(0),
@@ -22,6 +55,8 @@ shadowmapAtlasSize(4096),
 directionalLightCascadeCount(6) {
 	this->shadowAtlasFramebuffer = new Framebuffer(Framebuffer::Attachment::Depth, shadowmapAtlasSize, shadowmapAtlasSize);
 
+	MemoryTracker::SetCategory(this->shadowAtlasFramebuffer->GetDepthTexture(), MemoryCategory::ShadowMaps);
+
 	glGenBuffers(1, &this->lightsBuffer);
 	glBindBuffer(GL_SHADER_STORAGE_BUFFER, this->lightsBuffer);
 	glBufferData(GL_SHADER_STORAGE_BUFFER, 32 + sizeof(ShaderLightRep) * MAX_NUM_LIGHTS, nullptr, GL_DYNAMIC_DRAW);
@@ -41,6 +76,9 @@ GLuint LightSystem::GetLightsBufferHandle() {
 GLuint LightSystem::GetShadowmapsBufferHandle() {
 	return this->shadowmapsBuffer;
 }
+Texture* LightSystem::GetShadowAtlasTexture() const {
+	return this->shadowAtlasFramebuffer->GetDepthTexture();
+}
 
 void LightSystem::DoSpotLightShadowmap(Light* light, ShadowMapRegion& shadowmapRect) {
 	ShaderGlobalUniforms globalUniforms;
@@ -53,7 +91,7 @@ void LightSystem::DoSpotLightShadowmap(Light* light, ShadowMapRegion& shadowmapR
 	globalUniforms.Global_ProjectionMatrix = glm::perspective(light->GetSpotlightAngle() * 2, 1.0f, 0.1f, light->GetRange());
 	globalUniforms.Global_VPMatrix = globalUniforms.Global_ProjectionMatrix * globalUniforms.Global_ViewMatrix;
 	globalUniforms.Global_CameraWorldPos = light->GlobalTransform().Position();
-	globalUniforms.Global_Time = (float) glfwGetTime();
+	globalUniforms.Global_Time = Time::Current();
 	globalUniforms.Global_CameraFarPlane = 0;
 	globalUniforms.Global_CameraNearPlane = 0;
 	globalUniforms.Global_CameraFov = 0;
@@ -65,7 +103,7 @@ void LightSystem::DoSpotLightShadowmap(Light* light, ShadowMapRegion& shadowmapR
 		shadowmapRect.end.x - shadowmapRect.start.x, shadowmapRect.end.y - shadowmapRect.start.y
 	));
 
-	GetScene()->GetGraphics()->RenderScene(globalUniforms, this->shadowAtlasFramebuffer, renderParams);
+	this->shadowViews.push_back(ShadowView{globalUniforms, renderParams, light});
 
 	shadowmapRect.start /= this->shadowmapAtlasSize;
 	shadowmapRect.end /= this->shadowmapAtlasSize;
@@ -74,7 +112,7 @@ void LightSystem::DoSpotLightShadowmap(Light* light, ShadowMapRegion& shadowmapR
 void LightSystem::DoDirectionalLightShadowmap(Light* light, ShadowMapRegion* shadowmapRects) {
 	ShaderGlobalUniforms globalUniforms;
 	
-	globalUniforms.Global_Time = (float) glfwGetTime();
+	globalUniforms.Global_Time = Time::Current();
 	globalUniforms.Global_CameraFarPlane = 0;
 	globalUniforms.Global_CameraNearPlane = 0;
 	globalUniforms.Global_CameraFov = 0;
@@ -159,7 +197,7 @@ void LightSystem::DoDirectionalLightShadowmap(Light* light, ShadowMapRegion* sha
 			shadowmapRect.end.x - shadowmapRect.start.x, shadowmapRect.end.y - shadowmapRect.start.y
 		));
 		
-		GetScene()->GetGraphics()->RenderScene(globalUniforms, this->shadowAtlasFramebuffer, renderParams);
+		this->shadowViews.push_back(ShadowView{globalUniforms, renderParams, light});
 
 		shadowmapRect.start /= this->shadowmapAtlasSize;
 		shadowmapRect.end /= this->shadowmapAtlasSize;
@@ -179,7 +217,7 @@ void LightSystem::DoPointLightShadowmap(Light* light, ShadowMapRegion* shadowmap
 	ShaderGlobalUniforms globalUniforms;
 	
 	globalUniforms.Global_CameraWorldPos = light->GlobalTransform().Position();
-	globalUniforms.Global_Time = (float) glfwGetTime();
+	globalUniforms.Global_Time = Time::Current();
 	globalUniforms.Global_CameraFarPlane = 0;
 	globalUniforms.Global_CameraNearPlane = 0;
 	globalUniforms.Global_CameraFov = glm::radians(90.0f);
@@ -218,17 +256,52 @@ void LightSystem::DoPointLightShadowmap(Light* light, ShadowMapRegion* shadowmap
 			shadowmapRect.end.x - shadowmapRect.start.x, shadowmapRect.end.y - shadowmapRect.start.y
 		));
 		
-		GetScene()->GetGraphics()->RenderScene(globalUniforms, this->shadowAtlasFramebuffer, renderParams);
+		this->shadowViews.push_back(ShadowView{globalUniforms, renderParams, light});
 
 		shadowmapRect.start /= this->shadowmapAtlasSize;
 		shadowmapRect.end /= this->shadowmapAtlasSize;
 	}	
 }
 
-void LightSystem::OnPostRender() {
+void LightSystem::RenderShadowAtlas() {
 	glBindFramebuffer(GL_FRAMEBUFFER, this->shadowAtlasFramebuffer->GetHandle());
 	glClear(GL_DEPTH_BUFFER_BIT);
 
+	GPUProfiler* profiler = GetScene()->GetGraphics()->GetGPUProfiler();
+
+	const Light* currentLight = nullptr;
+	int lightNumber = 0;
+
+	for (const ShadowView& view : this->shadowViews) {
+		if (view.light != currentLight) {
+			if (currentLight != nullptr) {
+				profiler->EndZone();
+			}
+
+			currentLight = view.light;
+
+			profiler->BeginZone(LightZoneName(currentLight->GetType(), lightNumber++));
+		}
+
+		// Shadow texels hide more simplification than screen pixels do
+		RenderParams params = view.params;
+		params.lodBias = GetScene()->GetGraphics()->GetShadowLODBias();
+
+		GetScene()->GetGraphics()->RenderScene(view.uniforms, this->shadowAtlasFramebuffer, params);
+
+		RenderStats::Add(RenderCounter::ShadowViews);
+	}
+
+	if (currentLight != nullptr) {
+		profiler->EndZone();
+	}
+
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void LightSystem::OnPostRender() {
+	this->shadowViews.clear();
+
 	glm::vec4 ambientLight{1.0, 1.0, 1.0, 0.01};
 
 	int shadowmapTexturesCount = 0;
@@ -375,7 +448,12 @@ void LightSystem::OnPostRender() {
 	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, this->shadowmapsBuffer);
 	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
 
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	RenderGraph* graph = GetScene()->GetGraphics()->GetRenderGraph();
+
+	graph->AddPass("Shadow Atlas", [this](RenderGraph*) {
+		RenderShadowAtlas();
+	})
+	.Write(graph->ImportTexture("Shadow Atlas", GetShadowAtlasTexture()), RenderResourceUsage::RenderTarget);
 }
 
 int LightSystem::Order() {
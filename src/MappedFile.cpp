@@ -0,0 +1,105 @@
+#include <MappedFile.h>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile():
+data(nullptr),
+size(0)
+#ifdef _WIN32
+,
+fileHandle(INVALID_HANDLE_VALUE),
+mappingHandle(nullptr)
+#endif
+{ }
+
+MappedFile::~MappedFile() {
+#ifdef _WIN32
+	if (this->data) {
+		UnmapViewOfFile(this->data);
+	}
+
+	if (this->mappingHandle) {
+		CloseHandle(this->mappingHandle);
+	}
+
+	if (this->fileHandle != INVALID_HANDLE_VALUE) {
+		CloseHandle(this->fileHandle);
+	}
+#else
+	if (this->data) {
+		munmap(this->data, this->size);
+	}
+#endif
+}
+
+const unsigned char* MappedFile::GetData() const {
+	return static_cast<const unsigned char*>(this->data);
+}
+
+size_t MappedFile::GetSize() const {
+	return this->size;
+}
+
+MappedFile* MappedFile::Open(const fs::path& path) {
+	MappedFile* file = new MappedFile();
+
+#ifdef _WIN32
+	file->fileHandle = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+
+	LARGE_INTEGER fileSize;
+
+	if (file->fileHandle == INVALID_HANDLE_VALUE || !GetFileSizeEx(file->fileHandle, &fileSize) || fileSize.QuadPart == 0) {
+		delete file;
+		return nullptr;
+	}
+
+	file->mappingHandle = CreateFileMappingW(file->fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+	if (!file->mappingHandle) {
+		delete file;
+		return nullptr;
+	}
+
+	file->data = MapViewOfFile(file->mappingHandle, FILE_MAP_READ, 0, 0, 0);
+	file->size = (size_t) fileSize.QuadPart;
+#else
+	int descriptor = open(path.c_str(), O_RDONLY);
+
+	if (descriptor < 0) {
+		delete file;
+		return nullptr;
+	}
+
+	struct stat status;
+
+	if (fstat(descriptor, &status) != 0 || status.st_size == 0) {
+		close(descriptor);
+		delete file;
+		return nullptr;
+	}
+
+	file->size = (size_t) status.st_size;
+
+	void* data = mmap(nullptr, file->size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+
+	// The mapping stays valid after the descriptor is closed
+	close(descriptor);
+
+	file->data = data != MAP_FAILED ? data : nullptr;
+#endif
+
+	if (!file->data) {
+		delete file;
+		return nullptr;
+	}
+
+	return file;
+}
\ No newline at end of file
@@ -1,40 +1,32 @@
 #include <Material.h>
 
-#include <malloc.h>
+#include <cstring>
+
+#include <RenderStats.h>
+#include <GraphicsBackend.h>
 
 void ShaderVariableStorage::Bind() const {
+	GraphicsBackend* gfx = GraphicsBackend::Current();
+
 	int samplerIndex = 0;
 
 	for (unsigned int i = 0; i < this->uniformSpec->VariableCount(); i++) {
 		int offset = this->uniformSpec->VariableAt(i).offset;
+		int binding = this->uniformSpec->VariableAt(i).binding;
+		UniformSpec::UniformType type = this->uniformSpec->VariableAt(i).type;
 
-		switch (this->uniformSpec->VariableAt(i).type) {
+		switch (type) {
 		case UniformSpec::UniformType::Float1:
-			glUniform1f(this->uniformSpec->VariableAt(i).binding, GetValue<float>(i));
-			break;
 		case UniformSpec::UniformType::Float2:
-			glUniform2fv(this->uniformSpec->VariableAt(i).binding, 1, &GetValue<glm::vec2>(i)[0]);
-			break;
 		case UniformSpec::UniformType::Float3:
-			glUniform3fv(this->uniformSpec->VariableAt(i).binding, 1, &GetValue<glm::vec3>(i)[0]);
-			break;
 		case UniformSpec::UniformType::Float4:
-			glUniform4fv(this->uniformSpec->VariableAt(i).binding, 1, &GetValue<glm::vec4>(i)[0]);
-			break;
 		case UniformSpec::UniformType::Uint1:
-			glUniform1ui(this->uniformSpec->VariableAt(i).binding, GetValue<unsigned int>(i));
-			break;
 		case UniformSpec::UniformType::Uint2:
-			glUniform2uiv(this->uniformSpec->VariableAt(i).binding, 1, &GetValue<glm::uvec2>(i)[0]);
-			break;
 		case UniformSpec::UniformType::Uint3:
-			glUniform3uiv(this->uniformSpec->VariableAt(i).binding, 1, &GetValue<glm::uvec3>(i)[0]);
-			break;
+		case UniformSpec::UniformType::Uint4:
 		case UniformSpec::UniformType::Matrix3x3:
-			glUniformMatrix3fv(this->uniformSpec->VariableAt(i).binding, 1, false, &GetValue<glm::mat3>(i)[0][0]);
-			break;
 		case UniformSpec::UniformType::Matrix4x4:
-			glUniformMatrix4fv(this->uniformSpec->VariableAt(i).binding, 1, false, &GetValue<glm::mat4>(i)[0][0]);
+			gfx->SetUniform(binding, type, (char*) this->dataBuffer + offset);
 			break;
 		case UniformSpec::UniformType::Sampler2D:
 		{
@@ -50,9 +42,10 @@ void ShaderVariableStorage::Bind() const {
 				imageTexHandle = imageTex.tex->GetHandle();
 			}
 			
-			glActiveTexture(GL_TEXTURE0 + samplerIndex);
-			glBindTexture(GL_TEXTURE_2D, imageTexHandle);
-			glUniform1i(this->uniformSpec->VariableAt(i).binding, samplerIndex);
+			gfx->BindTexture(samplerIndex, GL_TEXTURE_2D, imageTexHandle);
+			gfx->SetUniform(binding, type, &samplerIndex);
+
+			RenderStats::Add(RenderCounter::TextureBinds);
 
 			samplerIndex++;
 
@@ -72,9 +65,10 @@ void ShaderVariableStorage::Bind() const {
 				cubeTexHandle = cubeTex.tex->GetHandle();
 			}
 			
-			glActiveTexture(GL_TEXTURE0 + samplerIndex);
-			glBindTexture(GL_TEXTURE_CUBE_MAP, cubeTexHandle);
-			glUniform1i(this->uniformSpec->VariableAt(i).binding, samplerIndex);
+			gfx->BindTexture(samplerIndex, GL_TEXTURE_CUBE_MAP, cubeTexHandle);
+			gfx->SetUniform(binding, type, &samplerIndex);
+
+			RenderStats::Add(RenderCounter::TextureBinds);
 
 			samplerIndex++;
 
@@ -100,10 +94,12 @@ void ShaderVariableStorage::Bind() const {
 					.format = imageTex.tex->GetFormat(),
 				});
 
-				glUniform1i(this->uniformSpec->VariableAt(i).binding, samplerIndex);
+				gfx->SetUniform(binding, type, &samplerIndex);
 			}
 
-			glBindImageTexture(samplerIndex, imageTexHandle, imageTex.level, false, 0, GL_READ_WRITE, imageFormat);
+			gfx->BindImageTexture(samplerIndex, imageTexHandle, imageTex.level, false, GL_READ_WRITE, imageFormat);
+
+			RenderStats::Add(RenderCounter::TextureBinds);
 
 			samplerIndex++;
 
@@ -128,10 +124,12 @@ void ShaderVariableStorage::Bind() const {
 					.format = cubeTex.tex->GetFormat(),
 				});
 
-				glUniform1i(this->uniformSpec->VariableAt(i).binding, samplerIndex);
+				gfx->SetUniform(binding, type, &samplerIndex);
 			}
 
-			glBindImageTexture(samplerIndex, imageTexHandle, cubeTex.level, true, 0, GL_READ_WRITE, imageFormat);
+			gfx->BindImageTexture(samplerIndex, imageTexHandle, cubeTex.level, true, GL_READ_WRITE, imageFormat);
+
+			RenderStats::Add(RenderCounter::TextureBinds);
 
 			samplerIndex++;
 
@@ -144,11 +142,11 @@ void ShaderVariableStorage::Bind() const {
 		auto uniformBufferSpec = this->uniformSpec->UniformBufferAt(i);
 		auto uniformBufferData = uniformBuffers[i];
 
-		glBindBuffer(GL_UNIFORM_BUFFER, uniformBufferData.bufferHandle);
-		glBufferData(GL_UNIFORM_BUFFER, uniformBufferSpec.size, uniformBufferData.bufferData, GL_STREAM_DRAW);
-		glBindBuffer(GL_UNIFORM_BUFFER, 0);
+		gfx->BufferData(GL_UNIFORM_BUFFER, uniformBufferData.bufferHandle, uniformBufferSpec.size, uniformBufferData.bufferData, GL_STREAM_DRAW);
 
-		glBindBufferBase(GL_UNIFORM_BUFFER, uniformBufferSpec.binding, uniformBufferData.bufferHandle);
+		RenderStats::Add(RenderCounter::UniformBytesUploaded, uniformBufferSpec.size);
+
+		gfx->BindBufferBase(GL_UNIFORM_BUFFER, uniformBufferSpec.binding, uniformBufferData.bufferHandle);
 	}
 
 	for (unsigned int i = 0; i < this->uniformSpec->StorageBuffersCount(); i++) {
@@ -168,12 +166,9 @@ uniformSpec(&uniformSpec) {
 	int uniformBuffersCount = uniformSpec.UniformBuffersCount();
 
 	this->uniformBuffers = new BufferPair[uniformBuffersCount];
-	GLuint* uniformBufferHandles = (GLuint*) alloca(sizeof(GLuint) * uniformBuffersCount);
-
-	glGenBuffers(uniformBuffersCount, uniformBufferHandles);
 
 	for (int i = 0; i < uniformBuffersCount; i++) {
-		GLuint bufferHandle = uniformBufferHandles[i];
+		GLuint bufferHandle = GraphicsBackend::Current()->CreateBuffer();
 		unsigned int bufferSize = uniformSpec.UniformBufferAt(i).size;
 
 		this->uniformBuffers[i].bufferData = (void*) new std::byte[bufferSize];
@@ -237,7 +232,10 @@ shader(shader),
 shaderVariables(shader->GetUniforms()) { }
 
 void Material::Bind() const {
-	glUseProgram(this->shader->GetHandle());
+	GraphicsBackend::Current()->UseProgram(this->shader->GetHandle());
+
+	RenderStats::Add(RenderCounter::MaterialBinds);
+	RenderStats::Add(RenderCounter::ProgramBinds);
 
 	this->shaderVariables.Bind();
 }
@@ -268,7 +266,9 @@ shader(shader),
 shaderVariables(shader->GetUniforms()) { }
 
 void ComputeDispatchData::Bind() const {
-	glUseProgram(this->shader->GetHandle());
+	GraphicsBackend::Current()->UseProgram(this->shader->GetHandle());
+
+	RenderStats::Add(RenderCounter::ProgramBinds);
 
 	this->shaderVariables.Bind();
 }
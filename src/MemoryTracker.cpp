@@ -0,0 +1,309 @@
+#include <MemoryTracker.h>
+
+#include <format>
+#include <fstream>
+#include <vector>
+#include <algorithm>
+
+#include <spdlog/spdlog.h>
+#include <imgui.h>
+
+#include <JSON.h>
+
+std::mutex MemoryTracker::mutex;
+std::unordered_map<const void*, MemoryTracker::Allocation> MemoryTracker::allocations;
+MemoryTracker::Usage MemoryTracker::totals[(int) MemoryCategory::Count] = {};
+MemoryTracker::Budget MemoryTracker::budgets[(int) MemoryCategory::Count] = {};
+bool MemoryTracker::overBudget[(int) MemoryCategory::Count] = {};
+
+std::string FormatBytes(uint64_t bytes) {
+	if (bytes >= 1024ull * 1024 * 1024) {
+		return std::format("{:.2f} GiB", bytes / (1024.0 * 1024.0 * 1024.0));
+	}
+	if (bytes >= 1024ull * 1024) {
+		return std::format("{:.2f} MiB", bytes / (1024.0 * 1024.0));
+	}
+	if (bytes >= 1024ull) {
+		return std::format("{:.2f} KiB", bytes / 1024.0);
+	}
+
+	return std::format("{} B", bytes);
+}
+
+void MemoryTracker::Add(MemoryCategory category, const Usage& usage) {
+	totals[(int) category].cpuBytes += usage.cpuBytes;
+	totals[(int) category].gpuBytes += usage.gpuBytes;
+}
+
+void MemoryTracker::Remove(MemoryCategory category, const Usage& usage) {
+	totals[(int) category].cpuBytes -= usage.cpuBytes;
+	totals[(int) category].gpuBytes -= usage.gpuBytes;
+}
+
+void MemoryTracker::CheckBudget(MemoryCategory category) {
+	const Usage& total = totals[(int) category];
+	const Budget& budget = budgets[(int) category];
+
+	bool over = (budget.cpuBytes && total.cpuBytes > budget.cpuBytes) || (budget.gpuBytes && total.gpuBytes > budget.gpuBytes);
+
+	// Only warn when crossing the budget, not on every allocation made while above it
+	if (over && !overBudget[(int) category]) {
+		spdlog::warn(
+			"{} memory over budget: {} CPU, {} GPU (budget {} CPU, {} GPU)",
+			GetName(category),
+			FormatBytes(total.cpuBytes),
+			FormatBytes(total.gpuBytes),
+			budget.cpuBytes ? FormatBytes(budget.cpuBytes) : "unlimited",
+			budget.gpuBytes ? FormatBytes(budget.gpuBytes) : "unlimited"
+		);
+	}
+
+	overBudget[(int) category] = over;
+}
+
+void MemoryTracker::Track(const void* owner, MemoryCategory category, uint64_t cpuBytes, uint64_t gpuBytes) {
+	std::lock_guard lock(mutex);
+
+	auto [it, created] = allocations.try_emplace(owner, Allocation{category, "", {0, 0}});
+	Allocation& allocation = it->second;
+
+	Remove(allocation.category, allocation.usage);
+
+	allocation.usage = Usage{cpuBytes, gpuBytes};
+
+	Add(allocation.category, allocation.usage);
+
+	CheckBudget(allocation.category);
+}
+
+void MemoryTracker::Untrack(const void* owner) {
+	std::lock_guard lock(mutex);
+
+	auto it = allocations.find(owner);
+
+	if (it == allocations.end()) {
+		return;
+	}
+
+	Remove(it->second.category, it->second.usage);
+	CheckBudget(it->second.category);
+
+	allocations.erase(it);
+}
+
+void MemoryTracker::SetCategory(const void* owner, MemoryCategory category) {
+	std::lock_guard lock(mutex);
+
+	auto [it, created] = allocations.try_emplace(owner, Allocation{category, "", {0, 0}});
+	Allocation& allocation = it->second;
+
+	if (allocation.category == category) {
+		return;
+	}
+
+	Remove(allocation.category, allocation.usage);
+	CheckBudget(allocation.category);
+
+	allocation.category = category;
+
+	Add(allocation.category, allocation.usage);
+	CheckBudget(allocation.category);
+}
+
+void MemoryTracker::SetLabel(const void* owner, const std::string& label) {
+	std::lock_guard lock(mutex);
+
+	auto it = allocations.find(owner);
+
+	if (it != allocations.end()) {
+		it->second.label = label;
+	}
+}
+
+MemoryTracker::Usage MemoryTracker::GetUsage(MemoryCategory category) {
+	std::lock_guard lock(mutex);
+
+	return totals[(int) category];
+}
+
+MemoryTracker::Usage MemoryTracker::GetUsage(const void* owner) {
+	std::lock_guard lock(mutex);
+
+	auto it = allocations.find(owner);
+
+	if (it == allocations.end()) {
+		return Usage{0, 0};
+	}
+
+	return it->second.usage;
+}
+
+MemoryTracker::Usage MemoryTracker::GetTotalUsage() {
+	std::lock_guard lock(mutex);
+
+	Usage result = {0, 0};
+
+	for (const Usage& total : totals) {
+		result.cpuBytes += total.cpuBytes;
+		result.gpuBytes += total.gpuBytes;
+	}
+
+	return result;
+}
+
+MemoryTracker::Budget MemoryTracker::GetBudget(MemoryCategory category) {
+	std::lock_guard lock(mutex);
+
+	return budgets[(int) category];
+}
+
+void MemoryTracker::SetBudget(MemoryCategory category, uint64_t cpuBytes, uint64_t gpuBytes) {
+	std::lock_guard lock(mutex);
+
+	budgets[(int) category] = Budget{cpuBytes, gpuBytes};
+	overBudget[(int) category] = false;
+
+	CheckBudget(category);
+}
+
+const char* MemoryTracker::GetName(MemoryCategory category) {
+	switch (category) {
+		case MemoryCategory::Meshes:           return "Meshes";
+		case MemoryCategory::Textures:         return "Textures";
+		case MemoryCategory::RenderTargets:    return "Render targets";
+		case MemoryCategory::ShadowMaps:       return "Shadow maps";
+		case MemoryCategory::ReflectionProbes: return "Reflection probes";
+		case MemoryCategory::PostProcessing:   return "Post processing";
+		default:                               return "Unknown";
+	}
+}
+
+const char* MemoryTracker::GetKey(MemoryCategory category) {
+	switch (category) {
+		case MemoryCategory::Meshes:           return "meshes";
+		case MemoryCategory::Textures:         return "textures";
+		case MemoryCategory::RenderTargets:    return "renderTargets";
+		case MemoryCategory::ShadowMaps:       return "shadowMaps";
+		case MemoryCategory::ReflectionProbes: return "reflectionProbes";
+		case MemoryCategory::PostProcessing:   return "postProcessing";
+		default:                               return "unknown";
+	}
+}
+
+std::string MemoryTracker::ToJSON() {
+	std::lock_guard lock(mutex);
+
+	uint64_t cpuBytes = 0;
+	uint64_t gpuBytes = 0;
+
+	std::string categories;
+
+	for (int i = 0; i < (int) MemoryCategory::Count; i++) {
+		cpuBytes += totals[i].cpuBytes;
+		gpuBytes += totals[i].gpuBytes;
+
+		categories += std::format(
+			"{}\"{}\":{{\"cpuBytes\":{},\"gpuBytes\":{},\"cpuBudget\":{},\"gpuBudget\":{}}}",
+			i > 0 ? "," : "",
+			GetKey((MemoryCategory) i),
+			totals[i].cpuBytes,
+			totals[i].gpuBytes,
+			budgets[i].cpuBytes,
+			budgets[i].gpuBytes
+		);
+	}
+
+	std::vector<const Allocation*> labeled;
+
+	for (const auto& [owner, allocation] : allocations) {
+		if (!allocation.label.empty()) {
+			labeled.push_back(&allocation);
+		}
+	}
+
+	std::sort(labeled.begin(), labeled.end(), [](const Allocation* a, const Allocation* b) {
+		return a->usage.cpuBytes + a->usage.gpuBytes > b->usage.cpuBytes + b->usage.gpuBytes;
+	});
+
+	std::string resources;
+
+	for (const Allocation* allocation : labeled) {
+		resources += std::format(
+			"{}{{\"path\":\"{}\",\"category\":\"{}\",\"cpuBytes\":{},\"gpuBytes\":{}}}",
+			resources.empty() ? "" : ",",
+			EscapeJSON(allocation->label),
+			GetKey(allocation->category),
+			allocation->usage.cpuBytes,
+			allocation->usage.gpuBytes
+		);
+	}
+
+	return std::format("{{\"cpuBytes\":{},\"gpuBytes\":{},\"categories\":{{{}}},\"resources\":[{}]}}", cpuBytes, gpuBytes, categories, resources);
+}
+
+bool MemoryTracker::Dump(const fs::path& path) {
+	std::ofstream file(path);
+
+	if (!file.is_open()) {
+		spdlog::error("Failed to open {} for the memory report", path.string());
+		return false;
+	}
+
+	file << ToJSON() << "\n";
+
+	return true;
+}
+
+void MemoryTracker::DrawImGui() {
+	if (ImGui::TreeNode("Memory")) {
+		{
+			std::lock_guard lock(mutex);
+
+			if (ImGui::BeginTable("Memory Categories", 3, ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV)) {
+				for (int i = 0; i < (int) MemoryCategory::Count; i++) {
+					ImGui::TableNextRow();
+
+					ImGui::TableSetColumnIndex(0);
+
+					if (overBudget[i]) {
+						ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "%s", GetName((MemoryCategory) i));
+					}
+					else {
+						ImGui::TextUnformatted(GetName((MemoryCategory) i));
+					}
+
+					ImGui::TableSetColumnIndex(1);
+					ImGui::Text("%s CPU", FormatBytes(totals[i].cpuBytes).c_str());
+
+					ImGui::TableSetColumnIndex(2);
+					ImGui::Text("%s GPU", FormatBytes(totals[i].gpuBytes).c_str());
+				}
+
+				ImGui::EndTable();
+			}
+
+			if (ImGui::TreeNode("Resources")) {
+				for (const auto& [owner, allocation] : allocations) {
+					if (allocation.label.empty()) {
+						continue;
+					}
+
+					ImGui::Text(
+						"%s: %s CPU, %s GPU",
+						allocation.label.c_str(),
+						FormatBytes(allocation.usage.cpuBytes).c_str(),
+						FormatBytes(allocation.usage.gpuBytes).c_str()
+					);
+				}
+
+				ImGui::TreePop();
+			}
+		}
+
+		if (ImGui::Button("Dump to memory.json")) {
+			Dump("memory.json");
+		}
+
+		ImGui::TreePop();
+	}
+}
\ No newline at end of file
@@ -2,37 +2,88 @@
 
 #include <vector>
 #include <map>
+#include <algorithm>
+#include <format>
+#include <fstream>
+#include <cstring>
+#include <climits>
+#include <cmath>
+#include <thread>
 #include <malloc.h>
 
 #include "assimp/Importer.hpp"
+#include <assimp/DefaultIOSystem.h>
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/packing.hpp>
 #include <glad/glad.h>
 
 #include <Formatters.h>
 #include <spdlog/spdlog.h>
 #include <Material.h>
 #include <Resources.h>
-
-inline glm::vec4 GetVec(aiVector3f source) {
-	return glm::vec4(
-		source.x,
-		source.y,
-		source.z,
-		0.0f
-	);
-}
-
-inline glm::vec4 GetVec(aiColor4D source) {
-	return glm::vec4(
-		source.r,
-		source.g,
-		source.b,
-		source.a
-	);
-}
+#include <MemoryTracker.h>
+#include <MappedFile.h>
+#include <MeshOptimizer.h>
+#include <ResourceLoader.h>
+#include <Profiler.h>
+
+#if defined(__SSE__) || defined(_M_X64)
+#include <xmmintrin.h>
+#endif
+
+constexpr uint32_t MESH_CACHE_MAGIC = 0x434D5A53; // "SZMC"
+// Bump whenever the conversion or the layout below changes, old files are then rebuilt
+constexpr uint32_t MESH_CACHE_VERSION = 7;
+constexpr uint64_t MESH_CACHE_ALIGNMENT = 16;
+
+// Vertices and faces converted by one import job, large meshes are split so they spread over the loader threads
+constexpr unsigned int IMPORT_CHUNK_SIZE = 1 << 16;
+// Staging used for meshes above the streaming threshold, peak memory stays near one ring on top of the GPU copy
+constexpr int STREAMING_SLOT_COUNT = 4;
+constexpr size_t STREAMING_SLOT_BYTES = 16 << 20;
+// Submeshes spanning fewer vertices than this get 16 bit indices
+constexpr unsigned int SHORT_INDEX_LIMIT = 1 << 16;
+// Packed meshes store positions as half floats when all of them are within this distance of the origin.
+// Half floats keep them within a thousandth of a unit there.
+constexpr float HALF_POSITION_LIMIT = 4.0f;
+// Each level of detail aims for this fraction of the triangles of the one before, levels that cannot get below
+// LOD_MIN_REDUCTION of it or would stray further than LOD_ERROR_LIMIT of the submesh size are dropped
+constexpr float LOD_REDUCTION = 0.5f;
+constexpr float LOD_MIN_REDUCTION = 0.8f;
+constexpr float LOD_ERROR_LIMIT = 0.05f;
+
+struct MeshCacheHeader {
+	uint32_t magic;
+	uint32_t version;
+	uint64_t key;
+	uint32_t vertexCount;
+	uint32_t vertexStride;
+	uint32_t materialCount;
+	uint32_t subMeshCount;
+	uint32_t materialTextureCount;
+	uint32_t vertexFormats;
+	uint32_t dependencyCount;
+	uint32_t padding;
+	uint64_t vertexOffset;
+};
+
+struct MeshCacheSubMesh {
+	uint32_t type;
+	int32_t materialIndex;
+	uint32_t faceCount;
+	uint32_t indexType;
+	uint32_t baseVertex;
+	uint32_t simplifiedCount;
+	uint64_t indexOffset;
+	uint32_t meshletCount;
+	uint32_t padding;
+	uint64_t meshletOffset;
+	BoundingBox bounds;
+	Mesh::SubMesh::LOD simplified[Mesh::SubMesh::MaxLODCount - 1];
+};
 
 // Mesh::SubMesh::SubMesh():
 // vertexCount(0),
@@ -44,45 +95,319 @@ inline glm::vec4 GetVec(aiColor4D source) {
 // materialIndex(0),
 // indexBuffer(0) { }
 
-void ReadVertex(const aiMesh* mesh, unsigned int vertexIndex, float* vertexData, const VertexSpec& spec) {
-	memset(vertexData, 0, spec.VertexSize() * sizeof(float));
+// Where each attribute sits inside a vertex, looked up once per import instead of once per vertex
+struct VertexLayout {
+	unsigned int stride;
+	unsigned int offsets[(int) VertexInputType::Color + 1];
+	unsigned int lengths[(int) VertexInputType::Color + 1];
+
+	VertexLayout(const VertexSpec& spec):
+	stride(spec.VertexSize()) {
+		unsigned int offset = 0;
+
+		for (int input = (int) VertexInputType::Position; input <= (int) VertexInputType::Color; input++) {
+			this->offsets[input] = offset;
+			this->lengths[input] = spec.GetLengthOf(VertexInputType(input));
+
+			offset += this->lengths[input];
+		}
+	}
+};
+
+template<unsigned int Length, typename T_Source>
+void CopyAttribute(const T_Source* source, unsigned int count, float* target, unsigned int stride) {
+	constexpr unsigned int sourceLength = sizeof(T_Source) / sizeof(float);
+
+	for (unsigned int i = 0; i < count; i++) {
+		const float* in = reinterpret_cast<const float*>(source + i);
+		float* out = target + i * stride;
+
+		for (unsigned int component = 0; component < Length; component++) {
+			out[component] = component < sourceLength ? in[component] : 0.0f;
+		}
+	}
+}
+
+template<typename T_Source>
+void CopyAttribute(const T_Source* source, unsigned int count, float* target, unsigned int stride, unsigned int length) {
+	switch (length) {
+		case 1: CopyAttribute<1>(source, count, target, stride); break;
+		case 2: CopyAttribute<2>(source, count, target, stride); break;
+		case 3: CopyAttribute<3>(source, count, target, stride); break;
+		default: CopyAttribute<4>(source, count, target, stride); break;
+	}
+}
+
+// Converts count vertices starting at first, one attribute at a time so the inner loops do not branch
+void ReadVertices(const aiMesh* mesh, unsigned int first, unsigned int count, float* vertexData, const VertexLayout& layout) {
+	memset(vertexData, 0, (size_t) count * layout.stride * sizeof(float));
+
+	auto read = [&](VertexInputType input, const auto* source) {
+		unsigned int length = layout.lengths[(int) input];
+
+		if (source && length) {
+			CopyAttribute(source + first, count, vertexData + layout.offsets[(int) input], layout.stride, length);
+		}
+	};
+
+	read(VertexInputType::Position, mesh->mVertices);
+	read(VertexInputType::Normal, mesh->mNormals);
+	read(VertexInputType::Binormal, mesh->mBitangents);
+	read(VertexInputType::Tangent, mesh->mTangents);
+	read(VertexInputType::UV1, mesh->mTextureCoords[0]);
+	read(VertexInputType::UV2, mesh->mTextureCoords[1]);
+	read(VertexInputType::Color, mesh->mColors[0]);
+}
+
+// Converts count vertices from the float layout used while importing into the formats of spec
+void PackVertices(const float* vertexData, unsigned int count, const VertexLayout& layout, const VertexSpec& spec, unsigned char* target) {
+	unsigned int stride = spec.VertexBytes();
+
+	for (int input = (int) VertexInputType::Position; input <= (int) VertexInputType::Color; input++) {
+		unsigned int length = layout.lengths[input];
+
+		if (!length) {
+			continue;
+		}
+
+		const float* source = vertexData + layout.offsets[input];
+		unsigned char* destination = target + spec.GetOffsetOf(VertexInputType(input));
+
+		auto pack = [&](auto write) {
+			for (unsigned int i = 0; i < count; i++) {
+				write(source + (size_t) i * layout.stride, destination + (size_t) i * stride);
+			}
+		};
+
+		auto vector = [length](const float* in) {
+			return glm::vec4(in[0], length > 1 ? in[1] : 0.0f, length > 2 ? in[2] : 0.0f, length > 3 ? in[3] : 0.0f);
+		};
+
+		switch (spec.GetFormatOf(VertexInputType(input))) {
+			case VertexFormat::Half:
+				pack([length](const float* in, unsigned char* out) {
+					uint16_t values[4] = {};
+
+					for (unsigned int component = 0; component < length; component++) {
+						values[component] = glm::packHalf1x16(in[component]);
+					}
+
+					memcpy(out, values, VertexSpec::GetSizeOf(VertexFormat::Half, length));
+				});
+				break;
+			case VertexFormat::Unorm16:
+				pack([length](const float* in, unsigned char* out) {
+					uint16_t values[4] = {};
+
+					for (unsigned int component = 0; component < length; component++) {
+						values[component] = glm::packUnorm1x16(in[component]);
+					}
+
+					memcpy(out, values, VertexSpec::GetSizeOf(VertexFormat::Unorm16, length));
+				});
+				break;
+			case VertexFormat::Snorm10:
+				pack([&](const float* in, unsigned char* out) {
+					uint32_t value = glm::packSnorm3x10_1x2(vector(in));
+
+					memcpy(out, &value, sizeof(value));
+				});
+				break;
+			case VertexFormat::Unorm8:
+				pack([&](const float* in, unsigned char* out) {
+					uint32_t value = glm::packUnorm4x8(vector(in));
+
+					memcpy(out, &value, sizeof(value));
+				});
+				break;
+			default:
+				pack([length](const float* in, unsigned char* out) {
+					memcpy(out, in, length * sizeof(float));
+				});
+				break;
+		}
+	}
+}
+
+GLenum GetAttributeType(VertexFormat format) {
+	switch (format) {
+		case VertexFormat::Half: return GL_HALF_FLOAT;
+		case VertexFormat::Unorm16: return GL_UNSIGNED_SHORT;
+		case VertexFormat::Snorm10: return GL_INT_2_10_10_10_REV;
+		case VertexFormat::Unorm8: return GL_UNSIGNED_BYTE;
+		default: return GL_FLOAT;
+	}
+}
+
+// Grows minCorner and maxCorner to contain count positions spaced stride floats apart
+void GrowBounds(const float* positions, unsigned int count, unsigned int stride, glm::vec3& minCorner, glm::vec3& maxCorner) {
+	unsigned int i = 0;
+
+#if defined(__SSE__) || defined(_M_X64)
+	__m128 low = _mm_setr_ps(minCorner.x, minCorner.y, minCorner.z, 0.0f);
+	__m128 high = _mm_setr_ps(maxCorner.x, maxCorner.y, maxCorner.z, 0.0f);
+
+	// Loads read one float past the position, so the last one is left to the scalar loop.
+	// The position goes first so NaNs are skipped the same way the comparisons below skip them.
+	for (; i + 1 < count; i++) {
+		__m128 position = _mm_loadu_ps(positions + (size_t) i * stride);
+
+		low = _mm_min_ps(position, low);
+		high = _mm_max_ps(position, high);
+	}
+
+	alignas(16) float lowLanes[4];
+	alignas(16) float highLanes[4];
+
+	_mm_store_ps(lowLanes, low);
+	_mm_store_ps(highLanes, high);
+
+	minCorner = glm::vec3(lowLanes[0], lowLanes[1], lowLanes[2]);
+	maxCorner = glm::vec3(highLanes[0], highLanes[1], highLanes[2]);
+#endif
+
+	for (; i < count; i++) {
+		const float* position = positions + (size_t) i * stride;
+
+		for (int axis = 0; axis < 3; axis++) {
+			if (position[axis] < minCorner[axis]) {
+				minCorner[axis] = position[axis];
+			}
+			if (position[axis] > maxCorner[axis]) {
+				maxCorner[axis] = position[axis];
+			}
+		}
+	}
+}
+
+// Writes count indices in the given type, 16 bit ones relative to baseVertex
+void StoreIndices(const unsigned int* indices, unsigned int count, GLenum indexType, unsigned int baseVertex, void* target) {
+	if (indexType == GL_UNSIGNED_INT) {
+		memcpy(target, indices, (size_t) count * sizeof(unsigned int));
+		return;
+	}
+
+	uint16_t* shortIndices = (uint16_t*) target;
+
+	for (unsigned int i = 0; i < count; i++) {
+		shortIndices[i] = (uint16_t) (indices[i] - baseVertex);
+	}
+}
+
+// Persistently mapped upload buffer split into slots, each fenced until the GPU has copied out of it
+class StagingRing {
+private:
+	GLuint buffer;
+	unsigned char* mapped;
+	size_t slotSize;
+	std::vector<GLsync> fences;
+public:
+	StagingRing(size_t slotSize, int slotCount):
+	buffer(0),
+	mapped(nullptr),
+	slotSize(slotSize),
+	fences(slotCount, nullptr) {
+		GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+		glCreateBuffers(1, &this->buffer);
+		glNamedBufferStorage(this->buffer, slotSize * slotCount, nullptr, flags | GL_CLIENT_STORAGE_BIT);
+
+		this->mapped = (unsigned char*) glMapNamedBufferRange(this->buffer, 0, slotSize * slotCount, flags);
+	}
+
+	~StagingRing() {
+		for (GLsync fence : this->fences) {
+			if (fence) {
+				glDeleteSync(fence);
+			}
+		}
+
+		glUnmapNamedBuffer(this->buffer);
+		glDeleteBuffers(1, &this->buffer);
+	}
+
+	size_t GetSlotSize() const {
+		return this->slotSize;
+	}
+
+	int GetSlotCount() const {
+		return this->fences.size();
+	}
+
+	// Blocks until the copies issued from the slot last time around are done
+	unsigned char* Acquire(int slot) {
+		if (GLsync fence = this->fences[slot]) {
+			while (glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000) == GL_TIMEOUT_EXPIRED) { }
+
+			glDeleteSync(fence);
+			this->fences[slot] = nullptr;
+		}
 
-	glm::vec4* dataPointer = reinterpret_cast<glm::vec4*>(vertexData);
+		return this->mapped + slot * this->slotSize;
+	}
 
-	if (mesh->HasPositions() && spec.GetLengthOf(VertexInputType::Position)) {
-		*dataPointer = GetVec(mesh->mVertices[vertexIndex]);
+	void Copy(int slot, size_t slotOffset, GLuint target, size_t targetOffset, size_t size) {
+		glCopyNamedBufferSubData(this->buffer, target, slot * this->slotSize + slotOffset, targetOffset, size);
 	}
-	dataPointer = reinterpret_cast<glm::vec4*>(reinterpret_cast<float*>(dataPointer) + spec.GetLengthOf(VertexInputType::Position));
 
-	if (mesh->HasNormals() && spec.GetLengthOf(VertexInputType::Normal)) {
-		*dataPointer = GetVec(mesh->mNormals[vertexIndex]);			
+	void Release(int slot) {
+		this->fences[slot] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
 	}
-	dataPointer = reinterpret_cast<glm::vec4*>(reinterpret_cast<float*>(dataPointer) + spec.GetLengthOf(VertexInputType::Normal));
 
-	if (mesh->HasTangentsAndBitangents() && spec.GetLengthOf(VertexInputType::Binormal)) {
-		*dataPointer = GetVec(mesh->mBitangents[vertexIndex]);
+	// Copies size bytes from data into target one slot at a time
+	void Stream(const void* data, GLuint target, size_t size) {
+		const unsigned char* bytes = static_cast<const unsigned char*>(data);
+
+		for (size_t offset = 0, slot = 0; offset < size; offset += this->slotSize, slot = (slot + 1) % GetSlotCount()) {
+			size_t chunkSize = std::min(this->slotSize, size - offset);
+
+			memcpy(Acquire(slot), bytes + offset, chunkSize);
+			Copy(slot, 0, target, offset, chunkSize);
+			Release(slot);
+		}
 	}
-	dataPointer = reinterpret_cast<glm::vec4*>(reinterpret_cast<float*>(dataPointer) + spec.GetLengthOf(VertexInputType::Binormal));
+};
 
-	if (mesh->HasTangentsAndBitangents() && spec.GetLengthOf(VertexInputType::Tangent)) {
-		*dataPointer = GetVec(mesh->mTangents[vertexIndex]);
+// Notes every file Assimp opens, so the cache also goes stale when a file the model refers to changes
+class RecordingIOSystem : public Assimp::DefaultIOSystem {
+public:
+	std::vector<std::string> opened;
+
+	Assimp::IOStream* Open(const char* file, const char* mode) override {
+		Assimp::IOStream* stream = Assimp::DefaultIOSystem::Open(file, mode);
+
+		if (stream && std::find(this->opened.begin(), this->opened.end(), file) == this->opened.end()) {
+			this->opened.push_back(file);
+		}
+
+		return stream;
 	}
-	dataPointer = reinterpret_cast<glm::vec4*>(reinterpret_cast<float*>(dataPointer) + spec.GetLengthOf(VertexInputType::Tangent));
+};
 
-	if (mesh->HasTextureCoords(0) && spec.GetLengthOf(VertexInputType::UV1)) {
-		*dataPointer = GetVec(mesh->mTextureCoords[0][vertexIndex]);
+static const aiScene* ReadScene(Assimp::Importer& importer, const fs::path& modelPath, std::vector<fs::path>& dependencies) {
+	if (!fs::exists(modelPath) || !fs::is_regular_file(modelPath)) {
+		return nullptr;
 	}
-	dataPointer = reinterpret_cast<glm::vec4*>(reinterpret_cast<float*>(dataPointer) + spec.GetLengthOf(VertexInputType::UV1));
 
-	if (mesh->HasTextureCoords(1) && spec.GetLengthOf(VertexInputType::UV2)) {
-		*dataPointer = GetVec(mesh->mTextureCoords[0][vertexIndex]);
+	// Owned by the importer
+	RecordingIOSystem* ioSystem = new RecordingIOSystem();
+	importer.SetIOHandler(ioSystem);
+
+	const aiScene* loaded_scene = importer.ReadFile(modelPath.string(), 
+		aiProcess_Triangulate | aiProcess_CalcTangentSpace
+	);
+
+	for (const std::string& file : ioSystem->opened) {
+		if (file != modelPath.string()) {
+			dependencies.push_back(file);
+		}
 	}
-	dataPointer = reinterpret_cast<glm::vec4*>(reinterpret_cast<float*>(dataPointer) + spec.GetLengthOf(VertexInputType::UV2));
-	
-	if (mesh->HasVertexColors(0) && spec.GetLengthOf(VertexInputType::Color)) {
-		*dataPointer = GetVec(mesh->mTextureCoords[0][vertexIndex]);
+
+	if (!loaded_scene || !loaded_scene->HasMeshes()) {
+		return nullptr;
 	}
-	dataPointer = reinterpret_cast<glm::vec4*>(reinterpret_cast<float*>(dataPointer) + spec.GetLengthOf(VertexInputType::Color));
+
+	return loaded_scene;
 }
 
 Mesh::MeshType Mesh::SubMesh::GetType() const {
@@ -115,6 +440,10 @@ GLuint Mesh::SubMesh::GetIndexBufferHandle() const {
 	return this->handle.indexBuffer;
 }
 
+GLuint Mesh::SubMesh::GetMeshletBufferHandle() const {
+	return this->handle.meshletBuffer;
+}
+
 BoundingBox Mesh::SubMesh::GetBounds() const {
 	return this->bounds;
 }
@@ -127,27 +456,124 @@ unsigned int Mesh::SubMesh::GetFaceCount() const {
 	return this->faceCount;
 }
 
+GLenum Mesh::SubMesh::GetIndexType() const {
+	return this->indexType;
+}
+
+unsigned int Mesh::SubMesh::GetIndexSize() const {
+	return this->indexType == GL_UNSIGNED_SHORT ? sizeof(uint16_t) : sizeof(unsigned int);
+}
+
+unsigned int Mesh::SubMesh::GetLODCount() const {
+	return this->simplifiedCount + 1;
+}
+
+Mesh::SubMesh::LOD Mesh::SubMesh::GetLOD(unsigned int level) const {
+	if (level == 0 || level > this->simplifiedCount) {
+		return { 0, GetVertexCount(), 0.0f };
+	}
+
+	return this->simplified[level - 1];
+}
+
+unsigned int Mesh::SubMesh::GetIndexCount() const {
+	if (this->simplifiedCount == 0) {
+		return GetVertexCount();
+	}
+
+	const LOD& last = this->simplified[this->simplifiedCount - 1];
+
+	return last.firstIndex + last.indexCount;
+}
+
+uint64_t Mesh::SubMesh::GetIndexBytes() const {
+	return (uint64_t) GetIndexCount() * GetIndexSize();
+}
+
+unsigned int Mesh::SubMesh::GetBaseVertex() const {
+	return this->baseVertex;
+}
+
+void Mesh::SubMesh::PackIndices() {
+	unsigned int indexCount = GetIndexCount();
+
+	if (!this->indexData || this->indexType != GL_UNSIGNED_INT || indexCount == 0) {
+		return;
+	}
+
+	const unsigned int* indices = (const unsigned int*) this->indexData;
+	auto [low, high] = std::minmax_element(indices, indices + indexCount);
+	unsigned int baseVertex = *low;
+
+	if (*high - baseVertex >= SHORT_INDEX_LIMIT) {
+		return;
+	}
+
+	unsigned char* packed = new unsigned char[(size_t) indexCount * sizeof(uint16_t)];
+
+	StoreIndices(indices, indexCount, GL_UNSIGNED_SHORT, baseVertex, packed);
+
+	delete[] (unsigned char*) this->indexData;
+
+	this->indexData = packed;
+	this->indexType = GL_UNSIGNED_SHORT;
+	this->baseVertex = baseVertex;
+}
+
+bool Mesh::keepCPUData = false;
+bool Mesh::packVertices = true;
+bool Mesh::buildMeshlets = false;
+uint64_t Mesh::streamingThreshold = 256ull << 20;
+fs::path Mesh::cacheDirectory = "./cache/meshes";
+
+Mesh::Mesh():
+materialCount(0),
+vertexCount(0),
+vertexData(nullptr),
+vertexSpec(VertexSpec::Mesh),
+vertexStride(0),
+vertexBuffer(0),
+cacheFile(nullptr) { }
+
 Mesh::~Mesh() {
-	delete this->vertexData;
-	glDeleteBuffers(1, &this->vertexBuffer);
+	MemoryTracker::Untrack(this);
+
+	if (!this->cacheFile) {
+		delete[] this->vertexData;
+	}
+
+	if (this->vertexBuffer) {
+		glDeleteBuffers(1, &this->vertexBuffer);
+	}
 
 	for (auto& submesh : this->subMeshes) {
-		delete submesh.indexData;
+		if (!this->cacheFile) {
+			delete[] (unsigned char*) submesh.indexData;
+			delete[] submesh.meshlets;
+		}
+
+		if (submesh.handle.vertexArray) {
+			glDeleteBuffers(1, &submesh.handle.indexBuffer);
+			glDeleteVertexArrays(1, &submesh.handle.vertexArray);
+		}
 
-		glDeleteBuffers(1, &submesh.handle.indexBuffer);
-		glDeleteVertexArrays(1, &submesh.handle.vertexArray);
+		if (submesh.handle.meshletBuffer) {
+			glDeleteBuffers(1, &submesh.handle.meshletBuffer);
+		}
 	}
 
 	for (auto* mat : this->materials) {
 		delete mat;
 	}
+
+	delete this->cacheFile;
 }
 
 unsigned int Mesh::GetMaterialsCount() const {
 	return this->materialCount;
 }
 
-std::vector<Material*> Mesh::GetDefaultMaterials() const {
+const std::vector<Material*>& Mesh::GetDefaultMaterials() const {
 	return this->materials;
 }
 
@@ -155,7 +581,7 @@ unsigned int Mesh::GetSubMeshCount() const {
 	return this->subMeshes.size();
 }
 
-std::vector<Mesh::SubMesh> Mesh::GetSubMeshes() const {
+std::span<const Mesh::SubMesh> Mesh::GetSubMeshes() const {
 	return this->subMeshes;
 }
 
@@ -167,38 +593,90 @@ const Mesh::SubMesh& Mesh::operator[](unsigned int index) const {
 	return SubMeshAt(index);
 }
 
-Mesh* Mesh::Load(fs::path modelPath, bool loadMaterials) {
-	if (!fs::exists(modelPath) || !fs::is_regular_file(modelPath)) {
-		return nullptr;
+// Where every aiMesh of a scene ends up, worked out up front so the meshes can be converted in independent chunks
+struct Mesh::ImportPlan {
+	struct Placement {
+		int subMesh;
+		unsigned int firstVertex;
+		unsigned int firstFace;
+		int lastChunk;
+	};
+
+	struct Chunk {
+		unsigned int mesh;
+		unsigned int firstVertex;
+		unsigned int vertexCount;
+		unsigned int firstFace;
+		unsigned int faceCount;
+		glm::vec3 minCorner;
+		glm::vec3 maxCorner;
+		float uvMin[2];
+		float uvMax[2];
+	};
+
+	// Vertices are converted to floats in layout first, then packed into the formats of spec
+	VertexLayout layout;
+	VertexSpec spec;
+	std::vector<SubMesh> subMeshes;
+	std::vector<Placement> placements;
+	std::vector<Chunk> chunks;
+	unsigned int vertexCount;
+	int subMeshCount;
+	int materialsCount;
+
+	ImportPlan(const VertexSpec& spec):
+	layout(spec),
+	spec(spec),
+	vertexCount(0),
+	subMeshCount(0),
+	materialsCount(0) { }
+
+	uint64_t GetVertexBytes() const {
+		return (uint64_t) this->vertexCount * this->spec.VertexBytes();
 	}
 
-	Assimp::Importer importer{};
+	// Bounds cover the whole vertex range of every mesh merged into a submesh, including vertices no face uses
+	void GetSubMeshCorners(std::vector<glm::vec3>& minCorners, std::vector<glm::vec3>& maxCorners) const {
+		minCorners.assign(this->subMeshes.size(), glm::vec3(INFINITY));
+		maxCorners.assign(this->subMeshes.size(), glm::vec3(-INFINITY));
 
-	const aiScene* loaded_scene = importer.ReadFile(modelPath.string(), 
-		aiProcess_Triangulate | aiProcess_CalcTangentSpace
-	);
+		for (const Chunk& chunk : this->chunks) {
+			int subMeshIndex = this->placements[chunk.mesh].subMesh;
 
-	if (!loaded_scene || !loaded_scene->HasMeshes()) {
-		return nullptr;
+			minCorners[subMeshIndex] = glm::min(minCorners[subMeshIndex], chunk.minCorner);
+			maxCorners[subMeshIndex] = glm::max(maxCorners[subMeshIndex], chunk.maxCorner);
+		}
 	}
 
-	spdlog::info("Loading mesh {}", modelPath.string());
-	
+	uint64_t GetConvertedBytes() const {
+		uint64_t bytes = GetVertexBytes();
+
+		for (const SubMesh& subMesh : this->subMeshes) {
+			bytes += subMesh.GetIndexBytes();
+		}
+
+		return bytes;
+	}
+};
+
+Mesh::ImportPlan Mesh::PlanImport(const aiScene* loaded_scene, const fs::path& modelPath) {
+	ImportPlan plan(VertexSpec::Mesh);
+
 	// Three submeshes for each material:
 	// - One with points
 	// - One with lines
 	// - One with triangles
 	// SubMesh subMeshes[loaded_scene->mNumMaterials * 3];
-	std::vector<SubMesh> subMeshes(loaded_scene->mNumMaterials * 3);
+	std::vector<SubMesh>& subMeshes = plan.subMeshes;
+	subMeshes.resize(loaded_scene->mNumMaterials * 3);
 
 	for (int subMeshIndex = 0; subMeshIndex < loaded_scene->mNumMaterials * 3; subMeshIndex++) {
 		subMeshes[subMeshIndex].type = MeshType((subMeshIndex % 3) + 1);
 		subMeshes[subMeshIndex].materialIndex = subMeshIndex / 3;
+		subMeshes[subMeshIndex].indexType = GL_UNSIGNED_INT;
 	}
 
-	unsigned int vertexCount = 0;
-
-	VertexSpec meshSpec = VertexSpec::Mesh;
+	plan.placements.resize(loaded_scene->mNumMeshes, { -1, 0, 0, -1 });
 
 	for (unsigned int meshIndex = 0; meshIndex < loaded_scene->mNumMeshes; meshIndex++) {
 		const aiMesh* currentMesh = loaded_scene->mMeshes[meshIndex];
@@ -207,111 +685,176 @@ Mesh* Mesh::Load(fs::path modelPath, bool loadMaterials) {
 		bool hasLines = (currentMesh->mPrimitiveTypes & aiPrimitiveType_LINE) != 0;
 		bool hasTriangles = (currentMesh->mPrimitiveTypes & aiPrimitiveType_TRIANGLE) != 0;
 
-		bool isSimple = (hasPoints + hasLines + hasTriangles) <= 1;
-
-		if (isSimple) {
-			if (hasPoints) {
-				SubMesh& pointsMesh = subMeshes[currentMesh->mMaterialIndex * 3];
+		bool isSimple = (hasPoints + hasLines + hasTriangles) == 1;
 
-				pointsMesh.faceCount += currentMesh->mNumFaces;
+		if (!isSimple) {
+			if (hasPoints || hasLines || hasTriangles) {
+				spdlog::warn("{}/{}: Meshes with mixed primitive types are unsupported", modelPath.string(), currentMesh->mName.C_Str());
 			}
-			else if (hasLines) {
-				SubMesh& linesMesh = subMeshes[currentMesh->mMaterialIndex * 3 + 1];
 
-				linesMesh.faceCount += currentMesh->mNumFaces;
-			}
-			else if (hasTriangles) {
-				SubMesh& trianglesMesh = subMeshes[currentMesh->mMaterialIndex * 3 + 2];
+			continue;
+		}
+
+		int primitiveN = hasLines + (2 * hasTriangles);
+		int subMeshIndex = currentMesh->mMaterialIndex * 3 + primitiveN;
+
+		ImportPlan::Placement& placement = plan.placements[meshIndex];
+		placement.subMesh = subMeshIndex;
+		placement.firstVertex = plan.vertexCount;
+		placement.firstFace = subMeshes[subMeshIndex].faceCount;
+
+		for (unsigned int first = 0; first < std::max(currentMesh->mNumVertices, currentMesh->mNumFaces); first += IMPORT_CHUNK_SIZE) {
+			ImportPlan::Chunk chunk{};
+			chunk.mesh = meshIndex;
+			chunk.firstVertex = std::min(first, currentMesh->mNumVertices);
+			chunk.vertexCount = std::min(currentMesh->mNumVertices - chunk.firstVertex, IMPORT_CHUNK_SIZE);
+			chunk.firstFace = std::min(first, currentMesh->mNumFaces);
+			chunk.faceCount = std::min(currentMesh->mNumFaces - chunk.firstFace, IMPORT_CHUNK_SIZE);
+			chunk.minCorner = glm::vec3(INFINITY);
+			chunk.maxCorner = glm::vec3(-INFINITY);
+			chunk.uvMin[0] = chunk.uvMin[1] = INFINITY;
+			chunk.uvMax[0] = chunk.uvMax[1] = -INFINITY;
+
+			placement.lastChunk = plan.chunks.size();
+			plan.chunks.push_back(chunk);
+		}
+
+		subMeshes[subMeshIndex].faceCount += currentMesh->mNumFaces;
+		plan.vertexCount += currentMesh->mNumVertices;
+	}
+
+	// From the source positions, the converted ones may sit in write combined memory that is slow to read
+	ResourceLoader::ParallelFor(plan.chunks.size(), [&](int chunkIndex) {
+		ImportPlan::Chunk& chunk = plan.chunks[chunkIndex];
+		const aiMesh* currentMesh = loaded_scene->mMeshes[chunk.mesh];
+
+		if (currentMesh->mVertices) {
+			GrowBounds(&currentMesh->mVertices[chunk.firstVertex].x, chunk.vertexCount, sizeof(currentMesh->mVertices[0]) / sizeof(float), chunk.minCorner, chunk.maxCorner);
+		}
+
+		for (int set = 0; set < 2; set++) {
+			const aiVector3D* uvs = currentMesh->mTextureCoords[set];
+
+			for (unsigned int i = 0; uvs && i < chunk.vertexCount; i++) {
+				const aiVector3D& uv = uvs[chunk.firstVertex + i];
 
-				trianglesMesh.faceCount += currentMesh->mNumFaces;
+				chunk.uvMin[set] = std::min({ chunk.uvMin[set], uv.x, uv.y });
+				chunk.uvMax[set] = std::max({ chunk.uvMax[set], uv.x, uv.y });
 			}
 		}
-		else {
-			spdlog::warn("{}/{}: Meshes with mixed primitive types are unsupported", modelPath.string(), currentMesh->mName.C_Str());
-			
-			continue;
+	});
+
+	if (packVertices) {
+		glm::vec3 minCorner(INFINITY);
+		glm::vec3 maxCorner(-INFINITY);
+		float uvMin[2] = { INFINITY, INFINITY };
+		float uvMax[2] = { -INFINITY, -INFINITY };
+
+		for (const ImportPlan::Chunk& chunk : plan.chunks) {
+			minCorner = glm::min(minCorner, chunk.minCorner);
+			maxCorner = glm::max(maxCorner, chunk.maxCorner);
+
+			for (int set = 0; set < 2; set++) {
+				uvMin[set] = std::min(uvMin[set], chunk.uvMin[set]);
+				uvMax[set] = std::max(uvMax[set], chunk.uvMax[set]);
+			}
 		}
 
-		vertexCount += currentMesh->mNumVertices;
-	}
+		// Unit vectors and colours always fit, positions and UVs only when their range does
+		plan.spec = plan.spec.WithFormat(VertexInputType::Normal, VertexFormat::Snorm10)
+			.WithFormat(VertexInputType::Binormal, VertexFormat::Snorm10)
+			.WithFormat(VertexInputType::Tangent, VertexFormat::Snorm10)
+			.WithFormat(VertexInputType::Color, VertexFormat::Unorm8);
+
+		float positionRange = std::max({ -minCorner.x, -minCorner.y, -minCorner.z, maxCorner.x, maxCorner.y, maxCorner.z });
 
-	int subMeshCount = 0;
-	
-	int* materialRemap = (int*) alloca(sizeof(int) * loaded_scene->mNumMaterials);
-	for (int i = 0; i < loaded_scene->mNumMaterials; i++) {
-		materialRemap[i] = -1;
+		if (positionRange <= HALF_POSITION_LIMIT) {
+			plan.spec = plan.spec.WithFormat(VertexInputType::Position, VertexFormat::Half);
+		}
+
+		for (int set = 0; set < 2; set++) {
+			if (uvMin[set] >= 0.0f && uvMax[set] <= 1.0f) {
+				plan.spec = plan.spec.WithFormat(VertexInputType(int(VertexInputType::UV1) + set), VertexFormat::Unorm16);
+			}
+		}
 	}
 
 	for (int i = 0; i < subMeshes.size(); i++) {
 		if (subMeshes[i].faceCount) {
-			subMeshCount++;
+			plan.subMeshCount++;
+		}
+	}
 
-			subMeshes[i].indexData = new unsigned int[subMeshes[i].faceCount * (unsigned int) subMeshes[i].type];
+	// Submeshes keep the material indices of the scene until RemapMaterials, the cache stores them like that
+	plan.materialsCount = loaded_scene->mNumMaterials;
 
-			subMeshes[i].faceCount = 0;
+	return plan;
+}
 
-			for (int materialIndex = 0; materialIndex < loaded_scene->mNumMaterials; materialIndex++) {
-				if (materialRemap[materialIndex] == -1) {
-					materialRemap[materialIndex] = subMeshes[i].materialIndex;
-				}
+void Mesh::RemapMaterials(bool loadMaterials) {
+	if (this->subMeshes.empty()) {
+		this->materialCount = 0;
+	}
 
-				if (!loadMaterials) {
-					if (materialRemap[materialIndex] == subMeshes[i].materialIndex) {
-						subMeshes[i].materialIndex = materialIndex;
-	
-						break;
-					}
-				}
-			}
-		}
+	if (loadMaterials || this->subMeshes.empty()) {
+		return;
 	}
 
-	int materialsCount = 0;
+	// Without materials of their own, the used ones are packed into the first slots in the order of the scene
+	std::vector<int> materialRemap(this->materialCount, -1);
 
-	for (int i = 0; i < loaded_scene->mNumMaterials; i++) {
-		materialsCount += materialRemap[i] >= 0;
+	for (const SubMesh& subMesh : this->subMeshes) {
+		materialRemap[subMesh.materialIndex] = 0;
 	}
 
-	float* vertexData = new float[vertexCount * meshSpec.VertexSize() + 3];
-	int vertexPointer = 0;
+	int usedCount = 0;
 
-	for (unsigned int meshIndex = 0; meshIndex < loaded_scene->mNumMeshes; meshIndex++) {
-		const aiMesh* currentMesh = loaded_scene->mMeshes[meshIndex];
+	for (int& slot : materialRemap) {
+		if (slot >= 0) {
+			slot = usedCount++;
+		}
+	}
 
-		bool hasPoints = (currentMesh->mPrimitiveTypes & aiPrimitiveType_POINT) != 0;
-		bool hasLines = (currentMesh->mPrimitiveTypes & aiPrimitiveType_LINE) != 0;
-		bool hasTriangles = (currentMesh->mPrimitiveTypes & aiPrimitiveType_TRIANGLE) != 0;
+	for (SubMesh& subMesh : this->subMeshes) {
+		subMesh.materialIndex = materialRemap[subMesh.materialIndex];
+	}
 
-		bool isSimple = (hasPoints + hasLines + hasTriangles) == 1;
+	this->materialCount = usedCount;
+}
 
-		if (!isSimple) {
-			continue;
-		}
+void Mesh::ConvertChunk(const aiScene* loaded_scene, ImportPlan& plan, int chunkIndex, float* vertexData, unsigned int* indexData) {
+	ImportPlan::Chunk& chunk = plan.chunks[chunkIndex];
 
-		int primitiveN = hasLines + (2 * hasTriangles);
+	const aiMesh* currentMesh = loaded_scene->mMeshes[chunk.mesh];
+	const ImportPlan::Placement& placement = plan.placements[chunk.mesh];
 
-		SubMesh& targetSubMesh = subMeshes[currentMesh->mMaterialIndex * 3 + primitiveN];
+	unsigned int verticesPerFace = (unsigned int) plan.subMeshes[placement.subMesh].type;
 
-		for (unsigned int faceIndex = 0; faceIndex < currentMesh->mNumFaces; faceIndex++) {
-			unsigned int baseIndex = (targetSubMesh.faceCount + faceIndex) * (primitiveN + 1);
-			targetSubMesh.indexData[baseIndex + 0] = currentMesh->mFaces[faceIndex].mIndices[0] + vertexPointer;
+	for (unsigned int faceIndex = 0; faceIndex < chunk.faceCount; faceIndex++) {
+		const aiFace& face = currentMesh->mFaces[chunk.firstFace + faceIndex];
 
-			if (primitiveN > 0) {
-				targetSubMesh.indexData[baseIndex + 1] = currentMesh->mFaces[faceIndex].mIndices[1] + vertexPointer;
-			}
-			if (primitiveN > 1) {
-				targetSubMesh.indexData[baseIndex + 2] = currentMesh->mFaces[faceIndex].mIndices[2] + vertexPointer;
-			}
+		for (unsigned int i = 0; i < verticesPerFace; i++) {
+			indexData[faceIndex * verticesPerFace + i] = face.mIndices[i] + placement.firstVertex;
 		}
+	}
 
-		targetSubMesh.faceCount += currentMesh->mNumFaces;
+	// Meshes with more faces than vertices end in chunks of faces only
+	if (chunk.vertexCount > 0) {
+		ReadVertices(currentMesh, chunk.firstVertex, chunk.vertexCount, vertexData, plan.layout);
+	}
+}
 
-		for (unsigned int vertexIndex = 0; vertexIndex < currentMesh->mNumVertices; vertexIndex++) {
-			float* currentVertex = vertexData + vertexPointer * meshSpec.VertexSize();
+Mesh* Mesh::FinishImport(ImportPlan& plan, unsigned char* vertexData) {
+	std::vector<SubMesh>& subMeshes = plan.subMeshes;
 
-			ReadVertex(currentMesh, vertexIndex, currentVertex, meshSpec);
+	std::vector<glm::vec3> minCorners;
+	std::vector<glm::vec3> maxCorners;
 
-			vertexPointer += 1;
+	plan.GetSubMeshCorners(minCorners, maxCorners);
+
+	for (int i = 0; i < subMeshes.size(); i++) {
+		if (subMeshes[i].faceCount) {
+			subMeshes[i].bounds = BoundingBox(minCorners[i], maxCorners[i]);
 		}
 	}
 
@@ -319,136 +862,887 @@ Mesh* Mesh::Load(fs::path modelPath, bool loadMaterials) {
 		return a.faceCount > b.faceCount;
 	});
 
-	subMeshes.resize(subMeshCount);
-
-	for (SubMesh& subMesh : subMeshes) {
-		glm::vec3 minCorner = glm::vec3(INFINITY);
-		glm::vec3 maxCorner = glm::vec3(-INFINITY);
-
-		for (int faceIndex = 0; faceIndex < subMesh.faceCount; faceIndex++) {
-			int verticesPerFace = (int) subMesh.type;
-
-			for (int i = 0; i < verticesPerFace; i++) {
-				glm::vec3 vertex = *(glm::vec3*) (vertexData + meshSpec.VertexSize() * subMesh.indexData[faceIndex * verticesPerFace + i]);
-
-				if (vertex.x < minCorner.x) {
-					minCorner.x = vertex.x;
-				}
-				if (vertex.y < minCorner.y) {
-					minCorner.y = vertex.y;
-				}
-				if (vertex.z < minCorner.z) {
-					minCorner.z = vertex.z;
-				}
-
-				if (vertex.x > maxCorner.x) {
-					maxCorner.x = vertex.x;
-				}
-				if (vertex.y > maxCorner.y) {
-					maxCorner.y = vertex.y;
-				}
-				if (vertex.z > maxCorner.z) {
-					maxCorner.z = vertex.z;
-				}
-			}
-		}
+	subMeshes.resize(plan.subMeshCount);
 
-		subMesh.bounds = BoundingBox(minCorner, maxCorner);
-	}
+	Mesh* loadedMesh = new Mesh();
+	loadedMesh->subMeshes = subMeshes;
+	loadedMesh->materialCount = plan.materialsCount;
+	loadedMesh->vertexCount = plan.vertexCount;
+	loadedMesh->vertexData = vertexData;
+	loadedMesh->vertexSpec = plan.spec;
+	loadedMesh->vertexStride = plan.spec.VertexBytes();
 
-	GLuint vertexBuffer;
-	glGenBuffers(1, &vertexBuffer);
-	
-	glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
-	glBufferData(GL_ARRAY_BUFFER, vertexCount * meshSpec.VertexSize() * sizeof(float), vertexData, GL_STATIC_DRAW);
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	loadedMesh->TrackMemory();
 
-	for (int subMeshIndex = 0; subMeshIndex < subMeshCount; subMeshIndex++) {
-		GLuint subMeshVertexArray, subMeshIndexBuffer;
+	return loadedMesh;
+}
 
-		glGenVertexArrays(1, &subMeshVertexArray);
-		glGenBuffers(1, &subMeshIndexBuffer);
+void Mesh::OptimizeImport(ImportPlan& plan, float* vertexData) {
+	PROFILE_ZONE("Mesh::OptimizeImport");
 
-		subMeshes[subMeshIndex].handle.vertexArray = subMeshVertexArray;
-		subMeshes[subMeshIndex].handle.indexBuffer = subMeshIndexBuffer;
+	std::vector<SubMesh>& subMeshes = plan.subMeshes;
+	const float* positions = vertexData + plan.layout.offsets[(int) VertexInputType::Position];
 
-		glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+	std::vector<glm::vec3> minCorners;
+	std::vector<glm::vec3> maxCorners;
 
-		glBindVertexArray(subMeshVertexArray);
+	plan.GetSubMeshCorners(minCorners, maxCorners);
 
-		unsigned int attributeOffset = 0;
-		for (int input = int(VertexInputType::Position) - 1; input < int(VertexInputType::Color); input++) {
-			int length = meshSpec.GetLengthOf(VertexInputType(input + 1));
+	ResourceLoader::ParallelFor(subMeshes.size(), [&](int i) {
+		SubMesh& subMesh = subMeshes[i];
 
-			if (length > 0) {
-				glVertexAttribPointer(input, length, GL_FLOAT, false, VertexSpec::Mesh.VertexSize() * sizeof(float), (void*) (attributeOffset * sizeof(float)));
-				glEnableVertexAttribArray(input);
-				
-				attributeOffset += length;
-			}
+		if (subMesh.type != MeshType::Triangles || !subMesh.faceCount) {
+			return;
 		}
 
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, subMeshIndexBuffer);
-		glBufferData(GL_ELEMENT_ARRAY_BUFFER, subMeshes[subMeshIndex].faceCount * (int) subMeshes[subMeshIndex].type * sizeof(unsigned int), subMeshes[subMeshIndex].indexData, GL_STATIC_DRAW);
+		unsigned int* indices = (unsigned int*) subMesh.indexData;
 
-		glBindVertexArray(0);
+		MeshOptimizer::OptimizeVertexCache(indices, subMesh.GetVertexCount());
+		MeshOptimizer::OptimizeOverdraw(indices, subMesh.GetVertexCount(), positions, plan.layout.stride);
 
-		glBindBuffer(GL_ARRAY_BUFFER, 0);
-	}
+		if (buildMeshlets) {
+			std::vector<MeshOptimizer::Meshlet> meshlets = MeshOptimizer::BuildMeshlets(indices, subMesh.GetVertexCount(), positions, plan.layout.stride);
 
-	std::vector<Material*> materials;
+			subMesh.meshletCount = meshlets.size();
+			subMesh.meshlets = new MeshOptimizer::Meshlet[meshlets.size()];
+
+			std::copy(meshlets.begin(), meshlets.end(), subMesh.meshlets);
+		}
+
+		float errorLimit = LOD_ERROR_LIMIT * glm::length(maxCorners[i] - minCorners[i]);
 
-	if (loadMaterials && loaded_scene->HasMaterials()) {
-		ShaderProgram* pbrProg = ShaderProgram::Build().WithVertexShader(
-			ResourceDatabase::Global->Get<VertexShader>("./res/shaders/lit.vert")
-		).WithPixelShader(
-			ResourceDatabase::Global->Get<PixelShader>("./res/shaders/pbr.frag")
-		).Link();
+		if (!std::isfinite(errorLimit)) {
+			return;
+		}
+
+		// Every level is simplified from the one before, so the errors add up
+		std::vector<unsigned int> lodIndices(indices, indices + subMesh.GetVertexCount());
+		std::vector<unsigned int> simplified;
+		SubMesh::LOD previous = subMesh.GetLOD(0);
 
-		for (int matIndex = 0; matIndex < loaded_scene->mNumMaterials; matIndex++) {
-			auto meshMaterial = loaded_scene->mMaterials[matIndex];
+		while (subMesh.simplifiedCount + 1 < SubMesh::MaxLODCount) {
+			size_t target = (size_t) (previous.indexCount / 3 * LOD_REDUCTION) * 3;
+			float error = 0.0f;
 
-			aiString colorTexturePath;
-			aiString normalTexturePath;
-			aiString armTexturePath;
+			simplified.resize(previous.indexCount);
 
-			meshMaterial->GetTexture(aiTextureType_DIFFUSE, 0, &colorTexturePath);
-			meshMaterial->GetTexture(aiTextureType_NORMALS, 0, &normalTexturePath);
-			meshMaterial->GetTexture(aiTextureType_METALNESS, 0, &armTexturePath);
+			size_t count = MeshOptimizer::Simplify(simplified.data(), lodIndices.data() + previous.firstIndex, previous.indexCount,
+				positions, plan.layout.stride, target, errorLimit - previous.error, &error);
+
+			if (count == 0 || count > previous.indexCount * LOD_MIN_REDUCTION) {
+				break;
+			}
 
-			Texture2D* albedoTex =
-				fs::is_regular_file(modelPath.parent_path() / colorTexturePath.C_Str())
-				? ResourceDatabase::Global->Get<Texture2D>((modelPath.parent_path() / colorTexturePath.C_Str()), Texture::ColorTextureRGB)
-				: ResourceDatabase::Global->Get<Texture2D>("./res/textures/default_color.png", Texture::ColorTextureRGB);
+			MeshOptimizer::OptimizeVertexCache(simplified.data(), count);
 
-			Texture2D* normalTex =
-				fs::is_regular_file(modelPath.parent_path() / normalTexturePath.C_Str())
-				? ResourceDatabase::Global->Get<Texture2D>((modelPath.parent_path() / normalTexturePath.C_Str()), Texture::TechnicalMapXYZ)
-				: ResourceDatabase::Global->Get<Texture2D>("./res/textures/default_norm.png", Texture::TechnicalMapXYZ);
-			
-			Texture2D* armTex =
-				fs::is_regular_file(modelPath.parent_path() / armTexturePath.C_Str())
-				? ResourceDatabase::Global->Get<Texture2D>((modelPath.parent_path() / armTexturePath.C_Str()), Texture::TechnicalMapXYZ)
-				: ResourceDatabase::Global->Get<Texture2D>("./res/textures/default_arm.png", Texture::TechnicalMapXYZ);
-			
-			Material* materialResult = new Material(pbrProg);
-			materialResult->SetValue("albedoMap", albedoTex);
-			materialResult->SetValue("normalMap", normalTex);
-			materialResult->SetValue("armMap", armTex);
+			previous = { (unsigned int) lodIndices.size(), (unsigned int) count, previous.error + error };
+			subMesh.simplified[subMesh.simplifiedCount++] = previous;
 
-			materials.push_back(materialResult);
+			lodIndices.insert(lodIndices.end(), simplified.begin(), simplified.begin() + count);
 		}
-	}
 
-	Mesh* loadedMesh = new Mesh();
-	loadedMesh->subMeshes = subMeshes;
-	loadedMesh->materialCount = materialsCount;
-	loadedMesh->materials = materials;
-	loadedMesh->vertexCount = vertexCount;
-	loadedMesh->vertexStride = VertexSpec::Mesh.VertexSize();
-	loadedMesh->vertexBuffer = vertexBuffer;
+		if (subMesh.simplifiedCount > 0) {
+			delete[] (unsigned char*) subMesh.indexData;
 
-	delete[] vertexData;
+			subMesh.indexData = new unsigned char[lodIndices.size() * sizeof(unsigned int)];
+			memcpy(subMesh.indexData, lodIndices.data(), lodIndices.size() * sizeof(unsigned int));
+		}
+	});
+
+	// Submeshes do not share vertices, so each one ends up with a contiguous range of them
+	std::vector<std::span<unsigned int>> indexLists;
+
+	for (SubMesh& subMesh : subMeshes) {
+		if (subMesh.faceCount) {
+			indexLists.push_back({ (unsigned int*) subMesh.indexData, subMesh.GetIndexCount() });
+		}
+	}
+
+	MeshOptimizer::OptimizeVertexFetch(vertexData, plan.vertexCount, plan.layout.stride, indexLists);
+
+	for (SubMesh& subMesh : subMeshes) {
+		subMesh.PackIndices();
+	}
+}
+
+Mesh* Mesh::FromScene(const aiScene* loaded_scene, ImportPlan& plan) {
+	PROFILE_ZONE("Mesh::FromScene");
+
+	for (SubMesh& subMesh : plan.subMeshes) {
+		if (subMesh.faceCount) {
+			subMesh.indexData = new unsigned char[subMesh.GetIndexBytes()];
+		}
+	}
+
+	float* convertedData = new float[(size_t) plan.vertexCount * plan.layout.stride];
+
+	ResourceLoader::ParallelFor(plan.chunks.size(), [&](int chunkIndex) {
+		const ImportPlan::Chunk& chunk = plan.chunks[chunkIndex];
+		const ImportPlan::Placement& placement = plan.placements[chunk.mesh];
+		const SubMesh& targetSubMesh = plan.subMeshes[placement.subMesh];
+
+		ConvertChunk(loaded_scene, plan, chunkIndex,
+			convertedData + (size_t) (placement.firstVertex + chunk.firstVertex) * plan.layout.stride,
+			(unsigned int*) targetSubMesh.indexData + (size_t) (placement.firstFace + chunk.firstFace) * (int) targetSubMesh.type
+		);
+	});
+
+	OptimizeImport(plan, convertedData);
+
+	// Packed after the optimization, which reads the float positions and moves whole vertices
+	unsigned int vertexBytes = plan.spec.VertexBytes();
+	unsigned char* vertexData = new unsigned char[(size_t) plan.vertexCount * vertexBytes];
+
+	ResourceLoader::ParallelFor((plan.vertexCount + IMPORT_CHUNK_SIZE - 1) / IMPORT_CHUNK_SIZE, [&](int range) {
+		unsigned int first = range * IMPORT_CHUNK_SIZE;
+
+		PackVertices(convertedData + (size_t) first * plan.layout.stride, std::min(plan.vertexCount - first, IMPORT_CHUNK_SIZE), plan.layout, plan.spec,
+			vertexData + (size_t) first * vertexBytes);
+	});
+
+	delete[] convertedData;
+
+	return FinishImport(plan, vertexData);
+}
+
+Mesh* Mesh::StreamScene(aiScene* loaded_scene, ImportPlan& plan) {
+	PROFILE_ZONE("Mesh::StreamScene");
+
+	// Every slot holds the vertices and indices of one chunk
+	size_t vertexSlotBytes = (size_t) IMPORT_CHUNK_SIZE * plan.spec.VertexBytes();
+	size_t indexSlotBytes = (size_t) IMPORT_CHUNK_SIZE * (int) MeshType::Triangles * sizeof(unsigned int);
+
+	StagingRing ring(vertexSlotBytes + indexSlotBytes, STREAMING_SLOT_COUNT);
+
+	// Indices go straight to their buffers, so the index type comes from the vertex ranges of the source meshes
+	std::vector<unsigned int> firstVertices(plan.subMeshes.size(), UINT_MAX);
+	std::vector<unsigned int> endVertices(plan.subMeshes.size(), 0);
+
+	for (unsigned int meshIndex = 0; meshIndex < plan.placements.size(); meshIndex++) {
+		const ImportPlan::Placement& placement = plan.placements[meshIndex];
+
+		if (placement.subMesh >= 0) {
+			firstVertices[placement.subMesh] = std::min(firstVertices[placement.subMesh], placement.firstVertex);
+			endVertices[placement.subMesh] = std::max(endVertices[placement.subMesh], placement.firstVertex + loaded_scene->mMeshes[meshIndex]->mNumVertices);
+		}
+	}
+
+	for (int i = 0; i < plan.subMeshes.size(); i++) {
+		if (plan.subMeshes[i].faceCount && endVertices[i] - firstVertices[i] < SHORT_INDEX_LIMIT) {
+			plan.subMeshes[i].indexType = GL_UNSIGNED_SHORT;
+			plan.subMeshes[i].baseVertex = firstVertices[i];
+		}
+	}
+
+	GLuint vertexBuffer;
+	glCreateBuffers(1, &vertexBuffer);
+	glNamedBufferData(vertexBuffer, plan.GetVertexBytes(), nullptr, GL_STATIC_DRAW);
+
+	for (SubMesh& subMesh : plan.subMeshes) {
+		if (subMesh.faceCount) {
+			glCreateBuffers(1, &subMesh.handle.indexBuffer);
+			glNamedBufferData(subMesh.handle.indexBuffer, subMesh.GetIndexBytes(), nullptr, GL_STATIC_DRAW);
+		}
+	}
+
+	for (int firstChunk = 0; firstChunk < plan.chunks.size(); firstChunk += ring.GetSlotCount()) {
+		int chunkCount = std::min((int) plan.chunks.size() - firstChunk, ring.GetSlotCount());
+
+		std::vector<unsigned char*> slots(chunkCount);
+
+		for (int i = 0; i < chunkCount; i++) {
+			slots[i] = ring.Acquire(i);
+		}
+
+		ResourceLoader::ParallelFor(chunkCount, [&](int i) {
+			const ImportPlan::Chunk& chunk = plan.chunks[firstChunk + i];
+			const SubMesh& targetSubMesh = plan.subMeshes[plan.placements[chunk.mesh].subMesh];
+
+			// Only the triangles within a chunk are reordered, the overdraw and fetch passes need the whole submesh
+			std::vector<unsigned int> indices((size_t) chunk.faceCount * (int) targetSubMesh.type);
+			std::vector<float> vertices((size_t) chunk.vertexCount * plan.layout.stride);
+
+			ConvertChunk(loaded_scene, plan, firstChunk + i, vertices.data(), indices.data());
+			PackVertices(vertices.data(), chunk.vertexCount, plan.layout, plan.spec, slots[i]);
+
+			if (targetSubMesh.type == MeshType::Triangles) {
+				MeshOptimizer::OptimizeVertexCache(indices.data(), indices.size());
+			}
+
+			StoreIndices(indices.data(), indices.size(), targetSubMesh.indexType, targetSubMesh.baseVertex, slots[i] + vertexSlotBytes);
+		});
+
+		for (int i = 0; i < chunkCount; i++) {
+			const ImportPlan::Chunk& chunk = plan.chunks[firstChunk + i];
+			const ImportPlan::Placement& placement = plan.placements[chunk.mesh];
+			const SubMesh& targetSubMesh = plan.subMeshes[placement.subMesh];
+
+			size_t vertexBytes = (size_t) chunk.vertexCount * plan.spec.VertexBytes();
+			size_t vertexOffset = (size_t) (placement.firstVertex + chunk.firstVertex) * plan.spec.VertexBytes();
+			size_t indexBytes = (size_t) chunk.faceCount * (int) targetSubMesh.type * targetSubMesh.GetIndexSize();
+			size_t indexOffset = (size_t) (placement.firstFace + chunk.firstFace) * (int) targetSubMesh.type * targetSubMesh.GetIndexSize();
+
+			if (vertexBytes) {
+				ring.Copy(i, 0, vertexBuffer, vertexOffset, vertexBytes);
+			}
+			if (indexBytes) {
+				ring.Copy(i, vertexSlotBytes, targetSubMesh.handle.indexBuffer, indexOffset, indexBytes);
+			}
+
+			ring.Release(i);
+
+			// The source mesh is no longer needed once its last chunk is converted
+			if (placement.lastChunk == firstChunk + i) {
+				aiMesh* sourceMesh = loaded_scene->mMeshes[chunk.mesh];
+
+				loaded_scene->mMeshes[chunk.mesh] = nullptr;
+				delete sourceMesh;
+			}
+		}
+	}
+
+	Mesh* loadedMesh = FinishImport(plan, nullptr);
+	loadedMesh->vertexBuffer = vertexBuffer;
+
+	loadedMesh->CreateVertexArrays();
+	loadedMesh->TrackMemory();
+
+	return loadedMesh;
+}
+
+void Mesh::TrackMemory() {
+	uint64_t vertexBytes = (uint64_t) this->vertexCount * this->vertexStride;
+	uint64_t cpuBytes = this->vertexData ? vertexBytes : 0;
+	uint64_t gpuBytes = IsUploaded() ? vertexBytes : 0;
+
+	for (const SubMesh& subMesh : this->subMeshes) {
+		uint64_t meshletBytes = (uint64_t) subMesh.meshletCount * sizeof(MeshOptimizer::Meshlet);
+
+		cpuBytes += subMesh.indexData ? subMesh.GetIndexBytes() : 0;
+		cpuBytes += subMesh.meshlets ? meshletBytes : 0;
+		gpuBytes += IsUploaded() ? subMesh.GetIndexBytes() : 0;
+		gpuBytes += subMesh.handle.meshletBuffer ? meshletBytes : 0;
+	}
+
+	MemoryTracker::Track(this, MemoryCategory::Meshes, cpuBytes, gpuBytes);
+}
+
+void Mesh::CreateVertexArrays() {
+	for (SubMesh& subMesh : this->subMeshes) {
+		GLuint subMeshVertexArray;
+
+		glGenVertexArrays(1, &subMeshVertexArray);
+
+		subMesh.handle.vertexArray = subMeshVertexArray;
+
+		glBindBuffer(GL_ARRAY_BUFFER, this->vertexBuffer);
+
+		glBindVertexArray(subMeshVertexArray);
+
+		for (int input = int(VertexInputType::Position) - 1; input < int(VertexInputType::Color); input++) {
+			VertexInputType type = VertexInputType(input + 1);
+			VertexFormat format = this->vertexSpec.GetFormatOf(type);
+			int length = this->vertexSpec.GetLengthOf(type);
+
+			if (length > 0) {
+				// Packed 10 bit vectors always come with all four components, the shader ignores the extra ones
+				int size = format == VertexFormat::Snorm10 ? 4 : length;
+				bool normalized = format != VertexFormat::Float && format != VertexFormat::Half;
+
+				glVertexAttribPointer(input, size, GetAttributeType(format), normalized, this->vertexStride, (void*) (uintptr_t) this->vertexSpec.GetOffsetOf(type));
+				glEnableVertexAttribArray(input);
+			}
+		}
+
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, subMesh.handle.indexBuffer);
+
+		glBindVertexArray(0);
+
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+	}
+}
+
+void Mesh::Upload() {
+	if (IsUploaded()) {
+		return;
+	}
+
+	uint64_t vertexBytes = (uint64_t) this->vertexCount * this->vertexStride;
+	uint64_t totalBytes = vertexBytes;
+
+	for (const SubMesh& subMesh : this->subMeshes) {
+		totalBytes += subMesh.GetIndexBytes();
+	}
+
+	// Large meshes go through a small staging ring so the driver never makes its own full size copy
+	StagingRing* ring = streamingThreshold && totalBytes > streamingThreshold ? new StagingRing(STREAMING_SLOT_BYTES, STREAMING_SLOT_COUNT) : nullptr;
+
+	auto createBuffer = [&](const void* data, uint64_t size) -> GLuint {
+		GLuint buffer;
+
+		glCreateBuffers(1, &buffer);
+		glNamedBufferData(buffer, size, ring ? nullptr : data, GL_STATIC_DRAW);
+
+		if (ring) {
+			ring->Stream(data, buffer, size);
+		}
+
+		return buffer;
+	};
+
+	this->vertexBuffer = createBuffer(this->vertexData, vertexBytes);
+
+	for (SubMesh& subMesh : this->subMeshes) {
+		subMesh.handle.indexBuffer = createBuffer(subMesh.indexData, subMesh.GetIndexBytes());
+
+		if (subMesh.meshletCount) {
+			subMesh.handle.meshletBuffer = createBuffer(subMesh.meshlets, (uint64_t) subMesh.meshletCount * sizeof(MeshOptimizer::Meshlet));
+		}
+	}
+
+	delete ring;
+
+	CreateVertexArrays();
+
+	if (keepCPUData) {
+		TrackMemory();
+	}
+	else {
+		ReleaseCPUData();
+	}
+}
+
+bool Mesh::IsUploaded() const {
+	return this->vertexBuffer != 0;
+}
+
+void Mesh::ReleaseCPUData() {
+	if (!this->cacheFile) {
+		delete[] this->vertexData;
+	}
+
+	this->vertexData = nullptr;
+
+	for (SubMesh& subMesh : this->subMeshes) {
+		if (!this->cacheFile) {
+			delete[] (unsigned char*) subMesh.indexData;
+			delete[] subMesh.meshlets;
+		}
+
+		subMesh.indexData = nullptr;
+		subMesh.meshlets = nullptr;
+	}
+
+	delete this->cacheFile;
+	this->cacheFile = nullptr;
+
+	TrackMemory();
+}
+
+bool Mesh::HasCPUData() const {
+	return this->vertexData != nullptr;
+}
+
+void Mesh::SetKeepCPUData(bool keep) {
+	keepCPUData = keep;
+}
+
+bool Mesh::GetKeepCPUData() {
+	return keepCPUData;
+}
+
+void Mesh::SetPackVertices(bool pack) {
+	packVertices = pack;
+}
+
+bool Mesh::GetPackVertices() {
+	return packVertices;
+}
+
+void Mesh::SetBuildMeshlets(bool build) {
+	buildMeshlets = build;
+}
+
+bool Mesh::GetBuildMeshlets() {
+	return buildMeshlets;
+}
+
+void Mesh::SetStreamingThreshold(uint64_t bytes) {
+	streamingThreshold = bytes;
+}
+
+uint64_t Mesh::GetStreamingThreshold() {
+	return streamingThreshold;
+}
+
+void Mesh::SetCacheDirectory(const fs::path& directory) {
+	cacheDirectory = directory;
+}
+
+const fs::path& Mesh::GetCacheDirectory() {
+	return cacheDirectory;
+}
+
+const void* Mesh::GetVertexData() const {
+	return this->vertexData;
+}
+
+unsigned int Mesh::GetVertexCount() const {
+	return this->vertexCount;
+}
+
+unsigned int Mesh::GetVertexStride() const {
+	return this->vertexStride;
+}
+
+const VertexSpec& Mesh::GetVertexSpec() const {
+	return this->vertexSpec;
+}
+
+const void* Mesh::SubMesh::GetIndexData() const {
+	return this->indexData;
+}
+
+unsigned int Mesh::SubMesh::GetIndex(unsigned int i) const {
+	if (this->indexType == GL_UNSIGNED_SHORT) {
+		return ((const uint16_t*) this->indexData)[i] + this->baseVertex;
+	}
+
+	return ((const unsigned int*) this->indexData)[i];
+}
+
+unsigned int Mesh::SubMesh::GetMeshletCount() const {
+	return this->meshletCount;
+}
+
+const MeshOptimizer::Meshlet* Mesh::SubMesh::GetMeshlets() const {
+	return this->meshlets;
+}
+
+std::vector<Mesh::MaterialTextures> Mesh::ReadMaterialTextures(const aiScene* loaded_scene) {
+	std::vector<MaterialTextures> materialTextures;
+
+	for (int matIndex = 0; matIndex < loaded_scene->mNumMaterials; matIndex++) {
+		auto meshMaterial = loaded_scene->mMaterials[matIndex];
+
+		aiString colorTexturePath;
+		aiString normalTexturePath;
+		aiString armTexturePath;
+
+		meshMaterial->GetTexture(aiTextureType_DIFFUSE, 0, &colorTexturePath);
+		meshMaterial->GetTexture(aiTextureType_NORMALS, 0, &normalTexturePath);
+		meshMaterial->GetTexture(aiTextureType_METALNESS, 0, &armTexturePath);
+
+		materialTextures.push_back({ colorTexturePath.C_Str(), normalTexturePath.C_Str(), armTexturePath.C_Str() });
+	}
+
+	return materialTextures;
+}
+
+std::vector<Material*> Mesh::BuildMaterials(const std::vector<MaterialTextures>& materialTextures, const fs::path& modelPath) {
+	std::vector<Material*> materials;
+
+	if (materialTextures.empty()) {
+		return materials;
+	}
+
+	ShaderProgram* pbrProg = ShaderProgram::Build().WithVertexShader(
+		ResourceDatabase::Global->Get<VertexShader>("./res/shaders/lit.vert")
+	).WithPixelShader(
+		ResourceDatabase::Global->Get<PixelShader>("./res/shaders/pbr.frag")
+	).Link();
+
+	for (const MaterialTextures& textures : materialTextures) {
+		Texture2D* albedoTex =
+			fs::is_regular_file(modelPath.parent_path() / textures.color)
+			? ResourceDatabase::Global->Get<Texture2D>((modelPath.parent_path() / textures.color), Texture::ColorTextureRGB)
+			: ResourceDatabase::Global->Get<Texture2D>("./res/textures/default_color.png", Texture::ColorTextureRGB);
+
+		Texture2D* normalTex =
+			fs::is_regular_file(modelPath.parent_path() / textures.normal)
+			? ResourceDatabase::Global->Get<Texture2D>((modelPath.parent_path() / textures.normal), Texture::TechnicalMapXYZ)
+			: ResourceDatabase::Global->Get<Texture2D>("./res/textures/default_norm.png", Texture::TechnicalMapXYZ);
+		
+		Texture2D* armTex =
+			fs::is_regular_file(modelPath.parent_path() / textures.arm)
+			? ResourceDatabase::Global->Get<Texture2D>((modelPath.parent_path() / textures.arm), Texture::TechnicalMapXYZ)
+			: ResourceDatabase::Global->Get<Texture2D>("./res/textures/default_arm.png", Texture::TechnicalMapXYZ);
+		
+		Material* materialResult = new Material(pbrProg);
+		materialResult->SetValue("albedoMap", albedoTex);
+		materialResult->SetValue("normalMap", normalTex);
+		materialResult->SetValue("armMap", armTex);
+
+		materials.push_back(materialResult);
+	}
+
+	return materials;
+}
+
+Mesh* Mesh::ReadCache(const fs::path& cachePath, uint64_t key, std::vector<MaterialTextures>& materialTextures) {
+	MappedFile* file = MappedFile::Open(cachePath);
+
+	if (!file) {
+		return nullptr;
+	}
+
+	const unsigned char* data = file->GetData();
+	size_t size = file->GetSize();
+	size_t cursor = 0;
+
+	auto read = [&](void* target, size_t bytes) -> bool {
+		if (bytes > size - cursor) {
+			return false;
+		}
+
+		memcpy(target, data + cursor, bytes);
+		cursor += bytes;
+
+		return true;
+	};
+
+	// Offsets and sizes come from the file, so they are checked before pointing into it
+	auto fits = [&](uint64_t offset, uint64_t bytes) -> bool {
+		return offset % MESH_CACHE_ALIGNMENT == 0 && offset <= size && bytes <= size - offset;
+	};
+
+	MeshCacheHeader header;
+
+	if (!read(&header, sizeof(header)) || header.magic != MESH_CACHE_MAGIC || header.version != MESH_CACHE_VERSION || header.key != key) {
+		delete file;
+		return nullptr;
+	}
+
+	VertexSpec vertexSpec(VertexSpec::Mesh.GetHash(), header.vertexFormats);
+	bool valid = true;
+
+	for (int input = (int) VertexInputType::Position; input <= (int) VertexInputType::Color; input++) {
+		valid = valid && vertexSpec.GetFormatOf(VertexInputType(input)) <= VertexFormat::Unorm8;
+	}
+
+	valid = valid && header.vertexStride == vertexSpec.VertexBytes()
+		&& fits(header.vertexOffset, (uint64_t) header.vertexCount * header.vertexStride);
+
+	std::vector<MeshCacheSubMesh> records(valid ? header.subMeshCount : 0);
+
+	for (MeshCacheSubMesh& record : records) {
+		valid = valid && read(&record, sizeof(record))
+			&& record.type >= (uint32_t) MeshType::Points && record.type <= (uint32_t) MeshType::Triangles
+			&& (record.indexType == GL_UNSIGNED_SHORT || record.indexType == GL_UNSIGNED_INT)
+			&& record.simplifiedCount < Mesh::SubMesh::MaxLODCount
+			&& record.materialIndex >= 0 && (uint32_t) record.materialIndex < header.materialCount;
+
+		// Levels of detail follow each other without gaps
+		uint64_t indexCount = valid ? (uint64_t) record.faceCount * record.type : 0;
+
+		for (unsigned int level = 0; valid && level < record.simplifiedCount; level++) {
+			valid = record.simplified[level].firstIndex == indexCount;
+			indexCount += record.simplified[level].indexCount;
+		}
+
+		valid = valid && fits(record.indexOffset, indexCount * (record.indexType == GL_UNSIGNED_SHORT ? sizeof(uint16_t) : sizeof(unsigned int)))
+			&& (record.meshletCount == 0 || record.type == (uint32_t) MeshType::Triangles)
+			&& fits(record.meshletOffset, (uint64_t) record.meshletCount * sizeof(MeshOptimizer::Meshlet));
+
+		// Every level indexes from baseVertex, the GPU would fetch past the vertices otherwise
+		uint64_t maxIndex = 0;
+
+		for (uint64_t i = 0; valid && i < indexCount; i++) {
+			maxIndex = std::max<uint64_t>(maxIndex, record.indexType == GL_UNSIGNED_SHORT
+				? ((const uint16_t*) (data + record.indexOffset))[i]
+				: ((const unsigned int*) (data + record.indexOffset))[i]);
+		}
+
+		valid = valid && (indexCount == 0 || (uint64_t) record.baseVertex + maxIndex < header.vertexCount);
+
+		// Culled draws read the index ranges straight from the file, so they have to stay within the full detail level
+		const MeshOptimizer::Meshlet* meshlets = (const MeshOptimizer::Meshlet*) (data + record.meshletOffset);
+
+		for (unsigned int i = 0; valid && i < record.meshletCount; i++) {
+			valid = meshlets[i].firstIndex <= (uint64_t) record.faceCount * record.type
+				&& meshlets[i].indexCount <= (uint64_t) record.faceCount * record.type - meshlets[i].firstIndex;
+		}
+	}
+
+	std::vector<MaterialTextures> textures(valid ? header.materialTextureCount : 0);
+
+	for (MaterialTextures& material : textures) {
+		for (std::string* path : { &material.color, &material.normal, &material.arm }) {
+			uint32_t length = 0;
+
+			valid = valid && read(&length, sizeof(length)) && length <= size - cursor;
+
+			if (valid) {
+				path->assign((const char*) data + cursor, length);
+				cursor += length;
+			}
+		}
+	}
+
+	bool current = true;
+
+	for (uint32_t i = 0; valid && i < header.dependencyCount; i++) {
+		uint32_t length = 0;
+		uint64_t hash = 0;
+
+		valid = read(&length, sizeof(length)) && length <= size - cursor;
+
+		if (valid) {
+			fs::path dependency = std::string((const char*) data + cursor, length);
+			cursor += length;
+
+			valid = read(&hash, sizeof(hash));
+			current = current && hash == ResourceDatabase::ContentKey(dependency, typeid(Mesh));
+		}
+	}
+
+	if (!valid) {
+		spdlog::warn("Mesh cache {} is corrupt, reimporting", cachePath.string());
+	}
+
+	if (!valid || !current) {
+		delete file;
+		return nullptr;
+	}
+
+	Mesh* loadedMesh = new Mesh();
+	loadedMesh->cacheFile = file;
+	loadedMesh->materialCount = header.materialCount;
+	loadedMesh->vertexCount = header.vertexCount;
+	loadedMesh->vertexSpec = vertexSpec;
+	loadedMesh->vertexStride = header.vertexStride;
+	// Mapped read only, nothing writes through these once the mesh is converted
+	loadedMesh->vertexData = (unsigned char*) (data + header.vertexOffset);
+
+	for (const MeshCacheSubMesh& record : records) {
+		SubMesh subMesh{};
+		subMesh.type = MeshType(record.type);
+		subMesh.materialIndex = record.materialIndex;
+		subMesh.faceCount = record.faceCount;
+		subMesh.indexType = record.indexType;
+		subMesh.baseVertex = record.baseVertex;
+		subMesh.bounds = record.bounds;
+		subMesh.simplifiedCount = record.simplifiedCount;
+		subMesh.indexData = (void*) (data + record.indexOffset);
+		subMesh.meshletCount = record.meshletCount;
+		subMesh.meshlets = record.meshletCount ? (MeshOptimizer::Meshlet*) (data + record.meshletOffset) : nullptr;
+
+		std::copy(record.simplified, record.simplified + record.simplifiedCount, subMesh.simplified);
+
+		loadedMesh->subMeshes.push_back(subMesh);
+	}
+
+	materialTextures = std::move(textures);
+
+	loadedMesh->TrackMemory();
+
+	return loadedMesh;
+}
+
+bool Mesh::WriteCache(const fs::path& cachePath, uint64_t key, const std::vector<MaterialTextures>& materialTextures, const std::vector<fs::path>& dependencies) const {
+	std::error_code error;
+	fs::create_directories(cachePath.parent_path(), error);
+
+	// Written next to the target and renamed, so other threads and processes never map a half written file
+	fs::path temporaryPath = cachePath;
+	temporaryPath += std::format(".{}.tmp", std::hash<std::thread::id>{}(std::this_thread::get_id()));
+
+	std::ofstream file(temporaryPath, std::ios::binary);
+
+	if (!file.is_open()) {
+		return false;
+	}
+
+	auto pad = [&]() -> uint64_t {
+		static const char zeros[MESH_CACHE_ALIGNMENT] = {};
+
+		uint64_t position = (uint64_t) file.tellp();
+		uint64_t aligned = (position + MESH_CACHE_ALIGNMENT - 1) / MESH_CACHE_ALIGNMENT * MESH_CACHE_ALIGNMENT;
+
+		file.write(zeros, aligned - position);
+
+		return aligned;
+	};
+
+	MeshCacheHeader header{};
+	header.magic = MESH_CACHE_MAGIC;
+	header.version = MESH_CACHE_VERSION;
+	header.key = key;
+	header.vertexCount = this->vertexCount;
+	header.vertexStride = this->vertexStride;
+	header.vertexFormats = this->vertexSpec.GetFormats();
+	header.materialCount = this->materialCount;
+	header.subMeshCount = this->subMeshes.size();
+	header.materialTextureCount = materialTextures.size();
+	header.dependencyCount = dependencies.size();
+
+	std::vector<MeshCacheSubMesh> records(this->subMeshes.size());
+
+	// Filled in with the final offsets once the blobs are written
+	file.write((const char*) &header, sizeof(header));
+	file.write((const char*) records.data(), records.size() * sizeof(MeshCacheSubMesh));
+
+	for (const MaterialTextures& material : materialTextures) {
+		for (const std::string* path : { &material.color, &material.normal, &material.arm }) {
+			uint32_t length = path->size();
+
+			file.write((const char*) &length, sizeof(length));
+			file.write(path->data(), length);
+		}
+	}
+
+	for (const fs::path& dependency : dependencies) {
+		std::string path = dependency.string();
+		uint32_t length = path.size();
+		uint64_t hash = ResourceDatabase::ContentKey(dependency, typeid(Mesh));
+
+		file.write((const char*) &length, sizeof(length));
+		file.write(path.data(), length);
+		file.write((const char*) &hash, sizeof(hash));
+	}
+
+	// Streamed meshes only have their data on the GPU, it is read back a slot at a time
+	std::vector<char> readback;
+
+	auto writeBlob = [&](const void* data, GLuint buffer, uint64_t size) {
+		if (data) {
+			file.write((const char*) data, (std::streamsize) size);
+			return;
+		}
+
+		readback.resize(std::min<uint64_t>(size, STREAMING_SLOT_BYTES));
+
+		for (uint64_t offset = 0; offset < size; offset += readback.size()) {
+			uint64_t chunkSize = std::min<uint64_t>(readback.size(), size - offset);
+
+			glGetNamedBufferSubData(buffer, offset, chunkSize, readback.data());
+			file.write(readback.data(), (std::streamsize) chunkSize);
+		}
+	};
+
+	header.vertexOffset = pad();
+	writeBlob(this->vertexData, this->vertexBuffer, (uint64_t) this->vertexCount * this->vertexStride);
+
+	for (int i = 0; i < this->subMeshes.size(); i++) {
+		const SubMesh& subMesh = this->subMeshes[i];
+
+		records[i].type = (uint32_t) subMesh.type;
+		records[i].materialIndex = subMesh.materialIndex;
+		records[i].faceCount = subMesh.faceCount;
+		records[i].indexType = subMesh.indexType;
+		records[i].baseVertex = subMesh.baseVertex;
+		records[i].bounds = subMesh.bounds;
+		records[i].simplifiedCount = subMesh.simplifiedCount;
+		records[i].indexOffset = pad();
+
+		std::copy(subMesh.simplified, subMesh.simplified + subMesh.simplifiedCount, records[i].simplified);
+
+		writeBlob(subMesh.indexData, subMesh.handle.indexBuffer, subMesh.GetIndexBytes());
+
+		records[i].meshletCount = subMesh.meshletCount;
+		records[i].meshletOffset = pad();
+
+		writeBlob(subMesh.meshlets, subMesh.handle.meshletBuffer, (uint64_t) subMesh.meshletCount * sizeof(MeshOptimizer::Meshlet));
+	}
+
+	file.seekp(0);
+	file.write((const char*) &header, sizeof(header));
+	file.write((const char*) records.data(), records.size() * sizeof(MeshCacheSubMesh));
+
+	bool written = file.good();
+	file.close();
+
+	if (written) {
+		fs::rename(temporaryPath, cachePath, error);
+		written = !error;
+	}
+
+	if (!written) {
+		fs::remove(temporaryPath, error);
+	}
+
+	return written;
+}
+
+Mesh* Mesh::ImportCached(const fs::path& modelPath, bool loadMaterials, std::vector<MaterialTextures>& materialTextures, bool allowStreaming) {
+	if (!fs::exists(modelPath) || !fs::is_regular_file(modelPath)) {
+		return nullptr;
+	}
+
+	uint64_t key = 0;
+	fs::path cachePath;
+
+	if (!cacheDirectory.empty()) {
+		// Loading with or without materials converts the same geometry, so both share one file
+		key = ResourceDatabase::ContentKey(modelPath, typeid(Mesh), MESH_CACHE_VERSION, VertexSpec::Mesh.GetHash(), packVertices, buildMeshlets);
+		cachePath = cacheDirectory / std::format("{:016x}.mesh", key);
+
+		if (Mesh* cachedMesh = ReadCache(cachePath, key, materialTextures)) {
+			cachedMesh->RemapMaterials(loadMaterials);
+
+			return cachedMesh;
+		}
+	}
+
+	Assimp::Importer importer{};
+	std::vector<fs::path> dependencies;
+
+	const aiScene* loaded_scene = ReadScene(importer, modelPath, dependencies);
+
+	if (!loaded_scene) {
+		return nullptr;
+	}
+
+	ImportPlan plan = PlanImport(loaded_scene, modelPath);
+	materialTextures = ReadMaterialTextures(loaded_scene);
+
+	Mesh* loadedMesh;
+
+	if (allowStreaming && streamingThreshold && plan.GetConvertedBytes() > streamingThreshold) {
+		spdlog::info("Streaming {} MB of geometry from {}", plan.GetConvertedBytes() >> 20, modelPath.string());
+
+		// Owning the scene lets the streaming path free each mesh once it is uploaded
+		aiScene* orphanedScene = importer.GetOrphanedScene();
+
+		loadedMesh = StreamScene(orphanedScene, plan);
+
+		delete orphanedScene;
+	}
+	else {
+		loadedMesh = FromScene(loaded_scene, plan);
+	}
+
+	if (key && !loadedMesh->WriteCache(cachePath, key, materialTextures, dependencies)) {
+		spdlog::warn("Failed to write the mesh cache for {} to {}", modelPath.string(), cachePath.string());
+	}
+
+	loadedMesh->RemapMaterials(loadMaterials);
+
+	return loadedMesh;
+}
+
+Mesh* Mesh::Import(const fs::path& modelPath) {
+	std::vector<MaterialTextures> materialTextures;
+
+	return ImportCached(modelPath, false, materialTextures, false);
+}
+
+Mesh* Mesh::Load(fs::path modelPath, bool loadMaterials) {
+	std::vector<MaterialTextures> materialTextures;
+
+	Mesh* loadedMesh = ImportCached(modelPath, loadMaterials, materialTextures, true);
+
+	if (!loadedMesh) {
+		return nullptr;
+	}
+
+	spdlog::info("Loading mesh {}", modelPath.string());
+
+	loadedMesh->Upload();
+
+	if (loadMaterials) {
+		loadedMesh->materials = BuildMaterials(materialTextures, modelPath);
+	}
 
 	return loadedMesh;
 }
\ No newline at end of file
@@ -0,0 +1,797 @@
+#include <MeshOptimizer.h>
+
+#include <vector>
+#include <array>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <cstdint>
+
+#include <glm/glm.hpp>
+
+// Indices of a submesh point into the vertex buffer of the whole mesh, per vertex state only covers the range used
+struct IndexRange {
+	unsigned int first;
+	unsigned int count;
+
+	IndexRange(const unsigned int* indices, size_t indexCount) {
+		auto [low, high] = std::minmax_element(indices, indices + indexCount);
+
+		this->first = *low;
+		this->count = *high - *low + 1;
+	}
+};
+
+// FIFO post transform cache, a vertex stays cached until size others were transformed after it
+struct CacheSimulation {
+	std::vector<unsigned int> timestamps;
+	unsigned int time;
+	unsigned int size;
+
+	CacheSimulation(unsigned int vertexCount, unsigned int size):
+	timestamps(vertexCount, 0),
+	time(size + 1),
+	size(size) { }
+
+	bool Contains(unsigned int vertex) const {
+		return this->time - this->timestamps[vertex] <= this->size;
+	}
+
+	// Returns whether the vertex had to be transformed
+	bool Access(unsigned int vertex) {
+		if (Contains(vertex)) {
+			return false;
+		}
+
+		this->timestamps[vertex] = this->time++;
+
+		return true;
+	}
+
+	unsigned int AccessTriangle(const unsigned int* triangle, unsigned int first) {
+		return Access(triangle[0] - first) + Access(triangle[1] - first) + Access(triangle[2] - first);
+	}
+
+	void Flush() {
+		this->time += this->size + 1;
+	}
+};
+
+void MeshOptimizer::OptimizeVertexCache(unsigned int* indices, size_t indexCount) {
+	size_t triangleCount = indexCount / 3;
+
+	if (triangleCount < 2) {
+		return;
+	}
+
+	IndexRange range(indices, indexCount);
+
+	// Triangles using every vertex, packed into one array
+	std::vector<unsigned int> liveTriangles(range.count, 0);
+	std::vector<unsigned int> adjacencyOffsets(range.count + 1, 0);
+	std::vector<unsigned int> adjacency(triangleCount * 3);
+
+	for (size_t i = 0; i < triangleCount * 3; i++) {
+		liveTriangles[indices[i] - range.first]++;
+	}
+
+	for (unsigned int vertex = 0; vertex < range.count; vertex++) {
+		adjacencyOffsets[vertex + 1] = adjacencyOffsets[vertex] + liveTriangles[vertex];
+	}
+
+	std::vector<unsigned int> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+
+	for (size_t i = 0; i < triangleCount * 3; i++) {
+		adjacency[fill[indices[i] - range.first]++] = i / 3;
+	}
+
+	CacheSimulation cache(range.count, CacheSize);
+	std::vector<bool> emitted(triangleCount, false);
+	std::vector<unsigned int> deadEnds;
+	std::vector<unsigned int> candidates;
+	std::vector<unsigned int> result;
+
+	result.reserve(triangleCount * 3);
+
+	unsigned int cursor = 0;
+	int fanning = 0;
+
+	while (fanning >= 0) {
+		candidates.clear();
+
+		// Emits every triangle around the fanning vertex that is not drawn yet
+		for (unsigned int a = adjacencyOffsets[fanning]; a < adjacencyOffsets[fanning + 1]; a++) {
+			unsigned int triangle = adjacency[a];
+
+			if (emitted[triangle]) {
+				continue;
+			}
+
+			for (int corner = 0; corner < 3; corner++) {
+				unsigned int vertex = indices[triangle * 3 + corner] - range.first;
+
+				result.push_back(indices[triangle * 3 + corner]);
+				deadEnds.push_back(vertex);
+				candidates.push_back(vertex);
+				liveTriangles[vertex]--;
+
+				cache.Access(vertex);
+			}
+
+			emitted[triangle] = true;
+		}
+
+		// The next fan goes around the vertex that entered the cache first and still has its remaining triangles fit
+		fanning = -1;
+		int bestPriority = -1;
+
+		for (unsigned int vertex : candidates) {
+			if (liveTriangles[vertex] == 0) {
+				continue;
+			}
+
+			int priority = 0;
+			unsigned int age = cache.time - cache.timestamps[vertex];
+
+			if (age + 2 * liveTriangles[vertex] <= CacheSize) {
+				priority = age;
+			}
+
+			if (priority > bestPriority) {
+				bestPriority = priority;
+				fanning = vertex;
+			}
+		}
+
+		if (fanning >= 0) {
+			continue;
+		}
+
+		// Dead end, go back to recently used vertices before scanning for any vertex with triangles left
+		while (!deadEnds.empty() && fanning < 0) {
+			unsigned int vertex = deadEnds.back();
+			deadEnds.pop_back();
+
+			if (liveTriangles[vertex] > 0) {
+				fanning = vertex;
+			}
+		}
+
+		while (cursor < range.count && fanning < 0) {
+			if (liveTriangles[cursor] > 0) {
+				fanning = cursor;
+			}
+			else {
+				cursor++;
+			}
+		}
+	}
+
+	memcpy(indices, result.data(), result.size() * sizeof(unsigned int));
+}
+
+void MeshOptimizer::OptimizeOverdraw(unsigned int* indices, size_t indexCount, const float* positions, unsigned int positionStride, float threshold) {
+	size_t triangleCount = indexCount / 3;
+
+	if (triangleCount < 2) {
+		return;
+	}
+
+	IndexRange range(indices, indexCount);
+	CacheSimulation cache(range.count, CacheSize);
+
+	// Hard boundaries where the order jumps to unconnected geometry, every vertex of the triangle misses there
+	std::vector<size_t> hardBoundaries;
+
+	for (size_t triangle = 0; triangle < triangleCount; triangle++) {
+		unsigned int misses = cache.AccessTriangle(indices + triangle * 3, range.first);
+
+		if (misses == 3 || triangle == 0) {
+			hardBoundaries.push_back(triangle);
+		}
+	}
+
+	hardBoundaries.push_back(triangleCount);
+
+	// Soft boundaries split hard clusters further wherever the part so far already has a low enough miss rate
+	std::vector<size_t> clusters;
+
+	for (size_t hard = 0; hard + 1 < hardBoundaries.size(); hard++) {
+		size_t start = hardBoundaries[hard];
+		size_t end = hardBoundaries[hard + 1];
+
+		cache.Flush();
+
+		unsigned int clusterMisses = 0;
+
+		for (size_t triangle = start; triangle < end; triangle++) {
+			clusterMisses += cache.AccessTriangle(indices + triangle * 3, range.first);
+		}
+
+		float clusterThreshold = threshold * clusterMisses / (end - start);
+
+		clusters.push_back(start);
+		cache.Flush();
+
+		unsigned int misses = 0;
+		unsigned int triangles = 0;
+
+		for (size_t triangle = start; triangle + 1 < end; triangle++) {
+			misses += cache.AccessTriangle(indices + triangle * 3, range.first);
+			triangles++;
+
+			if ((float) misses / triangles <= clusterThreshold) {
+				clusters.push_back(triangle + 1);
+				cache.Flush();
+
+				misses = 0;
+				triangles = 0;
+			}
+		}
+	}
+
+	clusters.push_back(triangleCount);
+
+	auto position = [&](unsigned int index) {
+		const float* p = positions + (size_t) index * positionStride;
+
+		return glm::vec3(p[0], p[1], p[2]);
+	};
+
+	glm::vec3 meshCentroid(0.0f);
+
+	for (size_t i = 0; i < triangleCount * 3; i++) {
+		meshCentroid += position(indices[i]);
+	}
+
+	meshCentroid /= (float) (triangleCount * 3);
+
+	// Clusters facing away from the center are likely in front of the others from wherever they are visible
+	struct ClusterOrder {
+		size_t cluster;
+		float occlusion;
+	};
+
+	std::vector<ClusterOrder> order(clusters.size() - 1);
+
+	for (size_t cluster = 0; cluster + 1 < clusters.size(); cluster++) {
+		glm::vec3 centroid(0.0f);
+		glm::vec3 normal(0.0f);
+		float area = 0.0f;
+
+		for (size_t triangle = clusters[cluster]; triangle < clusters[cluster + 1]; triangle++) {
+			glm::vec3 a = position(indices[triangle * 3]);
+			glm::vec3 b = position(indices[triangle * 3 + 1]);
+			glm::vec3 c = position(indices[triangle * 3 + 2]);
+
+			glm::vec3 areaNormal = glm::cross(b - a, c - a);
+			float triangleArea = glm::length(areaNormal);
+
+			centroid += (a + b + c) * (triangleArea / 3.0f);
+			normal += areaNormal;
+			area += triangleArea;
+		}
+
+		float normalLength = glm::length(normal);
+
+		centroid = area > 0.0f ? centroid / area : position(indices[clusters[cluster] * 3]);
+		normal = normalLength > 0.0f ? normal / normalLength : glm::vec3(0.0f);
+
+		order[cluster] = { cluster, glm::dot(centroid - meshCentroid, normal) };
+	}
+
+	std::stable_sort(order.begin(), order.end(), [](const ClusterOrder& a, const ClusterOrder& b) -> bool {
+		return a.occlusion > b.occlusion;
+	});
+
+	std::vector<unsigned int> result;
+	result.reserve(triangleCount * 3);
+
+	for (const ClusterOrder& entry : order) {
+		result.insert(result.end(), indices + clusters[entry.cluster] * 3, indices + clusters[entry.cluster + 1] * 3);
+	}
+
+	memcpy(indices, result.data(), result.size() * sizeof(unsigned int));
+}
+
+void MeshOptimizer::OptimizeVertexFetch(float* vertexData, unsigned int vertexCount, unsigned int vertexStride, std::span<const std::span<unsigned int>> indexLists) {
+	constexpr unsigned int unused = ~0u;
+
+	std::vector<unsigned int> remap(vertexCount, unused);
+	unsigned int next = 0;
+
+	for (std::span<unsigned int> indices : indexLists) {
+		for (unsigned int& index : indices) {
+			if (remap[index] == unused) {
+				remap[index] = next++;
+			}
+
+			index = remap[index];
+		}
+	}
+
+	for (unsigned int& target : remap) {
+		if (target == unused) {
+			target = next++;
+		}
+	}
+
+	std::vector<float> original(vertexData, vertexData + (size_t) vertexCount * vertexStride);
+
+	for (unsigned int vertex = 0; vertex < vertexCount; vertex++) {
+		memcpy(vertexData + (size_t) remap[vertex] * vertexStride, original.data() + (size_t) vertex * vertexStride, vertexStride * sizeof(float));
+	}
+}
+
+// Weighted sum of squared distances to a set of planes, each weighted by the area of the triangle it came from
+struct Quadric {
+	double a00 = 0.0, a01 = 0.0, a02 = 0.0, a11 = 0.0, a12 = 0.0, a22 = 0.0;
+	double b0 = 0.0, b1 = 0.0, b2 = 0.0;
+	double c = 0.0;
+	double weight = 0.0;
+
+	Quadric() = default;
+
+	// The plane of points p with dot(normal, p) + distance = 0
+	Quadric(const glm::vec3& normal, float distance, float weight):
+	a00(weight * normal.x * normal.x),
+	a01(weight * normal.x * normal.y),
+	a02(weight * normal.x * normal.z),
+	a11(weight * normal.y * normal.y),
+	a12(weight * normal.y * normal.z),
+	a22(weight * normal.z * normal.z),
+	b0(weight * normal.x * distance),
+	b1(weight * normal.y * distance),
+	b2(weight * normal.z * distance),
+	c(weight * distance * distance),
+	weight(weight) { }
+
+	void Add(const Quadric& other) {
+		this->a00 += other.a00;
+		this->a01 += other.a01;
+		this->a02 += other.a02;
+		this->a11 += other.a11;
+		this->a12 += other.a12;
+		this->a22 += other.a22;
+		this->b0 += other.b0;
+		this->b1 += other.b1;
+		this->b2 += other.b2;
+		this->c += other.c;
+		this->weight += other.weight;
+	}
+
+	// Mean squared distance of point to the planes
+	float Evaluate(const glm::vec3& point) const {
+		double x = point.x;
+		double y = point.y;
+		double z = point.z;
+
+		double result = this->a00 * x * x + this->a11 * y * y + this->a22 * z * z
+			+ 2.0 * (this->a01 * x * y + this->a02 * x * z + this->a12 * y * z)
+			+ 2.0 * (this->b0 * x + this->b1 * y + this->b2 * z)
+			+ this->c;
+
+		return this->weight > 0.0 ? (float) std::max(result / this->weight, 0.0) : 0.0f;
+	}
+};
+
+size_t MeshOptimizer::Simplify(unsigned int* destination, const unsigned int* indices, size_t indexCount, const float* positions, unsigned int positionStride, size_t targetIndexCount, float targetError, float* resultError) {
+	std::vector<unsigned int> result(indices, indices + indexCount / 3 * 3);
+	float error = 0.0f;
+
+	if (!result.empty() && result.size() > targetIndexCount) {
+		IndexRange range(result.data(), result.size());
+
+		auto position = [&](unsigned int index) {
+			const float* p = positions + (size_t) index * positionStride;
+
+			return glm::vec3(p[0], p[1], p[2]);
+		};
+
+		// Compared bitwise, so NaNs still sort
+		auto positionBits = [&](unsigned int vertex) {
+			std::array<uint32_t, 3> bits;
+
+			memcpy(bits.data(), positions + (size_t) (vertex + range.first) * positionStride, sizeof(bits));
+
+			return bits;
+		};
+
+		// Vertices at the same position only differ in attributes, topology goes by the first of them.
+		// Collapsing them would tear the seam open, so they are locked.
+		std::vector<unsigned int> welded(range.count);
+		std::vector<unsigned int> sorted(range.count);
+		std::vector<bool> locked(range.count, false);
+
+		for (unsigned int vertex = 0; vertex < range.count; vertex++) {
+			sorted[vertex] = vertex;
+		}
+
+		std::sort(sorted.begin(), sorted.end(), [&](unsigned int a, unsigned int b) -> bool {
+			return positionBits(a) < positionBits(b);
+		});
+
+		for (size_t start = 0, end = 0; start < sorted.size(); start = end) {
+			while (end < sorted.size() && positionBits(sorted[end]) == positionBits(sorted[start])) {
+				end++;
+			}
+
+			for (size_t i = start; i < end; i++) {
+				welded[sorted[i]] = sorted[start];
+			}
+
+			locked[sorted[start]] = end - start > 1;
+		}
+
+		auto corner = [&](size_t triangle, int k) {
+			return welded[result[triangle * 3 + k] - range.first];
+		};
+
+		std::vector<Quadric> quadrics(range.count);
+
+		for (size_t triangle = 0; triangle < result.size() / 3; triangle++) {
+			glm::vec3 a = position(result[triangle * 3]);
+			glm::vec3 normal = glm::cross(position(result[triangle * 3 + 1]) - a, position(result[triangle * 3 + 2]) - a);
+			float area = glm::length(normal);
+
+			if (area > 0.0f) {
+				normal = normal / area;
+
+				Quadric plane(normal, -glm::dot(normal, a), area * 0.5f);
+
+				for (int k = 0; k < 3; k++) {
+					quadrics[corner(triangle, k)].Add(plane);
+				}
+			}
+		}
+
+		// Triangles around every welded vertex, rebuilt after each pass of collapses
+		std::vector<unsigned int> adjacencyOffsets(range.count + 1);
+		std::vector<unsigned int> adjacency;
+
+		auto connect = [&]() {
+			std::fill(adjacencyOffsets.begin(), adjacencyOffsets.end(), 0);
+
+			for (size_t i = 0; i < result.size(); i++) {
+				adjacencyOffsets[corner(i / 3, i % 3) + 1]++;
+			}
+
+			for (unsigned int vertex = 0; vertex < range.count; vertex++) {
+				adjacencyOffsets[vertex + 1] += adjacencyOffsets[vertex];
+			}
+
+			std::vector<unsigned int> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+
+			adjacency.resize(result.size());
+
+			for (size_t i = 0; i < result.size(); i++) {
+				adjacency[fill[corner(i / 3, i % 3)]++] = i / 3;
+			}
+		};
+
+		connect();
+
+		// Edges without exactly one triangle running the other way are on a border or non manifold, their ends are locked
+		for (size_t triangle = 0; triangle < result.size() / 3; triangle++) {
+			for (int k = 0; k < 3; k++) {
+				unsigned int a = corner(triangle, k);
+				unsigned int b = corner(triangle, (k + 1) % 3);
+				int opposite = 0;
+
+				for (unsigned int i = adjacencyOffsets[b]; i < adjacencyOffsets[b + 1]; i++) {
+					for (int m = 0; m < 3; m++) {
+						opposite += corner(adjacency[i], m) == b && corner(adjacency[i], (m + 1) % 3) == a;
+					}
+				}
+
+				if (opposite != 1) {
+					locked[a] = true;
+					locked[b] = true;
+				}
+			}
+		}
+
+		auto neighbours = [&](unsigned int vertex, std::vector<unsigned int>& target) {
+			target.clear();
+
+			for (unsigned int i = adjacencyOffsets[vertex]; i < adjacencyOffsets[vertex + 1]; i++) {
+				for (int k = 0; k < 3; k++) {
+					if (corner(adjacency[i], k) != vertex) {
+						target.push_back(corner(adjacency[i], k));
+					}
+				}
+			}
+
+			std::sort(target.begin(), target.end());
+			target.erase(std::unique(target.begin(), target.end()), target.end());
+		};
+
+		// Moving from onto to must keep the surface manifold and not turn any remaining triangle over
+		std::vector<unsigned int> fromNeighbours;
+		std::vector<unsigned int> toNeighbours;
+
+		auto canCollapse = [&](unsigned int from, unsigned int to) -> bool {
+			unsigned int weldedFrom = welded[from - range.first];
+			unsigned int weldedTo = welded[to - range.first];
+
+			neighbours(weldedFrom, fromNeighbours);
+			neighbours(weldedTo, toNeighbours);
+
+			size_t shared = 0;
+
+			for (unsigned int vertex : toNeighbours) {
+				shared += std::binary_search(fromNeighbours.begin(), fromNeighbours.end(), vertex);
+			}
+
+			if (shared > 2) {
+				return false;
+			}
+
+			for (unsigned int i = adjacencyOffsets[weldedFrom]; i < adjacencyOffsets[weldedFrom + 1]; i++) {
+				unsigned int triangle = adjacency[i];
+				glm::vec3 before[3];
+				glm::vec3 after[3];
+				bool removed = false;
+
+				for (int k = 0; k < 3; k++) {
+					before[k] = position(result[triangle * 3 + k]);
+					after[k] = corner(triangle, k) == weldedFrom ? position(to) : before[k];
+					removed = removed || corner(triangle, k) == weldedTo;
+				}
+
+				glm::vec3 normalBefore = glm::cross(before[1] - before[0], before[2] - before[0]);
+				glm::vec3 normalAfter = glm::cross(after[1] - after[0], after[2] - after[0]);
+
+				// Turning further than about 75 degrees counts as a flip, that also keeps slivers with meaningless normals from forming
+				if (!removed && glm::dot(normalBefore, normalAfter) <= 0.25f * glm::length(normalBefore) * glm::length(normalAfter)) {
+					return false;
+				}
+			}
+
+			return true;
+		};
+
+		struct Collapse {
+			float cost;
+			unsigned int from;
+			unsigned int to;
+		};
+
+		enum VertexState : uint8_t {
+			Free,
+			Touched,
+			Collapsed
+		};
+
+		std::vector<Collapse> collapses;
+		std::vector<uint8_t> states(range.count);
+		std::vector<unsigned int> targets(range.count);
+
+		while (result.size() > targetIndexCount) {
+			collapses.clear();
+
+			for (size_t i = 0; i < result.size(); i++) {
+				unsigned int from = result[i];
+				unsigned int to = result[i - i % 3 + (i + 1) % 3];
+
+				if (!locked[welded[from - range.first]] && welded[from - range.first] != welded[to - range.first]) {
+					collapses.push_back({ quadrics[welded[from - range.first]].Evaluate(position(to)), from, to });
+				}
+			}
+
+			std::sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b) -> bool {
+				return a.cost != b.cost ? a.cost < b.cost : a.from != b.from ? a.from < b.from : a.to < b.to;
+			});
+
+			// Vertices around a collapse are left alone for the rest of the pass, so the checks above stay valid.
+			// Every collapse removes about two triangles.
+			size_t wanted = (result.size() - targetIndexCount) / 6 + 1;
+			size_t collapsed = 0;
+
+			std::fill(states.begin(), states.end(), Free);
+
+			for (const Collapse& collapse : collapses) {
+				float distance = std::sqrt(collapse.cost);
+				unsigned int from = welded[collapse.from - range.first];
+				unsigned int to = welded[collapse.to - range.first];
+
+				if (distance > targetError) {
+					break;
+				}
+
+				if (states[from] != Free || states[to] != Free || !canCollapse(collapse.from, collapse.to)) {
+					continue;
+				}
+
+				for (unsigned int vertex : fromNeighbours) {
+					states[vertex] = Touched;
+				}
+
+				states[from] = Collapsed;
+				targets[from] = collapse.to;
+
+				quadrics[to].Add(quadrics[from]);
+				error = std::max(error, distance);
+
+				if (++collapsed == wanted) {
+					break;
+				}
+			}
+
+			if (collapsed == 0) {
+				break;
+			}
+
+			size_t kept = 0;
+
+			for (size_t triangle = 0; triangle < result.size() / 3; triangle++) {
+				unsigned int moved[3];
+
+				for (int k = 0; k < 3; k++) {
+					unsigned int index = result[triangle * 3 + k];
+
+					moved[k] = states[welded[index - range.first]] == Collapsed ? targets[welded[index - range.first]] : index;
+				}
+
+				unsigned int a = welded[moved[0] - range.first];
+				unsigned int b = welded[moved[1] - range.first];
+				unsigned int c = welded[moved[2] - range.first];
+
+				if (a != b && b != c && a != c) {
+					result[kept++] = moved[0];
+					result[kept++] = moved[1];
+					result[kept++] = moved[2];
+				}
+			}
+
+			result.resize(kept);
+
+			connect();
+		}
+	}
+
+	if (resultError) {
+		*resultError = error;
+	}
+
+	memcpy(destination, result.data(), result.size() * sizeof(unsigned int));
+
+	return result.size();
+}
+
+std::vector<MeshOptimizer::Meshlet> MeshOptimizer::BuildMeshlets(const unsigned int* indices, size_t indexCount, const float* positions, unsigned int positionStride,
+	unsigned int maxVertices, unsigned int maxTriangles) {
+	std::vector<Meshlet> meshlets;
+	size_t triangleCount = indexCount / 3;
+
+	if (triangleCount == 0) {
+		return meshlets;
+	}
+
+	IndexRange range(indices, indexCount);
+
+	auto position = [&](unsigned int index) {
+		const float* p = positions + (size_t) index * positionStride;
+
+		return glm::vec3(p[0], p[1], p[2]);
+	};
+
+	auto finish = [&](size_t first, size_t end, const std::vector<unsigned int>& vertices) {
+		Meshlet meshlet{};
+		meshlet.firstIndex = first * 3;
+		meshlet.indexCount = (end - first) * 3;
+
+		glm::vec3 minCorner = position(vertices[0]);
+		glm::vec3 maxCorner = minCorner;
+
+		for (unsigned int vertex : vertices) {
+			minCorner = glm::min(minCorner, position(vertex));
+			maxCorner = glm::max(maxCorner, position(vertex));
+		}
+
+		glm::vec3 center = (minCorner + maxCorner) * 0.5f;
+		float radius = 0.0f;
+
+		for (unsigned int vertex : vertices) {
+			radius = std::max(radius, glm::distance(center, position(vertex)));
+		}
+
+		// Slivers without an area face no direction, they are left out of the cone
+		std::vector<glm::vec3> normals;
+		glm::vec3 axis(0.0f);
+
+		for (size_t triangle = first; triangle < end; triangle++) {
+			const unsigned int* corners = indices + triangle * 3;
+			glm::vec3 a = position(corners[0]);
+			glm::vec3 normal = glm::cross(position(corners[1]) - a, position(corners[2]) - a);
+			float length = glm::length(normal);
+
+			if (length > 0.0f) {
+				normals.push_back(normal / length);
+				axis += normals.back();
+			}
+		}
+
+		float cutoff = 1.0f;
+
+		if (glm::length(axis) > 0.0f) {
+			axis = glm::normalize(axis);
+
+			float minDot = 1.0f;
+
+			for (const glm::vec3& normal : normals) {
+				minDot = std::min(minDot, glm::dot(normal, axis));
+			}
+
+			// The normals spread asin(cutoff) around the axis, past a hemisphere some triangle always faces the view
+			if (minDot > 0.0f) {
+				cutoff = std::sqrt(1.0f - minDot * minDot);
+			}
+		}
+
+		for (int i = 0; i < 3; i++) {
+			meshlet.center[i] = center[i];
+			meshlet.coneAxis[i] = axis[i];
+		}
+
+		meshlet.radius = radius;
+		meshlet.coneCutoff = cutoff;
+
+		meshlets.push_back(meshlet);
+	};
+
+	// Meshlet number + 1 that last took in each vertex
+	std::vector<unsigned int> owners(range.count, 0);
+	std::vector<unsigned int> vertices;
+	size_t first = 0;
+
+	for (size_t triangle = 0; triangle < triangleCount; triangle++) {
+		const unsigned int* corners = indices + triangle * 3;
+		unsigned int owner = meshlets.size() + 1;
+		unsigned int added = 0;
+
+		for (int i = 0; i < 3; i++) {
+			bool repeated = (i > 0 && corners[i] == corners[0]) || (i > 1 && corners[i] == corners[1]);
+
+			added += owners[corners[i] - range.first] != owner && !repeated;
+		}
+
+		if (triangle > first && (vertices.size() + added > maxVertices || triangle - first == maxTriangles)) {
+			finish(first, triangle, vertices);
+
+			first = triangle;
+			owner = meshlets.size() + 1;
+			vertices.clear();
+		}
+
+		for (int i = 0; i < 3; i++) {
+			if (owners[corners[i] - range.first] != owner) {
+				owners[corners[i] - range.first] = owner;
+				vertices.push_back(corners[i]);
+			}
+		}
+	}
+
+	finish(first, triangleCount, vertices);
+
+	return meshlets;
+}
+
+float MeshOptimizer::GetACMR(const unsigned int* indices, size_t indexCount, unsigned int cacheSize) {
+	size_t triangleCount = indexCount / 3;
+
+	if (triangleCount == 0) {
+		return 0.0f;
+	}
+
+	IndexRange range(indices, indexCount);
+	CacheSimulation cache(range.count, cacheSize);
+
+	uint64_t misses = 0;
+
+	for (size_t triangle = 0; triangle < triangleCount; triangle++) {
+		misses += cache.AccessTriangle(indices + triangle * 3, range.first);
+	}
+
+	return (float) misses / triangleCount;
+}
\ No newline at end of file
@@ -0,0 +1,121 @@
+#include <MeshletCuller.h>
+
+#include <algorithm>
+#include <cmath>
+
+#include <Resources.h>
+#include <Shader.h>
+#include <GraphicsBackend.h>
+#include <RenderStats.h>
+#include <MemoryTracker.h>
+
+// How far the model matrix may stray from a rotation and uniform scale before cones are no longer trusted
+constexpr float CONE_CULLING_TOLERANCE = 1e-3f;
+
+MeshletCuller::MeshletCuller(ResourceDatabase* resources):
+drawBuffer(0),
+capacity(0),
+used(0) {
+	GraphicsBackend* gfx = GraphicsBackend::Current();
+
+	this->cullShader = new ComputeShaderProgram(resources->Get<ComputeShader>("./res/shaders/culling/meshlet_cull.comp"));
+
+	GLuint handle = this->cullShader->GetHandle();
+	this->uniforms.modelViewProjection = gfx->GetUniformLocation(handle, "modelViewProjection");
+	this->uniforms.viewOrigin = gfx->GetUniformLocation(handle, "viewOrigin");
+	this->uniforms.meshletCount = gfx->GetUniformLocation(handle, "meshletCount");
+	this->uniforms.drawOffset = gfx->GetUniformLocation(handle, "drawOffset");
+	this->uniforms.baseVertex = gfx->GetUniformLocation(handle, "baseVertex");
+	this->uniforms.coneCulling = gfx->GetUniformLocation(handle, "coneCulling");
+
+	this->drawBuffer = gfx->CreateBuffer();
+}
+
+MeshletCuller::~MeshletCuller() {
+	GraphicsBackend::Current()->DeleteBuffer(this->drawBuffer);
+
+	MemoryTracker::Untrack(this);
+
+	delete this->cullShader;
+}
+
+void MeshletCuller::BeginFrame() {
+	this->used = 0;
+
+	if (this->capacity > 0) {
+		GraphicsBackend::Current()->BufferData(GL_SHADER_STORAGE_BUFFER, this->drawBuffer, this->capacity, nullptr, GL_STREAM_DRAW);
+	}
+}
+
+uint64_t MeshletCuller::Cull(const Mesh::SubMesh* mesh, const glm::mat4& model, const glm::mat4& view, const glm::mat4& projection) {
+	GraphicsBackend* gfx = GraphicsBackend::Current();
+
+	unsigned int meshletCount = mesh->GetMeshletCount();
+	uint64_t regionBytes = (CountBytes + meshletCount * CommandBytes + 15) & ~(uint64_t) 15;
+
+	if (this->used + regionBytes > this->capacity) {
+		this->capacity = std::max({ this->capacity * 2, regionBytes, InitialBytes });
+		this->used = 0;
+
+		gfx->BufferData(GL_SHADER_STORAGE_BUFFER, this->drawBuffer, this->capacity, nullptr, GL_STREAM_DRAW);
+
+		MemoryTracker::Track(this, MemoryCategory::Meshes, 0, this->capacity);
+		MemoryTracker::SetLabel(this, "Meshlet draws");
+	}
+
+	uint64_t drawOffset = this->used;
+	this->used += regionBytes;
+
+	unsigned int zero = 0;
+	gfx->BufferSubData(GL_SHADER_STORAGE_BUFFER, this->drawBuffer, drawOffset, sizeof(zero), &zero);
+
+	glm::mat4 modelViewProjection = projection * view * model;
+	glm::mat4 inverseModelView = glm::inverse(view * model);
+
+	// Orthographic views face every meshlet from the same direction
+	glm::vec4 viewOrigin = projection[3][3] == 0.0f
+		? inverseModelView[3]
+		: glm::vec4(glm::normalize(glm::vec3(inverseModelView * glm::vec4(0.0f, 0.0f, -1.0f, 0.0f))), 0.0f);
+
+	// Cone angles only survive rotations and uniform scales, mirroring also swaps the faces that get culled
+	glm::mat3 linear = glm::mat3(model);
+	glm::mat3 gram = glm::transpose(linear) * linear;
+	float scale = gram[0][0];
+	unsigned int coneCulling = glm::determinant(linear) > 0.0f;
+
+	for (int i = 0; i < 3; i++) {
+		for (int j = 0; j < 3; j++) {
+			if (std::abs(gram[i][j] - (i == j ? scale : 0.0f)) > CONE_CULLING_TOLERANCE * scale) {
+				coneCulling = 0;
+			}
+		}
+	}
+
+	unsigned int drawOffsetWords = (unsigned int) (drawOffset / sizeof(unsigned int));
+	unsigned int baseVertex = mesh->GetBaseVertex();
+
+	gfx->UseProgram(this->cullShader->GetHandle());
+	RenderStats::Add(RenderCounter::ProgramBinds);
+
+	gfx->SetUniform(this->uniforms.modelViewProjection, UniformSpec::UniformType::Matrix4x4, &modelViewProjection);
+	gfx->SetUniform(this->uniforms.viewOrigin, UniformSpec::UniformType::Float4, &viewOrigin);
+	gfx->SetUniform(this->uniforms.meshletCount, UniformSpec::UniformType::Uint1, &meshletCount);
+	gfx->SetUniform(this->uniforms.drawOffset, UniformSpec::UniformType::Uint1, &drawOffsetWords);
+	gfx->SetUniform(this->uniforms.baseVertex, UniformSpec::UniformType::Uint1, &baseVertex);
+	gfx->SetUniform(this->uniforms.coneCulling, UniformSpec::UniformType::Uint1, &coneCulling);
+
+	gfx->BindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, mesh->GetMeshletBufferHandle());
+	gfx->BindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, this->drawBuffer);
+
+	gfx->DispatchCompute((meshletCount + GroupSize - 1) / GroupSize, 1, 1);
+
+	RenderStats::Add(RenderCounter::ComputeDispatches);
+
+	gfx->Barrier(GL_COMMAND_BARRIER_BIT);
+
+	return drawOffset;
+}
+
+void MeshletCuller::Draw(const Mesh::SubMesh* mesh, uint64_t drawOffset) const {
+	GraphicsBackend::Current()->DrawElementsIndirect(mesh->GetDrawMode(), mesh->GetIndexType(), this->drawBuffer, drawOffset + CountBytes, drawOffset, mesh->GetMeshletCount());
+}
\ No newline at end of file
@@ -1,7 +1,8 @@
 #include <Messaging.h>
 
-#include <stack>
 #include <Scene.h>
+#include <Profiler.h>
+#include <FrameAllocator.h>
 
 void Messenger::Call() {
 	(*this->receiver.*this->message)();
@@ -30,14 +31,16 @@ void MessageTree::PropagateMessageInternal(SceneNode* startNode, int messageId)
 		return;
 	}
 
-	std::stack<MessageNode*> nodeStack;
-	std::stack<Messenger> messengers;
+	PROFILE_ZONE("MessageTree::Propagate");
 
-	nodeStack.push(messageRoot);
+	FrameVector<MessageNode*> nodeStack;
+	FrameVector<Messenger> messengers;
+
+	nodeStack.push_back(messageRoot);
 
 	while (!nodeStack.empty()) {
-		MessageNode* top = nodeStack.top();
-		nodeStack.pop();
+		MessageNode* top = nodeStack.back();
+		nodeStack.pop_back();
 
 		if (!top->content.node->IsEnabled()) {
 			continue;
@@ -45,17 +48,19 @@ void MessageTree::PropagateMessageInternal(SceneNode* startNode, int messageId)
 
 		for (MessageNode* child : top->children) {
 			if (child->type == 0) {
-				nodeStack.push(child);
+				nodeStack.push_back(child);
 			}
 			else if (child->type == messageId){
-				messengers.push(child->content.msg);
+				messengers.push_back(child->content.msg);
 			}
 		}
 	}
 
-	while (!messengers.empty()) {
-		messengers.top().Call();
-		messengers.pop();
+	PROFILE_ZONE("MessageTree::Dispatch");
+
+	// Receivers are called in reverse discovery order
+	for (auto messenger = messengers.rbegin(); messenger != messengers.rend(); messenger++) {
+		messenger->Call();
 	}
 }
 
@@ -1,24 +1,317 @@
 #include <PostProcessingSystem.h>
 
+#include <format>
+
+#include <imgui.h>
+#include <spdlog/spdlog.h>
+
+#include <Texture.h>
+#include <Shader.h>
+#include <Material.h>
+#include <Graphics.h>
+#include <GPUProfiler.h>
+#include <Profiler.h>
+#include <RenderStats.h>
+
+static std::string ExpandSnippet(const std::string& code, const std::string& prefix) {
+	std::string result;
+	result.reserve(code.size());
+
+	for (char c : code) {
+		if (c == '$') {
+			result += prefix;
+		}
+		else {
+			result += c;
+		}
+	}
+
+	return result;
+}
+
+static std::string FusedEffectPrefix(int index) {
+	return std::format("fx{}_", index);
+}
+
 PostProcessingSystem::PostProcessingSystem(Scene* scene):
-GameObjectSystem<PostProcessEffect>(scene) {
-	glGenTextures(1, &this->postProcessColorBuffer);
-	glBindTexture(GL_TEXTURE_2D, this->postProcessColorBuffer);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-	glBindTexture(GL_TEXTURE_2D, 0);
+GameObjectSystem<PostProcessEffect>(scene),
+fusedKernels(),
+fusedKey(),
+effectZoneNames(),
+activeEffects(),
+chainSteps(),
+fuseEffects(true) {
+	this->pingPongBuffers[0] = nullptr;
+	this->pingPongBuffers[1] = nullptr;
+}
+
+Texture2D* PostProcessingSystem::NextBuffer(const Texture2D* current) const {
+	return current == this->pingPongBuffers[0] ? this->pingPongBuffers[1] : this->pingPongBuffers[0];
 }
 
-void PostProcessingSystem::UpdateBufferResolution(glm::vec2 newResolution) {
-	glBindTexture(GL_TEXTURE_2D, this->postProcessColorBuffer);
-	
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, newResolution.x, newResolution.y, 0,  GL_RGBA, GL_FLOAT, nullptr);
+bool PostProcessingSystem::HasActiveEffects() {
+	for (PostProcessEffect* effect : *GetAllObjects()) {
+		if (effect->IsEnabled()) {
+			return true;
+		}
+	}
 
-	glBindTexture(GL_TEXTURE_2D, 0);
+	return false;
 }
 
-GLuint PostProcessingSystem::GetPostProcessBuffer() {
-	return this->postProcessColorBuffer;
+const char* PostProcessingSystem::GetEffectZoneName(PostProcessEffect* effect) {
+	auto [it, created] = this->effectZoneNames.try_emplace(&typeid(*effect), nullptr);
+
+	if (created) {
+		it->second = Profiler::Intern(effect->GetName());
+	}
+
+	return it->second;
+}
+
+void PostProcessingSystem::BuildChain() {
+	this->activeEffects.clear();
+	this->chainSteps.clear();
+
+	for (PostProcessEffect* effect : *GetAllObjects()) {
+		if (effect->IsEnabled()) {
+			this->activeEffects.push_back(effect);
+		}
+	}
+
+	int i = 0;
+	while (i < (int) this->activeEffects.size()) {
+		int runLength = 0;
+
+		if (this->fuseEffects) {
+			while (i + runLength < (int) this->activeEffects.size()) {
+				PostProcessEffect* effect = this->activeEffects[i + runLength];
+
+				if (effect->GetFusedVariant() < 0 || (runLength > 0 && effect->PreFusedPassReadsInput())) {
+					break;
+				}
+
+				runLength++;
+			}
+		}
+
+		const FusedKernel* kernel = nullptr;
+
+		if (runLength >= 2) {
+			kernel = GetFusedKernel(i, runLength);
+		}
+
+		if (kernel && kernel->dispatch) {
+			this->chainSteps.push_back(ChainStep{i, runLength, false, kernel, kernel->zoneName.c_str()});
+
+			i += runLength;
+		}
+		else {
+			this->chainSteps.push_back(ChainStep{i, 1, this->activeEffects[i]->RunsInPlace(), nullptr, GetEffectZoneName(this->activeEffects[i])});
+
+			i++;
+		}
+	}
+}
+
+const PostProcessingSystem::FusedKernel* PostProcessingSystem::GetFusedKernel(int firstEffect, int effectCount) {
+	this->fusedKey.clear();
+
+	for (int i = 0; i < effectCount; i++) {
+		PostProcessEffect* effect = this->activeEffects[firstEffect + i];
+
+		this->fusedKey.push_back(FusedEffectKey{&typeid(*effect), effect->GetFusedVariant()});
+	}
+
+	auto cached = this->fusedKernels.find(this->fusedKey);
+
+	if (cached != this->fusedKernels.end()) {
+		return &cached->second;
+	}
+
+	return &this->fusedKernels.emplace(this->fusedKey, BuildFusedKernel(firstEffect, effectCount)).first->second;
+}
+
+PostProcessingSystem::FusedKernel PostProcessingSystem::BuildFusedKernel(int firstEffect, int effectCount) {
+	FusedKernel kernel{nullptr, "Fused", {}};
+
+	std::string declarations;
+	std::string body;
+
+	for (int i = 0; i < effectCount; i++) {
+		PostProcessEffect* effect = this->activeEffects[firstEffect + i];
+		PostProcessSnippet snippet;
+
+		if (!effect->GetFusedSnippet(&snippet)) {
+			return kernel;
+		}
+
+		std::string prefix = FusedEffectPrefix(i);
+
+		declarations += ExpandSnippet(snippet.declarations, prefix) + "\n";
+		body += "\t{\n" + ExpandSnippet(snippet.body, prefix) + "\n\t}\n";
+
+		kernel.zoneName += (i == 0 ? " " : " + ") + effect->GetName();
+
+		std::vector<std::string>& uniforms = kernel.uniforms.emplace_back();
+
+		for (const std::string& uniform : snippet.uniforms) {
+			uniforms.push_back(prefix + uniform);
+		}
+	}
+
+	std::string source =
+		"#version 460\n"
+		"\n"
+		"layout(local_size_x = 8, local_size_y = 8) in;\n"
+		"\n"
+		"layout(binding = 0) uniform sampler2D inputTex;\n"
+		"layout(rgba16f, binding = 0) uniform writeonly image2D outputImg;\n"
+		"\n"
+		+ declarations +
+		"void main() {\n"
+		"\tconst ivec2 pixelCoord = ivec2(gl_GlobalInvocationID);\n"
+		"\tvec2 inputSize = textureSize(inputTex, 0);\n"
+		"\n"
+		"\tif (pixelCoord.x >= inputSize.x || pixelCoord.y >= inputSize.y) {\n"
+		"\t\treturn;\n"
+		"\t}\n"
+		"\n"
+		"\tvec2 uv = (pixelCoord + 0.5) / inputSize;\n"
+		"\tvec4 color = texelFetch(inputTex, pixelCoord, 0);\n"
+		"\n"
+		+ body +
+		"\n"
+		"\timageStore(outputImg, pixelCoord, color);\n"
+		"}\n";
+
+	fs::path virtualPath = BaseShaderPath / "generated" / std::format("fused_post_{}.comp", this->fusedKernels.size());
+
+	ComputeShader* shader = ComputeShader::FromSource(virtualPath, source);
+
+	if (shader) {
+		kernel.dispatch = new ComputeShaderDispatch(shader);
+	}
+	else {
+		spdlog::error("Failed to build fused post-processing kernel, falling back to separate passes");
+	}
+
+	return kernel;
+}
+
+void PostProcessingSystem::RunStep(const ChainStep& step, const PostProcessParams* params) {
+	GPUProfiler* profiler = GetScene()->GetGraphics()->GetGPUProfiler();
+
+	RenderStats::Add(RenderCounter::PostProcessSteps);
+
+	if (!step.fusedKernel) {
+		GPUProfiler::Scope zone(profiler, step.zoneName);
+
+		this->activeEffects[step.firstEffect]->OnPostProcess(params);
+
+		return;
+	}
+
+	GPUProfiler::Scope zone(profiler, step.zoneName);
+
+	ComputeShaderDispatch* kernel = step.fusedKernel->dispatch;
+
+	for (int i = 0; i < step.effectCount; i++) {
+		PostProcessEffect* effect = this->activeEffects[step.firstEffect + i];
+
+		effect->OnPreFusedPass(params);
+		effect->SetFusedValues(kernel->GetData(), step.fusedKernel->uniforms[i]);
+	}
+
+	kernel->GetData()->SetValue("inputTex", params->inputTexture);
+	kernel->GetData()->SetValue("outputImg", params->outputTexture);
+
+	kernel->Dispatch(std::ceil(params->inputTexture->GetWidth() / 8.0f), std::ceil(params->inputTexture->GetHeight() / 8.0f), 1);
+}
+
+Texture2D* PostProcessingSystem::Process(Texture2D* source, Texture2D* depth, Texture2D* bufferA, Texture2D* bufferB, Texture2D* presentationTarget) {
+	BuildChain();
+
+	this->pingPongBuffers[0] = bufferA;
+	this->pingPongBuffers[1] = bufferB;
+
+	int lastOutOfPlace = -1;
+
+	for (int i = 0; i < (int) this->chainSteps.size(); i++) {
+		if (!this->chainSteps[i].inPlace) {
+			lastOutOfPlace = i;
+		}
+	}
+
+	PostProcessParams params;
+	params.depthTexture = depth;
+
+	Texture2D* current = source;
+
+	for (int i = 0; i < (int) this->chainSteps.size(); i++) {
+		const ChainStep& step = this->chainSteps[i];
+
+		params.inputTexture = current;
+
+		if (step.inPlace) {
+			params.outputTexture = current;
+		}
+		else if (i == lastOutOfPlace && presentationTarget != nullptr && presentationTarget != current) {
+			params.outputTexture = presentationTarget;
+		}
+		else {
+			params.outputTexture = NextBuffer(current);
+		}
+
+		RunStep(step, &params);
+
+		current = params.outputTexture;
+	}
+
+	if (presentationTarget != nullptr && current != presentationTarget) {
+		glCopyImageSubData(
+			current->GetHandle(),
+			GL_TEXTURE_2D,
+			0,
+			0,
+			0,
+			0,
+			presentationTarget->GetHandle(),
+			GL_TEXTURE_2D,
+			0,
+			0,
+			0,
+			0,
+			current->GetWidth(),
+			current->GetHeight(),
+			1
+		);
+
+		current = presentationTarget;
+	}
+
+	this->pingPongBuffers[0] = nullptr;
+	this->pingPongBuffers[1] = nullptr;
+
+	return current;
+}
+
+void PostProcessingSystem::DrawImGui() {
+	if (ImGui::TreeNode("Post Processing Debug")) {
+		ImGui::Checkbox("Fuse per-pixel effects", &this->fuseEffects);
+
+		int fusedSteps = 0;
+
+		for (const ChainStep& step : this->chainSteps) {
+			if (step.fusedKernel) {
+				fusedSteps++;
+			}
+		}
+
+		ImGui::Text("Active effects: %i", (int) this->activeEffects.size());
+		ImGui::Text("Dispatch steps: %i (%i fused)", (int) this->chainSteps.size(), fusedSteps);
+		ImGui::Text("Cached fused kernels: %i", (int) this->fusedKernels.size());
+
+		ImGui::TreePop();
+	}
 }
\ No newline at end of file
@@ -0,0 +1,397 @@
+#include <Profiler.h>
+
+#include <chrono>
+#include <cfloat>
+#include <format>
+#include <fstream>
+#include <algorithm>
+#include <unordered_set>
+
+#include <spdlog/spdlog.h>
+#include <imgui.h>
+
+#include <JSON.h>
+
+std::mutex Profiler::buffersMutex;
+std::vector<Profiler::ThreadBuffer*> Profiler::buffers;
+thread_local Profiler::ThreadBuffer* Profiler::localBuffer = nullptr;
+thread_local const Profiler::Scope* Profiler::currentScope = nullptr;
+
+std::atomic<bool> Profiler::enabled = SYZYF_PROFILING;
+bool Profiler::paused = false;
+
+uint64_t Profiler::frameStarts[FrameHistory];
+uint64_t Profiler::frameCount = 0;
+
+std::vector<Profiler::ThreadView> Profiler::timelineView;
+uint64_t Profiler::timelineStart = 0;
+uint64_t Profiler::timelineEnd = 0;
+
+const auto PROFILER_EPOCH = std::chrono::steady_clock::now();
+
+static std::string StripTypeName(const char* typeName) {
+	std::string name = typeName;
+
+	for (const char* prefix : { "class ", "struct " }) {
+		if (name.starts_with(prefix)) {
+			return name.substr(std::string(prefix).length());
+		}
+	}
+
+	int firstLetter = 0;
+	while (firstLetter < (int) name.length() && name[firstLetter] >= '0' && name[firstLetter] <= '9') {
+		firstLetter++;
+	}
+
+	return name.substr(firstLetter);
+}
+
+Profiler::Scope::Scope(const char* name, const char* detail):
+name(enabled ? name : nullptr),
+detail(detail),
+start(0),
+parent(nullptr) {
+	if (this->name) {
+		GetThreadBuffer()->depth++;
+
+		this->parent = currentScope;
+		currentScope = this;
+
+		this->start = Now();
+	}
+}
+
+Profiler::Scope::~Scope() {
+	if (!this->name) {
+		return;
+	}
+
+	uint64_t end = Now();
+
+	ThreadBuffer* buffer = GetThreadBuffer();
+	buffer->depth--;
+
+	currentScope = this->parent;
+
+	Record(ZoneEvent{this->name, this->detail, this->start, end, buffer->depth});
+}
+
+const char* Profiler::Scope::GetName() const {
+	return this->name;
+}
+
+const char* Profiler::Scope::GetDetail() const {
+	return this->detail;
+}
+
+uint64_t Profiler::Now() {
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - PROFILER_EPOCH).count();
+}
+
+void Profiler::EventSlot::Store(const ZoneEvent& event) {
+	this->name.store(event.name, std::memory_order_relaxed);
+	this->detail.store(event.detail, std::memory_order_relaxed);
+	this->start.store(event.start, std::memory_order_relaxed);
+	this->end.store(event.end, std::memory_order_relaxed);
+	this->depth.store(event.depth, std::memory_order_relaxed);
+}
+
+Profiler::ZoneEvent Profiler::EventSlot::Load() const {
+	return ZoneEvent{
+		this->name.load(std::memory_order_relaxed),
+		this->detail.load(std::memory_order_relaxed),
+		this->start.load(std::memory_order_relaxed),
+		this->end.load(std::memory_order_relaxed),
+		this->depth.load(std::memory_order_relaxed)
+	};
+}
+
+Profiler::ThreadBuffer* Profiler::GetThreadBuffer() {
+	if (localBuffer) {
+		return localBuffer;
+	}
+
+	std::lock_guard lock(buffersMutex);
+
+	localBuffer = new ThreadBuffer();
+	localBuffer->threadId = (uint32_t) buffers.size();
+	localBuffer->threadName = buffers.empty() ? "Main" : std::format("Thread {}", buffers.size());
+	localBuffer->events = std::make_unique<EventSlot[]>(EventsPerThread);
+	localBuffer->written = 0;
+	localBuffer->depth = 0;
+
+	// Buffers outlive their threads so finished workers still show up in exports
+	buffers.push_back(localBuffer);
+
+	return localBuffer;
+}
+
+void Profiler::Record(const ZoneEvent& event) {
+	ThreadBuffer* buffer = GetThreadBuffer();
+
+	uint64_t index = buffer->written.load(std::memory_order_relaxed);
+
+	// Orders the last count before the slot stores, a reader that copied any of them then sees at least that count
+	std::atomic_thread_fence(std::memory_order_release);
+
+	buffer->events[index % EventsPerThread].Store(event);
+	buffer->written.store(index + 1, std::memory_order_release);
+}
+
+std::vector<Profiler::ZoneEvent> Profiler::CopyEvents(ThreadBuffer* buffer, uint64_t endedAfter) {
+	uint64_t written = buffer->written.load(std::memory_order_acquire);
+	uint64_t oldest = written - std::min<uint64_t>(written, EventsPerThread);
+	uint64_t first = written;
+
+	// Events are stored in the order they ended, so the wanted ones form a suffix of the ring
+	while (first > oldest && buffer->events[(first - 1) % EventsPerThread].end.load(std::memory_order_relaxed) > endedAfter) {
+		first--;
+	}
+
+	std::vector<ZoneEvent> events;
+	events.reserve(written - first);
+
+	for (uint64_t i = first; i < written; i++) {
+		events.push_back(buffer->events[i % EventsPerThread].Load());
+	}
+
+	// Drop the slots the owner reused during the copy, including the one it may be writing right now
+	std::atomic_thread_fence(std::memory_order_acquire);
+	uint64_t reused = buffer->written.load(std::memory_order_relaxed) + 1;
+
+	if (reused > first + EventsPerThread) {
+		uint64_t stale = std::min<uint64_t>(reused - EventsPerThread - first, events.size());
+
+		events.erase(events.begin(), events.begin() + stale);
+	}
+
+	return events;
+}
+
+std::string Profiler::DisplayName(const char* name, const char* detail) {
+	if (detail) {
+		return StripTypeName(detail) + "::" + name;
+	}
+
+	return name;
+}
+
+void Profiler::BeginFrame() {
+	frameStarts[frameCount % FrameHistory] = Now();
+	frameCount++;
+}
+
+void Profiler::SetThreadName(const std::string& name) {
+	ThreadBuffer* buffer = GetThreadBuffer();
+
+	std::lock_guard lock(buffer->nameMutex);
+
+	buffer->threadName = name;
+}
+
+const char* Profiler::Intern(const std::string& name) {
+	static std::mutex internMutex;
+	static std::unordered_set<std::string> internedNames;
+
+	std::lock_guard lock(internMutex);
+
+	return internedNames.insert(name).first->c_str();
+}
+
+const Profiler::Scope* Profiler::GetCurrentScope() {
+	return currentScope;
+}
+
+bool Profiler::IsEnabled() {
+	return enabled;
+}
+
+void Profiler::SetEnabled(bool enabled) {
+	Profiler::enabled = enabled && SYZYF_PROFILING;
+}
+
+float Profiler::GetLastFrameTime() {
+	if (frameCount < 2) {
+		return 0.0f;
+	}
+
+	uint64_t start = frameStarts[(frameCount - 2) % FrameHistory];
+	uint64_t end = frameStarts[(frameCount - 1) % FrameHistory];
+
+	return (float) (end - start) / 1000000.0f;
+}
+
+bool Profiler::ExportChromeTrace(const fs::path& path) {
+	std::ofstream file(path);
+
+	if (!file.is_open()) {
+		spdlog::error("Failed to open {} for profiler trace export", path.string());
+		return false;
+	}
+
+	std::vector<ThreadBuffer*> threads;
+
+	{
+		std::lock_guard lock(buffersMutex);
+		threads = buffers;
+	}
+
+	file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+	bool first = true;
+	int eventCount = 0;
+
+	for (ThreadBuffer* thread : threads) {
+		std::string threadName;
+
+		{
+			std::lock_guard lock(thread->nameMutex);
+			threadName = thread->threadName;
+		}
+
+		file << (first ? "" : ",") << std::format(
+			"\n{{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":{},\"args\":{{\"name\":\"{}\"}}}}",
+			thread->threadId,
+			EscapeJSON(threadName)
+		);
+
+		first = false;
+
+		for (const ZoneEvent& event : CopyEvents(thread)) {
+			file << std::format(
+				",\n{{\"name\":\"{}\",\"cat\":\"cpu\",\"ph\":\"X\",\"pid\":1,\"tid\":{},\"ts\":{:.3f},\"dur\":{:.3f}}}",
+				EscapeJSON(DisplayName(event.name, event.detail)),
+				thread->threadId,
+				event.start / 1000.0,
+				(event.end - event.start) / 1000.0
+			);
+
+			eventCount++;
+		}
+	}
+
+	file << "\n]}\n";
+
+	spdlog::info("Exported {} profiler zones from {} threads to {}", eventCount, threads.size(), path.string());
+
+	return true;
+}
+
+void Profiler::DrawImGui() {
+	if (ImGui::TreeNode("CPU Profiler")) {
+		bool enabledValue = enabled;
+
+		if (ImGui::Checkbox("Enabled", &enabledValue)) {
+			SetEnabled(enabledValue);
+		}
+
+		ImGui::SameLine();
+		ImGui::Checkbox("Pause", &paused);
+
+		ImGui::SameLine();
+
+		if (ImGui::Button("Export trace")) {
+			ExportChromeTrace("cpu_trace.json");
+		}
+
+		float frameTimes[FrameHistory] = {};
+		int frameTimesCount = (int) std::min<uint64_t>(frameCount > 0 ? frameCount - 1 : 0, FrameHistory - 1);
+
+		for (int i = 0; i < frameTimesCount; i++) {
+			uint64_t frame = frameCount - frameTimesCount - 1 + i;
+
+			frameTimes[i] = (frameStarts[(frame + 1) % FrameHistory] - frameStarts[frame % FrameHistory]) / 1000000.0f;
+		}
+
+		ImGui::Text("CPU frame: %.3f ms", GetLastFrameTime());
+		ImGui::PlotLines("##CPUFrameTime", frameTimes, frameTimesCount, 0, "CPU frame (ms)", 0.0f, FLT_MAX, ImVec2(0, 60));
+
+		if (!paused && frameCount >= 2) {
+			timelineStart = frameStarts[(frameCount - 2) % FrameHistory];
+			timelineEnd = frameStarts[(frameCount - 1) % FrameHistory];
+
+			std::vector<ThreadBuffer*> threads;
+
+			{
+				std::lock_guard lock(buffersMutex);
+				threads = buffers;
+			}
+
+			timelineView.clear();
+
+			for (ThreadBuffer* thread : threads) {
+				ThreadView view;
+
+				{
+					std::lock_guard lock(thread->nameMutex);
+					view.name = thread->threadName;
+				}
+
+				for (const ZoneEvent& event : CopyEvents(thread, timelineStart)) {
+					if (event.start < timelineEnd) {
+						view.events.push_back(event);
+					}
+				}
+
+				timelineView.push_back(view);
+			}
+		}
+
+		if (timelineEnd > timelineStart) {
+			ImDrawList* drawList = ImGui::GetWindowDrawList();
+
+			float width = std::max(ImGui::GetContentRegionAvail().x, 400.0f);
+			float rowHeight = ImGui::GetTextLineHeightWithSpacing();
+			double scale = width / (double) (timelineEnd - timelineStart);
+
+			for (const ThreadView& view : timelineView) {
+				if (view.events.empty()) {
+					continue;
+				}
+
+				ImGui::Text("%s", view.name.c_str());
+
+				uint32_t maxDepth = 0;
+				for (const ZoneEvent& event : view.events) {
+					maxDepth = std::max(maxDepth, event.depth);
+				}
+
+				ImVec2 origin = ImGui::GetCursorScreenPos();
+				ImVec2 size(width, (maxDepth + 1) * rowHeight);
+
+				drawList->PushClipRect(origin, ImVec2(origin.x + size.x, origin.y + size.y), true);
+
+				for (const ZoneEvent& event : view.events) {
+					uint64_t start = std::max(event.start, timelineStart);
+					uint64_t end = std::min(event.end, timelineEnd);
+
+					ImVec2 min(origin.x + (float) ((start - timelineStart) * scale), origin.y + event.depth * rowHeight);
+					ImVec2 max(origin.x + (float) ((end - timelineStart) * scale), min.y + rowHeight - 1.0f);
+
+					max.x = std::max(max.x, min.x + 1.0f);
+
+					size_t hash = std::hash<std::string_view>()(event.name);
+					ImU32 color = IM_COL32(80 + hash % 120, 80 + (hash >> 8) % 120, 80 + (hash >> 16) % 120, 255);
+
+					drawList->AddRectFilled(min, max, color);
+
+					std::string name = DisplayName(event.name, event.detail);
+
+					if (max.x - min.x > ImGui::CalcTextSize(name.c_str()).x + 4.0f) {
+						drawList->AddText(ImVec2(min.x + 2.0f, min.y), IM_COL32_WHITE, name.c_str());
+					}
+
+					if (ImGui::IsMouseHoveringRect(min, max)) {
+						ImGui::SetTooltip("%s: %.3f ms", name.c_str(), (event.end - event.start) / 1000000.0f);
+					}
+				}
+
+				drawList->PopClipRect();
+
+				ImGui::Dummy(size);
+			}
+		}
+
+		ImGui::TreePop();
+	}
+}
\ No newline at end of file
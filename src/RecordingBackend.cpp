@@ -0,0 +1,300 @@
+#include <RecordingBackend.h>
+
+#include <bit>
+#include <algorithm>
+#include <format>
+#include <cstring>
+#include <string_view>
+
+RecordingBackend::RecordingBackend(bool keepCommands):
+keepCommands(keepCommands) {
+	Reset();
+}
+
+void RecordingBackend::Record(GraphicsCommandType type, bool redundant, uint32_t a, uint32_t b, uint32_t c, uint32_t d, uint64_t size) {
+	this->counts[(int) type]++;
+	this->redundantCount += redundant;
+
+	if (this->keepCommands) {
+		this->commands.push_back(GraphicsCommand{type, redundant, { a, b, c, d }, size});
+	}
+}
+
+void RecordingBackend::Reset() {
+	this->commands.clear();
+
+	for (uint64_t& count : this->counts) {
+		count = 0;
+	}
+
+	this->redundantCount = 0;
+	this->uploadedBytes = 0;
+
+	this->nextHandle = 1;
+
+	this->program = 0;
+	this->vertexArray = 0;
+	this->framebuffer = 0;
+
+	for (int i = 0; i < TextureUnits; i++) {
+		this->textures[i] = { 0, 0 };
+		this->images[i] = { 0, 0 };
+	}
+
+	this->bufferBases.clear();
+	this->capabilities.clear();
+	this->uniformValues.clear();
+
+	this->depthMask = -1;
+	this->depthFunc = 0;
+	this->cullFace = 0;
+	this->patchVertices = 0;
+}
+
+const std::vector<GraphicsCommand>& RecordingBackend::GetCommands() const {
+	return this->commands;
+}
+
+uint64_t RecordingBackend::GetCount(GraphicsCommandType type) const {
+	return this->counts[(int) type];
+}
+
+uint64_t RecordingBackend::GetRedundantCount() const {
+	return this->redundantCount;
+}
+
+uint64_t RecordingBackend::GetUploadedBytes() const {
+	return this->uploadedBytes;
+}
+
+std::string RecordingBackend::ToString() const {
+	std::string result;
+
+	for (const GraphicsCommand& command : this->commands) {
+		result += std::format("{} {} {} {} {}", GetName(command.type), command.args[0], command.args[1], command.args[2], command.args[3]);
+
+		if (command.size) {
+			result += std::format(" size={}", command.size);
+		}
+
+		if (command.redundant) {
+			result += " redundant";
+		}
+
+		result += "\n";
+	}
+
+	return result;
+}
+
+const char* RecordingBackend::GetName(GraphicsCommandType type) {
+	switch (type) {
+		case GraphicsCommandType::CreateBuffer:         return "CreateBuffer";
+		case GraphicsCommandType::DeleteBuffer:         return "DeleteBuffer";
+		case GraphicsCommandType::BufferData:           return "BufferData";
+		case GraphicsCommandType::BufferSubData:        return "BufferSubData";
+		case GraphicsCommandType::BindBufferBase:       return "BindBufferBase";
+		case GraphicsCommandType::UseProgram:           return "UseProgram";
+		case GraphicsCommandType::BindVertexArray:      return "BindVertexArray";
+		case GraphicsCommandType::BindTexture:          return "BindTexture";
+		case GraphicsCommandType::BindImageTexture:     return "BindImageTexture";
+		case GraphicsCommandType::SetUniform:           return "SetUniform";
+		case GraphicsCommandType::BindFramebuffer:      return "BindFramebuffer";
+		case GraphicsCommandType::SetViewport:          return "SetViewport";
+		case GraphicsCommandType::ClearColor:           return "ClearColor";
+		case GraphicsCommandType::Clear:                return "Clear";
+		case GraphicsCommandType::SetEnabled:           return "SetEnabled";
+		case GraphicsCommandType::SetDepthMask:         return "SetDepthMask";
+		case GraphicsCommandType::SetDepthFunc:         return "SetDepthFunc";
+		case GraphicsCommandType::SetCullFace:          return "SetCullFace";
+		case GraphicsCommandType::SetPatchVertices:     return "SetPatchVertices";
+		case GraphicsCommandType::DrawElements:         return "DrawElements";
+		case GraphicsCommandType::DrawElementsIndirect: return "DrawElementsIndirect";
+		case GraphicsCommandType::DispatchCompute:      return "DispatchCompute";
+		case GraphicsCommandType::Barrier:              return "Barrier";
+		default:                                        return "Unknown";
+	}
+}
+
+GLuint RecordingBackend::CreateBuffer() {
+	GLuint buffer = this->nextHandle++;
+
+	Record(GraphicsCommandType::CreateBuffer, false, buffer);
+
+	return buffer;
+}
+
+void RecordingBackend::DeleteBuffer(GLuint buffer) {
+	Record(GraphicsCommandType::DeleteBuffer, false, buffer);
+}
+
+void RecordingBackend::BufferData(GLenum target, GLuint buffer, size_t size, const void* data, GLenum usage) {
+	this->uploadedBytes += size;
+
+	Record(GraphicsCommandType::BufferData, false, target, buffer, usage, 0, size);
+}
+
+void RecordingBackend::BufferSubData(GLenum target, GLuint buffer, size_t offset, size_t size, const void* data) {
+	this->uploadedBytes += size;
+
+	Record(GraphicsCommandType::BufferSubData, false, target, buffer, offset, 0, size);
+}
+
+void RecordingBackend::BindBufferBase(GLenum target, unsigned int index, GLuint buffer) {
+	uint64_t key = ((uint64_t) target << 32) | index;
+
+	auto bound = this->bufferBases.find(key);
+	bool redundant = bound != this->bufferBases.end() && bound->second == buffer;
+
+	this->bufferBases[key] = buffer;
+
+	Record(GraphicsCommandType::BindBufferBase, redundant, target, index, buffer);
+}
+
+void RecordingBackend::UseProgram(GLuint program) {
+	bool redundant = this->program == program;
+
+	this->program = program;
+
+	Record(GraphicsCommandType::UseProgram, redundant, program);
+}
+
+void RecordingBackend::BindVertexArray(GLuint vertexArray) {
+	bool redundant = this->vertexArray == vertexArray;
+
+	this->vertexArray = vertexArray;
+
+	Record(GraphicsCommandType::BindVertexArray, redundant, vertexArray);
+}
+
+void RecordingBackend::BindTexture(unsigned int unit, GLenum target, GLuint texture) {
+	bool redundant = false;
+
+	if (unit < TextureUnits) {
+		redundant = this->textures[unit].target == target && this->textures[unit].texture == texture;
+
+		this->textures[unit] = { target, texture };
+	}
+
+	Record(GraphicsCommandType::BindTexture, redundant, unit, target, texture);
+}
+
+void RecordingBackend::BindImageTexture(unsigned int unit, GLuint texture, int level, bool layered, GLenum access, GLenum format) {
+	bool redundant = false;
+
+	if (unit < TextureUnits) {
+		redundant = this->images[unit].texture == texture && this->images[unit].level == level;
+
+		this->images[unit] = { texture, level };
+	}
+
+	Record(GraphicsCommandType::BindImageTexture, redundant, unit, texture, level, format);
+}
+
+int RecordingBackend::GetUniformLocation(GLuint program, const char* name) {
+	return -1;
+}
+
+void RecordingBackend::SetUniform(int location, UniformSpec::UniformType type, const void* value) {
+	bool isTexture = type == UniformSpec::UniformType::Sampler2D
+		|| type == UniformSpec::UniformType::Cubemap
+		|| type == UniformSpec::UniformType::Image2D
+		|| type == UniformSpec::UniformType::UImage2D
+		|| type == UniformSpec::UniformType::ImageCube;
+
+	size_t size = isTexture ? sizeof(int) : UniformSpec::SizeOf(type);
+	size_t hash = std::hash<std::string_view>()(std::string_view((const char*) value, size));
+
+	// Uniform values live in the program object, so the same location is only redundant within one program
+	uint64_t key = ((uint64_t) this->program << 32) | (uint32_t) location;
+
+	auto stored = this->uniformValues.find(key);
+	bool redundant = stored != this->uniformValues.end() && stored->second == hash;
+
+	this->uniformValues[key] = hash;
+
+	uint32_t firstWord = 0;
+	memcpy(&firstWord, value, std::min<size_t>(size, sizeof(firstWord)));
+
+	Record(GraphicsCommandType::SetUniform, redundant, std::bit_cast<uint32_t>(location), (uint32_t) type, firstWord, 0, size);
+}
+
+void RecordingBackend::BindFramebuffer(GLuint framebuffer) {
+	bool redundant = this->framebuffer == framebuffer;
+
+	this->framebuffer = framebuffer;
+
+	Record(GraphicsCommandType::BindFramebuffer, redundant, framebuffer);
+}
+
+void RecordingBackend::SetViewport(int x, int y, int width, int height) {
+	Record(GraphicsCommandType::SetViewport, false, x, y, width, height);
+}
+
+void RecordingBackend::ClearColor(float r, float g, float b, float a) {
+	Record(GraphicsCommandType::ClearColor, false, std::bit_cast<uint32_t>(r), std::bit_cast<uint32_t>(g), std::bit_cast<uint32_t>(b), std::bit_cast<uint32_t>(a));
+}
+
+void RecordingBackend::Clear(GLbitfield mask) {
+	Record(GraphicsCommandType::Clear, false, mask);
+}
+
+void RecordingBackend::SetEnabled(GLenum capability, bool enabled) {
+	auto stored = this->capabilities.find(capability);
+	bool redundant = stored != this->capabilities.end() && stored->second == enabled;
+
+	this->capabilities[capability] = enabled;
+
+	Record(GraphicsCommandType::SetEnabled, redundant, capability, enabled);
+}
+
+void RecordingBackend::SetDepthMask(bool enabled) {
+	bool redundant = this->depthMask == (int) enabled;
+
+	this->depthMask = enabled;
+
+	Record(GraphicsCommandType::SetDepthMask, redundant, enabled);
+}
+
+void RecordingBackend::SetDepthFunc(GLenum func) {
+	bool redundant = this->depthFunc == func;
+
+	this->depthFunc = func;
+
+	Record(GraphicsCommandType::SetDepthFunc, redundant, func);
+}
+
+void RecordingBackend::SetCullFace(GLenum face) {
+	bool redundant = this->cullFace == face;
+
+	this->cullFace = face;
+
+	Record(GraphicsCommandType::SetCullFace, redundant, face);
+}
+
+void RecordingBackend::SetPatchVertices(int vertices) {
+	bool redundant = this->patchVertices == vertices;
+
+	this->patchVertices = vertices;
+
+	Record(GraphicsCommandType::SetPatchVertices, redundant, vertices);
+}
+
+void RecordingBackend::DrawElements(GLenum mode, unsigned int count, GLenum indexType, uint64_t indexOffset, int baseVertex, unsigned int instanceCount) {
+	uint64_t indexBytes = (uint64_t) count * (indexType == GL_UNSIGNED_SHORT ? sizeof(uint16_t) : sizeof(uint32_t));
+
+	Record(GraphicsCommandType::DrawElements, false, mode, count, instanceCount, this->vertexArray, indexBytes);
+}
+
+// The draw count is only known on the GPU, record the upper bound
+void RecordingBackend::DrawElementsIndirect(GLenum mode, GLenum indexType, GLuint commandBuffer, uint64_t commandOffset, uint64_t countOffset, unsigned int maxDrawCount) {
+	Record(GraphicsCommandType::DrawElementsIndirect, false, mode, maxDrawCount, commandBuffer, this->vertexArray);
+}
+
+void RecordingBackend::DispatchCompute(unsigned int groupsX, unsigned int groupsY, unsigned int groupsZ) {
+	Record(GraphicsCommandType::DispatchCompute, false, groupsX, groupsY, groupsZ, this->program);
+}
+
+void RecordingBackend::Barrier(GLbitfield barriers) {
+	Record(GraphicsCommandType::Barrier, false, barriers);
+}
\ No newline at end of file
@@ -1,17 +1,24 @@
 #include <ReflectionProbeSystem.h>
 
-#include <GLFW/glfw3.h>
+#include <TimeSystem.h>
 #include <glm/glm.hpp>
 #include <imgui.h>
 
 #include <ReflectionProbe.h>
 #include <Graphics.h>
+#include <LightSystem.h>
+#include <RenderGraph.h>
+#include <GPUProfiler.h>
+#include <RenderStats.h>
 #include <Resources.h>
 #include <Skybox.h>
+#include <MemoryTracker.h>
 
 #include "../res/shaders/shared/shared.h"
 #include "../res/shaders/shared/uniforms.h"
 
+constexpr const char* PROBE_FACE_ZONES[6] = { "Probe Face 0", "Probe Face 1", "Probe Face 2", "Probe Face 3", "Probe Face 4", "Probe Face 5" };
+
 Texture2D* GenerateBRDFConvolution() {
 	static ComputeShaderDispatch* BrdfConvolutionDispatch;
 
@@ -54,6 +61,22 @@ skyboxProbe(nullptr) {
 	this->reflectionProbeFramebuffer = new Framebuffer(Framebuffer::Attachment::HDRColor | Framebuffer::Attachment::CubemappedColor | Framebuffer::Attachment::Depth, ReflectionProbe::resolution, ReflectionProbe::resolution);
 
 	this->brdfConvolutionMap = GenerateBRDFConvolution();
+
+	MemoryTracker::SetCategory(this->reflectionProbeFramebuffer->GetColorTexture(), MemoryCategory::ReflectionProbes);
+	MemoryTracker::SetCategory(this->reflectionProbeFramebuffer->GetDepthTexture(), MemoryCategory::ReflectionProbes);
+	MemoryTracker::SetCategory(this->brdfConvolutionMap, MemoryCategory::ReflectionProbes);
+}
+
+void ReflectionProbeSystem::ReplaceMaps(ReflectionProbe* probe, Cubemap* irradianceMap, Cubemap* prefilterMap) {
+	// The probe owns its maps, regenerating it releases the previous pair
+	delete probe->irradianceMap;
+	delete probe->prefilterMap;
+
+	probe->irradianceMap = irradianceMap;
+	probe->prefilterMap = prefilterMap;
+
+	MemoryTracker::SetCategory(irradianceMap, MemoryCategory::ReflectionProbes);
+	MemoryTracker::SetCategory(prefilterMap, MemoryCategory::ReflectionProbes);
 }
 
 void ReflectionProbeSystem::RecalculateSkyboxIBL() {
@@ -68,15 +91,13 @@ void ReflectionProbeSystem::RecalculateSkyboxIBL() {
 
 	if (!sky) {
 		this->skyboxProbe->dirty = false;
-		this->skyboxProbe->irradianceMap = new Cubemap(1, 1, Texture::HDRColorBuffer);
-		this->skyboxProbe->prefilterMap = new Cubemap(1, 1, Texture::HDRColorBuffer);
+		ReplaceMaps(this->skyboxProbe, new Cubemap(1, 1, Texture::HDRColorBuffer), new Cubemap(1, 1, Texture::HDRColorBuffer));
 
 		return;
 	}
 	
 	this->skyboxProbe->dirty = false;
-	this->skyboxProbe->irradianceMap = skyCubemap->GenerateIrradianceMap();
-	this->skyboxProbe->prefilterMap = skyCubemap->GeneratePrefilterIBLMap();
+	ReplaceMaps(this->skyboxProbe, skyCubemap->GenerateIrradianceMap(), skyCubemap->GeneratePrefilterIBLMap());
 }
 
 void ReflectionProbeSystem::InvalidateAll() {
@@ -113,7 +134,7 @@ Texture2D* ReflectionProbeSystem::BRDFConvolutionMap() {
 	return this->brdfConvolutionMap;
 }
 
-void ReflectionProbeSystem::OnPostRender() {
+void ReflectionProbeSystem::RenderProbe(ReflectionProbe* probe) {
 	const glm::vec3 directions[] {
 		{ 1,  0,  0},
 		{-1,  0,  0},
@@ -123,6 +144,74 @@ void ReflectionProbeSystem::OnPostRender() {
 		{ 0,  0, -1}
 	};
 
+	ShaderGlobalUniforms globalUniforms;
+	
+	globalUniforms.Global_CameraWorldPos = probe->GlobalTransform().Position();
+	globalUniforms.Global_Time = Time::Current();
+	globalUniforms.Global_CameraFarPlane = 0;
+	globalUniforms.Global_CameraNearPlane = 0;
+	globalUniforms.Global_CameraFov = glm::radians(90.0f);
+
+	GPUProfiler* profiler = GetScene()->GetGraphics()->GetGPUProfiler();
+
+	for (int face = 0; face < 6; face++) {
+		GPUProfiler::Scope faceZone(profiler, PROBE_FACE_ZONES[face]);
+
+		if (face == 2) {
+			globalUniforms.Global_ViewMatrix = glm::lookAt(
+				probe->GlobalTransform().Position().Value(),
+				probe->GlobalTransform().Position() + directions[face],
+				glm::vec3(0, 0, 1)
+			);
+		}
+		else if (face == 3) {
+			globalUniforms.Global_ViewMatrix = glm::lookAt(
+				probe->GlobalTransform().Position().Value(),
+				probe->GlobalTransform().Position() + directions[face],
+				glm::vec3(0, 0, -1)
+			);	
+		}
+		else {
+			globalUniforms.Global_ViewMatrix = glm::lookAt(
+				probe->GlobalTransform().Position().Value(),
+				probe->GlobalTransform().Position() + directions[face],
+				glm::vec3(0, -1, 0)
+			);
+		}
+		globalUniforms.Global_ProjectionMatrix = glm::perspective(glm::radians(90.0f), 1.0f, 0.1f, 100.0f);
+		globalUniforms.Global_VPMatrix = globalUniforms.Global_ProjectionMatrix * globalUniforms.Global_ViewMatrix;
+
+		this->reflectionProbeFramebuffer->SetColorTexture(this->reflectionProbeFramebuffer->GetColorTexture(), face);
+
+		RenderParams params(RenderPassType::Color, glm::vec4(0, 0, ReflectionProbe::resolution, ReflectionProbe::resolution), true);
+		params.lodBias = GetScene()->GetGraphics()->GetProbeLODBias();
+		
+		GetScene()->GetGraphics()->RenderScene(globalUniforms, this->reflectionProbeFramebuffer, params);
+
+		RenderStats::Add(RenderCounter::ProbeFaces);
+	}
+	
+	probe->dirty = false;
+
+	Cubemap* irradianceMap;
+	Cubemap* prefilterMap;
+
+	{
+		GPUProfiler::Scope zone(profiler, "Probe Irradiance");
+
+		irradianceMap = static_cast<Cubemap*>(this->reflectionProbeFramebuffer->GetColorTexture())->GenerateIrradianceMap();
+	}
+
+	{
+		GPUProfiler::Scope zone(profiler, "Probe Prefilter");
+
+		prefilterMap = static_cast<Cubemap*>(this->reflectionProbeFramebuffer->GetColorTexture())->GeneratePrefilterIBLMap();
+	}
+
+	ReplaceMaps(probe, irradianceMap, prefilterMap);
+}
+
+void ReflectionProbeSystem::OnPostRender() {
 	if (this->skyboxProbe == nullptr) {
 		RecalculateSkyboxIBL();
 
@@ -140,49 +229,14 @@ void ReflectionProbeSystem::OnPostRender() {
 			break;
 		}
 
-		ShaderGlobalUniforms globalUniforms;
-		
-		globalUniforms.Global_CameraWorldPos = probe->GlobalTransform().Position();
-		globalUniforms.Global_Time = (float) glfwGetTime();
-		globalUniforms.Global_CameraFarPlane = 0;
-		globalUniforms.Global_CameraNearPlane = 0;
-		globalUniforms.Global_CameraFov = glm::radians(90.0f);
-
-		for (int face = 0; face < 6; face++) {
-			if (face == 2) {
-				globalUniforms.Global_ViewMatrix = glm::lookAt(
-					probe->GlobalTransform().Position().Value(),
-					probe->GlobalTransform().Position() + directions[face],
-					glm::vec3(0, 0, 1)
-				);
-			}
-			else if (face == 3) {
-				globalUniforms.Global_ViewMatrix = glm::lookAt(
-					probe->GlobalTransform().Position().Value(),
-					probe->GlobalTransform().Position() + directions[face],
-					glm::vec3(0, 0, -1)
-				);	
-			}
-			else {
-				globalUniforms.Global_ViewMatrix = glm::lookAt(
-					probe->GlobalTransform().Position().Value(),
-					probe->GlobalTransform().Position() + directions[face],
-					glm::vec3(0, -1, 0)
-				);
-			}
-			globalUniforms.Global_ProjectionMatrix = glm::perspective(glm::radians(90.0f), 1.0f, 0.1f, 100.0f);
-			globalUniforms.Global_VPMatrix = globalUniforms.Global_ProjectionMatrix * globalUniforms.Global_ViewMatrix;
-
-			this->reflectionProbeFramebuffer->SetColorTexture(this->reflectionProbeFramebuffer->GetColorTexture(), face);
-
-			RenderParams params(RenderPassType::Color, glm::vec4(0, 0, ReflectionProbe::resolution, ReflectionProbe::resolution), true);
-			
-			GetScene()->GetGraphics()->RenderScene(globalUniforms, this->reflectionProbeFramebuffer, params);
-		}
-		
-		probe->dirty = false;
-		probe->irradianceMap = static_cast<Cubemap*>(this->reflectionProbeFramebuffer->GetColorTexture())->GenerateIrradianceMap();
-		probe->prefilterMap = static_cast<Cubemap*>(this->reflectionProbeFramebuffer->GetColorTexture())->GeneratePrefilterIBLMap();
+		RenderGraph* graph = GetScene()->GetGraphics()->GetRenderGraph();
+
+		graph->AddPass("Reflection Probe", [this, probe](RenderGraph*) {
+			RenderProbe(probe);
+		})
+		.Read(graph->ImportTexture("Shadow Atlas", GetScene()->GetGraphics()->GetLightSystem()->GetShadowAtlasTexture()), RenderResourceUsage::Sampled)
+		.Write(graph->ImportTexture("Reflection Probe Capture", this->reflectionProbeFramebuffer->GetColorTexture()), RenderResourceUsage::RenderTarget)
+		.SideEffect();
 
 		break; // Only recompute 1 probe at a time
 	}
@@ -0,0 +1,414 @@
+#include <RenderGraph.h>
+
+#include <cstring>
+
+#include <spdlog/spdlog.h>
+#include <imgui.h>
+
+#include <GPUProfiler.h>
+#include <GraphicsBackend.h>
+#include <Profiler.h>
+#include <FrameAllocator.h>
+#include <MemoryTracker.h>
+
+constexpr int TRANSIENT_POOL_MAX_UNUSED_FRAMES = 120;
+
+RenderGraph::PassBuilder::PassBuilder(RenderGraph* graph, int passIndex):
+graph(graph),
+passIndex(passIndex) { }
+
+RenderGraph::PassBuilder& RenderGraph::PassBuilder::Read(ResourceHandle resource, RenderResourceUsage usage) {
+	if (resource < 0 || resource >= this->graph->resourceCount) {
+		spdlog::error("Render pass {} reads an invalid resource", this->graph->passes[this->passIndex].name);
+		return *this;
+	}
+
+	this->graph->passes[this->passIndex].accesses.push_back(PassAccess{resource, usage, false});
+
+	return *this;
+}
+
+RenderGraph::PassBuilder& RenderGraph::PassBuilder::Write(ResourceHandle resource, RenderResourceUsage usage) {
+	if (resource < 0 || resource >= this->graph->resourceCount) {
+		spdlog::error("Render pass {} writes an invalid resource", this->graph->passes[this->passIndex].name);
+		return *this;
+	}
+
+	this->graph->passes[this->passIndex].accesses.push_back(PassAccess{resource, usage, true});
+
+	return *this;
+}
+
+RenderGraph::PassBuilder& RenderGraph::PassBuilder::SideEffect() {
+	this->graph->passes[this->passIndex].sideEffect = true;
+
+	return *this;
+}
+
+RenderGraph::RenderGraph(GPUProfiler* profiler):
+resources(),
+passes(),
+resourceCount(0),
+passCount(0),
+texturePool(),
+scratchTextures(),
+lastFrameStats(),
+lastFrameTransientCount(0),
+executing(false),
+profiler(profiler) { }
+
+RenderGraph::~RenderGraph() {
+	for (PooledTexture& pooled : this->texturePool) {
+		delete pooled.texture;
+	}
+}
+
+bool RenderGraph::IsShaderWrite(RenderResourceUsage usage) {
+	return usage == RenderResourceUsage::Image || usage == RenderResourceUsage::Storage;
+}
+
+GLbitfield RenderGraph::BarrierFor(RenderResourceUsage usage, bool isBuffer) {
+	switch (usage) {
+		case RenderResourceUsage::RenderTarget:
+			return GL_FRAMEBUFFER_BARRIER_BIT;
+		case RenderResourceUsage::Sampled:
+			return GL_TEXTURE_FETCH_BARRIER_BIT;
+		case RenderResourceUsage::Image:
+			return GL_SHADER_IMAGE_ACCESS_BARRIER_BIT;
+		case RenderResourceUsage::Storage:
+			return GL_SHADER_STORAGE_BARRIER_BIT;
+		case RenderResourceUsage::Uniform:
+			return GL_UNIFORM_BARRIER_BIT;
+		case RenderResourceUsage::Copy:
+			return isBuffer ? GL_BUFFER_UPDATE_BARRIER_BIT : GL_TEXTURE_UPDATE_BARRIER_BIT;
+		case RenderResourceUsage::Upload:
+			return GL_BUFFER_UPDATE_BARRIER_BIT;
+	}
+
+	return 0;
+}
+
+bool RenderGraph::ParamsMatch(const TextureParams& a, const TextureParams& b) {
+	return (
+		Texture::CalcInternalFormat(a) == Texture::CalcInternalFormat(b)
+		&& a.wrapU == b.wrapU
+		&& a.wrapV == b.wrapV
+		&& a.minFilter == b.minFilter
+		&& a.magFilter == b.magFilter
+	);
+}
+
+Texture2D* RenderGraph::AcquireTexture(const glm::uvec2& size, const TextureParams& params) {
+	for (PooledTexture& pooled : this->texturePool) {
+		if (pooled.inUse || pooled.texture->GetSize() != size || !ParamsMatch(pooled.params, params)) {
+			continue;
+		}
+
+		pooled.inUse = true;
+		pooled.unusedFrames = 0;
+
+		return pooled.texture;
+	}
+
+	PooledTexture pooled;
+	pooled.texture = new Texture2D(size.x, size.y, params);
+	pooled.params = params;
+	pooled.inUse = true;
+	pooled.unusedFrames = 0;
+
+	this->texturePool.push_back(pooled);
+
+	MemoryTracker::SetCategory(pooled.texture, MemoryCategory::RenderTargets);
+
+	return pooled.texture;
+}
+
+void RenderGraph::ReleaseTexture(Texture2D* texture) {
+	for (PooledTexture& pooled : this->texturePool) {
+		if (pooled.texture == texture) {
+			pooled.inUse = false;
+			return;
+		}
+	}
+}
+
+void RenderGraph::TrimPool() {
+	for (int i = (int) this->texturePool.size() - 1; i >= 0; i--) {
+		PooledTexture& pooled = this->texturePool[i];
+
+		if (pooled.inUse) {
+			pooled.inUse = false;
+			continue;
+		}
+
+		pooled.unusedFrames++;
+
+		if (pooled.unusedFrames > TRANSIENT_POOL_MAX_UNUSED_FRAMES) {
+			delete pooled.texture;
+			this->texturePool.erase(this->texturePool.begin() + i);
+		}
+	}
+}
+
+RenderGraph::ResourceHandle RenderGraph::AddResource(const char* name, Texture* texture, GLuint buffer, bool transient, const glm::uvec2& size, const TextureParams& params) {
+	if (this->resourceCount == (int) this->resources.size()) {
+		this->resources.emplace_back();
+	}
+
+	GraphResource& resource = this->resources[this->resourceCount];
+	resource.name = name;
+	resource.texture = texture;
+	resource.buffer = buffer;
+	resource.transient = transient;
+	resource.output = false;
+	resource.size = size;
+	resource.params = params;
+	resource.firstUse = -1;
+	resource.lastUse = -1;
+	resource.pendingShaderWrite = false;
+
+	return (ResourceHandle) this->resourceCount++;
+}
+
+RenderGraph::ResourceHandle RenderGraph::ImportTexture(const char* name, Texture* texture) {
+	for (int i = 0; i < this->resourceCount; i++) {
+		if (!this->resources[i].transient && this->resources[i].texture == texture && (texture != nullptr || std::strcmp(this->resources[i].name, name) == 0)) {
+			return i;
+		}
+	}
+
+	return AddResource(name, texture, 0, false, texture ? texture->GetSize() : glm::uvec2(0), Texture::HDRColorBuffer);
+}
+
+RenderGraph::ResourceHandle RenderGraph::ImportBuffer(const char* name, GLuint buffer) {
+	for (int i = 0; i < this->resourceCount; i++) {
+		if (!this->resources[i].transient && !this->resources[i].texture && this->resources[i].buffer == buffer && buffer != 0) {
+			return i;
+		}
+	}
+
+	return AddResource(name, nullptr, buffer, false, glm::uvec2(0), Texture::HDRColorBuffer);
+}
+
+RenderGraph::ResourceHandle RenderGraph::CreateTexture(const char* name, const glm::uvec2& size, const TextureParams& params) {
+	return AddResource(name, nullptr, 0, true, size, params);
+}
+
+Texture2D* RenderGraph::AcquireScratchTexture(const glm::uvec2& size, const TextureParams& params) {
+	Texture2D* texture = AcquireTexture(size, params);
+
+	this->scratchTextures.push_back(texture);
+
+	return texture;
+}
+
+void RenderGraph::MarkOutput(ResourceHandle resource) {
+	if (resource < 0 || resource >= this->resourceCount) {
+		return;
+	}
+
+	this->resources[resource].output = true;
+}
+
+RenderGraph::PassBuilder RenderGraph::AddPass(const char* name, void* closure, void (*execute)(void* closure, RenderGraph* graph)) {
+	if (this->executing) {
+		spdlog::error("Tried to add render pass {} while the render graph is executing", name);
+	}
+
+	if (this->passCount == (int) this->passes.size()) {
+		this->passes.emplace_back();
+	}
+
+	GraphPass& pass = this->passes[this->passCount];
+	pass.name = name;
+	pass.accesses.clear();
+	pass.closure = closure;
+	pass.execute = execute;
+	pass.sideEffect = false;
+	pass.culled = false;
+	pass.barriers = 0;
+
+	return PassBuilder(this, this->passCount++);
+}
+
+Texture* RenderGraph::GetTexture(ResourceHandle resource) const {
+	if (resource < 0 || resource >= this->resourceCount) {
+		return nullptr;
+	}
+
+	return this->resources[resource].texture;
+}
+
+GLuint RenderGraph::GetBuffer(ResourceHandle resource) const {
+	if (resource < 0 || resource >= this->resourceCount) {
+		return 0;
+	}
+
+	return this->resources[resource].buffer;
+}
+
+bool RenderGraph::IsExecuting() const {
+	return this->executing;
+}
+
+void RenderGraph::Compile() {
+	FrameVector<bool> needed(this->resourceCount, false);
+
+	for (int i = 0; i < this->resourceCount; i++) {
+		needed[i] = this->resources[i].output;
+	}
+
+	for (int i = this->passCount - 1; i >= 0; i--) {
+		GraphPass& pass = this->passes[i];
+
+		bool alive = pass.sideEffect;
+
+		for (const PassAccess& access : pass.accesses) {
+			if (access.write && needed[access.resource]) {
+				alive = true;
+				break;
+			}
+		}
+
+		pass.culled = !alive;
+
+		if (!alive) {
+			continue;
+		}
+
+		for (const PassAccess& access : pass.accesses) {
+			if (!access.write) {
+				needed[access.resource] = true;
+			}
+		}
+	}
+
+	for (int i = 0; i < this->passCount; i++) {
+		GraphPass& pass = this->passes[i];
+
+		if (pass.culled) {
+			continue;
+		}
+
+		pass.barriers = 0;
+
+		for (const PassAccess& access : pass.accesses) {
+			GraphResource& resource = this->resources[access.resource];
+
+			if (resource.firstUse < 0) {
+				resource.firstUse = i;
+			}
+			resource.lastUse = i;
+
+			if (resource.pendingShaderWrite) {
+				pass.barriers |= BarrierFor(access.usage, resource.texture == nullptr && !resource.transient);
+			}
+		}
+
+		for (const PassAccess& access : pass.accesses) {
+			GraphResource& resource = this->resources[access.resource];
+
+			if (access.write) {
+				resource.pendingShaderWrite = IsShaderWrite(access.usage);
+			}
+			else if (pass.barriers != 0) {
+				resource.pendingShaderWrite = false;
+			}
+		}
+	}
+}
+
+void RenderGraph::Reset() {
+	this->resourceCount = 0;
+	this->passCount = 0;
+}
+
+void RenderGraph::Execute() {
+	PROFILE_ZONE("RenderGraph::Execute");
+
+	Compile();
+
+	this->executing = true;
+
+	this->lastFrameStats.clear();
+	this->lastFrameTransientCount = 0;
+
+	for (int i = 0; i < this->passCount; i++) {
+		GraphPass& pass = this->passes[i];
+
+		this->lastFrameStats.push_back(PassStats{pass.name, pass.culled, pass.barriers});
+
+		if (pass.culled) {
+			continue;
+		}
+
+		for (int r = 0; r < this->resourceCount; r++) {
+			GraphResource& resource = this->resources[r];
+
+			if (resource.transient && resource.firstUse == i) {
+				resource.texture = AcquireTexture(resource.size, resource.params);
+				this->lastFrameTransientCount++;
+			}
+		}
+
+		if (pass.barriers != 0) {
+			GraphicsBackend::Current()->Barrier(pass.barriers);
+		}
+
+		PROFILE_ZONE(pass.name);
+		GPUProfiler::Scope zone(this->profiler, pass.name);
+
+		pass.execute(pass.closure, this);
+
+		for (Texture2D* texture : this->scratchTextures) {
+			ReleaseTexture(texture);
+		}
+
+		this->scratchTextures.clear();
+
+		for (int r = 0; r < this->resourceCount; r++) {
+			GraphResource& resource = this->resources[r];
+
+			if (resource.transient && resource.lastUse == i) {
+				ReleaseTexture(static_cast<Texture2D*>(resource.texture));
+			}
+		}
+	}
+
+	this->executing = false;
+
+	TrimPool();
+
+	Reset();
+}
+
+void RenderGraph::DrawImGui() {
+	if (ImGui::TreeNode("Render Graph")) {
+		int culledCount = 0;
+
+		for (const PassStats& stats : this->lastFrameStats) {
+			if (stats.culled) {
+				culledCount++;
+			}
+		}
+
+		ImGui::Text("Passes: %i (%i culled)", (int) this->lastFrameStats.size(), culledCount);
+		ImGui::Text("Transient textures: %i (%i pooled)", this->lastFrameTransientCount, (int) this->texturePool.size());
+
+		ImGui::Separator();
+
+		for (const PassStats& stats : this->lastFrameStats) {
+			if (stats.culled) {
+				ImGui::TextDisabled("%s (culled)", stats.name);
+			}
+			else if (stats.barriers != 0) {
+				ImGui::Text("%s (barrier 0x%x)", stats.name, stats.barriers);
+			}
+			else {
+				ImGui::Text("%s", stats.name);
+			}
+		}
+
+		ImGui::TreePop();
+	}
+}
\ No newline at end of file
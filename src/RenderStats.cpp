@@ -0,0 +1,130 @@
+#include <RenderStats.h>
+
+#include <format>
+#include <fstream>
+
+#include <spdlog/spdlog.h>
+#include <imgui.h>
+
+uint64_t RenderStats::current[(int) RenderCounter::Count] = {};
+RenderStats::Snapshot RenderStats::lastFrame = {};
+uint64_t RenderStats::frameIndex = 0;
+
+uint64_t RenderStats::Snapshot::Get(RenderCounter counter) const {
+	return this->counters[(int) counter];
+}
+
+void RenderStats::BeginFrame() {
+	for (int i = 0; i < (int) RenderCounter::Count; i++) {
+		current[i] = 0;
+	}
+}
+
+void RenderStats::EndFrame() {
+	lastFrame.frame = frameIndex;
+
+	for (int i = 0; i < (int) RenderCounter::Count; i++) {
+		lastFrame.counters[i] = current[i];
+	}
+
+	frameIndex++;
+}
+
+uint64_t RenderStats::Get(RenderCounter counter) {
+	return lastFrame.Get(counter);
+}
+
+const RenderStats::Snapshot& RenderStats::GetLastFrame() {
+	return lastFrame;
+}
+
+const char* RenderStats::GetName(RenderCounter counter) {
+	switch (counter) {
+		case RenderCounter::DrawCalls:            return "Draw calls";
+		case RenderCounter::InstancedDrawCalls:   return "Instanced draw calls";
+		case RenderCounter::Triangles:            return "Triangles";
+		case RenderCounter::FrustumCulled:        return "Frustum culled";
+		case RenderCounter::LayerCulled:          return "Layer culled";
+		case RenderCounter::MaterialBinds:        return "Material binds";
+		case RenderCounter::ProgramBinds:         return "Program binds";
+		case RenderCounter::VertexArrayBinds:     return "VAO binds";
+		case RenderCounter::TextureBinds:         return "Texture binds";
+		case RenderCounter::UniformBytesUploaded: return "Uniform bytes uploaded";
+		case RenderCounter::ShadowViews:          return "Shadow views";
+		case RenderCounter::ProbeFaces:           return "Probe faces";
+		case RenderCounter::PostProcessSteps:     return "Post process steps";
+		case RenderCounter::ComputeDispatches:    return "Compute dispatches";
+		case RenderCounter::MeshletDraws:         return "Meshlet draws";
+		default:                                  return "Unknown";
+	}
+}
+
+const char* RenderStats::GetKey(RenderCounter counter) {
+	switch (counter) {
+		case RenderCounter::DrawCalls:            return "drawCalls";
+		case RenderCounter::InstancedDrawCalls:   return "instancedDrawCalls";
+		case RenderCounter::Triangles:            return "triangles";
+		case RenderCounter::FrustumCulled:        return "frustumCulled";
+		case RenderCounter::LayerCulled:          return "layerCulled";
+		case RenderCounter::MaterialBinds:        return "materialBinds";
+		case RenderCounter::ProgramBinds:         return "programBinds";
+		case RenderCounter::VertexArrayBinds:     return "vertexArrayBinds";
+		case RenderCounter::TextureBinds:         return "textureBinds";
+		case RenderCounter::UniformBytesUploaded: return "uniformBytesUploaded";
+		case RenderCounter::ShadowViews:          return "shadowViews";
+		case RenderCounter::ProbeFaces:           return "probeFaces";
+		case RenderCounter::PostProcessSteps:     return "postProcessSteps";
+		case RenderCounter::ComputeDispatches:    return "computeDispatches";
+		case RenderCounter::MeshletDraws:         return "meshletDraws";
+		default:                                  return "unknown";
+	}
+}
+
+std::string RenderStats::ToJSON() {
+	std::string json = std::format("{{\"frame\":{}", lastFrame.frame);
+
+	for (int i = 0; i < (int) RenderCounter::Count; i++) {
+		json += std::format(",\"{}\":{}", GetKey((RenderCounter) i), lastFrame.counters[i]);
+	}
+
+	json += "}";
+
+	return json;
+}
+
+bool RenderStats::Dump(const fs::path& path) {
+	std::ofstream file(path, std::ios::app);
+
+	if (!file.is_open()) {
+		spdlog::error("Failed to open {} for render stats dump", path.string());
+		return false;
+	}
+
+	file << ToJSON() << "\n";
+
+	return true;
+}
+
+void RenderStats::DrawImGui() {
+	if (ImGui::TreeNode("Render Stats")) {
+		if (ImGui::BeginTable("Render Counters", 2, ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV)) {
+			for (int i = 0; i < (int) RenderCounter::Count; i++) {
+				ImGui::TableNextRow();
+
+				ImGui::TableSetColumnIndex(0);
+				ImGui::TextUnformatted(GetName((RenderCounter) i));
+
+				ImGui::TableSetColumnIndex(1);
+				ImGui::Text("%llu", (unsigned long long) lastFrame.counters[i]);
+			}
+
+			ImGui::EndTable();
+		}
+
+		if (ImGui::Button("Dump to render_stats.jsonl")) {
+			Dump("render_stats.jsonl");
+		}
+
+		ImGui::TreePop();
+	}
+}
\ No newline at end of file
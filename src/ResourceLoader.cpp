@@ -0,0 +1,256 @@
+#include <ResourceLoader.h>
+
+#include <chrono>
+#include <atomic>
+#include <memory>
+#include <algorithm>
+#include <iterator>
+#include <format>
+
+#include <spdlog/spdlog.h>
+
+#include <Profiler.h>
+
+std::mutex ResourceLoader::jobsMutex;
+std::condition_variable ResourceLoader::jobsAvailable;
+std::deque<ResourceLoader::Task> ResourceLoader::jobs;
+std::vector<std::thread> ResourceLoader::workers;
+bool ResourceLoader::stopping = false;
+
+std::mutex ResourceLoader::uploadsMutex;
+std::condition_variable ResourceLoader::uploadsAvailable;
+std::deque<ResourceLoader::Task> ResourceLoader::uploads;
+
+std::thread::id ResourceLoader::contextThread;
+
+void ResourceLoader::WorkerMain(int index) {
+	Profiler::SetThreadName(std::format("Loader {}", index));
+
+	while (true) {
+		std::function<void()> job;
+
+		{
+			std::unique_lock lock(jobsMutex);
+
+			jobsAvailable.wait(lock, [] { return stopping || !jobs.empty(); });
+
+			if (stopping) {
+				return;
+			}
+
+			job = std::move(jobs.front().run);
+			jobs.pop_front();
+		}
+
+		PROFILE_ZONE("ResourceLoader::Job");
+
+		job();
+	}
+}
+
+void ResourceLoader::Start(int workerCount) {
+	std::lock_guard lock(jobsMutex);
+
+	if (!workers.empty()) {
+		return;
+	}
+
+	if (workerCount <= 0) {
+		workerCount = std::max((int) std::thread::hardware_concurrency() - 1, 1);
+	}
+
+	contextThread = std::this_thread::get_id();
+	stopping = false;
+
+	for (int i = 0; i < workerCount; i++) {
+		workers.emplace_back(WorkerMain, i);
+	}
+
+	spdlog::info("Started {} resource loader threads", workerCount);
+}
+
+void ResourceLoader::Stop() {
+	{
+		std::lock_guard lock(jobsMutex);
+
+		stopping = true;
+	}
+
+	jobsAvailable.notify_all();
+
+	for (std::thread& worker : workers) {
+		worker.join();
+	}
+
+	std::deque<Task> dropped;
+
+	{
+		std::lock_guard jobsLock(jobsMutex);
+		std::lock_guard uploadsLock(uploadsMutex);
+
+		workers.clear();
+
+		dropped.swap(jobs);
+		std::move(uploads.begin(), uploads.end(), std::back_inserter(dropped));
+		uploads.clear();
+	}
+
+	if (!dropped.empty()) {
+		spdlog::warn("Dropping {} resource loads still in flight", dropped.size());
+	}
+
+	// Outside the locks, cancelling completes the loads in their databases
+	for (Task& task : dropped) {
+		if (task.cancel) {
+			task.cancel();
+		}
+	}
+}
+
+bool ResourceLoader::IsRunning() {
+	std::lock_guard lock(jobsMutex);
+
+	return !workers.empty();
+}
+
+void ResourceLoader::Enqueue(std::function<void()> job, std::function<void()> cancel) {
+	if (!IsRunning()) {
+		Start();
+	}
+
+	{
+		std::lock_guard lock(jobsMutex);
+
+		jobs.push_back(Task{std::move(job), std::move(cancel)});
+	}
+
+	jobsAvailable.notify_one();
+}
+
+void ResourceLoader::ParallelFor(int count, const std::function<void(int)>& body) {
+	struct Range {
+		std::atomic<int> next = 0;
+		std::atomic<int> finished = 0;
+	};
+
+	int helpers = 0;
+
+	{
+		std::lock_guard lock(jobsMutex);
+
+		helpers = std::min((int) workers.size(), count - 1);
+	}
+
+	if (helpers <= 0) {
+		for (int i = 0; i < count; i++) {
+			body(i);
+		}
+
+		return;
+	}
+
+	// Helpers that only start after the caller is done find nothing left and never touch body
+	auto range = std::make_shared<Range>();
+
+	auto work = [range, count, &body] {
+		for (int i = range->next++; i < count; i = range->next++) {
+			body(i);
+
+			if (++range->finished == count) {
+				range->finished.notify_all();
+			}
+		}
+	};
+
+	{
+		std::lock_guard lock(jobsMutex);
+
+		for (int i = 0; i < helpers; i++) {
+			jobs.push_front(Task{work, nullptr});
+		}
+	}
+
+	jobsAvailable.notify_all();
+
+	work();
+
+	for (int finished = range->finished; finished < count; finished = range->finished) {
+		range->finished.wait(finished);
+	}
+}
+
+void ResourceLoader::EnqueueUpload(std::function<void()> upload, std::function<void()> cancel) {
+	{
+		std::lock_guard lock(uploadsMutex);
+
+		uploads.push_back(Task{std::move(upload), std::move(cancel)});
+	}
+
+	uploadsAvailable.notify_all();
+}
+
+int ResourceLoader::ProcessUploads(double budgetSeconds) {
+	PROFILE_ZONE("ResourceLoader::ProcessUploads");
+
+	auto start = std::chrono::steady_clock::now();
+	int processed = 0;
+
+	while (true) {
+		std::function<void()> upload;
+
+		{
+			std::lock_guard lock(uploadsMutex);
+
+			if (uploads.empty()) {
+				break;
+			}
+
+			upload = std::move(uploads.front().run);
+			uploads.pop_front();
+		}
+
+		upload();
+		processed++;
+
+		std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+		if (budgetSeconds > 0.0 && elapsed.count() >= budgetSeconds) {
+			break;
+		}
+	}
+
+	return processed;
+}
+
+void ResourceLoader::ProcessUploadsUntil(const std::function<bool()>& done) {
+	if (!IsContextThread()) {
+		spdlog::error("Waiting on resource loads outside of the GL context thread would never finish");
+		return;
+	}
+
+	while (!done()) {
+		if (ProcessUploads() > 0) {
+			continue;
+		}
+
+		std::unique_lock lock(uploadsMutex);
+
+		uploadsAvailable.wait_for(lock, std::chrono::milliseconds(1), [] { return !uploads.empty(); });
+	}
+}
+
+bool ResourceLoader::IsContextThread() {
+	return !IsRunning() || std::this_thread::get_id() == contextThread;
+}
+
+int ResourceLoader::GetPendingJobs() {
+	std::lock_guard lock(jobsMutex);
+
+	return (int) jobs.size();
+}
+
+int ResourceLoader::GetPendingUploads() {
+	std::lock_guard lock(uploadsMutex);
+
+	return (int) uploads.size();
+}
\ No newline at end of file
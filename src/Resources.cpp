@@ -1,24 +1,470 @@
 #include <Resources.h>
 
+#include <fstream>
+#include <cstring>
+
+std::shared_mutex ResourcePaths::mutex;
+std::unordered_map<std::string, ResourceId> ResourcePaths::ids;
+std::deque<fs::path> ResourcePaths::paths;
+
+std::mutex ResourceDatabase::sharedMutex;
+std::unordered_map<uint64_t, ResourceDatabase::SharedResource> ResourceDatabase::sharedResources;
+std::unordered_map<const std::type_info*, const Resource*> ResourceDatabase::placeholders;
+thread_local ResourceDatabase::LoadingFile ResourceDatabase::loadingFile = {};
+
 ResourceDatabase* const ResourceDatabase::Global = new ResourceDatabase();
 
+ResourceId ResourcePaths::Intern(const fs::path& path) {
+	std::string key = path.lexically_normal().generic_string();
+
+	{
+		std::shared_lock lock(mutex);
+
+		auto it = ids.find(key);
+
+		if (it != ids.end()) {
+			return it->second;
+		}
+	}
+
+	std::unique_lock lock(mutex);
+
+	auto [it, created] = ids.try_emplace(key, (ResourceId) paths.size());
+
+	if (created) {
+		paths.push_back(key);
+	}
+
+	return it->second;
+}
+
+const fs::path& ResourcePaths::GetPath(ResourceId id) {
+	std::shared_lock lock(mutex);
+
+	return paths[id];
+}
+
+ResourceDatabase::ResourceDatabase():
+useCounter(0),
+budget(0) { }
+
+ResourceDatabase::~ResourceDatabase() {
+	// Loads in flight still point at this database
+	ResourceLoader::ProcessUploadsUntil([this] {
+		return GetPendingLoads() == 0;
+	});
+
+	Purge();
+}
+
+uint64_t ResourceDatabase::HashBytes(uint64_t hash, const void* data, size_t size) {
+	const unsigned char* bytes = static_cast<const unsigned char*>(data);
+
+	for (size_t i = 0; i < size; i++) {
+		hash ^= bytes[i];
+		hash *= 0x100000001b3ull;
+	}
+
+	return hash;
+}
+
+uint64_t ResourceDatabase::HashContent(const fs::path& path, const std::type_info& type) {
+	if (loadingFile.path && *loadingFile.type == type && *loadingFile.path == path) {
+		return loadingFile.hash;
+	}
+
+	uint64_t hash = 0xcbf29ce484222325ull;
+
+	hash = HashBytes(hash, type.name(), std::strlen(type.name()));
+
+	// Files can refer to others relative to themselves, so only identical files in the same folder are shared
+	std::string directory = path.lexically_normal().parent_path().generic_string();
+	hash = HashBytes(hash, directory.data(), directory.size());
+
+	std::ifstream file(path, std::ios::binary);
+
+	if (!file.is_open()) {
+		// Paths that do not name a file directly, like the parts of a cubemap
+		std::string name = path.lexically_normal().generic_string();
+
+		return HashBytes(hash, name.data(), name.size());
+	}
+
+	char buffer[64 * 1024];
+
+	while (file) {
+		file.read(buffer, sizeof(buffer));
+		hash = HashBytes(hash, buffer, file.gcount());
+	}
+
+	return hash;
+}
+
+const Resource* ResourceDatabase::AcquireShared(uint64_t contentKey, const std::type_info& type) {
+	if (!contentKey) {
+		return nullptr;
+	}
+
+	std::lock_guard lock(sharedMutex);
+
+	auto it = sharedResources.find(contentKey);
+
+	if (it == sharedResources.end() || it->second.type != &type) {
+		return nullptr;
+	}
+
+	it->second.users++;
+
+	return it->second.resource;
+}
+
+const Resource* ResourceDatabase::ShareLoaded(uint64_t contentKey, const std::type_info& type, const Resource* resource) {
+	if (!contentKey) {
+		return resource;
+	}
+
+	std::unique_lock lock(sharedMutex);
+
+	auto [it, created] = sharedResources.try_emplace(contentKey, SharedResource{&type, resource, 0});
+
+	if (!created && it->second.type != &type) {
+		// Hash collision between types, keep this one private
+		return resource;
+	}
+
+	it->second.users++;
+
+	if (!created) {
+		// Another database finished loading the same content first
+		const Resource* shared = it->second.resource;
+
+		lock.unlock();
+		delete resource;
+
+		return shared;
+	}
+
+	return resource;
+}
+
+const Resource* ResourceDatabase::ReleaseShared(uint64_t contentKey, const Resource* resource) {
+	if (!contentKey) {
+		return resource;
+	}
+
+	std::lock_guard lock(sharedMutex);
+
+	auto it = sharedResources.find(contentKey);
+
+	if (it == sharedResources.end() || it->second.resource != resource) {
+		return resource;
+	}
+
+	if (--it->second.users > 0) {
+		return nullptr;
+	}
+
+	sharedResources.erase(it);
+
+	return resource;
+}
+
+const Resource* ResourceDatabase::Find(ResourceId id, const std::type_info& type, bool pin) {
+	std::shared_lock lock(this->mutex);
+
+	auto it = this->loadedResources.find(id);
+
+	if (it == this->loadedResources.end() || it->second.type != &type) {
+		return nullptr;
+	}
+
+	ResourceInfo& info = it->second;
+
+	if (pin) {
+		info.pinned = true;
+	}
+	else {
+		info.references++;
+	}
+
+	info.lastUsed = this->useCounter++;
+
+	return info.resource;
+}
+
+const Resource* ResourceDatabase::Insert(ResourceId id, const std::type_info& type, const Resource* resource, uint64_t contentKey, bool pin) {
+	std::vector<const Resource*> victims;
+	const Resource* result;
+
+	{
+		std::unique_lock lock(this->mutex);
+
+		auto [it, created] = this->loadedResources.try_emplace(id);
+		ResourceInfo& info = it->second;
+
+		if (!created && info.type == &type) {
+			// Loaded by another thread in the meantime, drop our copy
+			victims.push_back(ReleaseShared(contentKey, resource));
+		}
+		else {
+			if (!created) {
+				spdlog::warn("Replacing {} with a resource of another type", ResourcePaths::GetPath(id).string());
+
+				victims.push_back(ReleaseEntry(info));
+			}
+
+			info.type = &type;
+			info.resource = resource;
+			info.contentKey = contentKey;
+			info.references = 0;
+			info.pinned = false;
+
+			MemoryTracker::SetLabel(resource, ResourcePaths::GetPath(id).string());
+		}
+
+		if (pin) {
+			info.pinned = true;
+		}
+		else {
+			info.references++;
+		}
+
+		info.lastUsed = this->useCounter++;
+		result = info.resource;
+
+		EvictLocked(victims);
+	}
+
+	for (const Resource* victim : victims) {
+		delete victim;
+	}
+
+	return result;
+}
+
+void ResourceDatabase::CompleteLoad(ResourceId id, const std::shared_ptr<AsyncLoad>& load, const Resource* resource) {
+	{
+		std::unique_lock lock(this->mutex);
+
+		this->pendingLoads.erase(id);
+	}
+
+	if (!resource) {
+		spdlog::error("Failed to load {} asynchronously", ResourcePaths::GetPath(id).string());
+	}
+
+	load->resource = resource;
+	load->status = resource ? LoadStatus::Ready : LoadStatus::Failed;
+}
+
+int ResourceDatabase::GetPendingLoads() const {
+	std::shared_lock lock(this->mutex);
+
+	return (int) this->pendingLoads.size();
+}
+
+void ResourceDatabase::AddReference(ResourceId id) {
+	std::shared_lock lock(this->mutex);
+
+	auto it = this->loadedResources.find(id);
+
+	if (it != this->loadedResources.end()) {
+		it->second.references++;
+	}
+}
+
+void ResourceDatabase::Release(ResourceId id) {
+	std::vector<const Resource*> victims;
+
+	{
+		std::unique_lock lock(this->mutex);
+
+		auto it = this->loadedResources.find(id);
+
+		if (it == this->loadedResources.end() || it->second.references == 0) {
+			return;
+		}
+
+		if (--it->second.references == 0) {
+			EvictLocked(victims);
+		}
+	}
+
+	for (const Resource* victim : victims) {
+		delete victim;
+	}
+}
+
+const Resource* ResourceDatabase::ReleaseEntry(const ResourceInfo& info) {
+	return ReleaseShared(info.contentKey, info.resource);
+}
+
+void ResourceDatabase::EvictLocked(std::vector<const Resource*>& victims) {
+	if (this->budget == 0) {
+		return;
+	}
+
+	uint64_t resident = 0;
+
+	for (const auto& [id, info] : this->loadedResources) {
+		MemoryTracker::Usage usage = MemoryTracker::GetUsage(info.resource);
+
+		resident += usage.cpuBytes + usage.gpuBytes;
+	}
+
+	while (resident > this->budget) {
+		auto oldest = this->loadedResources.end();
+
+		for (auto it = this->loadedResources.begin(); it != this->loadedResources.end(); it++) {
+			if (it->second.pinned || it->second.references > 0) {
+				continue;
+			}
+
+			if (oldest == this->loadedResources.end() || it->second.lastUsed < oldest->second.lastUsed) {
+				oldest = it;
+			}
+		}
+
+		if (oldest == this->loadedResources.end()) {
+			break;
+		}
+
+		MemoryTracker::Usage usage = MemoryTracker::GetUsage(oldest->second.resource);
+		resident -= usage.cpuBytes + usage.gpuBytes;
+
+		spdlog::info("Evicting {} from the resource database", ResourcePaths::GetPath(oldest->first).string());
+
+		victims.push_back(ReleaseEntry(oldest->second));
+		this->loadedResources.erase(oldest);
+	}
+}
+
+uint64_t ResourceDatabase::GetResidentBytes() const {
+	std::shared_lock lock(this->mutex);
+
+	uint64_t resident = 0;
+
+	for (const auto& [id, info] : this->loadedResources) {
+		MemoryTracker::Usage usage = MemoryTracker::GetUsage(info.resource);
+
+		resident += usage.cpuBytes + usage.gpuBytes;
+	}
+
+	return resident;
+}
+
+uint64_t ResourceDatabase::GetBudget() const {
+	return this->budget;
+}
+
+void ResourceDatabase::SetBudget(uint64_t bytes) {
+	std::vector<const Resource*> victims;
+
+	{
+		std::unique_lock lock(this->mutex);
+
+		this->budget = bytes;
+
+		EvictLocked(victims);
+	}
+
+	for (const Resource* victim : victims) {
+		delete victim;
+	}
+}
+
 void ResourceDatabase::Free(const fs::path& path) {
-	if (this->loadedResources.contains(path)) {
-		delete this->loadedResources[path].resource;
+	ResourceId id = ResourcePaths::Intern(path);
 
-		this->loadedResources[path].resource = nullptr;
+	const Resource* victim = nullptr;
+	GenericInfo generic = {};
+
+	{
+		std::unique_lock lock(this->mutex);
+
+		if (auto it = this->loadedResources.find(id); it != this->loadedResources.end()) {
+			if (it->second.references > 0) {
+				spdlog::warn("Freeing {} while {} handles still refer to it", path.string(), it->second.references.load());
+			}
+
+			victim = ReleaseEntry(it->second);
+			this->loadedResources.erase(it);
+		}
+		else if (auto it = this->loadedGenericAssets.find(id); it != this->loadedGenericAssets.end()) {
+			generic = it->second;
+			this->loadedGenericAssets.erase(it);
+		}
 	}
-	else if (this->loadedGenericAssets.contains(path)) {
-		delete this->loadedGenericAssets[path].resource;
 
-		this->loadedGenericAssets[path].resource = nullptr;
+	delete victim;
+
+	if (generic.resource) {
+		generic.destroy(generic.resource);
 	}
 }
 
 void ResourceDatabase::Purge() {
-	for (auto& resPair : this->loadedResources) {
-		delete resPair.second.resource;
+	std::vector<const Resource*> victims;
+	std::vector<GenericInfo> generics;
+
+	{
+		std::unique_lock lock(this->mutex);
+
+		for (const auto& [id, info] : this->loadedResources) {
+			victims.push_back(ReleaseEntry(info));
+		}
+
+		for (const auto& [id, info] : this->loadedGenericAssets) {
+			generics.push_back(info);
+		}
+
+		this->loadedResources.clear();
+		this->loadedGenericAssets.clear();
+	}
+
+	for (const Resource* victim : victims) {
+		delete victim;
+	}
+
+	for (const GenericInfo& generic : generics) {
+		generic.destroy(generic.resource);
 	}
+}
+
+int ResourceBatch::GetCount() const {
+	return (int) this->loads.size();
+}
+
+int ResourceBatch::GetCompleted() const {
+	int completed = 0;
+
+	for (const auto& load : this->loads) {
+		completed += load->status != LoadStatus::Loading;
+	}
+
+	return completed;
+}
+
+float ResourceBatch::GetProgress() const {
+	return this->loads.empty() ? 1.0f : (float) GetCompleted() / this->loads.size();
+}
+
+bool ResourceBatch::IsDone() const {
+	return GetCompleted() == GetCount();
+}
+
+bool ResourceBatch::HasFailed() const {
+	for (const auto& load : this->loads) {
+		if (load->status == LoadStatus::Failed) {
+			return true;
+		}
+	}
+
+	return false;
+}
 
-	this->loadedResources.clear();
+void ResourceBatch::Wait() const {
+	ResourceLoader::ProcessUploadsUntil([this] {
+		return IsDone();
+	});
 }
\ No newline at end of file
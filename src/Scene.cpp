@@ -12,6 +12,8 @@
 #include <Graphics.h>
 #include <InputSystem.h>
 #include <Layer.h>
+#include <Profiler.h>
+#include <AllocationTracker.h>
 
 SceneNode::SceneNode(Scene* scene) :
 scene(scene),
@@ -113,7 +115,7 @@ void SceneNode::SetEnabled(bool value) {
 	}
 }
 
-const std::vector<SceneNode*> SceneNode::GetChildren() {
+std::span<SceneNode* const> SceneNode::GetChildren() const {
 	return this->children;
 }
 
@@ -195,7 +197,7 @@ void SceneNode::SetLayer(uint8_t layer) {
 	}
 }
 
-const std::vector<GameObject*> SceneNode::AttachedObjects() {
+std::span<GameObject* const> SceneNode::AttachedObjects() const {
 	return this->objects;
 }
 
@@ -217,7 +219,7 @@ void SceneNode::DetachScene(Scene* scene) {
 	GetScene()->DetachSceneFromNodeInternal(this, scene);
 }
 
-std::vector<Scene*> SceneNode::GetAttachedScenes() const {
+std::span<Scene* const> SceneNode::GetAttachedScenes() const {
 	return this->attachedScenes;
 }
 
@@ -406,16 +408,27 @@ void Scene::QueueDelete(Scene* scene) {
 }
 
 void Scene::Update() {
+	PROFILE_ZONE("Scene::Update");
+
+	AllocationTracker::NoAllocationScope noAllocation;
+
 	for (auto& component: this->components) {
+		PROFILE_ZONE_DETAIL("OnPreUpdate", typeid(*component).name());
 		component->OnPreUpdate();
 	}
 
-	this->messageTree.PropagateMessage<Message::Update>(this->root);
+	{
+		PROFILE_ZONE("Message::Update");
+		this->messageTree.PropagateMessage<Message::Update>(this->root);
+	}
 
 	for (auto& component: this->components) {
+		PROFILE_ZONE_DETAIL("OnPostUpdate", typeid(*component).name());
 		component->OnPostUpdate();
 	}
 
+	PROFILE_ZONE("Scene::FlushDeleted");
+
 	while(!this->deletedReceiversQueue.empty()) {
 		auto deleted = this->deletedReceiversQueue.front();
 		deleted->~MessageReceiver();
@@ -436,14 +449,27 @@ void Scene::Render() {
 		return;
 	}
 
+	PROFILE_ZONE("Scene::Render");
+
+	AllocationTracker::NoAllocationScope noAllocation;
+
 	for (auto& component: this->components) {
+		PROFILE_ZONE_DETAIL("OnPreRender", typeid(*component).name());
 		component->OnPreRender();
 	}
 	
-	this->messageTree.PropagateMessage<Message::Render>(this->root);
-	this->messageTree.PropagateMessage<Message::DrawGizmos>(this->root);
+	{
+		PROFILE_ZONE("Message::Render");
+		this->messageTree.PropagateMessage<Message::Render>(this->root);
+	}
+
+	{
+		PROFILE_ZONE("Message::DrawGizmos");
+		this->messageTree.PropagateMessage<Message::DrawGizmos>(this->root);
+	}
 
 	for (auto& component: this->components) {
+		PROFILE_ZONE_DETAIL("OnPostRender", typeid(*component).name());
 		component->OnPostRender();
 	}
 }
@@ -460,6 +486,7 @@ void Scene::OnDisable() {
 
 void Scene::DrawImGui() {
 	for (auto& component: this->components) {
+		PROFILE_ZONE_DETAIL("DrawImGui", typeid(*component).name());
 		component->DrawImGui();
 	}
 }
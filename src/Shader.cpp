@@ -3,10 +3,13 @@
 #include <fstream>
 #include <sstream>
 #include <queue>
+#include <cstring>
 #include <malloc.h>
 
 #include <PreComp.h>
 #include <Material.h>
+#include <RenderStats.h>
+#include <GraphicsBackend.h>
 
 #include <spdlog/spdlog.h>
 
@@ -151,7 +154,10 @@ ShaderBase* ShaderBase::Load(fs::path filePath) {
 		// throw shader::shader_unknown_type_exception(path_to_file);
 	}
 
-	GLuint shaderHandle = glCreateShader(shaderType);
+	return Compile(filePath, shaderType, LoadFile(filePath));
+}
+
+ShaderCode ExpandIncludes(const fs::path& filePath, char* rootContent) {
 	ShaderCode code;
 
 	std::queue<fs::path> filesToLoad;
@@ -169,7 +175,7 @@ ShaderBase* ShaderBase::Load(fs::path filePath) {
 
 		ShaderFile loadedFile;
 		loadedFile.filePath = loadedFilePath;
-		loadedFile.content = LoadFile(loadedFilePath);
+		loadedFile.content = code.loadedFiles.empty() ? rootContent : LoadFile(loadedFilePath);
 
 		code.loadedFiles.push_back(loadedFile);
 
@@ -222,6 +228,29 @@ ShaderBase* ShaderBase::Load(fs::path filePath) {
 		code.segments = newCodeSegments;
 	}
 
+	return code;
+}
+
+std::string ShaderBase::Preprocess(const fs::path& filePath) {
+	ShaderCode code = ExpandIncludes(filePath, LoadFile(filePath));
+
+	std::string source;
+
+	for (const auto& segment : code.segments) {
+		source.append(segment.str, segment.length);
+	}
+
+	for (auto& file : code.loadedFiles) {
+		delete[] file.content;
+	}
+
+	return source;
+}
+
+ShaderBase* ShaderBase::Compile(const fs::path& filePath, GLenum shaderType, char* rootContent) {
+	GLuint shaderHandle = glCreateShader(shaderType);
+	ShaderCode code = ExpandIncludes(filePath, rootContent);
+
 	char** segmentsStrings = (char**) alloca(sizeof(char*) * code.segments.size());
 	int* segmentsLengths = (int*) alloca(sizeof(int) * code.segments.size());
 
@@ -452,6 +481,23 @@ ComputeShader* ComputeShader::Load(fs::path filePath) {
 	return result;
 }
 
+ComputeShader* ComputeShader::FromSource(const fs::path& virtualPath, const std::string& source) {
+	char* content = new char[source.size() + 1];
+	memcpy(content, source.c_str(), source.size() + 1);
+
+	ShaderBase* compiled = ShaderBase::Compile(virtualPath, GL_COMPUTE_SHADER, content);
+
+	ComputeShader* result = dynamic_cast<ComputeShader*>(compiled);
+
+	if (!result) {
+		delete compiled;
+
+		return nullptr;
+	}
+	
+	return result;
+}
+
 GLenum ComputeShader::GetType() const {
 	return GL_COMPUTE_SHADER;
 }
@@ -523,6 +569,8 @@ ShaderProgram* ShaderBuilder::Link() {
 	);
 
 	if (this->tessCtrlShader && this->tessEvalShader) {
+		prog->tessCtrlShader = this->tessCtrlShader;
+		prog->tessEvalShader = this->tessEvalShader;
 		prog->flags = ShaderProgramFlags::UsePatches;
 	}
 	else {
@@ -535,6 +583,8 @@ ShaderProgram* ShaderBuilder::Link() {
 ShaderProgram::ShaderProgram(VertexShader* vertexShader, GeometryShader* geometryShader, PixelShader* pixelShader, GLuint handle):
 vertexShader(vertexShader),
 geometryShader(geometryShader),
+tessCtrlShader(nullptr),
+tessEvalShader(nullptr),
 pixelShader(pixelShader),
 handle(handle) {
 	this->uniforms = UniformSpec(this);
@@ -559,6 +609,22 @@ const VertexSpec& ShaderProgram::GetVertexSpec() const {
 	return this->vertexShader->GetVertexSpec();
 }
 
+VertexShader* ShaderProgram::GetVertexShader() const {
+	return this->vertexShader;
+}
+GeometryShader* ShaderProgram::GetGeometryShader() const {
+	return this->geometryShader;
+}
+TesselationControlShader* ShaderProgram::GetTessControlShader() const {
+	return this->tessCtrlShader;
+}
+TesselationEvaluationShader* ShaderProgram::GetTessEvaluationShader() const {
+	return this->tessEvalShader;
+}
+PixelShader* ShaderProgram::GetPixelShader() const {
+	return this->pixelShader;
+}
+
 bool ShaderProgram::IgnoresDepthPrepass() const {
 	return ((unsigned int) this->flags & (unsigned int) ShaderProgramFlags::IgnoreDepthPrepass) != 0;
 }
@@ -637,9 +703,11 @@ ComputeShaderDispatch::ComputeShaderDispatch(ComputeShaderProgram* program) {
 void ComputeShaderDispatch::Dispatch(int groupsX, int groupsY, int groupsZ) const {
 	this->dispatchData->Bind();
 
-	glDispatchCompute(groupsX, groupsY, groupsZ);
+	GraphicsBackend::Current()->DispatchCompute(groupsX, groupsY, groupsZ);
+
+	RenderStats::Add(RenderCounter::ComputeDispatches);
 
-	glMemoryBarrier(GL_ALL_BARRIER_BITS);
+	GraphicsBackend::Current()->Barrier(GL_ALL_BARRIER_BITS);
 }
 
 ComputeDispatchData* ComputeShaderDispatch::GetData() {
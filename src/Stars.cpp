@@ -0,0 +1,49 @@
+#include <Stars.h>
+
+#include <imgui.h>
+
+#include <Scene.h>
+#include <Graphics.h>
+#include <Resources.h>
+#include <Shader.h>
+
+Stars::Stars(int starCount):
+starCount(starCount) {
+	this->starMesh = GetScene()->Resources()->Get<Mesh>("./res/models/star.obj");
+
+	ShaderProgram* starProgram = ShaderProgram::Build()
+	.WithVertexShader(
+		GetScene()->Resources()->Get<VertexShader>("./res/shaders/star.vert")
+	).WithGeometryShader(
+		GetScene()->Resources()->Get<GeometryShader>("./res/shaders/star.geom")
+	).WithPixelShader(
+		GetScene()->Resources()->Get<PixelShader>("./res/shaders/star.frag")
+	).Link();
+	starProgram->SetIgnoresDepthPrepass(true);
+	starProgram->SetCastsShadows(false);
+
+	this->starMaterial = new Material(starProgram);
+}
+
+int Stars::GetStarCount() const {
+	return this->starCount;
+}
+
+void Stars::SetStarCount(int starCount) {
+	this->starCount = starCount;
+}
+
+void Stars::Render() {
+	GetScene()->GetGraphics()->DrawMeshInstanced(
+		this->starMesh,
+		0,
+		this->starMaterial,
+		this->GlobalTransform(),
+		this->starCount,
+		BoundingBox::CenterAndExtents(glm::vec3(0, 0, 0), glm::vec3(15, 15, 15))
+	);
+}
+
+void Stars::DrawImGui() {
+	ImGui::InputInt("Star count", &this->starCount);
+}
\ No newline at end of file
@@ -0,0 +1,164 @@
+#include <TemporalUpsampler.h>
+
+#include <imgui.h>
+
+#include <Resources.h>
+#include <Texture.h>
+#include <Framebuffer.h>
+#include <Shader.h>
+#include <Material.h>
+#include <MemoryTracker.h>
+
+constexpr TextureParams HistoryBufferParams {
+	.channels = TextureChannels::RGBA,
+	.colorSpace = TextureColor::Linear,
+	.format = TextureFormat::Float,
+	.wrapU = TextureWrap::Clamp,
+	.wrapV = TextureWrap::Clamp,
+	.wrapW = TextureWrap::Clamp
+};
+
+static float Halton(int index, int base) {
+	float result = 0.0f;
+	float fraction = 1.0f;
+
+	while (index > 0) {
+		fraction /= base;
+		result += fraction * (index % base);
+		index /= base;
+	}
+
+	return result;
+}
+
+TemporalUpsampler::TemporalUpsampler(ResourceDatabase* resources):
+motionFramebuffer(new Framebuffer(Framebuffer::Attachment::None, 0, 0)),
+historyIndex(0),
+historyValid(false),
+renderResolution(0),
+jitterIndex(0),
+jitter(0.0f),
+viewProjection(1.0f),
+previousViewProjection(1.0f),
+feedback(0.9f) {
+	this->historyBuffers[0] = new Texture2D(0, 0, HistoryBufferParams);
+	this->historyBuffers[1] = new Texture2D(0, 0, HistoryBufferParams);
+
+	MemoryTracker::SetCategory(this->historyBuffers[0], MemoryCategory::PostProcessing);
+	MemoryTracker::SetCategory(this->historyBuffers[1], MemoryCategory::PostProcessing);
+
+	this->motionVectorShader = ShaderProgram::Build()
+	.WithVertexShader(
+		resources->Get<VertexShader>("./res/shaders/motion_vectors.vert")
+	)
+	.WithPixelShader(
+		resources->Get<PixelShader>("./res/shaders/motion_vectors.frag")
+	).Link();
+
+	this->resolveShader = new ComputeShaderDispatch(resources->Get<ComputeShader>("./res/shaders/temporal/temporal_upsample.comp"));
+}
+
+TemporalUpsampler::~TemporalUpsampler() {
+	delete this->motionFramebuffer;
+	delete this->historyBuffers[0];
+	delete this->historyBuffers[1];
+}
+
+void TemporalUpsampler::Resize(const glm::uvec2& renderResolution, const glm::uvec2& outputResolution, Texture* depthTexture) {
+	this->renderResolution = renderResolution;
+
+	// The depth attachment belongs to the main viewport, which has already been resized
+	this->motionFramebuffer->SetDepthTexture(nullptr);
+	this->motionFramebuffer->SetSize(renderResolution);
+	this->motionFramebuffer->SetDepthTexture(depthTexture);
+
+	if (this->historyBuffers[0]->GetSize() != outputResolution) {
+		this->historyBuffers[0]->Resize(outputResolution);
+		this->historyBuffers[1]->Resize(outputResolution);
+	}
+
+	InvalidateHistory();
+}
+
+void TemporalUpsampler::BeginFrame(const glm::mat4& unjitteredViewProjection) {
+	this->previousViewProjection = this->historyValid ? this->viewProjection : unjitteredViewProjection;
+	this->viewProjection = unjitteredViewProjection;
+
+	this->jitterIndex = (this->jitterIndex + 1) % JitterSequenceLength;
+
+	this->jitter = glm::vec2(
+		Halton(this->jitterIndex + 1, 2),
+		Halton(this->jitterIndex + 1, 3)
+	) - 0.5f;
+}
+
+void TemporalUpsampler::InvalidateHistory() {
+	this->historyValid = false;
+}
+
+glm::vec2 TemporalUpsampler::GetProjectionJitter() const {
+	if (this->renderResolution.x == 0 || this->renderResolution.y == 0) {
+		return glm::vec2(0.0f);
+	}
+
+	return 2.0f * this->jitter / glm::vec2(this->renderResolution);
+}
+
+const glm::mat4& TemporalUpsampler::GetPreviousViewProjection() const {
+	return this->previousViewProjection;
+}
+
+Framebuffer* TemporalUpsampler::GetMotionFramebuffer() const {
+	return this->motionFramebuffer;
+}
+
+ShaderProgram* TemporalUpsampler::GetMotionVectorShader() const {
+	return this->motionVectorShader;
+}
+
+Texture2D* TemporalUpsampler::GetHistoryBuffer(int index) const {
+	return this->historyBuffers[index];
+}
+
+Texture2D* TemporalUpsampler::Resolve(Texture2D* color, Texture2D* depth, Texture2D* velocity, Texture2D* output, bool accumulate) {
+	Texture2D* history = this->historyBuffers[this->historyIndex];
+	Texture2D* target = this->historyBuffers[1 - this->historyIndex];
+
+	if (output == nullptr) {
+		output = target;
+	}
+
+	ComputeDispatchData* data = this->resolveShader->GetData();
+
+	data->SetValue("colorTex", color);
+	data->SetValue("depthTex", depth);
+	data->SetValue("velocityTex", velocity);
+	data->SetValue("historyTex", history);
+	data->SetValue("historyImg", target);
+	data->SetValue("outputImg", output);
+	data->SetValue("jitter", this->jitter);
+	data->SetValue("invViewProjection", glm::inverse(this->viewProjection));
+	data->SetValue("prevViewProjection", this->previousViewProjection);
+	data->SetValue("historyValid", (unsigned int) (accumulate && this->historyValid));
+	data->SetValue("feedback", this->feedback);
+
+	this->resolveShader->Dispatch(std::ceil(target->GetWidth() / 8.0f), std::ceil(target->GetHeight() / 8.0f), 1);
+
+	this->historyIndex = 1 - this->historyIndex;
+	this->historyValid = accumulate;
+
+	return output;
+}
+
+void TemporalUpsampler::DrawImGui() {
+	if (ImGui::TreeNode("Temporal Upsampling")) {
+		ImGui::SliderFloat("History feedback", &this->feedback, 0.0f, 0.98f);
+		ImGui::Text("Jitter: %.3f, %.3f", this->jitter.x, this->jitter.y);
+
+		if (ImGui::Button("Reset history")) {
+			InvalidateHistory();
+		}
+
+		ImGui::TreePop();
+	}
+}
\ No newline at end of file
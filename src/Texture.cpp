@@ -2,9 +2,13 @@
 
 #include "stb_image.h"
 
+#include <mutex>
+#include <cstring>
+
 #include <Material.h>
 #include <Mesh.h>
 #include <Resources.h>
+#include <MemoryTracker.h>
 
 GLenum ToGL(TextureWrap wrap) {
 	static constexpr GLenum values[] {
@@ -55,15 +59,36 @@ GLenum ToGL(TextureFormat format) {
 	return values[(int) format];
 }
 
-unsigned char* LoadTextureData(const fs::path& texPath, const TextureParams& loadParams, int* width, int* height, int* nrChannels) {
+void FlipRows(unsigned char* data, size_t rowSize, int height) {
+	std::vector<unsigned char> row(rowSize);
+
+	for (int top = 0, bottom = height - 1; top < bottom; top++, bottom--) {
+		unsigned char* topRow = data + top * rowSize;
+		unsigned char* bottomRow = data + bottom * rowSize;
+
+		std::memcpy(row.data(), topRow, rowSize);
+		std::memcpy(topRow, bottomRow, rowSize);
+		std::memcpy(bottomRow, row.data(), rowSize);
+	}
+}
+
+// Safe to call from loader threads, the process wide stb settings are never changed while decoding
+unsigned char* LoadTextureData(const fs::path& texPath, const TextureParams& loadParams, bool flip, int* width, int* height, int* nrChannels) {
+	// stbi_ldr_to_hdr_gamma is global state shared by every thread
+	static std::mutex floatDecodeMutex;
+
 	unsigned char* textureData = nullptr;
+	size_t channelSize = 1;
 
 	if (loadParams.format == TextureFormat::Float) {
+		std::lock_guard lock(floatDecodeMutex);
+
 		if (loadParams.colorSpace == TextureColor::Linear) {
 			stbi_ldr_to_hdr_gamma(1.0f);
 		}
 
 		textureData = (unsigned char*) stbi_loadf(texPath.string().c_str(), width, height, nrChannels, loadParams.NumChannels());
+		channelSize = sizeof(float);
 
 		if (loadParams.colorSpace == TextureColor::Linear) {
 			stbi_ldr_to_hdr_gamma(2.2f);
@@ -73,6 +98,10 @@ unsigned char* LoadTextureData(const fs::path& texPath, const TextureParams& loa
 		textureData = stbi_load(texPath.string().c_str(), width, height, nrChannels, loadParams.NumChannels());
 	}
 
+	if (textureData && flip) {
+		FlipRows(textureData, (size_t) *width * loadParams.NumChannels() * channelSize, *height);
+	}
+
 	return textureData;
 }
 
@@ -80,6 +109,10 @@ Texture::~Texture() {
 	if (this->owning) {
 		glDeleteTextures(1, &this->handle);
 	}
+
+	stbi_image_free(this->pixelData);
+
+	MemoryTracker::Untrack(this);
 }
 
 GLenum Texture::CalcInternalFormat(const TextureParams& params) {
@@ -286,6 +319,54 @@ void Texture::Update() {
 	this->dirty = false;
 
 	glBindTexture(type, 0);
+
+	this->TrackMemory();
+}
+
+uint64_t Texture::EstimateGPUBytes() const {
+	uint64_t pixelSize;
+
+	if (this->channels == TextureChannels::Depth || this->channels == TextureChannels::DepthStencil) {
+		pixelSize = 4;
+	}
+	else {
+		// Float textures are allocated as 16F, see CalcInternalFormat
+		constexpr uint64_t channelSizes[] {1, 4, 2, 4};
+
+		pixelSize = channelSizes[(int) this->format] * this->GetNumChannels();
+	}
+
+	uint64_t layerSize = 0;
+	uint64_t mipWidth = this->width;
+	uint64_t mipHeight = this->height;
+
+	while (mipWidth > 0 && mipHeight > 0) {
+		layerSize += mipWidth * mipHeight * pixelSize;
+
+		if (!this->mipmapped.value || (mipWidth == 1 && mipHeight == 1)) {
+			break;
+		}
+
+		mipWidth = std::max<uint64_t>(mipWidth / 2, 1);
+		mipHeight = std::max<uint64_t>(mipHeight / 2, 1);
+	}
+
+	return this->GetType() == TextureType::Cubemap ? layerSize * 6 : layerSize;
+}
+
+void Texture::TrackMemory() {
+	// Wrapped handles belong to someone else
+	if (!this->owning) {
+		return;
+	}
+
+	uint64_t cpuBytes = 0;
+
+	if (this->pixelData) {
+		cpuBytes = (uint64_t) this->width * this->height * this->GetNumChannels() * (this->format == TextureFormat::Float ? sizeof(float) : 1);
+	}
+
+	MemoryTracker::Track(this, MemoryCategory::Textures, cpuBytes, this->handle ? this->EstimateGPUBytes() : 0);
 }
 
 template<> Texture2D* Texture::Load<Texture2D>(const fs::path& texturePath, const TextureParams& loadParams) {
@@ -313,6 +394,7 @@ void Texture2D::Create() {
 		glBindTexture(GL_TEXTURE_2D, 0);
 		
 		this->Update();
+		this->TrackMemory();
 	}
 }
 
@@ -365,8 +447,16 @@ Texture2D::Texture2D(unsigned int width, unsigned int height, const TextureParam
 }
 
 Texture2D* Texture2D::Load(const fs::path& texturePath, const TextureParams& loadParams) {
-	stbi_set_flip_vertically_on_load(true);
-	
+	Texture2D* result = Texture2D::Import(texturePath, loadParams);
+
+	if (result) {
+		result->Upload();
+	}
+
+	return result;
+}
+
+Texture2D* Texture2D::Import(const fs::path& texturePath, const TextureParams& loadParams) {
 	fs::directory_entry textureFile(texturePath);
 
 	if (!textureFile.exists() || !textureFile.is_regular_file()) {
@@ -375,31 +465,58 @@ Texture2D* Texture2D::Load(const fs::path& texturePath, const TextureParams& loa
 	}
 
 	int width, height, nrChannels;
-	unsigned char *textureData = LoadTextureData(texturePath, loadParams, &width, &height, &nrChannels);
+	unsigned char *textureData = LoadTextureData(texturePath, loadParams, true, &width, &height, &nrChannels);
 
 	if (!textureData) {
 		spdlog::error("stbi_load failed on file {}", texturePath.string());
 		return nullptr;
 	}
 
-	GLuint textureHandle;
-	glGenTextures(1, &textureHandle);
+	Texture2D* result = new Texture2D();
 
-	glBindTexture(GL_TEXTURE_2D, textureHandle);
+	result->format = loadParams.format;
+	result->channels = loadParams.channels;
+	result->colorSpace = loadParams.colorSpace;
+	result->owning = true;
+	result->handle = 0;
+	result->width = width;
+	result->height = height;
+	result->dirty = true;
+	result->pixelData = textureData;
 
-	GLenum internalFormat = CalcInternalFormat(loadParams);
-	GLenum format = ToGL(loadParams.channels);
-	GLenum textureType = ToGL(loadParams.format);
+	result->SetWrapModeU(loadParams.wrapU);
+	result->SetWrapModeV(loadParams.wrapV);
+	result->SetMinFilter(loadParams.minFilter);
+	result->SetMagFilter(loadParams.magFilter);
 
-	glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, format, textureType, textureData);
-	
-	stbi_image_free(textureData);
+	result->TrackMemory();
+
+	return result;
+}
+
+void Texture2D::Upload() {
+	if (this->handle || !this->pixelData) {
+		return;
+	}
+
+	glGenTextures(1, &this->handle);
+
+	glBindTexture(GL_TEXTURE_2D, this->handle);
+
+	GLenum internalFormat = CalcInternalFormat(this->colorSpace, this->format, this->channels);
+	GLenum format = ToGL(this->channels);
+	GLenum textureType = ToGL(this->format);
+
+	glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, this->width, this->height, 0, format, textureType, this->pixelData);
 	
 	glBindTexture(GL_TEXTURE_2D, 0);
-	
-	Texture2D* result = new Texture2D(width, height, loadParams, textureHandle);
 
-	return result;
+	stbi_image_free(this->pixelData);
+	this->pixelData = nullptr;
+
+	this->dirty = true;
+	this->Update();
+	this->TrackMemory();
 }
 
 void Cubemap::Create() {
@@ -423,6 +540,8 @@ void Cubemap::Create() {
 		this->Update();
 	
 		glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+
+		this->TrackMemory();
 	}
 }
 
@@ -538,8 +657,6 @@ Cubemap* Cubemap::LoadEquirectangular(const fs::path& texturePath, const Texture
 }
 
 Cubemap* Cubemap::LoadParts(const fs::path& texturePath, const TextureParams& loadParams) {
-	stbi_set_flip_vertically_on_load(false);
-
 	static std::string cubeSides[] {
 		"_right",
 		"_left",
@@ -570,7 +687,7 @@ Cubemap* Cubemap::LoadParts(const fs::path& texturePath, const TextureParams& lo
 
 	int width, height, nrChannels;
 	for (int i = 0; i < 6; i++) {
-		unsigned char *textureData = LoadTextureData(texturePaths[i], loadParams, &width, &height, &nrChannels);
+		unsigned char *textureData = LoadTextureData(texturePaths[i], loadParams, false, &width, &height, &nrChannels);
 
 		if (!textureData) {
 			spdlog::error("stbi_load failed on file {}", texturePaths[i].string());
@@ -598,6 +715,8 @@ Cubemap* Cubemap::LoadParts(const fs::path& texturePath, const TextureParams& lo
 	
 	result->handle = textureHandle;
 	result->format = loadParams.format;
+	result->channels = loadParams.channels;
+	result->colorSpace = loadParams.colorSpace;
 	result->width = width;
 	result->height = height;
 	result->owning = true;
@@ -646,7 +765,7 @@ Cubemap* Cubemap::GenerateIrradianceMap() {
 	}
 	glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
 
-	Cubemap* result = new Cubemap(width, height, creationParams, handle);
+	Cubemap* result = new Cubemap(texSize, texSize, creationParams, handle);
 	
 	irradianceProg->GetData()->SetValue("environmentMap", this);
 	irradianceProg->GetData()->SetValue("outputImg", result);
@@ -698,7 +817,7 @@ Cubemap* Cubemap::GeneratePrefilterIBLMap() {
 	
 	glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
 	
-	Cubemap* result = new Cubemap(width, height, creationParams, handle);
+	Cubemap* result = new Cubemap(texSize, texSize, creationParams, handle);
 	
 	cubemapPrefilterProg->GetData()->SetValue("environmentMap", this);
 	
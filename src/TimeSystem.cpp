@@ -20,6 +20,7 @@ TimePoint Time::startup;
 TimePoint Time::now;
 float Time::applicationTime;
 float Time::deltaTime;
+float Time::fixedDelta = 0.0f;
 
 void Time::Update() {
 	auto newNow = TimePoint(system_clock::now());
@@ -29,8 +30,14 @@ void Time::Update() {
 		now = newNow;
 	}
 
-	applicationTime = duration<float>(newNow.GetTime() - startup.GetTime()).count();
-	deltaTime = duration<float>(newNow.GetTime() - now.GetTime()).count();
+	if (fixedDelta > 0.0f) {
+		deltaTime = fixedDelta;
+		applicationTime += fixedDelta;
+	}
+	else {
+		applicationTime = duration<float>(newNow.GetTime() - startup.GetTime()).count();
+		deltaTime = duration<float>(newNow.GetTime() - now.GetTime()).count();
+	}
 
 	now = newNow;
 }
@@ -39,3 +46,6 @@ const TimePoint& Time::Now() { return now; }
 TimePoint Time::SystemTime() { return TimePoint(system_clock::now()); }
 float Time::Current() { return applicationTime; }
 float Time::Delta() { return deltaTime; }
+
+float Time::GetFixedDelta() { return fixedDelta; }
+void Time::SetFixedDelta(float delta) { fixedDelta = delta; }
@@ -52,6 +52,47 @@ void Tonemapper::OnPostProcess(const PostProcessParams* params) {
 	}
 }
 
+bool Tonemapper::RunsInPlace() const {
+	return this->toneOperator == TonemapperOperator::None;
+}
+
+std::vector<float> Tonemapper::GetSettings() const {
+	return { (float) this->toneOperator };
+}
+
+void Tonemapper::SetSettings(const std::vector<float>& settings) {
+	if (settings.size() != 1) {
+		return;
+	}
+
+	this->toneOperator = (TonemapperOperator) settings[0];
+}
+
+int Tonemapper::GetFusedVariant() const {
+	return this->toneOperator == TonemapperOperator::None ? -1 : (int) this->toneOperator;
+}
+
+bool Tonemapper::GetFusedSnippet(PostProcessSnippet* snippet) const {
+	switch (this->toneOperator) {
+		case TonemapperOperator::Reinhard:
+			snippet->body = "color.rgb = ReinhardTonemapper(color.rgb);";
+			break;
+		case TonemapperOperator::Aces:
+			snippet->body = "color.rgb = ACESFitted(color.rgb);";
+			break;
+		case TonemapperOperator::GranTurismo:
+			snippet->body = "color.rgb = GranTurismoTonemapper(color.rgb);";
+			break;
+		case TonemapperOperator::None:
+		default:
+			return false;
+	}
+
+	snippet->declarations = "#include \"tonemapping/operators.h\"\n";
+
+	return true;
+}
+
 void Tonemapper::DrawImGui() {
 	const char* operators[] { "None", "Reinhard", "Aces", "Gran Turismo" };
 
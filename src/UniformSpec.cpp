@@ -37,6 +37,27 @@ UniformTypeInfo GetUniformInfo(GLenum type) {
 	return { UniformSpec::UniformType::Unsupported, 0 };
 }
 
+int UniformSpec::SizeOf(UniformType type) {
+	switch (type) {
+		case UniformSpec::UniformType::Float1:    return 1 * sizeof(GLfloat);
+		case UniformSpec::UniformType::Float2:    return 2 * sizeof(GLfloat);
+		case UniformSpec::UniformType::Float3:    return 3 * sizeof(GLfloat);
+		case UniformSpec::UniformType::Float4:    return 4 * sizeof(GLfloat);
+		case UniformSpec::UniformType::Uint1:     return 1 * sizeof(GLuint);
+		case UniformSpec::UniformType::Uint2:     return 2 * sizeof(GLuint);
+		case UniformSpec::UniformType::Uint3:     return 3 * sizeof(GLuint);
+		case UniformSpec::UniformType::Uint4:     return 4 * sizeof(GLuint);
+		case UniformSpec::UniformType::Matrix3x3: return 9 * sizeof(GLfloat);
+		case UniformSpec::UniformType::Matrix4x4: return 16 * sizeof(GLfloat);
+		case UniformSpec::UniformType::Sampler2D:
+		case UniformSpec::UniformType::Image2D:
+		case UniformSpec::UniformType::UImage2D:  return sizeof(UniformSpec::TextureUniform<Texture2D>);
+		case UniformSpec::UniformType::Cubemap:
+		case UniformSpec::UniformType::ImageCube: return sizeof(UniformSpec::TextureUniform<Cubemap>);
+		default:                                  return 0;
+	}
+}
+
 void UniformSpec::CreateFrom(GLuint programHandle) {
 	int uniformBufferCount = 0;
 	int uniformVariablesCount = 0;
@@ -234,7 +255,8 @@ void UniformSpec::CreateFrom(GLuint programHandle) {
 // 	}
 // }
 
-UniformSpec::UniformSpec() { }
+UniformSpec::UniformSpec():
+variablesBufferLength(0) { }
 
 UniformSpec::UniformSpec(const ShaderProgram* program) {
 	GLuint handle = program->GetHandle();
@@ -248,6 +270,12 @@ UniformSpec::UniformSpec(const ComputeShaderProgram* program) {
 	CreateFrom(handle);
 }
 
+void UniformSpec::AddVariable(const std::string& name, UniformType type, int binding) {
+	this->variables.push_back({ type, this->variablesBufferLength, binding, name });
+
+	this->variablesBufferLength += SizeOf(type);
+}
+
 unsigned int UniformSpec::GetBufferSize() const {
 	return this->variablesBufferLength;
 }
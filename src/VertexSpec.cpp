@@ -63,16 +63,21 @@ void VertexSpec::SetInputAt(int index, VertexInput input) {
 
 	this->hash |= (inputHash << ((uint64_t) input.type - 1u) * 4u);
 	this->hash |= ((uint64_t) input.type) << (32u + index * 4);
+	this->formats |= (uint32_t) input.format << ((uint32_t) input.type - 1u) * 4u;
 }
 
-VertexSpec::VertexSpec(std::initializer_list<VertexInput> inputs) {
+VertexSpec::VertexSpec(std::initializer_list<VertexInput> inputs) :
+hash(0),
+formats(0) {
 	int index = 0;
 	for (auto i : inputs) {
 		SetInputAt(index++, i);
 	}
 }
 
-VertexSpec::VertexSpec(std::vector<VertexInput> inputs) {
+VertexSpec::VertexSpec(std::vector<VertexInput> inputs) :
+hash(0),
+formats(0) {
 	int index = 0;
 	for (auto i : inputs) {
 		SetInputAt(index++, i);
@@ -80,13 +85,16 @@ VertexSpec::VertexSpec(std::vector<VertexInput> inputs) {
 }
 
 VertexSpec::VertexSpec(const VertexSpec& other) :
-hash(other.hash) { }
+hash(other.hash),
+formats(other.formats) { }
 
-VertexSpec::VertexSpec(uint64_t hash) :
-hash(hash) { }
+VertexSpec::VertexSpec(uint64_t hash, uint32_t formats) :
+hash(hash),
+formats(formats) { }
 
 VertexSpec::VertexSpec() :
-hash(0) { }
+hash(0),
+formats(0) { }
 
 std::vector<VertexInput> VertexSpec::GetInputs() const {
 	std::vector<VertexInput> result;
@@ -98,9 +106,9 @@ std::vector<VertexInput> VertexSpec::GetInputs() const {
 			break;
 		}
 
-		uint8_t count = (uint8_t) (this->hash >> (type - 1u) * 4) & 0xf;
+		uint8_t count = (uint8_t) (this->hash >> (type - 1u) * 4) & 0b111;
 
-		result.push_back({(VertexInputType) type, count});
+		result.push_back({(VertexInputType) type, count, GetFormatOf((VertexInputType) type)});
 	}
 
 	return result;
@@ -110,6 +118,37 @@ int VertexSpec::GetLengthOf(VertexInputType input) const {
 	return (this->hash >> (((uint64_t) input - 1) * 4)) & 0b111;
 }
 
+VertexFormat VertexSpec::GetFormatOf(VertexInputType input) const {
+	return (VertexFormat) ((this->formats >> (((uint32_t) input - 1) * 4)) & 0xf);
+}
+
+unsigned int VertexSpec::GetOffsetOf(VertexInputType input) const {
+	unsigned int offset = 0;
+
+	for (int type = (int) VertexInputType::Position; type < (int) input; type++) {
+		offset += GetSizeOf(GetFormatOf(VertexInputType(type)), GetLengthOf(VertexInputType(type)));
+	}
+
+	return offset;
+}
+
+unsigned int VertexSpec::GetSizeOf(VertexFormat format, unsigned int length) {
+	if (length == 0) {
+		return 0;
+	}
+
+	switch (format) {
+		case VertexFormat::Half:
+		case VertexFormat::Unorm16:
+			return (length * 2 + 3) & ~3u;
+		case VertexFormat::Snorm10:
+		case VertexFormat::Unorm8:
+			return 4;
+		default:
+			return length * 4;
+	}
+}
+
 unsigned int VertexSpec::VertexSize() const {
 	unsigned int result = 0;
 
@@ -120,7 +159,17 @@ unsigned int VertexSpec::VertexSize() const {
 			break;
 		}
 
-		result += (this->hash >> (type - 1u) * 4) & 0xf;
+		result += (this->hash >> (type - 1u) * 4) & 0b111;
+	}
+
+	return result;
+}
+
+unsigned int VertexSpec::VertexBytes() const {
+	unsigned int result = 0;
+
+	for (int type = (int) VertexInputType::Position; type <= (int) VertexInputType::Color; type++) {
+		result += GetSizeOf(GetFormatOf(VertexInputType(type)), GetLengthOf(VertexInputType(type)));
 	}
 
 	return result;
@@ -130,6 +179,22 @@ uint64_t VertexSpec::GetHash() const {
 	return this->hash;
 }
 
+uint32_t VertexSpec::GetFormats() const {
+	return this->formats;
+}
+
+VertexSpec VertexSpec::WithFormat(VertexInputType input, VertexFormat format) const {
+	VertexSpec result(*this);
+
+	if (GetLengthOf(input) > 0) {
+		uint32_t shift = ((uint32_t) input - 1) * 4;
+
+		result.formats = (result.formats & ~(0xfu << shift)) | ((uint32_t) format << shift);
+	}
+
+	return result;
+}
+
 bool VertexSpec::Compatible(const VertexSpec& other) const {
 	if (*this == other) {
 		return true;
@@ -154,10 +219,10 @@ bool VertexSpec::Compatible(const VertexSpec& other) const {
 }
 
 bool VertexSpec::operator==(const VertexSpec& other) const {
-	return this->hash == other.hash;
+	return this->hash == other.hash && this->formats == other.formats;
 }
 bool VertexSpec::operator!=(const VertexSpec& other) const {
-	return this->hash != other.hash;
+	return !(*this == other);
 }
 
 const VertexSpec VertexSpec::Sprite {
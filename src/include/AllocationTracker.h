@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <mutex>
+#include <atomic>
+
+#ifndef SYZYF_ALLOCATION_TRACKING
+#define SYZYF_ALLOCATION_TRACKING 0
+#endif
+
+// Counts global operator new calls per frame and attributes them to the innermost profiler zone.
+// The hook is only compiled in with SYZYF_ALLOCATION_TRACKING, and even then stays idle until enabled.
+class AllocationTracker {
+public:
+	struct ZoneAllocations {
+		const char* name;
+		const char* detail;
+		uint64_t count;
+		uint64_t bytes;
+		// Allocations made inside a NoAllocationScope once strict mode kicked in
+		uint64_t violations;
+	};
+
+	struct Snapshot {
+		uint64_t frame;
+		uint64_t count;
+		uint64_t bytes;
+		uint64_t violations;
+		// Sorted by allocated bytes, zones without allocations are left out
+		std::vector<ZoneAllocations> zones;
+	};
+
+	// Marks code that should not touch the heap in steady state frames, nests freely
+	class NoAllocationScope {
+	public:
+		NoAllocationScope();
+		~NoAllocationScope();
+
+		NoAllocationScope(const NoAllocationScope&) = delete;
+		NoAllocationScope& operator=(const NoAllocationScope&) = delete;
+	};
+private:
+	static constexpr int MaxZones = 1024;
+	static constexpr int MaxReportedFrames = 10;
+
+	struct ZoneSlot {
+		bool used;
+		ZoneAllocations allocations;
+	};
+
+	static std::atomic<bool> enabled;
+	static bool strict;
+	static uint64_t strictFromFrame;
+	static uint64_t reportedFrames;
+
+	static uint64_t frameCount;
+	static uint64_t totalViolations;
+
+	// Fixed storage, the hook runs inside operator new and must not allocate itself
+	static std::mutex zonesMutex;
+	static ZoneSlot zones[MaxZones + 1];
+
+	static Snapshot lastFrame;
+
+	static thread_local int suspended;
+	static thread_local int noAllocationDepth;
+
+	static ZoneSlot& FindSlot(const char* name, const char* detail);
+	static void ReportViolations();
+public:
+	AllocationTracker() = delete;
+
+	// Called by the replaced operator new, cheap while tracking is disabled
+	static void Record(size_t size);
+
+	static void BeginFrame();
+
+	// False when the engine was built without the hook
+	static bool IsAvailable();
+
+	static bool IsEnabled();
+	static void SetEnabled(bool enabled);
+
+	// Flags every allocation inside Scene::Update and Scene::Render from fromFrame on
+	static void SetStrict(bool strict, uint64_t fromFrame = 0);
+	static bool IsStrict();
+
+	static const Snapshot& GetLastFrame();
+	static uint64_t GetTotalViolations();
+
+	static void DrawImGui();
+};
\ No newline at end of file
@@ -8,21 +8,55 @@
 
 class Bloom : public PostProcessEffect, public ImGuiDrawable {
 private:
-	glm::vec2 savedResolution;
-	GLuint bloomTexture;
+	glm::vec2 frameResolution;
+	// Borrowed from the render graph pool for the pass that runs the effect
+	Texture2D* bloomTexture;
+	int mipCount;
+	GLuint downsampleCounterBuffer;
 	ComputeShaderProgram* downsampleShader;
 	ComputeShaderProgram* upsampleShader;
 	ComputeShaderProgram* finalShader;
 
+	struct {
+		GLint treshold;
+		GLint mip0Size;
+		GLint mipCount;
+		GLint groupCount;
+	} downsampleUniforms;
+
+	struct {
+		GLint texelSize;
+		GLint mipLevel;
+		GLint bloomIntensity;
+	} upsampleUniforms;
+
+	struct {
+		GLint frameTexelSize;
+		GLint bloomTexelSize;
+		GLint bloomIntensity;
+	} finalUniforms;
+
 	float threshold = 1.5f;
 	float knee = 0.1f;
 	float intensity = 0.6f;
 
-	void UpdateTexture();
+	void BuildPyramid(const PostProcessParams* params);
 public:
 	Bloom();
+	~Bloom();
 
 	virtual void OnPostProcess(const PostProcessParams* params);
 
+	virtual bool RunsInPlace() const;
+
+	virtual int GetFusedVariant() const;
+	virtual bool GetFusedSnippet(PostProcessSnippet* snippet) const;
+	virtual void OnPreFusedPass(const PostProcessParams* params);
+	virtual bool PreFusedPassReadsInput() const;
+	virtual void SetFusedValues(ComputeDispatchData* data, const std::vector<std::string>& uniforms);
+
+	virtual std::vector<float> GetSettings() const;
+	virtual void SetSettings(const std::vector<float>& settings);
+
 	virtual void DrawImGui();
 };
\ No newline at end of file
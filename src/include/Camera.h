@@ -43,6 +43,7 @@ private:
 	Orthographic orthoData;
 	Viewport* renderTarget;
 	LayerMask layerMask;
+	glm::vec2 projectionJitter;
 public:
 	Camera(Perspective perspectiveData);
 	Camera(Orthographic orthoData);
@@ -81,8 +82,12 @@ public:
 
 	glm::mat4 ViewMatrix() const;
 	glm::mat4 ProjectionMatrix() const;
+	glm::mat4 UnjitteredProjectionMatrix() const;
 	glm::mat4 ViewProjectionMatrix() const;
 
+	glm::vec2 GetProjectionJitter() const;
+	void SetProjectionJitter(glm::vec2 ndcOffset);
+
 	Viewport* GetRenderTarget() const;
 	void SetRenderTarget(Viewport* viewport);
 
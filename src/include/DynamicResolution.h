@@ -0,0 +1,46 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+class DynamicResolution {
+private:
+	static constexpr int QueryLatency = 4;
+
+	GLuint startQueries[QueryLatency];
+	GLuint endQueries[QueryLatency];
+	bool queryIssued[QueryLatency];
+	int queryIndex;
+
+	bool enabled;
+	float targetFrameTime;
+	float minScale;
+	float maxScale;
+
+	float scale;
+	float gpuFrameTime;
+	int framesSinceChange;
+
+	void OnFrameTimeMeasured(float frameTimeMs);
+public:
+	DynamicResolution();
+	~DynamicResolution();
+
+	void BeginFrame();
+	void EndFrame();
+
+	bool IsEnabled() const;
+	void SetEnabled(bool enabled);
+
+	float GetTargetFrameTime() const;
+	void SetTargetFrameTime(float frameTimeMs);
+
+	void SetScaleRange(float minScale, float maxScale);
+
+	float GetScale() const;
+	float GetGPUFrameTime() const;
+
+	glm::uvec2 GetRenderResolution(const glm::uvec2& outputResolution) const;
+
+	void DrawImGui();
+};
\ No newline at end of file
@@ -4,6 +4,7 @@
 
 class GLFWwindow;
 class Scene;
+class Viewport;
 
 template <typename T>
 concept SceneCreationCallback = requires(T a, Scene* s) {
@@ -17,22 +18,40 @@ private:
 	static GLFWwindow* window;
 	static Scene* rootScene;
 
+	static constexpr double UploadBudgetSeconds = 0.002;
+
+	static bool headless;
+	static int frameLimit;
+	static Viewport* headlessTarget;
+
 	static bool InitProgram();
+	static bool InitHeadless(unsigned int width, unsigned int height);
 	static bool InitImGui();
+	static void InitGLState();
+	static void InitResources();
 	static void Terminate();
 	static void Update();
 	static void Render();
 	static void DrawImGui();
+	static void WriteProfilerTrace();
 public:
 	static bool Setup();
 	template <SceneCreationCallback T>
 	static bool Setup(T* sceneCreationCallback);
 
+	// Renders frameCount frames into an offscreen target using a surfaceless EGL context
+	static bool SetupHeadless(unsigned int width, unsigned int height, int frameCount);
+	template <SceneCreationCallback T>
+	static bool SetupHeadless(T* sceneCreationCallback, unsigned int width, unsigned int height, int frameCount);
+
 	static void MainLoop();
 	static void Exit(int code = 0);
 
 	static Scene* GetRoot();
 	static GLFWwindow* GetWindow();
+
+	static bool IsHeadless();
+	static Viewport* GetHeadlessTarget();
 };
 
 template <SceneCreationCallback T>
@@ -45,5 +64,18 @@ bool Engine::Setup(T* sceneCreationCallback) {
 
 	sceneCreationCallback(rootScene);
 
+	return true;
+}
+
+template <SceneCreationCallback T>
+bool Engine::SetupHeadless(T* sceneCreationCallback, unsigned int width, unsigned int height, int frameCount) {
+	bool result = SetupHeadless(width, height, frameCount);
+
+	if (!result) {
+		return false;
+	}
+
+	sceneCreationCallback(rootScene);
+
 	return true;
 }
\ No newline at end of file
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <vector>
+
+// Linear allocator for data that does not outlive the frame it was created in.
+// Every thread bumps its own arena, BeginFrame rewinds all of them and nothing is ever freed individually.
+class FrameArena {
+private:
+	static constexpr size_t MinBlockSize = 64 * 1024;
+
+	struct Block {
+		Block* previous;
+		size_t size;
+	};
+
+	Block* current;
+	size_t offset;
+	size_t used;
+	size_t peak;
+	uint64_t frame;
+
+	static std::atomic<uint64_t> currentFrame;
+
+	void AddBlock(size_t minSize);
+	void Rewind();
+public:
+	FrameArena();
+	~FrameArena();
+
+	FrameArena(const FrameArena&) = delete;
+	FrameArena& operator=(const FrameArena&) = delete;
+
+	void* Allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+	template<typename T>
+	T* Allocate(size_t count);
+
+	size_t GetUsedBytes() const;
+	size_t GetPeakBytes() const;
+
+	// Arena of the calling thread, rewound on its first allocation after BeginFrame
+	static FrameArena& Local();
+
+	// Invalidates everything allocated from any arena during the previous frame
+	static void BeginFrame();
+};
+
+// Standard allocator over the calling thread's frame arena, deallocation is a no-op
+template<typename T>
+class FrameAllocator {
+public:
+	using value_type = T;
+
+	FrameAllocator() = default;
+
+	template<typename U>
+	FrameAllocator(const FrameAllocator<U>&) { }
+
+	T* allocate(size_t count) {
+		return FrameArena::Local().Allocate<T>(count);
+	}
+
+	void deallocate(T*, size_t) { }
+
+	template<typename U>
+	bool operator==(const FrameAllocator<U>&) const {
+		return true;
+	}
+};
+
+template<typename T>
+using FrameVector = std::vector<T, FrameAllocator<T>>;
+
+template<typename T>
+T* FrameArena::Allocate(size_t count) {
+	return static_cast<T*>(Allocate(count * sizeof(T), alignof(T)));
+}
\ No newline at end of file
@@ -0,0 +1,148 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <filesystem>
+#include <unordered_map>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <SceneComponent.h>
+#include <BoundingBox.h>
+#include <UniformSpec.h>
+#include <Texture.h>
+#include <Camera.h>
+#include <Light.h>
+
+namespace fs = std::filesystem;
+
+class SceneGraphics;
+class Mesh;
+class Material;
+class ShaderProgram;
+
+// Everything SceneGraphics needs to render one frame, with assets referenced by their resource paths.
+// Replaying it needs the same asset files but none of the objects that produced the frame.
+class FrameCapture {
+	friend class FrameReplay;
+public:
+	struct CameraRecord {
+		Camera::CameraType type;
+		Camera::Perspective perspective;
+		Camera::Orthographic ortho;
+		uint32_t layerMask;
+		glm::vec3 position;
+		glm::quat rotation;
+	};
+
+	struct LightRecord {
+		Light::LightType type;
+		glm::vec3 color;
+		float range;
+		float spotlightAngle;
+		float intensity;
+		float linearAttenuation;
+		float quadraticAttenuation;
+		bool shadowCasting;
+		glm::vec3 position;
+		glm::quat rotation;
+	};
+
+	struct VariableRecord {
+		std::string name;
+		UniformSpec::UniformType type;
+		std::vector<char> value;
+		// Only used by texture variables, an empty path binds no texture
+		std::string texturePath;
+		TextureParams textureParams;
+		unsigned int level;
+	};
+
+	struct UniformBufferRecord {
+		std::string name;
+		std::vector<char> data;
+	};
+
+	struct MaterialRecord {
+		std::string vertexShader;
+		std::string geometryShader;
+		std::string tessControlShader;
+		std::string tessEvaluationShader;
+		std::string pixelShader;
+		bool ignoresDepthPrepass;
+		bool castsShadows;
+		std::vector<VariableRecord> variables;
+		std::vector<UniformBufferRecord> uniformBuffers;
+	};
+
+	struct NodeRecord {
+		uint32_t mesh;
+		uint32_t subMesh;
+		uint32_t material;
+		uint32_t instanceCount;
+		glm::mat4 transformation;
+		BoundingBox bounds;
+		uint8_t layer;
+	};
+
+	struct EffectRecord {
+		std::string type;
+		std::vector<float> settings;
+	};
+
+	glm::uvec2 resolution;
+	// Replays render at this fixed scale with dynamic resolution off
+	float renderScale;
+	bool temporalUpsampling;
+	CameraRecord camera;
+	std::vector<std::string> meshes;
+	std::vector<MaterialRecord> materials;
+	std::vector<NodeRecord> nodes;
+	std::vector<LightRecord> lights;
+	std::vector<EffectRecord> effects;
+	// Index into materials, -1 when the frame has no sky
+	int skyMaterial;
+private:
+	static void CaptureMaterial(const Material* material, const std::unordered_map<const void*, std::string>& texturePaths, MaterialRecord& record);
+	// Variables are matched by name, so captures survive shader edits that keep the variable
+	static void RestoreMaterial(const MaterialRecord& record, Material* material, ResourceDatabase* resources);
+public:
+	FrameCapture();
+
+	// Snapshots the render list SceneGraphics has queued for the current frame
+	static FrameCapture* Capture(SceneGraphics* graphics);
+
+	static FrameCapture* Load(const fs::path& path);
+	bool Save(const fs::path& path) const;
+};
+
+// Recreates a captured frame in an otherwise empty scene and resubmits its render list every frame.
+// Assets are resolved once in Load, nothing is updated or reloaded while replaying.
+class FrameReplay : public SceneComponent {
+private:
+	struct Draw {
+		const Mesh* mesh;
+		int subMesh;
+		const Material* material;
+		unsigned int instanceCount;
+		glm::mat4 transformation;
+		BoundingBox bounds;
+		uint8_t layer;
+	};
+
+	std::vector<Draw> draws;
+	std::vector<Material*> materials;
+	std::vector<ShaderProgram*> programs;
+
+	Material* CreateMaterial(const FrameCapture::MaterialRecord& record, std::unordered_map<std::string, ShaderProgram*>& programCache);
+public:
+	FrameReplay(Scene* scene);
+	virtual ~FrameReplay();
+
+	bool Load(const FrameCapture* capture);
+
+	unsigned int GetDrawCount() const;
+
+	virtual void OnPreRender();
+};
\ No newline at end of file
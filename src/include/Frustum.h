@@ -2,6 +2,8 @@
 
 #include <glm/glm.hpp>
 
+#include <BoundingBox.h>
+
 struct Plane {
 	glm::vec3 normal;
 	float distance;
@@ -26,4 +28,9 @@ struct Frustum {
 	        const Plane& nearPlane,
 	        const Plane& farPlane
 	);
-};
\ No newline at end of file
+};
+
+Frustum ComputeFrustum(const glm::mat4& projectionMatrix);
+
+bool TestPlane(const Plane& plane, const BoundingBox& bounds);
+bool TestFrustum(const Frustum& frustum, const BoundingBox& bounds);
\ No newline at end of file
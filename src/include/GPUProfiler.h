@@ -0,0 +1,105 @@
+#pragma once
+
+#include <vector>
+#include <filesystem>
+
+#include <glad/glad.h>
+
+namespace fs = std::filesystem;
+
+class GPUProfiler {
+public:
+	struct ZoneTiming {
+		const char* name;
+		int depth;
+		float time;
+		float averageTime;
+	};
+
+	// Times the GPU work issued during its lifetime and labels it with a debug group.
+	// The name is kept, not copied, use string literals or Profiler::Intern.
+	class Scope {
+	private:
+		GPUProfiler* profiler;
+	public:
+		Scope(GPUProfiler* profiler, const char* name);
+		~Scope();
+
+		Scope(const Scope&) = delete;
+		Scope& operator=(const Scope&) = delete;
+	};
+private:
+	static constexpr int QueryLatency = 4;
+	static constexpr int HistoryLength = 240;
+
+	struct PendingZone {
+		const char* name;
+		int depth;
+		GLuint startQuery;
+		GLuint endQuery;
+	};
+
+	struct FrameQueries {
+		std::vector<GLuint> queries;
+		int usedQueries;
+		std::vector<PendingZone> zones;
+		GLuint lastQuery;
+		unsigned int frameIndex;
+		bool issued;
+	};
+
+	struct RecordedZone {
+		unsigned int frameIndex;
+		const char* name;
+		int depth;
+		float time;
+	};
+
+	FrameQueries frames[QueryLatency];
+	int queryIndex;
+	unsigned int frameIndex;
+	bool inFrame;
+
+	std::vector<int> openZones;
+
+	bool enabled;
+
+	// Swapped on every collected frame, the previous timings feed the averages
+	std::vector<ZoneTiming> timings;
+	std::vector<ZoneTiming> previousTimings;
+	unsigned int timingsFrameIndex;
+	int droppedFrames;
+
+	float frameTimeHistory[HistoryLength];
+	int historyOffset;
+
+	bool recording;
+	std::vector<RecordedZone> recordedZones;
+
+	GLuint AcquireQuery(FrameQueries& frame);
+	void Collect(FrameQueries& frame);
+public:
+	GPUProfiler();
+	~GPUProfiler();
+
+	void BeginFrame();
+	void EndFrame();
+
+	void BeginZone(const char* name);
+	void EndZone();
+
+	bool IsEnabled() const;
+	void SetEnabled(bool enabled);
+
+	const std::vector<ZoneTiming>& GetTimings() const;
+	float GetFrameTime() const;
+	unsigned int GetTimingsFrame() const;
+
+	bool IsRecording() const;
+	void StartRecording();
+	void StopRecording();
+
+	bool ExportCSV(const fs::path& path) const;
+
+	void DrawImGui();
+};
\ No newline at end of file
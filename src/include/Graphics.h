@@ -1,6 +1,7 @@
 #pragma once
 
 #include <vector>
+#include <unordered_map>
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 
@@ -15,10 +16,16 @@ struct ShaderGlobalUniforms;
 class MeshRenderer;
 class Scene;
 class ComputeShaderDispatch;
+class Texture;
 class Texture2D;
 class LightSystem;
 class PostProcessingSystem;
 class ReflectionProbeSystem;
+class RenderGraph;
+class GPUProfiler;
+class DynamicResolution;
+class TemporalUpsampler;
+class MeshletCuller;
 class Camera;
 class Viewport;
 
@@ -33,7 +40,8 @@ enum class RenderPassType {
 	DepthPrepass = 2,
 	Shadows = 6,
 	Gizmos = 8,
-	PostProcessing = 16
+	PostProcessing = 16,
+	MotionVectors = 32
 };
 
 struct RenderParams {
@@ -41,11 +49,16 @@ struct RenderParams {
 	glm::vec4 viewport;
 	bool clearDepth;
 	LayerMask layers;
+	// Multiplies the screen space error allowed when picking levels of detail
+	float lodBias;
+	// Keeps the picked levels as the starting point for the next frame
+	bool recordLODs;
 
 	RenderParams(RenderPassType pass, glm::vec4 viewport, bool clearDepth = false, LayerMask layers = LayerMask::All);
 };
 
 class SceneGraphics : public GameObjectSystem<Camera> {
+	friend class FrameCapture;
 private:
 	struct RenderNode {
 		const Mesh::SubMesh* mesh;
@@ -57,9 +70,10 @@ private:
 		const glm::mat4 transformation;
 		const BoundingBox bounds;
 		uint8_t layer;
+		const void* owner;
 
-		RenderNode(const Mesh::SubMesh* mesh, const Material* material, unsigned int instanceCount, const glm::mat4& transformation, uint8_t layer);
-		RenderNode(const Mesh::SubMesh* mesh, const Material* material, unsigned int instanceCount, const glm::mat4& transformation, const BoundingBox& bounds, uint8_t layer);
+		RenderNode(const Mesh::SubMesh* mesh, const Material* material, unsigned int instanceCount, const glm::mat4& transformation, uint8_t layer, const void* owner = nullptr);
+		RenderNode(const Mesh::SubMesh* mesh, const Material* material, unsigned int instanceCount, const glm::mat4& transformation, const BoundingBox& bounds, uint8_t layer, const void* owner = nullptr);
 		RenderNode(const Mesh::SubMesh* mesh, const Material* material, bool ignoreDepth, const glm::mat4& transformation, uint8_t layer);
 		RenderNode(const Mesh::SubMesh* mesh, const Material* material, bool ignoreDepth, const glm::mat4& transformation, const BoundingBox& bounds, uint8_t layer);
 	};
@@ -70,6 +84,61 @@ private:
 	GLuint objectUniformsBuffer;
 	
 	Viewport* mainViewport;
+	Viewport* outputTarget;
+	glm::uvec2 outputResolution;
+
+	GPUProfiler* gpuProfiler;
+	RenderGraph* renderGraph;
+
+	DynamicResolution* dynamicResolution;
+	TemporalUpsampler* temporalUpsampler;
+	bool temporalUpsampling;
+
+	MeshletCuller* meshletCuller;
+	bool meshletCulling;
+
+	struct PreviousTransform {
+		glm::mat4 transformation;
+		uint64_t frame;
+	};
+
+	// Updated in place while temporal upsampling is on, so nodes are only allocated for owners that were not rendered recently
+	std::unordered_map<const void*, PreviousTransform> previousTransforms;
+
+	// How a view turns model space errors into pixels
+	struct LODView {
+		glm::mat4 viewProjection;
+		float pixelsPerUnit;
+		bool perspective;
+		float errorPixels;
+	};
+
+	struct LODKey {
+		const void* owner;
+		const Mesh::SubMesh* mesh;
+
+		bool operator==(const LODKey& other) const = default;
+	};
+
+	struct LODKeyHash {
+		size_t operator()(const LODKey& key) const {
+			return (std::hash<const void*>()(key.owner) * 31) ^ std::hash<const void*>()(key.mesh);
+		}
+	};
+
+	struct LODRecord {
+		unsigned int level;
+		uint64_t frame;
+	};
+
+	// Levels the main camera picked in its color pass, switching to a coarser one takes a margin so the levels do not flicker.
+	// Entries outlive a few frames out of view, so nodes are only allocated for meshes that were not seen recently
+	std::unordered_map<LODKey, LODRecord, LODKeyHash> previousLODs;
+	// Counts rendered frames, stamps the entries of previousTransforms and previousLODs
+	uint64_t historyFrame;
+	float lodErrorPixels;
+	float shadowLODBias;
+	float probeLODBias;
 
 	LightSystem* lightSystem;
 	PostProcessingSystem* postProcessing;
@@ -77,28 +146,66 @@ private:
 
 	Camera* mainCamera;
 
+	fs::path capturePath;
+
 	void RenderObjects(const ShaderGlobalUniforms& globalUniforms, RenderParams params);
-	void RenderFullscreenFrameQuad();
+	void RenderMotionVectors(const ShaderGlobalUniforms& globalUniforms, const RenderParams& params);
+	void RenderFullscreenFrameQuad(Texture* source);
+
+	LODView GetLODView(const glm::mat4& projection, const glm::mat4& view, float viewportHeight, float bias) const;
+	// Coarsest level whose error stays below the allowed pixels on screen, worldBounds are the node's bounds transformed
+	unsigned int SelectLOD(const RenderNode& node, const BoundingBox& worldBounds, const LODView& view) const;
 	
 	void BindGlobalUniformBuffer(const ShaderGlobalUniforms& globalUniforms);
+
+	bool UsesUpsampling() const;
 	
 	void Render();
 public:
 	SceneGraphics(Scene* scene);
 
 	glm::vec2 GetScreenResolution() const;
+	glm::vec2 GetRenderResolution() const;
 	void UpdateScreenResolution(glm::vec2 newResolution);
 	
 	LightSystem* GetLightSystem();
 	PostProcessingSystem* GetPostProcessing();
 	ReflectionProbeSystem* GetEnvMapping();
 
+	RenderGraph* GetRenderGraph() const;
+	GPUProfiler* GetGPUProfiler() const;
+
+	DynamicResolution* GetDynamicResolution() const;
+	TemporalUpsampler* GetTemporalUpsampler() const;
+
+	bool IsTemporalUpsamplingEnabled() const;
+	void SetTemporalUpsamplingEnabled(bool enabled);
+
 	Viewport* GetMainViewport() const;
 	Framebuffer* GetMainFramebuffer() const;
 
+	Viewport* GetOutputTarget() const;
+	void SetOutputTarget(Viewport* target);
+
 	Camera* GetMainCamera() const;
 	void SetMainCamera(Camera* camera);
 
+	// Simplified levels of detail are drawn while their error covers fewer pixels than this, zero always draws full detail
+	void SetLODErrorPixels(float pixels);
+	float GetLODErrorPixels() const;
+	// Multiply the allowed error in shadow maps and reflection probes, where coarser geometry is rarely noticed
+	void SetShadowLODBias(float bias);
+	float GetShadowLODBias() const;
+	void SetProbeLODBias(float bias);
+	float GetProbeLODBias() const;
+
+	// Culls the meshlets of full detail meshes on the GPU before drawing them, off by default
+	void SetMeshletCulling(bool enabled);
+	bool GetMeshletCulling() const;
+
+	// Writes the render input of the next frame to path once it has been rendered
+	void CaptureFrame(const fs::path& path);
+
 	void DrawMesh(MeshRenderer* renderer);
 	void DrawMesh(const Mesh* mesh, int subMeshIndex, const Material* material, const glm::mat4& transformation, uint8_t layer = Layer::Default);
 	void DrawMesh(const Mesh* mesh, int subMeshIndex, const Material* material, const glm::mat4& transformation, const BoundingBox& bounds, uint8_t layer = Layer::Default);
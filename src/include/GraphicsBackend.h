@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <glad/glad.h>
+
+#include <UniformSpec.h>
+
+// Every command the renderer submits per frame goes through the current backend, resource creation
+// outside of the per-frame buffers still talks to GL directly
+class GraphicsBackend {
+private:
+	static GraphicsBackend* current;
+public:
+	virtual ~GraphicsBackend() = default;
+
+	static GraphicsBackend* Current();
+	// Passing nullptr restores the GL backend
+	static void SetCurrent(GraphicsBackend* backend);
+
+	virtual GLuint CreateBuffer() = 0;
+	virtual void DeleteBuffer(GLuint buffer) = 0;
+	virtual void BufferData(GLenum target, GLuint buffer, size_t size, const void* data, GLenum usage) = 0;
+	virtual void BufferSubData(GLenum target, GLuint buffer, size_t offset, size_t size, const void* data) = 0;
+	virtual void BindBufferBase(GLenum target, unsigned int index, GLuint buffer) = 0;
+
+	virtual void UseProgram(GLuint program) = 0;
+	virtual void BindVertexArray(GLuint vertexArray) = 0;
+	virtual void BindTexture(unsigned int unit, GLenum target, GLuint texture) = 0;
+	virtual void BindImageTexture(unsigned int unit, GLuint texture, int level, bool layered, GLenum access, GLenum format) = 0;
+
+	virtual int GetUniformLocation(GLuint program, const char* name) = 0;
+	// Samplers and images take the texture unit as an int
+	virtual void SetUniform(int location, UniformSpec::UniformType type, const void* value) = 0;
+
+	virtual void BindFramebuffer(GLuint framebuffer) = 0;
+	virtual void SetViewport(int x, int y, int width, int height) = 0;
+	virtual void ClearColor(float r, float g, float b, float a) = 0;
+	virtual void Clear(GLbitfield mask) = 0;
+
+	virtual void SetEnabled(GLenum capability, bool enabled) = 0;
+	virtual void SetDepthMask(bool enabled) = 0;
+	virtual void SetDepthFunc(GLenum func) = 0;
+	virtual void SetCullFace(GLenum face) = 0;
+	virtual void SetPatchVertices(int vertices) = 0;
+
+	// Indices are read from the bound vertex array starting indexOffset bytes in and offset by baseVertex, instanceCount 0 issues a regular draw
+	virtual void DrawElements(GLenum mode, unsigned int count, GLenum indexType, uint64_t indexOffset, int baseVertex, unsigned int instanceCount = 0) = 0;
+	// Issues the DrawElementsIndirectCommand records in commandBuffer starting commandOffset bytes in, as many as the uint countOffset bytes in says
+	virtual void DrawElementsIndirect(GLenum mode, GLenum indexType, GLuint commandBuffer, uint64_t commandOffset, uint64_t countOffset, unsigned int maxDrawCount) = 0;
+	virtual void DispatchCompute(unsigned int groupsX, unsigned int groupsY, unsigned int groupsZ) = 0;
+	virtual void Barrier(GLbitfield barriers) = 0;
+};
+
+class GLBackend : public GraphicsBackend {
+public:
+	virtual GLuint CreateBuffer();
+	virtual void DeleteBuffer(GLuint buffer);
+	virtual void BufferData(GLenum target, GLuint buffer, size_t size, const void* data, GLenum usage);
+	virtual void BufferSubData(GLenum target, GLuint buffer, size_t offset, size_t size, const void* data);
+	virtual void BindBufferBase(GLenum target, unsigned int index, GLuint buffer);
+
+	virtual void UseProgram(GLuint program);
+	virtual void BindVertexArray(GLuint vertexArray);
+	virtual void BindTexture(unsigned int unit, GLenum target, GLuint texture);
+	virtual void BindImageTexture(unsigned int unit, GLuint texture, int level, bool layered, GLenum access, GLenum format);
+
+	virtual int GetUniformLocation(GLuint program, const char* name);
+	virtual void SetUniform(int location, UniformSpec::UniformType type, const void* value);
+
+	virtual void BindFramebuffer(GLuint framebuffer);
+	virtual void SetViewport(int x, int y, int width, int height);
+	virtual void ClearColor(float r, float g, float b, float a);
+	virtual void Clear(GLbitfield mask);
+
+	virtual void SetEnabled(GLenum capability, bool enabled);
+	virtual void SetDepthMask(bool enabled);
+	virtual void SetDepthFunc(GLenum func);
+	virtual void SetCullFace(GLenum face);
+	virtual void SetPatchVertices(int vertices);
+
+	virtual void DrawElements(GLenum mode, unsigned int count, GLenum indexType, uint64_t indexOffset, int baseVertex, unsigned int instanceCount = 0);
+	virtual void DrawElementsIndirect(GLenum mode, GLenum indexType, GLuint commandBuffer, uint64_t commandOffset, uint64_t countOffset, unsigned int maxDrawCount);
+	virtual void DispatchCompute(unsigned int groupsX, unsigned int groupsY, unsigned int groupsZ);
+	virtual void Barrier(GLbitfield barriers);
+};
\ No newline at end of file
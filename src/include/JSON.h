@@ -0,0 +1,6 @@
+#pragma once
+
+#include <string>
+
+// Escapes quotes, backslashes and control characters for use inside a JSON string literal
+std::string EscapeJSON(const std::string& text);
\ No newline at end of file
@@ -5,13 +5,24 @@
 #include <GameObjectSystem.h>
 #include <Light.h>
 #include <Framebuffer.h>
+#include <Graphics.h>
 #include <Debug.h>
 
+#include "../res/shaders/shared/uniforms.h"
+
 class LightSystem : public GameObjectSystem<Light>, public ImGuiDrawable {
 	friend class SceneGraphics;
 private:
+	struct ShadowView {
+		ShaderGlobalUniforms uniforms;
+		RenderParams params;
+		const Light* light;
+	};
+
 	Framebuffer* shadowAtlasFramebuffer;
 
+	std::vector<ShadowView> shadowViews;
+
 	GLuint lightsBuffer;
 	GLuint shadowmapsBuffer;
 
@@ -23,11 +34,14 @@ private:
 	void DoSpotLightShadowmap(Light* light, ShadowMapRegion& shadowmapRect);
 	void DoDirectionalLightShadowmap(Light* light, ShadowMapRegion* shadowmapRects);
 	void DoPointLightShadowmap(Light* light, ShadowMapRegion* shadowmapRects);
+
+	void RenderShadowAtlas();
 public:
 	LightSystem(Scene* scene);
 
 	GLuint GetLightsBufferHandle();
 	GLuint GetShadowmapsBufferHandle();
+	Texture* GetShadowAtlasTexture() const;
 
 	virtual void OnPostRender();
 
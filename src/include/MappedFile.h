@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+// Read only view of a whole file mapped into memory, pages are only read from disk once touched
+class MappedFile {
+private:
+	void* data;
+	size_t size;
+
+#ifdef _WIN32
+	void* fileHandle;
+	void* mappingHandle;
+#endif
+
+	MappedFile();
+public:
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	const unsigned char* GetData() const;
+	size_t GetSize() const;
+
+	// Null if the file does not exist, is empty or cannot be mapped
+	static MappedFile* Open(const fs::path& path);
+};
\ No newline at end of file
@@ -10,6 +10,7 @@
 
 class ShaderVariableStorage {
 	friend class SceneGraphics;
+	friend class FrameCapture;
 private:
 	struct BufferPair {
 		void* bufferData;
@@ -66,6 +67,7 @@ public:
 };
 
 class Material {
+	friend class FrameCapture;
 private:
 	const ShaderProgram* shader;
 	ShaderVariableStorage shaderVariables;
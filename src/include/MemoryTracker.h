@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <mutex>
+#include <unordered_map>
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+enum class MemoryCategory {
+	Meshes = 0,
+	Textures,
+	RenderTargets,
+	ShadowMaps,
+	ReflectionProbes,
+	PostProcessing,
+	Count
+};
+
+// Bookkeeping of the memory held by engine resources, keyed by the owning object.
+// GPU sizes are estimates from format, dimensions and mip count, drivers may pad or compress.
+class MemoryTracker {
+public:
+	struct Usage {
+		uint64_t cpuBytes;
+		uint64_t gpuBytes;
+	};
+
+	struct Budget {
+		// Zero means unlimited
+		uint64_t cpuBytes;
+		uint64_t gpuBytes;
+	};
+private:
+	struct Allocation {
+		MemoryCategory category;
+		std::string label;
+		Usage usage;
+	};
+
+	static std::mutex mutex;
+	static std::unordered_map<const void*, Allocation> allocations;
+	static Usage totals[(int) MemoryCategory::Count];
+	static Budget budgets[(int) MemoryCategory::Count];
+	static bool overBudget[(int) MemoryCategory::Count];
+
+	static void Add(MemoryCategory category, const Usage& usage);
+	static void Remove(MemoryCategory category, const Usage& usage);
+	static void CheckBudget(MemoryCategory category);
+public:
+	MemoryTracker() = delete;
+
+	// Sets the current size of owner, the category only applies when owner is not tracked yet
+	static void Track(const void* owner, MemoryCategory category, uint64_t cpuBytes, uint64_t gpuBytes);
+	static void Untrack(const void* owner);
+
+	// Moves owner to another category, tracking it with no memory if it was not tracked yet
+	static void SetCategory(const void* owner, MemoryCategory category);
+	// Names the allocation in reports, resources are labeled with the path they were registered under
+	static void SetLabel(const void* owner, const std::string& label);
+
+	static Usage GetUsage(MemoryCategory category);
+	// Zero for owners that are not tracked
+	static Usage GetUsage(const void* owner);
+	static Usage GetTotalUsage();
+
+	static Budget GetBudget(MemoryCategory category);
+	// Logs a warning whenever the category grows past the budget
+	static void SetBudget(MemoryCategory category, uint64_t cpuBytes, uint64_t gpuBytes);
+
+	static const char* GetName(MemoryCategory category);
+	static const char* GetKey(MemoryCategory category);
+
+	static std::string ToJSON();
+	static bool Dump(const fs::path& path);
+
+	static void DrawImGui();
+};
\ No newline at end of file
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <vector>
+#include <string>
+#include <span>
 #include <filesystem>
 
 #include <glad/glad.h>
@@ -7,10 +10,13 @@
 #include <VertexSpec.h>
 #include <BoundingBox.h>
 #include <Resources.h>
+#include <MeshOptimizer.h>
 
 namespace fs = std::filesystem;
 
 class Material;
+class MappedFile;
+struct aiScene;
 
 class Mesh : public Resource {
 public:
@@ -22,17 +28,40 @@ public:
 
 	class SubMesh {
 		friend class Mesh;
+	public:
+		// Level 0 is the full detail triangles, coarser levels follow them in the same index data
+		static constexpr unsigned int MaxLODCount = 4;
+
+		struct LOD {
+			unsigned int firstIndex;
+			unsigned int indexCount;
+			// How far the simplified surface may be from the full detail one, in model units
+			float error;
+		};
 	private:
 		unsigned int faceCount;
-		unsigned int* indexData;
+		// In the index type, 16 bit indices are relative to baseVertex
+		void* indexData;
+		GLenum indexType;
+		unsigned int baseVertex;
 		MeshType type;
 		int materialIndex;
 		BoundingBox bounds;
+		// The levels after level 0
+		unsigned int simplifiedCount;
+		LOD simplified[MaxLODCount - 1];
+		// Only built for the full detail level of triangle submeshes
+		unsigned int meshletCount;
+		MeshOptimizer::Meshlet* meshlets;
 
 		struct {
 			GLuint vertexArray;
 			GLuint indexBuffer;
+			GLuint meshletBuffer;
 		} handle;
+
+		// Switches the 32 bit indices to 16 bit when they span few enough vertices
+		void PackIndices();
 	public:
 		MeshType GetType() const;
 		unsigned int GetVerticesPerFace() const;
@@ -42,11 +71,33 @@ public:
 
 		GLuint GetVertexArrayHandle() const;
 		GLuint GetIndexBufferHandle() const;
+		// Storage buffer with the meshlets, 0 when there are none
+		GLuint GetMeshletBufferHandle() const;
 
+		// Indices of the full detail level
 		unsigned int GetVertexCount() const;
 		unsigned int GetFaceCount() const;
 
+		unsigned int GetLODCount() const;
+		LOD GetLOD(unsigned int level) const;
+
+		GLenum GetIndexType() const;
+		unsigned int GetIndexSize() const;
+		// Of all levels
+		unsigned int GetIndexCount() const;
+		uint64_t GetIndexBytes() const;
+		// Added to every index by the draw call
+		unsigned int GetBaseVertex() const;
+
+		const void* GetIndexData() const;
+		// Vertex the i-th index refers to, with the base vertex added
+		unsigned int GetIndex(unsigned int i) const;
+
 		BoundingBox GetBounds() const;
+
+		unsigned int GetMeshletCount() const;
+		// Null once the CPU data is released
+		const MeshOptimizer::Meshlet* GetMeshlets() const;
 	};
 
 	// class MeshPart {
@@ -61,30 +112,107 @@ public:
 	// 	int faceOffset;
 	// };
 private:
+	struct MaterialTextures {
+		std::string color;
+		std::string normal;
+		std::string arm;
+	};
+
+	struct ImportPlan;
+
 	std::vector<SubMesh> subMeshes;
 	std::vector<Material*> materials;
 	// std::map<std::string, MeshPart> parts;
 	
 	unsigned int materialCount;
 	unsigned int vertexCount;
-	float* vertexData;
+	unsigned char* vertexData;
+	VertexSpec vertexSpec;
 	unsigned int vertexStride;
 	GLuint vertexBuffer;
+	// Set for meshes read from the cache, the vertex and index data then point into it
+	MappedFile* cacheFile;
+
+	static bool keepCPUData;
+	static bool packVertices;
+	static bool buildMeshlets;
+	static uint64_t streamingThreshold;
+	static fs::path cacheDirectory;
+
+	void TrackMemory();
+	void CreateVertexArrays();
+
+	static ImportPlan PlanImport(const aiScene* scene, const fs::path& modelPath);
+	static void ConvertChunk(const aiScene* scene, ImportPlan& plan, int chunkIndex, float* vertexData, unsigned int* indexData);
+	static Mesh* FinishImport(ImportPlan& plan, unsigned char* vertexData);
+	// Adds the simplified levels of detail, reorders the converted triangles for the vertex cache and overdraw, then the vertices for fetch locality
+	static void OptimizeImport(ImportPlan& plan, float* vertexData);
+
+	static Mesh* FromScene(const aiScene* scene, ImportPlan& plan);
+	// Converts chunk by chunk into GL buffers through a staging ring, freeing the meshes of the scene as it goes
+	static Mesh* StreamScene(aiScene* scene, ImportPlan& plan);
+	static std::vector<MaterialTextures> ReadMaterialTextures(const aiScene* scene);
+	static std::vector<Material*> BuildMaterials(const std::vector<MaterialTextures>& materialTextures, const fs::path& modelPath);
+
+	// Reads the cached conversion when there is one, otherwise imports through Assimp and writes the cache
+	static Mesh* ImportCached(const fs::path& modelPath, bool loadMaterials, std::vector<MaterialTextures>& materialTextures, bool allowStreaming);
+	static Mesh* ReadCache(const fs::path& cachePath, uint64_t key, std::vector<MaterialTextures>& materialTextures);
+	bool WriteCache(const fs::path& cachePath, uint64_t key, const std::vector<MaterialTextures>& materialTextures, const std::vector<fs::path>& dependencies) const;
+	// Imported and cached meshes use the material indices of the scene, without materials the used ones are packed together
+	void RemapMaterials(bool loadMaterials);
 public:
-	Mesh() = default;
+	Mesh();
 	virtual ~Mesh();
 
 	unsigned int GetMaterialsCount() const;
-	std::vector<Material*> GetDefaultMaterials() const;
+	const std::vector<Material*>& GetDefaultMaterials() const;
 
 	unsigned int GetSubMeshCount() const;
-	std::vector<SubMesh> GetSubMeshes() const;
+	std::span<const SubMesh> GetSubMeshes() const;
 
 	const SubMesh& SubMeshAt(unsigned int index) const;
 	const SubMesh& operator[](unsigned int index) const;
 
 	// Mesh* Separate(std::string partName);
 
+	// Uploads the converted geometry to the GPU, does nothing if the mesh was uploaded already
+	void Upload();
+	bool IsUploaded() const;
+
+	// Frees the CPU copies of the vertex and index data, Upload does this itself unless SetKeepCPUData is on
+	void ReleaseCPUData();
+	bool HasCPUData() const;
+
+	// Off by default, turn on before loading meshes whose geometry is read back on the CPU
+	static void SetKeepCPUData(bool keep);
+	static bool GetKeepCPUData();
+
+	// On by default, imported vertices are stored in the narrowest formats that keep them precise enough
+	static void SetPackVertices(bool pack);
+	static bool GetPackVertices();
+
+	// Off by default, splits the triangles of meshes loaded afterwards into meshlets the renderer culls on the GPU.
+	// Streamed meshes are never split.
+	static void SetBuildMeshlets(bool build);
+	static bool GetBuildMeshlets();
+
+	// Meshes above this many bytes of converted geometry are streamed to the GPU in chunks when loaded, zero turns it off
+	static void SetStreamingThreshold(uint64_t bytes);
+	static uint64_t GetStreamingThreshold();
+
+	// Converted meshes are cached here keyed by the source file contents, an empty path turns the cache off
+	static void SetCacheDirectory(const fs::path& directory);
+	static const fs::path& GetCacheDirectory();
+
+	// CPU side vertex data in the formats of the vertex spec, null once the mesh was uploaded unless CPU data is kept
+	const void* GetVertexData() const;
+	unsigned int GetVertexCount() const;
+	// In bytes
+	unsigned int GetVertexStride() const;
+	const VertexSpec& GetVertexSpec() const;
+
 	static Mesh* Load(fs::path modelPath, bool loadMaterials = false);
+	// Converts the model without touching the GPU, call Upload before rendering it
+	static Mesh* Import(const fs::path& modelPath);
 	// static Mesh* Create(unsigned int vertexCount, float* vertexData, unsigned int triangleCount, unsigned int* indexData, const VertexSpec& meshSpec);
 };
\ No newline at end of file
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <vector>
+
+// Reorders the index and vertex data of triangle lists for the GPU, the rendered geometry stays the same.
+// Follows Sander, Nehab and Barczak, "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw".
+// Simplify is the exception, it builds coarser versions of a mesh for levels of detail.
+class MeshOptimizer {
+public:
+	// Post transform cache size the orderings aim for, at or below what current GPUs have
+	static constexpr unsigned int CacheSize = 16;
+	static constexpr unsigned int MeshletMaxVertices = 64;
+	static constexpr unsigned int MeshletMaxTriangles = 124;
+
+	// A run of triangles small enough to be culled as a whole, laid out like the std430 struct the culling shader reads
+	struct Meshlet {
+		float center[3];
+		float radius;
+		// Every triangle faces away from views whose direction to the center is within the cone, a cutoff of 1 never culls
+		float coneAxis[3];
+		float coneCutoff;
+		unsigned int firstIndex;
+		unsigned int indexCount;
+		unsigned int padding[2];
+	};
+
+	MeshOptimizer() = delete;
+
+	// Reorders triangles so they reuse recently transformed vertices (Tipsify)
+	static void OptimizeVertexCache(unsigned int* indices, size_t indexCount);
+	// Splits the triangles into clusters and draws the outward facing ones first, so they occlude the rest.
+	// Clusters are only cut where the cache miss rate stays within threshold of the input, run it after OptimizeVertexCache.
+	static void OptimizeOverdraw(unsigned int* indices, size_t indexCount, const float* positions, unsigned int positionStride, float threshold = 1.05f);
+	// Renumbers vertices in the order the index lists first use them, vertices no list uses end up last
+	static void OptimizeVertexFetch(float* vertexData, unsigned int vertexCount, unsigned int vertexStride, std::span<const std::span<unsigned int>> indexLists);
+
+	// Collapses edges in order of quadric error (Garland and Heckbert) until targetIndexCount is reached or the next collapse would move
+	// the surface further than targetError. Borders and vertices split for attribute seams stay in place.
+	// Writes the remaining triangles to destination, which may be indices, and returns their index count.
+	static size_t Simplify(unsigned int* destination, const unsigned int* indices, size_t indexCount, const float* positions, unsigned int positionStride, size_t targetIndexCount, float targetError, float* resultError = nullptr);
+
+	// Cuts the triangles into meshlets in the order they come, run it after OptimizeVertexCache so each run stays compact
+	static std::vector<Meshlet> BuildMeshlets(const unsigned int* indices, size_t indexCount, const float* positions, unsigned int positionStride,
+		unsigned int maxVertices = MeshletMaxVertices, unsigned int maxTriangles = MeshletMaxTriangles);
+
+	// Average cache misses per triangle with a FIFO cache, 0.5 at best and 3 at worst
+	static float GetACMR(const unsigned int* indices, size_t indexCount, unsigned int cacheSize = CacheSize);
+};
\ No newline at end of file
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <Mesh.h>
+
+class ResourceDatabase;
+class ComputeShaderProgram;
+
+// Culls the meshlets of a submesh against the view frustum and their normal cones on the GPU,
+// the ones left are drawn with a single indirect draw. There is no depth pyramid to test occlusion against.
+class MeshletCuller {
+private:
+	static constexpr unsigned int GroupSize = 64;
+	// Every cull writes a draw count followed by up to one DrawElementsIndirectCommand per meshlet
+	static constexpr uint64_t CountBytes = 16;
+	static constexpr uint64_t CommandBytes = 5 * sizeof(unsigned int);
+	static constexpr uint64_t InitialBytes = 64 * 1024;
+
+	ComputeShaderProgram* cullShader;
+
+	struct {
+		int modelViewProjection;
+		int viewOrigin;
+		int meshletCount;
+		int drawOffset;
+		int baseVertex;
+		int coneCulling;
+	} uniforms;
+
+	GLuint drawBuffer;
+	uint64_t capacity;
+	uint64_t used;
+public:
+	MeshletCuller(ResourceDatabase* resources);
+	~MeshletCuller();
+
+	// Orphans the draws of the previous frame
+	void BeginFrame();
+
+	// Returns where the draws were written, pass it to Draw once the material is bound
+	uint64_t Cull(const Mesh::SubMesh* mesh, const glm::mat4& model, const glm::mat4& view, const glm::mat4& projection);
+	// Expects the vertex array of mesh to be bound
+	void Draw(const Mesh::SubMesh* mesh, uint64_t drawOffset) const;
+};
\ No newline at end of file
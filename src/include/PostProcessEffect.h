@@ -1,8 +1,12 @@
 #pragma once
 
+#include <string>
+#include <vector>
+
 #include <GameObject.h>
 
 class Texture2D;
+class ComputeDispatchData;
 
 struct PostProcessParams {
 	Texture2D* inputTexture;
@@ -10,7 +14,48 @@ struct PostProcessParams {
 	Texture2D* depthTexture;
 };
 
+// Per-pixel body of an effect that can be fused with its neighbours into one compute kernel.
+// The body reads and writes `vec4 color` at `ivec2 pixelCoord` / `vec2 uv`; every `$` is replaced
+// with a prefix unique to the effect within the fused kernel.
+struct PostProcessSnippet {
+	std::string declarations;
+	std::string body;
+	// Declared uniforms without the prefix, SetFusedValues gets their prefixed names in this order
+	std::vector<std::string> uniforms;
+};
+
 class PostProcessEffect : public GameObject {
 public:
 	virtual void OnPostProcess(const PostProcessParams* params) = 0;
+
+	virtual bool RunsInPlace() const {
+		return false;
+	}
+
+	// Identifies the snippet GetFusedSnippet writes, fused kernels are cached by the types and variants of their effects.
+	// Effects whose snippet depends on their settings return a different variant for each, negative when they can't be fused.
+	virtual int GetFusedVariant() const {
+		return -1;
+	}
+
+	virtual bool GetFusedSnippet(PostProcessSnippet* snippet) const {
+		return false;
+	}
+
+	virtual void OnPreFusedPass(const PostProcessParams* params) { }
+
+	// Effects whose pre-pass reads the input texture can only open a fused run,
+	// further in the input of the run is not the output of the effect before them
+	virtual bool PreFusedPassReadsInput() const {
+		return false;
+	}
+
+	virtual void SetFusedValues(ComputeDispatchData* data, const std::vector<std::string>& uniforms) { }
+
+	// Tweakable parameters flattened to floats, frame captures store and restore them in this order
+	virtual std::vector<float> GetSettings() const {
+		return {};
+	}
+
+	virtual void SetSettings(const std::vector<float>& settings) { }
 };
\ No newline at end of file
@@ -1,16 +1,79 @@
 #pragma once
 
+#include <string>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <typeinfo>
+
 #include <glad/glad.h>
 #include <GameObjectSystem.h>
 #include <PostProcessEffect.h>
+#include <Texture.h>
+
+class ComputeShaderDispatch;
 
 class PostProcessingSystem : public GameObjectSystem<PostProcessEffect> {
+public:
+	static constexpr TextureParams BufferParams {
+		.channels = TextureChannels::RGBA,
+		.colorSpace = TextureColor::Linear,
+		.format = TextureFormat::Float,
+		.wrapU = TextureWrap::Clamp,
+		.wrapV = TextureWrap::Clamp,
+		.wrapW = TextureWrap::Clamp
+	};
 private:
-	GLuint postProcessColorBuffer;
+	struct FusedEffectKey {
+		const std::type_info* type;
+		int variant;
+
+		auto operator<=>(const FusedEffectKey& other) const = default;
+	};
+
+	// Everything a fused step needs per frame, built once with the kernel
+	struct FusedKernel {
+		ComputeShaderDispatch* dispatch;
+		std::string zoneName;
+		// Prefixed uniform names of each effect in the run
+		std::vector<std::vector<std::string>> uniforms;
+	};
+
+	struct ChainStep {
+		int firstEffect;
+		int effectCount;
+		bool inPlace;
+		const FusedKernel* fusedKernel;
+		const char* zoneName;
+	};
+
+	// Borrowed for the duration of Process
+	Texture2D* pingPongBuffers[2];
+
+	std::map<std::vector<FusedEffectKey>, FusedKernel> fusedKernels;
+	// Reused for lookups, so finding a cached kernel does not allocate
+	std::vector<FusedEffectKey> fusedKey;
+	// Interned names of the effects run on their own
+	std::unordered_map<const std::type_info*, const char*> effectZoneNames;
+	std::vector<PostProcessEffect*> activeEffects;
+	std::vector<ChainStep> chainSteps;
+
+	bool fuseEffects;
+
+	Texture2D* NextBuffer(const Texture2D* current) const;
+
+	const char* GetEffectZoneName(PostProcessEffect* effect);
+	void BuildChain();
+	const FusedKernel* GetFusedKernel(int firstEffect, int effectCount);
+	FusedKernel BuildFusedKernel(int firstEffect, int effectCount);
+	void RunStep(const ChainStep& step, const PostProcessParams* params);
 public:
 	PostProcessingSystem(Scene* scene);
 
-	void UpdateBufferResolution(glm::vec2 newResolution);
+	bool HasActiveEffects();
+
+	// Effects ping-pong between bufferA and bufferB, which have to match the size of source and use BufferParams
+	Texture2D* Process(Texture2D* source, Texture2D* depth, Texture2D* bufferA, Texture2D* bufferB, Texture2D* presentationTarget = nullptr);
 
-	GLuint GetPostProcessBuffer();
+	virtual void DrawImGui();
 };
\ No newline at end of file
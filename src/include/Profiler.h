@@ -0,0 +1,130 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <filesystem>
+
+#ifndef SYZYF_PROFILING
+#define SYZYF_PROFILING 1
+#endif
+
+namespace fs = std::filesystem;
+
+class Profiler {
+public:
+	struct ZoneEvent {
+		const char* name;
+		const char* detail;
+		uint64_t start;
+		uint64_t end;
+		uint32_t depth;
+	};
+
+	// Records the time between construction and destruction on the calling thread.
+	// Both strings must outlive the profiler, use string literals, typeid names or Intern().
+	class Scope {
+	private:
+		const char* name;
+		const char* detail;
+		uint64_t start;
+		const Scope* parent;
+	public:
+		Scope(const char* name, const char* detail = nullptr);
+		~Scope();
+
+		const char* GetName() const;
+		const char* GetDetail() const;
+
+		Scope(const Scope&) = delete;
+		Scope& operator=(const Scope&) = delete;
+	};
+private:
+	static constexpr int EventsPerThread = 1 << 16;
+	static constexpr int FrameHistory = 240;
+
+	// Relaxed atomics so readers can copy a slot while its owner overwrites it
+	struct EventSlot {
+		std::atomic<const char*> name;
+		std::atomic<const char*> detail;
+		std::atomic<uint64_t> start;
+		std::atomic<uint64_t> end;
+		std::atomic<uint32_t> depth;
+
+		void Store(const ZoneEvent& event);
+		ZoneEvent Load() const;
+	};
+
+	// Single producer ring, only the owning thread writes events. Readers copy without locking
+	// and drop whatever the owner may have overwritten while they were copying
+	struct ThreadBuffer {
+		uint32_t threadId;
+		std::mutex nameMutex;
+		std::string threadName;
+		std::unique_ptr<EventSlot[]> events;
+		std::atomic<uint64_t> written;
+		uint32_t depth;
+	};
+
+	struct ThreadView {
+		std::string name;
+		std::vector<ZoneEvent> events;
+	};
+
+	static std::mutex buffersMutex;
+	static std::vector<ThreadBuffer*> buffers;
+	static thread_local ThreadBuffer* localBuffer;
+	static thread_local const Scope* currentScope;
+
+	static std::atomic<bool> enabled;
+	static bool paused;
+
+	static uint64_t frameStarts[FrameHistory];
+	static uint64_t frameCount;
+
+	static std::vector<ThreadView> timelineView;
+	static uint64_t timelineStart;
+	static uint64_t timelineEnd;
+
+	static ThreadBuffer* GetThreadBuffer();
+	static void Record(const ZoneEvent& event);
+	static std::vector<ZoneEvent> CopyEvents(ThreadBuffer* buffer, uint64_t endedAfter = 0);
+public:
+	Profiler() = delete;
+
+	static uint64_t Now();
+
+	static void BeginFrame();
+
+	static void SetThreadName(const std::string& name);
+	static const char* Intern(const std::string& name);
+	static std::string DisplayName(const char* name, const char* detail);
+
+	// Innermost zone open on the calling thread, nullptr outside of zones or while disabled.
+	// Safe to call from allocation hooks, it never allocates
+	static const Scope* GetCurrentScope();
+
+	static bool IsEnabled();
+	static void SetEnabled(bool enabled);
+
+	static float GetLastFrameTime();
+
+	static bool ExportChromeTrace(const fs::path& path);
+
+	static void DrawImGui();
+};
+
+#if SYZYF_PROFILING
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_ZONE(name) Profiler::Scope PROFILE_CONCAT(profileZone, __LINE__)(name)
+#define PROFILE_ZONE_DETAIL(name, detail) Profiler::Scope PROFILE_CONCAT(profileZone, __LINE__)(name, detail)
+#define PROFILE_FUNCTION() PROFILE_ZONE(__func__)
+#else
+#define PROFILE_ZONE(name)
+#define PROFILE_ZONE_DETAIL(name, detail)
+#define PROFILE_FUNCTION()
+#endif
\ No newline at end of file
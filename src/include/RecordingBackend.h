@@ -0,0 +1,128 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+#include <GraphicsBackend.h>
+
+enum class GraphicsCommandType : uint8_t {
+	CreateBuffer = 0,
+	DeleteBuffer,
+	BufferData,
+	BufferSubData,
+	BindBufferBase,
+	UseProgram,
+	BindVertexArray,
+	BindTexture,
+	BindImageTexture,
+	SetUniform,
+	BindFramebuffer,
+	SetViewport,
+	ClearColor,
+	Clear,
+	SetEnabled,
+	SetDepthMask,
+	SetDepthFunc,
+	SetCullFace,
+	SetPatchVertices,
+	DrawElements,
+	DrawElementsIndirect,
+	DispatchCompute,
+	Barrier,
+	Count
+};
+
+struct GraphicsCommand {
+	GraphicsCommandType type;
+	// Set when the command would not have changed any state
+	bool redundant;
+	uint32_t args[4];
+	uint64_t size;
+};
+
+// Captures the command stream in memory instead of calling a driver, works without a GL context.
+// Draws record { mode, count, instanceCount, vertexArray } and the index bytes they read in size, uploads their byte count.
+class RecordingBackend : public GraphicsBackend {
+private:
+	static constexpr int TextureUnits = 32;
+
+	struct BoundTexture {
+		GLenum target;
+		GLuint texture;
+	};
+
+	struct BoundImage {
+		GLuint texture;
+		int level;
+	};
+
+	std::vector<GraphicsCommand> commands;
+	uint64_t counts[(int) GraphicsCommandType::Count];
+	uint64_t redundantCount;
+	uint64_t uploadedBytes;
+	bool keepCommands;
+
+	GLuint nextHandle;
+
+	GLuint program;
+	GLuint vertexArray;
+	GLuint framebuffer;
+	BoundTexture textures[TextureUnits];
+	BoundImage images[TextureUnits];
+	std::unordered_map<uint64_t, GLuint> bufferBases;
+	std::unordered_map<GLenum, bool> capabilities;
+	std::unordered_map<uint64_t, size_t> uniformValues;
+	int depthMask;
+	GLenum depthFunc;
+	GLenum cullFace;
+	int patchVertices;
+
+	void Record(GraphicsCommandType type, bool redundant, uint32_t a = 0, uint32_t b = 0, uint32_t c = 0, uint32_t d = 0, uint64_t size = 0);
+public:
+	RecordingBackend(bool keepCommands = true);
+
+	// Drops recorded commands, counters and the tracked state
+	void Reset();
+
+	const std::vector<GraphicsCommand>& GetCommands() const;
+	uint64_t GetCount(GraphicsCommandType type) const;
+	uint64_t GetRedundantCount() const;
+	uint64_t GetUploadedBytes() const;
+
+	// One command per line, meant for dumps and comparing streams in tests
+	std::string ToString() const;
+
+	static const char* GetName(GraphicsCommandType type);
+
+	virtual GLuint CreateBuffer();
+	virtual void DeleteBuffer(GLuint buffer);
+	virtual void BufferData(GLenum target, GLuint buffer, size_t size, const void* data, GLenum usage);
+	virtual void BufferSubData(GLenum target, GLuint buffer, size_t offset, size_t size, const void* data);
+	virtual void BindBufferBase(GLenum target, unsigned int index, GLuint buffer);
+
+	virtual void UseProgram(GLuint program);
+	virtual void BindVertexArray(GLuint vertexArray);
+	virtual void BindTexture(unsigned int unit, GLenum target, GLuint texture);
+	virtual void BindImageTexture(unsigned int unit, GLuint texture, int level, bool layered, GLenum access, GLenum format);
+
+	// There is no program to introspect, so every uniform looks absent
+	virtual int GetUniformLocation(GLuint program, const char* name);
+	virtual void SetUniform(int location, UniformSpec::UniformType type, const void* value);
+
+	virtual void BindFramebuffer(GLuint framebuffer);
+	virtual void SetViewport(int x, int y, int width, int height);
+	virtual void ClearColor(float r, float g, float b, float a);
+	virtual void Clear(GLbitfield mask);
+
+	virtual void SetEnabled(GLenum capability, bool enabled);
+	virtual void SetDepthMask(bool enabled);
+	virtual void SetDepthFunc(GLenum func);
+	virtual void SetCullFace(GLenum face);
+	virtual void SetPatchVertices(int vertices);
+
+	virtual void DrawElements(GLenum mode, unsigned int count, GLenum indexType, uint64_t indexOffset, int baseVertex, unsigned int instanceCount = 0);
+	virtual void DrawElementsIndirect(GLenum mode, GLenum indexType, GLuint commandBuffer, uint64_t commandOffset, uint64_t countOffset, unsigned int maxDrawCount);
+	virtual void DispatchCompute(unsigned int groupsX, unsigned int groupsY, unsigned int groupsZ);
+	virtual void Barrier(GLbitfield barriers);
+};
\ No newline at end of file
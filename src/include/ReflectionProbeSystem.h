@@ -13,6 +13,9 @@ private:
 	Framebuffer* reflectionProbeFramebuffer;
 
 	Texture2D* brdfConvolutionMap;
+
+	void RenderProbe(ReflectionProbe* probe);
+	void ReplaceMaps(ReflectionProbe* probe, Cubemap* irradianceMap, Cubemap* prefilterMap);
 public:
 	ReflectionProbeSystem(Scene* scene);
 
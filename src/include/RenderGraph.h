@@ -0,0 +1,152 @@
+#pragma once
+
+#include <vector>
+#include <new>
+#include <type_traits>
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <Texture.h>
+#include <FrameAllocator.h>
+
+class GPUProfiler;
+
+enum class RenderResourceUsage {
+	RenderTarget = 0,
+	Sampled,
+	Image,
+	Storage,
+	Uniform,
+	Copy,
+	Upload
+};
+
+class RenderGraph {
+public:
+	typedef int ResourceHandle;
+
+	static constexpr ResourceHandle InvalidResource = -1;
+
+	class PassBuilder {
+		friend class RenderGraph;
+	private:
+		RenderGraph* graph;
+		int passIndex;
+
+		PassBuilder(RenderGraph* graph, int passIndex);
+	public:
+		PassBuilder& Read(ResourceHandle resource, RenderResourceUsage usage);
+		PassBuilder& Write(ResourceHandle resource, RenderResourceUsage usage);
+		PassBuilder& SideEffect();
+	};
+private:
+	struct GraphResource {
+		const char* name;
+		Texture* texture;
+		GLuint buffer;
+		bool transient;
+		bool output;
+		glm::uvec2 size;
+		TextureParams params;
+		int firstUse;
+		int lastUse;
+		bool pendingShaderWrite;
+	};
+
+	struct PassAccess {
+		ResourceHandle resource;
+		RenderResourceUsage usage;
+		bool write;
+	};
+
+	struct GraphPass {
+		const char* name;
+		std::vector<PassAccess> accesses;
+		// Copy of the callback in the frame arena
+		void* closure;
+		void (*execute)(void* closure, RenderGraph* graph);
+		bool sideEffect;
+		bool culled;
+		GLbitfield barriers;
+	};
+
+	struct PooledTexture {
+		Texture2D* texture;
+		TextureParams params;
+		bool inUse;
+		int unusedFrames;
+	};
+
+	struct PassStats {
+		const char* name;
+		bool culled;
+		GLbitfield barriers;
+	};
+
+	// Slots are kept across frames so their access lists keep their capacity, only the first counts are in use
+	std::vector<GraphResource> resources;
+	std::vector<GraphPass> passes;
+	int resourceCount;
+	int passCount;
+	std::vector<PooledTexture> texturePool;
+	std::vector<Texture2D*> scratchTextures;
+
+	std::vector<PassStats> lastFrameStats;
+	int lastFrameTransientCount;
+
+	bool executing;
+
+	GPUProfiler* profiler;
+
+	static bool IsShaderWrite(RenderResourceUsage usage);
+	static GLbitfield BarrierFor(RenderResourceUsage usage, bool isBuffer);
+	static bool ParamsMatch(const TextureParams& a, const TextureParams& b);
+
+	Texture2D* AcquireTexture(const glm::uvec2& size, const TextureParams& params);
+	void ReleaseTexture(Texture2D* texture);
+	void TrimPool();
+
+	ResourceHandle AddResource(const char* name, Texture* texture, GLuint buffer, bool transient, const glm::uvec2& size, const TextureParams& params);
+	PassBuilder AddPass(const char* name, void* closure, void (*execute)(void* closure, RenderGraph* graph));
+
+	void Compile();
+	void Reset();
+public:
+	RenderGraph(GPUProfiler* profiler = nullptr);
+	~RenderGraph();
+
+	// Names are not copied, use string literals or Profiler::Intern
+	ResourceHandle ImportTexture(const char* name, Texture* texture);
+	ResourceHandle ImportBuffer(const char* name, GLuint buffer);
+	ResourceHandle CreateTexture(const char* name, const glm::uvec2& size, const TextureParams& params);
+	// Pool texture for work inside a single pass, it goes back to the pool when the pass returns.
+	// Textures taken outside of Execute go back with the first pass of the next one.
+	Texture2D* AcquireScratchTexture(const glm::uvec2& size, const TextureParams& params);
+
+	void MarkOutput(ResourceHandle resource);
+
+	// The callback is copied into the frame arena, which never runs destructors
+	template<typename T_Execute>
+	PassBuilder AddPass(const char* name, const T_Execute& execute);
+
+	Texture* GetTexture(ResourceHandle resource) const;
+	GLuint GetBuffer(ResourceHandle resource) const;
+
+	bool IsExecuting() const;
+
+	void Execute();
+
+	void DrawImGui();
+};
+
+template<typename T_Execute>
+RenderGraph::PassBuilder RenderGraph::AddPass(const char* name, const T_Execute& execute) {
+	static_assert(std::is_trivially_destructible_v<T_Execute>, "Render pass callbacks can only capture trivially destructible values");
+
+	void* closure = new (FrameArena::Local().Allocate(sizeof(T_Execute), alignof(T_Execute))) T_Execute(execute);
+
+	return AddPass(name, closure, [](void* closure, RenderGraph* graph) {
+		(*static_cast<T_Execute*>(closure))(graph);
+	});
+}
\ No newline at end of file
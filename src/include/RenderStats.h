@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+enum class RenderCounter {
+	DrawCalls = 0,
+	InstancedDrawCalls,
+	Triangles,
+	FrustumCulled,
+	LayerCulled,
+	MaterialBinds,
+	ProgramBinds,
+	VertexArrayBinds,
+	TextureBinds,
+	UniformBytesUploaded,
+	ShadowViews,
+	ProbeFaces,
+	PostProcessSteps,
+	ComputeDispatches,
+	MeshletDraws,
+	Count
+};
+
+class RenderStats {
+public:
+	struct Snapshot {
+		uint64_t frame;
+		uint64_t counters[(int) RenderCounter::Count];
+
+		uint64_t Get(RenderCounter counter) const;
+	};
+private:
+	static uint64_t current[(int) RenderCounter::Count];
+	static Snapshot lastFrame;
+	static uint64_t frameIndex;
+public:
+	RenderStats() = delete;
+
+	static inline void Add(RenderCounter counter, uint64_t amount = 1) {
+		current[(int) counter] += amount;
+	}
+
+	// Once per engine frame, every scene rendered in between counts towards the same frame
+	static void BeginFrame();
+	static void EndFrame();
+
+	static uint64_t Get(RenderCounter counter);
+	static const Snapshot& GetLastFrame();
+
+	static const char* GetName(RenderCounter counter);
+	static const char* GetKey(RenderCounter counter);
+
+	static std::string ToJSON();
+	static bool Dump(const fs::path& path);
+
+	static void DrawImGui();
+};
\ No newline at end of file
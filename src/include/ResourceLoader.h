@@ -0,0 +1,57 @@
+#pragma once
+
+#include <functional>
+#include <deque>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+// Worker threads for file reads and decoding, plus the queue of GL work they hand back to the context thread
+class ResourceLoader {
+private:
+	struct Task {
+		std::function<void()> run;
+		// Runs instead when Stop drops the task, so nothing is left waiting on it
+		std::function<void()> cancel;
+	};
+
+	static std::mutex jobsMutex;
+	static std::condition_variable jobsAvailable;
+	static std::deque<Task> jobs;
+	static std::vector<std::thread> workers;
+	static bool stopping;
+
+	static std::mutex uploadsMutex;
+	static std::condition_variable uploadsAvailable;
+	static std::deque<Task> uploads;
+
+	static std::thread::id contextThread;
+
+	static void WorkerMain(int index);
+public:
+	ResourceLoader() = delete;
+
+	// Spawns the workers, zero picks one less than the hardware thread count.
+	// The calling thread is the one owning the GL context, uploads only run there.
+	static void Start(int workerCount = 0);
+	// Jobs and uploads still queued are not run, their cancel callbacks are instead
+	static void Stop();
+	static bool IsRunning();
+
+	static void Enqueue(std::function<void()> job, std::function<void()> cancel = nullptr);
+	// Runs body for every index in [0, count) on the workers and the calling thread, returns once all are done.
+	// The caller keeps taking indices itself, so this is safe to call from inside a job.
+	static void ParallelFor(int count, const std::function<void(int)>& body);
+	static void EnqueueUpload(std::function<void()> upload, std::function<void()> cancel = nullptr);
+
+	// Runs queued uploads until budgetSeconds is spent, at least one per call, zero runs all of them
+	static int ProcessUploads(double budgetSeconds = 0.0);
+	// Keeps running uploads on the context thread until done returns true
+	static void ProcessUploadsUntil(const std::function<bool()>& done);
+
+	static bool IsContextThread();
+
+	static int GetPendingJobs();
+	static int GetPendingUploads();
+};
\ No newline at end of file
@@ -1,12 +1,25 @@
 #pragma once
 
 #include <filesystem>
-#include <map>
+#include <unordered_map>
+#include <deque>
+#include <vector>
+#include <string>
+#include <utility>
 #include <concepts>
 #include <typeinfo>
+#include <type_traits>
+#include <cstdint>
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
+#include <memory>
 
 #include <spdlog/spdlog.h>
 
+#include <MemoryTracker.h>
+#include <ResourceLoader.h>
+
 namespace fs = std::filesystem;
 
 class Resource {
@@ -19,23 +32,192 @@ concept Loadable = requires(fs::path p, T_Params... loadParams) {
 	{ T::Load(p, loadParams...) } -> std::convertible_to<T*>;
 } && std::derived_from<T, Resource>;
 
+// Split loaders, Import only touches the CPU and may run on any thread, Upload runs on the GL context thread
+template<class T, typename... T_Params>
+concept AsyncLoadable = requires(T* resource, fs::path p, T_Params... loadParams) {
+	{ T::Import(p, loadParams...) } -> std::convertible_to<T*>;
+	resource->Upload();
+} && std::derived_from<T, Resource>;
+
+using ResourceId = uint32_t;
+
+// Process wide table of normalized resource paths, an id stays valid for the lifetime of the program
+class ResourcePaths {
+private:
+	static std::shared_mutex mutex;
+	static std::unordered_map<std::string, ResourceId> ids;
+	static std::deque<fs::path> paths;
+public:
+	ResourcePaths() = delete;
+
+	static ResourceId Intern(const fs::path& path);
+	static const fs::path& GetPath(ResourceId id);
+};
+
+class ResourceDatabase;
+
+// Counted reference to a resource, the database may evict it once no handle refers to it
+template<class T_Resource>
+class ResourceHandle {
+	friend class ResourceDatabase;
+private:
+	ResourceDatabase* database;
+	ResourceId id;
+	T_Resource* resource;
+
+	ResourceHandle(ResourceDatabase* database, ResourceId id, T_Resource* resource);
+public:
+	ResourceHandle();
+	ResourceHandle(const ResourceHandle& other);
+	ResourceHandle(ResourceHandle&& other);
+	~ResourceHandle();
+
+	ResourceHandle& operator=(ResourceHandle other);
+
+	T_Resource* Get() const;
+	T_Resource* operator->() const;
+	explicit operator bool() const;
+
+	ResourceId GetId() const;
+};
+
+enum class LoadStatus {
+	Loading,
+	Ready,
+	Failed
+};
+
+struct AsyncLoad {
+	std::atomic<LoadStatus> status = LoadStatus::Loading;
+	// Set before the status turns Ready
+	const Resource* resource = nullptr;
+};
+
+// Future-like result of GetAsync, hands out the type's placeholder until the load finishes
+template<class T_Resource>
+class AsyncResource {
+private:
+	std::shared_ptr<AsyncLoad> load;
+	T_Resource* placeholder;
+public:
+	AsyncResource();
+	AsyncResource(std::shared_ptr<AsyncLoad> load, T_Resource* placeholder);
+
+	LoadStatus GetStatus() const;
+	bool IsReady() const;
+
+	// The loaded resource, or the placeholder while loading and after a failed load
+	T_Resource* Get() const;
+	// Blocks until the load finished, only valid on the GL context thread since it runs the uploads itself
+	T_Resource* Wait() const;
+
+	const std::shared_ptr<AsyncLoad>& GetLoad() const;
+};
+
+// Group of asynchronous loads that are all in flight at the same time, for loading screens and preloads
+class ResourceBatch {
+private:
+	std::vector<std::shared_ptr<AsyncLoad>> loads;
+public:
+	template<class T_Resource>
+	AsyncResource<T_Resource> Add(const AsyncResource<T_Resource>& resource);
+
+	int GetCount() const;
+	int GetCompleted() const;
+	float GetProgress() const;
+	bool IsDone() const;
+	bool HasFailed() const;
+
+	void Wait() const;
+};
+
 class ResourceDatabase {
+	template<class T_Resource>
+	friend class ResourceHandle;
 private:
 	struct ResourceInfo {
 		const std::type_info* type;
 		const Resource* resource;
+		// Key into the cache shared by all databases, zero for resources registered by hand
+		uint64_t contentKey;
+		// Live handles, resources handed out as plain pointers are pinned and never evicted
+		std::atomic<uint32_t> references;
+		std::atomic<bool> pinned;
+		std::atomic<uint64_t> lastUsed;
 	};
 
 	struct GenericInfo {
 		const std::type_info* type;
 		const void* resource;
+		void (*destroy)(const void*);
 	};
 
-	std::map<const fs::path, ResourceInfo> loadedResources;
-	std::map<const fs::path, ResourceInfo> loadedGenericAssets;
+	struct SharedResource {
+		const std::type_info* type;
+		const Resource* resource;
+		uint32_t users;
+	};
+
+	static std::mutex sharedMutex;
+	static std::unordered_map<uint64_t, SharedResource> sharedResources;
+	static std::unordered_map<const std::type_info*, const Resource*> placeholders;
+
+	mutable std::shared_mutex mutex;
+	std::unordered_map<ResourceId, ResourceInfo> loadedResources;
+	std::unordered_map<ResourceId, GenericInfo> loadedGenericAssets;
+	std::unordered_map<ResourceId, std::shared_ptr<AsyncLoad>> pendingLoads;
+
+	std::atomic<uint64_t> useCounter;
+	uint64_t budget;
+
+	// The file a loader is running for on this thread, caches the loader keys with ContentKey reuse its hash
+	struct LoadingFile {
+		const fs::path* path;
+		const std::type_info* type;
+		uint64_t hash;
+	};
+
+	static thread_local LoadingFile loadingFile;
+
+	static uint64_t HashContent(const fs::path& path, const std::type_info& type);
+	static uint64_t HashBytes(uint64_t hash, const void* data, size_t size);
+
+	template<typename... T_Params>
+	static uint64_t CombineParams(uint64_t hash, const T_Params&... loadParams);
+
+	static const Resource* AcquireShared(uint64_t contentKey, const std::type_info& type);
+	static const Resource* ShareLoaded(uint64_t contentKey, const std::type_info& type, const Resource* resource);
+	// Returns the resource when this was its last user and it should be deleted
+	static const Resource* ReleaseShared(uint64_t contentKey, const Resource* resource);
+
+	const Resource* Find(ResourceId id, const std::type_info& type, bool pin);
+	const Resource* Insert(ResourceId id, const std::type_info& type, const Resource* resource, uint64_t contentKey, bool pin);
+
+	template<class T_Resource, typename... T_Params>
+	T_Resource* GetOrLoad(ResourceId id, const fs::path& resourcePath, bool pin, T_Params... loadParams);
+
+	void CompleteLoad(ResourceId id, const std::shared_ptr<AsyncLoad>& load, const Resource* resource);
+
+	void AddReference(ResourceId id);
+	void Release(ResourceId id);
+
+	const Resource* ReleaseEntry(const ResourceInfo& info);
+	void EvictLocked(std::vector<const Resource*>& victims);
 public:
 	static ResourceDatabase* const Global;
 
+	ResourceDatabase();
+	~ResourceDatabase();
+
+	ResourceDatabase(const ResourceDatabase&) = delete;
+	ResourceDatabase& operator=(const ResourceDatabase&) = delete;
+
+	// Hash of the file contents, its folder and the load parameters, zero when the parameters cannot be hashed bytewise.
+	// Also keys on-disk caches of converted resources.
+	template<typename... T_Params>
+	static uint64_t ContentKey(const fs::path& path, const std::type_info& type, const T_Params&... loadParams);
+
+	// Plain pointers pin the resource until it is freed or the database purged
 	template<class T_Resource, typename... T_Params>
 		requires(Loadable<T_Resource, T_Params...>)
 	T_Resource* Get(const fs::path& resourcePath, T_Params... loadParams);
@@ -48,6 +230,27 @@ public:
 		requires(!std::derived_from<T_Resource, Resource>)
 	T_Resource* Get(const fs::path& resourcePath);
 
+	// Like Get, but the resource becomes evictable once the last handle is gone
+	template<class T_Resource, typename... T_Params>
+		requires(Loadable<T_Resource, T_Params...>)
+	ResourceHandle<T_Resource> Acquire(const fs::path& resourcePath, T_Params... loadParams);
+
+	// Imports on a loader thread and uploads on the context thread during a later frame, pins like Get
+	template<class T_Resource, typename... T_Params>
+		requires(AsyncLoadable<T_Resource, T_Params...>)
+	AsyncResource<T_Resource> GetAsync(const fs::path& resourcePath, T_Params... loadParams);
+
+	// Stand-in returned by AsyncResource::Get while a resource of this type is loading
+	template<class T_Resource>
+		requires(std::derived_from<T_Resource, Resource>)
+	static void SetPlaceholder(T_Resource* placeholder);
+
+	template<class T_Resource>
+		requires(std::derived_from<T_Resource, Resource>)
+	static T_Resource* GetPlaceholder();
+
+	int GetPendingLoads() const;
+
 	template <typename T_Resource>
 		requires(std::derived_from<T_Resource, Resource>)
 	void Register(T_Resource* resource, const fs::path& path);
@@ -64,81 +267,398 @@ public:
 		requires(!std::derived_from<T_Resource, Resource>)
 	bool IsLoaded(const fs::path& path) const;
 
+	// Every loaded resource of exactly this type, paired with the path it was registered under
+	template <typename T_Resource>
+		requires(std::derived_from<T_Resource, Resource>)
+	std::vector<std::pair<fs::path, T_Resource*>> GetLoaded() const;
+
+	// Memory held by the resources of this database, as reported to the MemoryTracker
+	uint64_t GetResidentBytes() const;
+
+	uint64_t GetBudget() const;
+	// Evicts the least recently used unreferenced resources while the database is above budget, zero disables eviction
+	void SetBudget(uint64_t bytes);
+
 	void Free(const fs::path& path);
 
 	void Purge();
 };
 
+template<typename... T_Params>
+uint64_t ResourceDatabase::ContentKey(const fs::path& path, const std::type_info& type, const T_Params&... loadParams) {
+	return CombineParams(HashContent(path, type), loadParams...);
+}
+
+template<typename... T_Params>
+uint64_t ResourceDatabase::CombineParams(uint64_t hash, const T_Params&... loadParams) {
+	uint64_t key = hash;
+	bool shareable = true;
+
+	([&] {
+		if constexpr (std::has_unique_object_representations_v<T_Params>) {
+			key = HashBytes(key, &loadParams, sizeof(T_Params));
+		}
+		else {
+			shareable = false;
+		}
+	}(), ...);
+
+	if (!shareable) {
+		return 0;
+	}
+
+	return key ? key : 1;
+}
+
 template<class T_Resource, typename... T_Params>
-	requires(Loadable<T_Resource, T_Params...>)
-T_Resource* ResourceDatabase::Get(const fs::path& resourcePath, T_Params... loadParams) {
-	if (IsLoaded<T_Resource>(resourcePath)) {
-		return (T_Resource*) this->loadedResources.at(resourcePath).resource;
+T_Resource* ResourceDatabase::GetOrLoad(ResourceId id, const fs::path& resourcePath, bool pin, T_Params... loadParams) {
+	if (const Resource* found = Find(id, typeid(T_Resource), pin)) {
+		return (T_Resource*) found;
 	}
 
-	T_Resource* res = T_Resource::Load(resourcePath, loadParams...);
+	// Loading happens outside the lock, loaders fetch their own dependencies from the databases
+	uint64_t fileHash = HashContent(resourcePath, typeid(T_Resource));
+	uint64_t contentKey = CombineParams(fileHash, loadParams...);
+	const Resource* res = AcquireShared(contentKey, typeid(T_Resource));
+
+	if (!res) {
+		LoadingFile outerFile = loadingFile;
+		loadingFile = { &resourcePath, &typeid(T_Resource), fileHash };
 
-	if (res) {
-		Register(res, resourcePath);
+		T_Resource* loaded = T_Resource::Load(resourcePath, loadParams...);
+
+		loadingFile = outerFile;
+
+		if (!loaded) {
+			return nullptr;
+		}
+
+		res = ShareLoaded(contentKey, typeid(T_Resource), loaded);
 	}
 
-	return res;
+	return (T_Resource*) Insert(id, typeid(T_Resource), res, contentKey, pin);
+}
+
+template<class T_Resource, typename... T_Params>
+	requires(Loadable<T_Resource, T_Params...>)
+T_Resource* ResourceDatabase::Get(const fs::path& resourcePath, T_Params... loadParams) {
+	return GetOrLoad<T_Resource>(ResourcePaths::Intern(resourcePath), resourcePath, true, loadParams...);
 }
 
 template<class T_Resource>
 	requires(std::derived_from<T_Resource, Resource> && !Loadable<T_Resource>)
 T_Resource* ResourceDatabase::Get(const fs::path& resourcePath) {
-	if (IsLoaded<T_Resource>(resourcePath)) {
-		return (T_Resource*) this->loadedResources.at(resourcePath).resource;
-	}
-
-	return nullptr;
+	return (T_Resource*) Find(ResourcePaths::Intern(resourcePath), typeid(T_Resource), true);
 }
 
 template<class T_Resource>
 	requires(!std::derived_from<T_Resource, Resource>)
 T_Resource* ResourceDatabase::Get(const fs::path& resourcePath) {
-	if (IsLoaded<T_Resource>(resourcePath)) {
-		return (T_Resource*) this->loadedGenericAssets.at(resourcePath).resource;
+	std::shared_lock lock(this->mutex);
+
+	auto it = this->loadedGenericAssets.find(ResourcePaths::Intern(resourcePath));
+
+	if (it == this->loadedGenericAssets.end() || it->second.type != &typeid(T_Resource)) {
+		return nullptr;
+	}
+
+	return (T_Resource*) it->second.resource;
+}
+
+template<class T_Resource, typename... T_Params>
+	requires(Loadable<T_Resource, T_Params...>)
+ResourceHandle<T_Resource> ResourceDatabase::Acquire(const fs::path& resourcePath, T_Params... loadParams) {
+	ResourceId id = ResourcePaths::Intern(resourcePath);
+	T_Resource* res = GetOrLoad<T_Resource>(id, resourcePath, false, loadParams...);
+
+	if (!res) {
+		return ResourceHandle<T_Resource>();
+	}
+
+	return ResourceHandle<T_Resource>(this, id, res);
+}
+
+template<class T_Resource, typename... T_Params>
+	requires(AsyncLoadable<T_Resource, T_Params...>)
+AsyncResource<T_Resource> ResourceDatabase::GetAsync(const fs::path& resourcePath, T_Params... loadParams) {
+	ResourceId id = ResourcePaths::Intern(resourcePath);
+	T_Resource* placeholder = GetPlaceholder<T_Resource>();
+
+	std::shared_ptr<AsyncLoad> load;
+
+	if (const Resource* found = Find(id, typeid(T_Resource), true)) {
+		load = std::make_shared<AsyncLoad>();
+		load->resource = found;
+		load->status = LoadStatus::Ready;
+
+		return AsyncResource<T_Resource>(load, placeholder);
 	}
 
-	return nullptr;
+	{
+		std::unique_lock lock(this->mutex);
+
+		auto [it, created] = this->pendingLoads.try_emplace(id);
+
+		if (!created) {
+			return AsyncResource<T_Resource>(it->second, placeholder);
+		}
+
+		load = it->second = std::make_shared<AsyncLoad>();
+	}
+
+	ResourceLoader::Enqueue([this, id, resourcePath, load, loadParams...]() {
+		uint64_t fileHash = HashContent(resourcePath, typeid(T_Resource));
+		uint64_t contentKey = CombineParams(fileHash, loadParams...);
+		const Resource* shared = AcquireShared(contentKey, typeid(T_Resource));
+		T_Resource* imported = nullptr;
+
+		if (!shared) {
+			LoadingFile outerFile = loadingFile;
+			loadingFile = { &resourcePath, &typeid(T_Resource), fileHash };
+			imported = T_Resource::Import(resourcePath, loadParams...);
+			loadingFile = outerFile;
+		}
+
+		ResourceLoader::EnqueueUpload([this, id, load, contentKey, shared, imported]() {
+			const Resource* res = shared;
+
+			if (imported) {
+				imported->Upload();
+
+				res = ShareLoaded(contentKey, typeid(T_Resource), imported);
+			}
+
+			CompleteLoad(id, load, res ? Insert(id, typeid(T_Resource), res, contentKey, true) : nullptr);
+		}, [this, id, load, contentKey, shared, imported]() {
+			delete imported;
+
+			if (shared) {
+				delete ReleaseShared(contentKey, shared);
+			}
+
+			CompleteLoad(id, load, nullptr);
+		});
+	}, [this, id, load]() {
+		CompleteLoad(id, load, nullptr);
+	});
+
+	return AsyncResource<T_Resource>(load, placeholder);
+}
+
+template<class T_Resource>
+	requires(std::derived_from<T_Resource, Resource>)
+void ResourceDatabase::SetPlaceholder(T_Resource* placeholder) {
+	std::lock_guard lock(sharedMutex);
+
+	placeholders[&typeid(T_Resource)] = placeholder;
+}
+
+template<class T_Resource>
+	requires(std::derived_from<T_Resource, Resource>)
+T_Resource* ResourceDatabase::GetPlaceholder() {
+	std::lock_guard lock(sharedMutex);
+
+	auto it = placeholders.find(&typeid(T_Resource));
+
+	return it != placeholders.end() ? (T_Resource*) it->second : nullptr;
 }
 
 template <typename T_Resource>
 	requires(std::derived_from<T_Resource, Resource>)
 void ResourceDatabase::Register(T_Resource* resource, const fs::path& path) {
-	if (this->loadedResources.contains(path) && this->loadedResources[path].resource) {
-		spdlog::warn("Registering a resource multiple times: {}", path.string().c_str());
+	ResourceId id = ResourcePaths::Intern(path);
+
+	{
+		std::unique_lock lock(this->mutex);
+
+		auto [it, created] = this->loadedResources.try_emplace(id);
+
+		if (!created) {
+			spdlog::warn("Registering a resource multiple times: {}", path.string().c_str());
+		}
+
+		ResourceInfo& info = it->second;
+
+		info.type = &typeid(T_Resource);
+		info.resource = resource;
+		info.contentKey = 0;
+		info.references = 0;
+		info.pinned = true;
+		info.lastUsed = this->useCounter++;
 	}
 
-	this->loadedResources[path] = ResourceInfo {
-		.type = &typeid(T_Resource),
-		.resource = resource
-	};
+	MemoryTracker::SetLabel(resource, path.string());
 }
 
 template <typename T_Resource>
 	requires(!std::derived_from<T_Resource, Resource>)
 void ResourceDatabase::Register(T_Resource* resource, const fs::path& path) {
-	if (this->loadedGenericAssets.contains(path)) {
+	std::unique_lock lock(this->mutex);
+
+	ResourceId id = ResourcePaths::Intern(path);
+
+	if (this->loadedGenericAssets.contains(id)) {
 		spdlog::warn("Registering a resource multiple times: {}", path.string().c_str());
 	}
 
-	this->loadedGenericAssets[path] = ResourceInfo {
+	this->loadedGenericAssets[id] = GenericInfo {
 		.type = &typeid(T_Resource),
-		.resource = resource
+		.resource = resource,
+		.destroy = [](const void* asset) {
+			delete (const T_Resource*) asset;
+		}
 	};
 }
 
 template <typename T_Resource>
 	requires(std::derived_from<T_Resource, Resource>)
 bool ResourceDatabase::IsLoaded(const fs::path& path) const {
-	return this->loadedResources.contains(path) && this->loadedResources.at(path).type == &typeid(T_Resource) && this->loadedResources.at(path).resource;
+	std::shared_lock lock(this->mutex);
+
+	auto it = this->loadedResources.find(ResourcePaths::Intern(path));
+
+	return it != this->loadedResources.end() && it->second.type == &typeid(T_Resource);
 }
 
 template <typename T_Resource>
 	requires(!std::derived_from<T_Resource, Resource>)
 bool ResourceDatabase::IsLoaded(const fs::path& path) const {
-	return this->loadedGenericAssets.contains(path) && this->loadedGenericAssets.at(path).type == &typeid(T_Resource) && this->loadedGenericAssets.at(path).resource;
+	std::shared_lock lock(this->mutex);
+
+	auto it = this->loadedGenericAssets.find(ResourcePaths::Intern(path));
+
+	return it != this->loadedGenericAssets.end() && it->second.type == &typeid(T_Resource);
+}
+
+template <typename T_Resource>
+	requires(std::derived_from<T_Resource, Resource>)
+std::vector<std::pair<fs::path, T_Resource*>> ResourceDatabase::GetLoaded() const {
+	std::shared_lock lock(this->mutex);
+
+	std::vector<std::pair<fs::path, T_Resource*>> result;
+
+	for (const auto& [id, info] : this->loadedResources) {
+		if (info.type == &typeid(T_Resource)) {
+			result.push_back({ ResourcePaths::GetPath(id), (T_Resource*) info.resource });
+		}
+	}
+
+	return result;
+}
+
+template<class T_Resource>
+ResourceHandle<T_Resource>::ResourceHandle(ResourceDatabase* database, ResourceId id, T_Resource* resource):
+database(database),
+id(id),
+resource(resource) { }
+
+template<class T_Resource>
+ResourceHandle<T_Resource>::ResourceHandle():
+database(nullptr),
+id(0),
+resource(nullptr) { }
+
+template<class T_Resource>
+ResourceHandle<T_Resource>::ResourceHandle(const ResourceHandle& other):
+database(other.database),
+id(other.id),
+resource(other.resource) {
+	if (this->database) {
+		this->database->AddReference(this->id);
+	}
+}
+
+template<class T_Resource>
+ResourceHandle<T_Resource>::ResourceHandle(ResourceHandle&& other):
+database(other.database),
+id(other.id),
+resource(other.resource) {
+	other.database = nullptr;
+	other.resource = nullptr;
+}
+
+template<class T_Resource>
+ResourceHandle<T_Resource>::~ResourceHandle() {
+	if (this->database) {
+		this->database->Release(this->id);
+	}
+}
+
+template<class T_Resource>
+ResourceHandle<T_Resource>& ResourceHandle<T_Resource>::operator=(ResourceHandle other) {
+	std::swap(this->database, other.database);
+	std::swap(this->id, other.id);
+	std::swap(this->resource, other.resource);
+
+	return *this;
+}
+
+template<class T_Resource>
+T_Resource* ResourceHandle<T_Resource>::Get() const {
+	return this->resource;
+}
+
+template<class T_Resource>
+T_Resource* ResourceHandle<T_Resource>::operator->() const {
+	return this->resource;
+}
+
+template<class T_Resource>
+ResourceHandle<T_Resource>::operator bool() const {
+	return this->resource != nullptr;
+}
+
+template<class T_Resource>
+ResourceId ResourceHandle<T_Resource>::GetId() const {
+	return this->id;
+}
+
+template<class T_Resource>
+AsyncResource<T_Resource>::AsyncResource():
+load(nullptr),
+placeholder(nullptr) { }
+
+template<class T_Resource>
+AsyncResource<T_Resource>::AsyncResource(std::shared_ptr<AsyncLoad> load, T_Resource* placeholder):
+load(std::move(load)),
+placeholder(placeholder) { }
+
+template<class T_Resource>
+LoadStatus AsyncResource<T_Resource>::GetStatus() const {
+	return this->load ? this->load->status.load() : LoadStatus::Failed;
+}
+
+template<class T_Resource>
+bool AsyncResource<T_Resource>::IsReady() const {
+	return GetStatus() == LoadStatus::Ready;
+}
+
+template<class T_Resource>
+T_Resource* AsyncResource<T_Resource>::Get() const {
+	return IsReady() ? (T_Resource*) this->load->resource : this->placeholder;
+}
+
+template<class T_Resource>
+T_Resource* AsyncResource<T_Resource>::Wait() const {
+	if (this->load) {
+		ResourceLoader::ProcessUploadsUntil([this] {
+			return GetStatus() != LoadStatus::Loading;
+		});
+	}
+
+	return Get();
+}
+
+template<class T_Resource>
+const std::shared_ptr<AsyncLoad>& AsyncResource<T_Resource>::GetLoad() const {
+	return this->load;
+}
+
+template<class T_Resource>
+AsyncResource<T_Resource> ResourceBatch::Add(const AsyncResource<T_Resource>& resource) {
+	if (resource.GetLoad()) {
+		this->loads.push_back(resource.GetLoad());
+	}
+
+	return resource;
 }
\ No newline at end of file
@@ -2,6 +2,7 @@
 
 #include <concepts>
 #include <vector>
+#include <span>
 #include <typeinfo>
 #include <queue>
 
@@ -58,7 +59,7 @@ public:
 	bool IsEnabled() const;
 	void SetEnabled(bool value);
 
-	const std::vector<SceneNode*> GetChildren();
+	std::span<SceneNode* const> GetChildren() const;
 	SceneNode* GetParent();
 	void SetParent(SceneNode* newParent);
 	bool IsChildOf(const SceneNode* node);
@@ -73,7 +74,7 @@ public:
 	bool CheckLayerMask(uint32_t layerMask);
 	void SetLayer(uint8_t layer);
 
-	const std::vector<GameObject*> AttachedObjects();
+	std::span<GameObject* const> AttachedObjects() const;
 	
 	template<class T_GO, typename... T_Param>
 		requires std::derived_from<T_GO, GameObject>
@@ -91,6 +92,11 @@ public:
 		requires std::derived_from<T_GO, GameObject>
 	std::vector<T_GO*> GetAllObjects() const;
 
+	// Appends instead of returning a new vector, pass a FrameVector for per-frame queries
+	template<class T_GO, class T_Container>
+		requires std::derived_from<T_GO, GameObject>
+	void GetAllObjects(T_Container& result) const;
+
 	template<class T_GO>
 		requires std::derived_from<T_GO, GameObject>
 	T_GO* GetObjectInChildren() const;
@@ -103,12 +109,16 @@ public:
 		requires std::derived_from<T_GO, GameObject>
 	std::vector<T_GO*> GetAllObjectsInChildren() const;
 
+	template<class T_GO, class T_Container>
+		requires std::derived_from<T_GO, GameObject>
+	void GetAllObjectsInChildren(T_Container& result) const;
+
 	void DeleteObject(GameObject* obj);
 
 	void AttachScene(Scene* scene);
 	void DetachScene(Scene* scene);
 
-	std::vector<Scene*> GetAttachedScenes() const;
+	std::span<Scene* const> GetAttachedScenes() const;
 
 	static void operator delete(SceneNode* ptr, std::destroying_delete_t);
 };
@@ -172,6 +182,10 @@ public:
 		requires std::derived_from<T_GO, GameObject>
 	std::vector<T_GO*> FindObjectsOfType();
 
+	template<class T_GO, class T_Container>
+		requires std::derived_from<T_GO, GameObject>
+	void FindObjectsOfType(T_Container& result);
+
 	template<class T_SC>
 		requires std::derived_from<T_SC, SceneComponent>
 	T_SC* GetComponent();
@@ -246,6 +260,14 @@ template<class T_GO>
 std::vector<T_GO*> SceneNode::GetAllObjects() const {
 	std::vector<T_GO*> result;
 
+	GetAllObjects<T_GO>(result);
+
+	return result;
+}
+
+template<class T_GO, class T_Container>
+	requires std::derived_from<T_GO, GameObject>
+void SceneNode::GetAllObjects(T_Container& result) const {
 	for (GameObject* obj : this->objects) {
 		T_GO* converted = dynamic_cast<T_GO*>(obj);
 
@@ -253,8 +275,6 @@ std::vector<T_GO*> SceneNode::GetAllObjects() const {
 			result.push_back(converted);
 		}
 	}
-
-	return result;
 }
 
 template<class T_GO>
@@ -294,19 +314,23 @@ bool SceneNode::TryGetObjectInChildren(T_GO*& found) const {
 template<class T_GO>
 	requires std::derived_from<T_GO, GameObject>
 std::vector<T_GO*> SceneNode::GetAllObjectsInChildren() const {
-	std::vector<T_GO*> result = GetAllObjects<T_GO>();
-
-	for (const auto& child : this->children) {
-		std::vector<T_GO*> partial = child->GetAllObjectsInChildren<T_GO>();
+	std::vector<T_GO*> result;
 
-		for (const auto& obj : partial) {
-			result.push_back(obj);
-		}
-	}
+	GetAllObjectsInChildren<T_GO>(result);
 
 	return result;
 }
 
+template<class T_GO, class T_Container>
+	requires std::derived_from<T_GO, GameObject>
+void SceneNode::GetAllObjectsInChildren(T_Container& result) const {
+	GetAllObjects<T_GO>(result);
+
+	for (const auto& child : this->children) {
+		child->GetAllObjectsInChildren<T_GO>(result);
+	}
+}
+
 template<class T_GO, typename... T_Param>
 	requires std::derived_from<T_GO, GameObject>
 T_GO* Scene::CreateObjectOn(SceneNode* node, T_Param... params) {
@@ -346,6 +370,12 @@ std::vector<T_GO*> Scene::FindObjectsOfType() {
 	return this->root->GetAllObjectsInChildren<T_GO>();
 }
 
+template<class T_GO, class T_Container>
+	requires std::derived_from<T_GO, GameObject>
+void Scene::FindObjectsOfType(T_Container& result) {
+	this->root->GetAllObjectsInChildren<T_GO>(result);
+}
+
 template<class T_SC>
 	requires std::derived_from<T_SC, SceneComponent>
 T_SC* Scene::GetComponent() {
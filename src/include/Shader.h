@@ -65,10 +65,15 @@ protected:
 	const GLuint handle;
 
 	ShaderBase(fs::path filePath, ShaderVariantInfo variantInfo, GLuint handle);
+
+	static ShaderBase* Compile(const fs::path& filePath, GLenum shaderType, char* rootContent);
 public:
 	virtual ~ShaderBase();
 	static ShaderBase* Load(fs::path filePath);
 	static ShaderBase* Load(fs::path filePath, const ShaderVariantInfo& variantInfo);
+
+	// Returns the source with all includes expanded, exactly as it would be handed to the driver
+	static std::string Preprocess(const fs::path& filePath);
 	
 	const fs::path& GetFilePath() const;
 	std::string GetName() const;
@@ -137,6 +142,7 @@ private:
 	ComputeShader(fs::path filePath, ShaderVariantInfo variantInfo, GLuint handle);
 public:
 	static ComputeShader* Load(fs::path filePath);
+	static ComputeShader* FromSource(const fs::path& virtualPath, const std::string& source);
 
 	virtual GLenum GetType() const;
 };
@@ -164,6 +170,8 @@ class ShaderProgram {
 private:
 	VertexShader* vertexShader;
 	GeometryShader* geometryShader;
+	TesselationControlShader* tessCtrlShader;
+	TesselationEvaluationShader* tessEvalShader;
 	PixelShader* pixelShader;
 	UniformSpec uniforms;
 	ShaderProgramFlags flags;
@@ -179,6 +187,12 @@ public:
 	const UniformSpec& GetUniforms() const;
 	const VertexSpec& GetVertexSpec() const;
 
+	VertexShader* GetVertexShader() const;
+	GeometryShader* GetGeometryShader() const;
+	TesselationControlShader* GetTessControlShader() const;
+	TesselationEvaluationShader* GetTessEvaluationShader() const;
+	PixelShader* GetPixelShader() const;
+
 	bool IgnoresDepthPrepass() const;
 	bool CastsShadows() const;
 	bool UsesPatches() const;
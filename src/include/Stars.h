@@ -0,0 +1,22 @@
+#pragma once
+
+#include <GameObject.h>
+#include <Mesh.h>
+#include <Material.h>
+#include <Debug.h>
+
+class Stars : public GameObject, public ImGuiDrawable {
+private:
+	Mesh* starMesh;
+	Material* starMaterial;
+	int starCount;
+public:
+	Stars(int starCount = 1000);
+
+	int GetStarCount() const;
+	void SetStarCount(int starCount);
+
+	void Render();
+
+	virtual void DrawImGui();
+};
\ No newline at end of file
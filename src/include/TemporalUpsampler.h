@@ -0,0 +1,52 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+class ResourceDatabase;
+class Framebuffer;
+class Texture;
+class Texture2D;
+class ShaderProgram;
+class ComputeShaderDispatch;
+
+class TemporalUpsampler {
+private:
+	static constexpr int JitterSequenceLength = 8;
+
+	Framebuffer* motionFramebuffer;
+	Texture2D* historyBuffers[2];
+	int historyIndex;
+	bool historyValid;
+
+	ShaderProgram* motionVectorShader;
+	ComputeShaderDispatch* resolveShader;
+
+	glm::uvec2 renderResolution;
+
+	int jitterIndex;
+	glm::vec2 jitter;
+
+	glm::mat4 viewProjection;
+	glm::mat4 previousViewProjection;
+
+	float feedback;
+public:
+	TemporalUpsampler(ResourceDatabase* resources);
+	~TemporalUpsampler();
+
+	void Resize(const glm::uvec2& renderResolution, const glm::uvec2& outputResolution, Texture* depthTexture);
+
+	void BeginFrame(const glm::mat4& unjitteredViewProjection);
+	void InvalidateHistory();
+
+	glm::vec2 GetProjectionJitter() const;
+	const glm::mat4& GetPreviousViewProjection() const;
+
+	Framebuffer* GetMotionFramebuffer() const;
+	ShaderProgram* GetMotionVectorShader() const;
+	Texture2D* GetHistoryBuffer(int index) const;
+
+	Texture2D* Resolve(Texture2D* color, Texture2D* depth, Texture2D* velocity, Texture2D* output, bool accumulate);
+
+	void DrawImGui();
+};
\ No newline at end of file
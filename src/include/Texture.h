@@ -2,6 +2,7 @@
 
 #include <filesystem>
 #include <concepts>
+#include <cstdint>
 
 #include <glm/glm.hpp>
 #include <glad/glad.h>
@@ -89,6 +90,9 @@ protected:
 	bool dirty;
 	bool owning;
 
+	// Decoded pixels waiting for Upload, only set for textures created with Import
+	unsigned char* pixelData = nullptr;
+
 	TextureChannels channels;
 	TextureColor colorSpace;
 	TextureFormat format;
@@ -100,6 +104,8 @@ protected:
 	TextureInfoBit<bool> mipmapped;
 
 	virtual void Create() = 0;
+
+	void TrackMemory();
 public:
 	static constexpr TextureParams ColorTextureRGB {.channels = TextureChannels::RGB, .colorSpace = TextureColor::SRGB, .format = TextureFormat::Ubyte, .minFilter = TextureFilter::LinearMipmapLinear};
 	static constexpr TextureParams ColorTextureRGBA {TextureChannels::RGBA, TextureColor::SRGB, TextureFormat::Ubyte};
@@ -152,6 +158,9 @@ public:
 
 	bool IsDirty() const;
 	void Update();
+
+	// Storage size derived from format, dimensions and the mip chain
+	uint64_t EstimateGPUBytes() const;
 };
 
 class Texture2D : public Texture {
@@ -163,6 +172,11 @@ public:
 	Texture2D(unsigned int width, unsigned int height, const TextureParams& creationParams, GLuint handle);
 
 	static Texture2D* Load(const fs::path& texturePath, const TextureParams& loadParams);
+	// Decodes the image without touching the GPU, safe to call from any thread, call Upload before using it
+	static Texture2D* Import(const fs::path& texturePath, const TextureParams& loadParams);
+
+	// Creates the GL texture from the imported pixels, does nothing if it was uploaded already
+	void Upload();
 
 	virtual constexpr TextureType GetType() const {
 		return TextureType::Texture2D;
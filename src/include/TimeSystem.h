@@ -54,10 +54,15 @@ private:
 	static TimePoint now;
 	static float applicationTime;
 	static float deltaTime;
+	static float fixedDelta;
 	static void Update();
 public:
 	static const TimePoint& Now();
 	static TimePoint SystemTime();
 	static float Current();
 	static float Delta();
+
+	// A positive fixed delta makes every frame advance the application time by exactly that step
+	static float GetFixedDelta();
+	static void SetFixedDelta(float delta);
 };
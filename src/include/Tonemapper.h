@@ -28,5 +28,13 @@ public:
 
 	virtual void OnPostProcess(const PostProcessParams* params);
 
+	virtual bool RunsInPlace() const;
+
+	virtual int GetFusedVariant() const;
+	virtual bool GetFusedSnippet(PostProcessSnippet* snippet) const;
+
+	virtual std::vector<float> GetSettings() const;
+	virtual void SetSettings(const std::vector<float>& settings);
+
 	virtual void DrawImGui();
 };
\ No newline at end of file
@@ -96,6 +96,11 @@ public:
 	UniformSpec(const ShaderProgram* program);
 	UniformSpec(const ComputeShaderProgram* program);
 
+	// Appends a variable to the default block, used to describe a layout without a linked program
+	void AddVariable(const std::string& name, UniformType type, int binding = -1);
+
+	static int SizeOf(UniformType type);
+
 	unsigned int GetBufferSize() const;
 	unsigned int VariableCount() const;
 	unsigned int UniformBuffersCount() const;
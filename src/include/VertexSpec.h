@@ -18,14 +18,28 @@ enum class VertexInputType : uint8_t {
 	Color
 };
 
+// How the components of an input are stored, shaders read every format as floats
+enum class VertexFormat : uint8_t {
+	Float = 0,
+	Half,
+	// Normalized to [0, 1]
+	Unorm16,
+	// x, y and z normalized to [-1, 1] in one 32 bit word, for unit vectors
+	Snorm10,
+	// Normalized to [0, 1]
+	Unorm8
+};
+
 struct VertexInput {
 	VertexInputType type;
 	uint8_t length;
+	VertexFormat format = VertexFormat::Float;
 };
 
 class VertexSpec {
 private:
 	uint64_t hash;
+	uint32_t formats;
 	
 	void SetInputAt(int index, VertexInput input);
 public:
@@ -39,15 +53,28 @@ public:
 	VertexSpec(std::vector<VertexInput> inputs);
 
 	VertexSpec(const VertexSpec& other);
-	VertexSpec(uint64_t hash);
+	VertexSpec(uint64_t hash, uint32_t formats = 0);
 	VertexSpec();
 
+	VertexSpec& operator=(const VertexSpec& other) = default;
+
 	std::vector<VertexInput> GetInputs() const;
 
 	int GetLengthOf(VertexInputType input) const;
+	VertexFormat GetFormatOf(VertexInputType input) const;
+	// Inputs are laid out in the order of VertexInputType, each starting 4 byte aligned
+	unsigned int GetOffsetOf(VertexInputType input) const;
 
+	// Components per vertex
 	unsigned int VertexSize() const;
+	unsigned int VertexBytes() const;
 	uint64_t GetHash() const;
+	uint32_t GetFormats() const;
+
+	// Copy of the spec storing input in format, inputs the spec does not have are left out
+	VertexSpec WithFormat(VertexInputType input, VertexFormat format) const;
+
+	static unsigned int GetSizeOf(VertexFormat format, unsigned int length);
 
 	bool Compatible(const VertexSpec& other) const;
 	bool operator==(const VertexSpec& other) const;
@@ -1,5 +1,8 @@
 #include "imgui.h"
 
+#include <cstdio>
+#include <string_view>
+
 #include <Formatters.h>
 #include <Shader.h>
 #include <Mesh.h>
@@ -9,6 +12,7 @@
 #include <Graphics.h>
 #include <Camera.h>
 #include <Skybox.h>
+#include <Stars.h>
 #include <Resources.h>
 #include <Light.h>
 #include <Bloom.h>
@@ -108,46 +112,6 @@ public:
 	}
 };
 
-class Stars : public GameObject, public ImGuiDrawable {
-private:
-	Mesh* starMesh;
-	Material* starMaterial;
-	int starCount;
-public:
-	Stars(int starCount = 1000) {
-		this->starMesh = GetScene()->Resources()->Get<Mesh>("./res/models/star.obj");
-		
-		ShaderProgram* starProgram = ShaderProgram::Build()
-		.WithVertexShader(
-			GetScene()->Resources()->Get<VertexShader>("./res/shaders/star.vert")
-		).WithGeometryShader(
-			GetScene()->Resources()->Get<GeometryShader>("./res/shaders/star.geom")
-		).WithPixelShader(
-			GetScene()->Resources()->Get<PixelShader>("./res/shaders/star.frag")
-		).Link();
-		starProgram->SetIgnoresDepthPrepass(true);
-		starProgram->SetCastsShadows(false);
-
-		this->starMaterial = new Material(starProgram);
-		this->starCount = starCount;
-	}
-
-	void Render() {
-		GetScene()->GetGraphics()->DrawMeshInstanced(
-			this->starMesh,
-			0,
-			this->starMaterial,
-			this->GlobalTransform(),
-			this->starCount,
-			BoundingBox::CenterAndExtents(glm::vec3(0, 0, 0), glm::vec3(15, 15, 15))
-		);
-	}
-
-	void DrawImGui() {
-		ImGui::InputInt("Star count", &this->starCount);
-	}
-};
-
 void InitScene(Scene* mainScene) {
 	ShaderProgram* skyProg = ShaderProgram::Build().WithVertexShader(
 		mainScene->Resources()->Get<VertexShader>("./res/shaders/skybox.vert")
@@ -179,7 +143,29 @@ void InitScene(Scene* mainScene) {
 		mainScene->Resources()->Get<PixelShader>("./res/shaders/pbr refract.frag")
 	).Link();
 
+	ResourceDatabase* resources = mainScene->Resources();
+
+	// Decoded concurrently on the loader threads, the Get calls below then find everything loaded
+	ResourceBatch preload;
+	preload.Add(resources->GetAsync<Mesh>("./res/models/cannon/cannon.obj"));
+	preload.Add(resources->GetAsync<Mesh>("./res/models/not_cube.obj"));
+	preload.Add(resources->GetAsync<Mesh>("./res/models/tv_stand.fbx"));
+	preload.Add(resources->GetAsync<Mesh>("./res/models/schnoz/schnoz.obj"));
+	preload.Add(resources->GetAsync<Texture2D>("./res/models/cannon/textures/cannon_01_diff_1k.png", Texture::ColorTextureRGB));
+	preload.Add(resources->GetAsync<Texture2D>("./res/models/cannon/textures/cannon_01_nor_gl_1k.png", Texture::TechnicalMapXYZ));
+	preload.Add(resources->GetAsync<Texture2D>("./res/models/cannon/textures/cannon_01_arm_1k.png", Texture::TechnicalMapXYZ));
+	preload.Add(resources->GetAsync<Texture2D>("./res/textures/material_preview/worn-shiny-metal-albedo.png", Texture::ColorTextureRGB));
+	preload.Add(resources->GetAsync<Texture2D>("./res/textures/material_preview/worn-shiny-metal-Normal-ogl.png", Texture::TechnicalMapXYZ));
+	preload.Add(resources->GetAsync<Texture2D>("./res/textures/material_preview/worn-shiny-metal-arm.png", Texture::TechnicalMapXYZ));
+	preload.Add(resources->GetAsync<Texture2D>("./res/textures/material_preview/worn-rough-metal-arm.png", Texture::TechnicalMapXYZ));
+	preload.Add(resources->GetAsync<Texture2D>("./res/textures/material_preview/worn-shiny-nonmetal-arm.png", Texture::TechnicalMapXYZ));
+	preload.Add(resources->GetAsync<Texture2D>("./res/models/schnoz/Diffuse.png", Texture::ColorTextureRGB));
+
+	// Needs the GL context for its materials, so it loads here while the others decode
 	Mesh* gmConstructMesh = mainScene->Resources()->Get<Mesh>("./res/models/construct/construct.obj", true);
+
+	preload.Wait();
+
 	Mesh* cannonMesh = mainScene->Resources()->Get<Mesh>("./res/models/cannon/cannon.obj");
 	Mesh* cubeMesh = mainScene->Resources()->Get<Mesh>("./res/models/not_cube.obj");
 	Mesh* tvMesh = mainScene->Resources()->Get<Mesh>("./res/models/tv_stand.fbx");
@@ -351,8 +337,33 @@ void InitScene(Scene* mainScene) {
 	mainScene->AddComponent<DebugInspector>();
 }
 
-int main(int, char**) {
-	if (!Engine::Setup(InitScene)) {
+int main(int argc, char** argv) {
+	bool headless = false;
+	int frameCount = 300;
+	glm::uvec2 resolution(1920, 1080);
+
+	for (int i = 1; i < argc; i++) {
+		std::string_view arg = argv[i];
+
+		if (arg == "--headless") {
+			headless = true;
+		}
+		else if (arg == "--frames" && i + 1 < argc) {
+			frameCount = std::atoi(argv[++i]);
+		}
+		else if (arg == "--resolution" && i + 1 < argc) {
+			if (sscanf(argv[++i], "%ux%u", &resolution.x, &resolution.y) != 2) {
+				spdlog::error("Invalid resolution {}, expected WIDTHxHEIGHT", argv[i]);
+				return EXIT_FAILURE;
+			}
+		}
+	}
+
+	bool initialized = headless
+		? Engine::SetupHeadless(InitScene, resolution.x, resolution.y, frameCount)
+		: Engine::Setup(InitScene);
+
+	if (!initialized) {
 		spdlog::error("Failed to initialize project!");
 		return EXIT_FAILURE;
 	}